@@ -0,0 +1,43 @@
+
+BUILD_DIR := bin
+OBJ_DIR := obj
+
+ASSEMBLY := bench
+SRC_DIR := $(ASSEMBLY)
+EXTENSION := 
+COMPILER_FLAGS := -g -O2 -MD -Werror=vla -fdeclspec -fPIC
+INCLUDE_FLAGS := -Iengine/src
+LINKER_FLAGS := -L./$(BUILD_DIR)/ -lengine -Wl,-rpath,.
+DEFINES := -D_DEBUG -DFSNIMPORT
+
+SRC_FILES := $(shell find $(SRC_DIR) -name *.c)		# .c files
+DIRECTORIES := $(shell find $(SRC_DIR) -type d)		# directories with .h files
+OBJ_FILES := $(SRC_FILES:%=$(OBJ_DIR)/%.o)		# compiled .o objects
+
+all: scaffold compile link
+
+.PHONY: scaffold
+scaffold: # create build directory
+	@echo Scaffolding folder structure...
+	@mkdir -p $(addprefix $(OBJ_DIR)/,$(DIRECTORIES))
+	@echo Done.
+
+.PHONY: link
+link: scaffold $(OBJ_FILES) # link
+	@echo Linking $(ASSEMBLY)...
+	clang $(OBJ_FILES) -o $(BUILD_DIR)/$(ASSEMBLY)$(EXTENSION) $(LINKER_FLAGS)
+
+.PHONY: compile
+compile: #compile .c files
+	@echo Compiling...
+
+.PHONY: clean
+clean: # clean build directory
+	rm -rf $(BUILD_DIR)/$(ASSEMBLY)
+	rm -rf $(OBJ_DIR)/$(SRC_DIR)
+
+$(OBJ_DIR)/%.c.o: %.c # compile .c to .o object
+	@echo   $<...
+	@clang $< $(COMPILER_FLAGS) -c -o $@ $(DEFINES) $(INCLUDE_FLAGS)
+
+-include $(OBJ_FILES:.o=.d)
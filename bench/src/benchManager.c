@@ -0,0 +1,170 @@
+#include "benchManager.h"
+
+#include <core/fstring.h>
+#include <core/logger.h>
+#include <helpers/dinoArray.h>
+#include <helpers/sampleStats.h>
+#include <platform/filesystem.h>
+#include <platform/platform.h>
+
+#include <stdio.h>
+
+#define BENCH_MAX_RUNS 1024
+
+typedef struct bench {
+    const char* name;
+    u64 opsPerRun;
+    PFN_benchSetup setup;
+    PFN_benchRun run;
+    PFN_benchTeardown teardown;
+} bench;
+
+typedef struct benchResult {
+    char name[128];
+    u64 opsPerRun;
+    // All in nanoseconds per op.
+    sampleStats stats;
+} benchResult;
+
+volatile u64 benchSink;
+
+static bench* benches;
+
+void benchMgrInit() {
+    benches = dinoCreate(bench);
+}
+
+void benchMgrRegister(const char* name, u64 opsPerRun, PFN_benchSetup setup, PFN_benchRun run,
+                      PFN_benchTeardown teardown) {
+    bench b;
+    b.name = name;
+    b.opsPerRun = opsPerRun;
+    b.setup = setup;
+    b.run = run;
+    b.teardown = teardown;
+    dinoPush(benches, b);
+}
+
+static b8 writeJson(const char* path, benchResult* results, u32 cnt) {
+    fileHandle f;
+    if (!fsOpen(path, FILE_MODE_WRITE, false, &f)) {
+        FERROR("Couldn't open %s to write the bench results.", path);
+        return false;
+    }
+    // One benchmark a line so a baseline can be read back a line at a time.
+    fsWriteLine(&f, "{\"unit\":\"ns/op\",\"benches\":[");
+    char line[512];
+    for (u32 i = 0; i < cnt; ++i) {
+        sampleStats* s = &results[i].stats;
+        snprintf(line, sizeof(line),
+                 "{\"name\":\"%s\",\"ops\":%llu,\"runs\":%u,\"min\":%.3f,\"median\":%.3f,\"mean\":%.3f,\"stddev\":%.3f,"
+                 "\"max\":%.3f}%s",
+                 results[i].name, results[i].opsPerRun, s->count, s->min, s->p50, s->mean, s->stddev, s->max,
+                 i + 1 < cnt ? "," : "");
+        fsWriteLine(&f, line);
+    }
+    fsWriteLine(&f, "]}");
+    fsClose(&f);
+    FINFO("Wrote bench results to %s", path);
+    return true;
+}
+
+// Reads back a file written by writeJson.
+static benchResult* readBaseline(const char* path) {
+    fileHandle f;
+    if (!fsOpen(path, FILE_MODE_READ, false, &f)) {
+        FERROR("Couldn't open the baseline %s", path);
+        return 0;
+    }
+    benchResult* baseline = dinoCreate(benchResult);
+    char lineBuffer[512] = "";
+    char* c = &lineBuffer[0];
+    u64 lineLen = 0;
+    while (fsReadLine(&f, 511, &c, &lineLen)) {
+        benchResult r = {};
+        if (sscanf(lineBuffer, "{\"name\":\"%127[^\"]\",\"ops\":%llu,\"runs\":%u,\"min\":%lf,\"median\":%lf", r.name,
+                   &r.opsPerRun, &r.stats.count, &r.stats.min, &r.stats.p50) == 5) {
+            dinoPush(baseline, r);
+        }
+    }
+    fsClose(&f);
+    return baseline;
+}
+
+u32 benchMgrRunBenches(const benchOptions* options) {
+    u32 len = dinoLength(benches);
+    u32 timedRuns = options->timedRuns;
+    if (timedRuns == 0 || timedRuns > BENCH_MAX_RUNS) {
+        timedRuns = timedRuns ? BENCH_MAX_RUNS : 1;
+    }
+
+    f64* samples = platformAllocate(sizeof(f64) * timedRuns, false);
+    f64* scratch = platformAllocate(sizeof(f64) * timedRuns, false);
+    benchResult* results = dinoCreate(benchResult);
+    benchResult* baseline = options->baselinePath ? readBaseline(options->baselinePath) : 0;
+    u32 regressions = 0;
+
+    for (u32 i = 0; i < len; ++i) {
+        bench* b = &benches[i];
+        if (options->filter && !strSub(b->name, options->filter)) {
+            continue;
+        }
+        if (b->setup && !b->setup()) {
+            FWARN("[SKIPPED] %s setup failed.", b->name);
+            continue;
+        }
+        for (u32 w = 0; w < options->warmupRuns; ++w) {
+            b->run(b->opsPerRun);
+        }
+        for (u32 r = 0; r < timedRuns; ++r) {
+            u64 start = platformGetTimestampNs();
+            b->run(b->opsPerRun);
+            u64 end = platformGetTimestampNs();
+            samples[r] = (f64)(end - start) / (f64)b->opsPerRun;
+        }
+        if (b->teardown) {
+            b->teardown();
+        }
+
+        benchResult res = {};
+        strNCpy(res.name, b->name, sizeof(res.name) - 1);
+        res.opsPerRun = b->opsPerRun;
+        sampleStatsCompute(samples, timedRuns, scratch, &res.stats);
+        dinoPush(results, res);
+
+        FINFO("%-32s median %10.2f ns/op | min %10.2f | stddev %8.2f (%.1f%%)", b->name, res.stats.p50,
+              res.stats.min, res.stats.stddev, res.stats.mean > 0 ? res.stats.stddev / res.stats.mean * 100.0 : 0);
+
+        if (!baseline) {
+            continue;
+        }
+        u32 baseLen = dinoLength(baseline);
+        for (u32 j = 0; j < baseLen; ++j) {
+            if (!strEqual(baseline[j].name, b->name) || baseline[j].stats.p50 <= 0) {
+                continue;
+            }
+            f64 change = (res.stats.p50 - baseline[j].stats.p50) / baseline[j].stats.p50 * 100.0;
+            if (change > options->thresholdPct) {
+                regressions++;
+                FERROR("[REGRESSED] %s is %.1f%% slower than the baseline (%.2f -> %.2f ns/op)", b->name, change,
+                       baseline[j].stats.p50, res.stats.p50);
+            } else if (change < -options->thresholdPct) {
+                FINFO("[IMPROVED] %s is %.1f%% faster than the baseline (%.2f -> %.2f ns/op)", b->name, -change,
+                      baseline[j].stats.p50, res.stats.p50);
+            }
+            break;
+        }
+    }
+
+    if (options->jsonPath) {
+        writeJson(options->jsonPath, results, dinoLength(results));
+    }
+    if (baseline) {
+        FINFO("%u regression(s) over %.1f%% against %s", regressions, options->thresholdPct, options->baselinePath);
+        dinoDestroy(baseline);
+    }
+    dinoDestroy(results);
+    platformFree(samples, false);
+    platformFree(scratch, false);
+    return regressions;
+}
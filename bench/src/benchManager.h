@@ -0,0 +1,50 @@
+#pragma once
+
+#include <defines.h>
+
+/**
+ * @brief Runs ops operations of whatever is being benchmarked.
+ */
+typedef void (*PFN_benchRun)(u64 ops);
+/** @brief Called once before a benchmark's runs. Returns false to skip it. */
+typedef b8 (*PFN_benchSetup)();
+/** @brief Called once after a benchmark's runs. */
+typedef void (*PFN_benchTeardown)();
+
+typedef struct benchOptions {
+    // Untimed runs before the timed ones to warm caches and allocators.
+    u32 warmupRuns;
+    // Timed runs. The stats are over these.
+    u32 timedRuns;
+    // Only run benchmarks with this in their name. 0 runs all of them.
+    const char* filter;
+    // Where to write the results as JSON. 0 to not write them.
+    const char* jsonPath;
+    // A previous run's JSON to compare against. 0 to not compare.
+    const char* baselinePath;
+    // How many percent slower than the baseline's median counts as a regression.
+    f64 thresholdPct;
+} benchOptions;
+
+// Feed results in here so the compiler can't optimize the work away.
+extern volatile u64 benchSink;
+
+void benchMgrInit();
+
+/**
+ * @brief Registers a benchmark.
+ * @param name The benchmark's name. Used to match it up with the baseline
+ * @param opsPerRun How many ops each run does. Pick enough for a run to take about a millisecond
+ * @param setup Called before the runs. Can be 0
+ * @param run Does the work being timed
+ * @param teardown Called after the runs. Can be 0
+ */
+void benchMgrRegister(const char* name, u64 opsPerRun, PFN_benchSetup setup, PFN_benchRun run,
+                      PFN_benchTeardown teardown);
+
+/**
+ * @brief Runs every registered benchmark.
+ * @param options How to run them
+ * @returns How many benchmarks regressed against the baseline
+ */
+u32 benchMgrRunBenches(const benchOptions* options);
@@ -0,0 +1,61 @@
+#include <core/fmemory.h>
+#include <core/fstring.h>
+#include <helpers/dinoArray.h>
+#include <helpers/hashtable.h>
+#include "../benchManager.h"
+
+#define TABLE_SIZE 4096
+#define KEY_CNT 1024
+
+static hashtable table;
+static void* tableMemory;
+static char keys[KEY_CNT][16];
+// The table keeps a pointer to the value rather than a copy, so they need to
+// outlive it.
+static u64 values[KEY_CNT];
+
+static b8 hashtableSetup() {
+    tableMemory = fallocate(sizeof(entry) * TABLE_SIZE, MEMORY_TAG_DICT);
+    hashtableCreate(sizeof(u64), TABLE_SIZE, tableMemory, false, &table);
+    for (u64 i = 0; i < KEY_CNT; ++i) {
+        strFmt(keys[i], "key_%llu", i);
+        values[i] = i;
+        hashtableSet(&table, keys[i], &values[i]);
+    }
+    return true;
+}
+
+static void hashtableTeardown() {
+    // Not hashtableDestroy, it frees the hashtable struct itself too.
+    ffree(tableMemory, sizeof(entry) * TABLE_SIZE, MEMORY_TAG_DICT);
+}
+
+static void hashtableSetRun(u64 ops) {
+    for (u64 i = 0; i < ops; ++i) {
+        hashtableSet(&table, keys[i % KEY_CNT], &values[i % KEY_CNT]);
+    }
+}
+
+static void hashtableGetRun(u64 ops) {
+    u64 v = 0;
+    for (u64 i = 0; i < ops; ++i) {
+        hashtableGet(&table, keys[i % KEY_CNT], &v);
+        benchSink += v;
+    }
+}
+
+// Grows a dino array from empty, so the resizes are part of the cost.
+static void dinoPushRun(u64 ops) {
+    u64* arr = dinoCreate(u64);
+    for (u64 i = 0; i < ops; ++i) {
+        dinoPush(arr, i);
+    }
+    benchSink += dinoLength(arr);
+    dinoDestroy(arr);
+}
+
+void containersRegisterBenches() {
+    benchMgrRegister("hashtableSet", 10000, hashtableSetup, hashtableSetRun, hashtableTeardown);
+    benchMgrRegister("hashtableGet", 10000, hashtableSetup, hashtableGetRun, hashtableTeardown);
+    benchMgrRegister("dinoPush 10k", 10000, 0, dinoPushRun, 0);
+}
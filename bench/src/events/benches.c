@@ -0,0 +1,40 @@
+#include <core/event.h>
+#include "../benchManager.h"
+
+#define LISTENER_CNT 32
+
+static u64 listeners[LISTENER_CNT];
+
+static b8 onEvent(u16 code, void* sender, void* listenerInst, eventContext context) {
+    benchSink += *(u64*)listenerInst + context.data.u64[0];
+    // Not handled, so every listener gets it.
+    return false;
+}
+
+static b8 fanOutSetup() {
+    for (u32 i = 0; i < LISTENER_CNT; ++i) {
+        listeners[i] = i;
+        if (!eventRegister(EVENT_CODE_DEBUG4, &listeners[i], onEvent)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void fanOutRun(u64 ops) {
+    eventContext context = {};
+    for (u64 i = 0; i < ops; ++i) {
+        context.data.u64[0] = i;
+        eventFire(EVENT_CODE_DEBUG4, 0, context);
+    }
+}
+
+static void fanOutTeardown() {
+    for (u32 i = 0; i < LISTENER_CNT; ++i) {
+        eventUnregister(EVENT_CODE_DEBUG4, &listeners[i], onEvent);
+    }
+}
+
+void eventsRegisterBenches() {
+    benchMgrRegister("eventFire 32 listeners", 5000, fanOutSetup, fanOutRun, fanOutTeardown);
+}
@@ -0,0 +1,132 @@
+#include "benchManager.h"
+
+#include "containers/benches.h"
+#include "events/benches.h"
+#include "math/benches.h"
+#include "memory/benches.h"
+#include "resources/benches.h"
+#include "strings/benches.h"
+
+#include <core/event.h>
+#include <core/fmemory.h>
+#include <core/fstring.h>
+#include <core/logger.h>
+#include <platform/platform.h>
+#include <resources/resourceManager.h>
+#include <resources/vfs.h>
+
+#include <stdio.h>
+
+/*
+ * Usage: bench [--filter name] [--runs n] [--warmup n] [--json out.json]
+ *              [--baseline base.json] [--threshold percent]
+ *
+ * Run from bin/ like the testbed so ../Assets/ resolves. Save a run with
+ * --json and pass it back with --baseline later to catch regressions. Exits
+ * with 1 if anything regressed, 2 if the arguments are wrong.
+ */
+static void printUsage(FILE* out, const char* exe) {
+    fprintf(out,
+            "Usage: %s [--filter name] [--runs n] [--warmup n] [--json out.json]\n"
+            "          [--baseline base.json] [--threshold percent]\n"
+            "  --filter     Only run benches whose name contains this\n"
+            "  --runs       Timed runs of each bench, 30 by default\n"
+            "  --warmup     Untimed runs before those, 3 by default\n"
+            "  --json       Writes the results here\n"
+            "  --baseline   Compares against results written with --json\n"
+            "  --threshold  How many percent slower counts as a regression, 10 by default\n",
+            exe);
+}
+
+int main(int argc, char** argv) {
+    benchOptions options = {};
+    options.warmupRuns = 3;
+    options.timedRuns = 30;
+    options.thresholdPct = 10.0;
+
+    for (i32 i = 1; i < argc; i += 2) {
+        const char* arg = argv[i];
+        if (strEqual(arg, "--help") || strEqual(arg, "-h")) {
+            printUsage(stdout, argv[0]);
+            return 0;
+        }
+        // Everything else takes a value.
+        if (i + 1 >= argc) {
+            fprintf(stderr, "%s needs a value.\n", arg);
+            printUsage(stderr, argv[0]);
+            return 2;
+        }
+        const char* val = argv[i + 1];
+        b8 parsed = true;
+        if (strEqual(arg, "--filter")) {
+            options.filter = val;
+        } else if (strEqual(arg, "--runs")) {
+            parsed = strToU32(val, &options.timedRuns);
+        } else if (strEqual(arg, "--warmup")) {
+            parsed = strToU32(val, &options.warmupRuns);
+        } else if (strEqual(arg, "--json")) {
+            options.jsonPath = val;
+        } else if (strEqual(arg, "--baseline")) {
+            options.baselinePath = val;
+        } else if (strEqual(arg, "--threshold")) {
+            parsed = strToF64(val, &options.thresholdPct);
+        } else {
+            fprintf(stderr, "Unknown argument %s\n", arg);
+            printUsage(stderr, argv[0]);
+            return 2;
+        }
+        if (!parsed) {
+            fprintf(stderr, "%s isn't a valid value for %s.\n", val, arg);
+            return 2;
+        }
+    }
+
+    memorySystemSettings memSettings;
+    memSettings.totalSize = MEBIBYTES(256);
+    memoryInit(memSettings);
+
+    u64 eventMemReq = 0;
+    eventInit(&eventMemReq, 0);
+    void* eventState = platformAllocate(eventMemReq, false);
+    platformZeroMemory(eventState, eventMemReq);
+    eventInit(&eventMemReq, eventState);
+
+    vfsConfig vfsSettings = {};
+    vfsSettings.rootAssetPath = "../Assets/";
+    u64 vfsMemReq = 0;
+    vfsInit(&vfsMemReq, 0, vfsSettings);
+    void* vfsState = platformAllocate(vfsMemReq, false);
+    vfsInit(&vfsMemReq, vfsState, vfsSettings);
+
+    resourceManagerSettings rsSettings = {};
+    rsSettings.maxManagers = 32;
+    rsSettings.cachePath = 0;
+    u64 rsMemReq = 0;
+    resourceManagerInit(&rsMemReq, 0, rsSettings);
+    void* rsState = platformAllocate(rsMemReq, false);
+    resourceManagerInit(&rsMemReq, rsState, rsSettings);
+
+    // Always initalize the bench manager first.
+    benchMgrInit();
+
+    memoryRegisterBenches();
+    containersRegisterBenches();
+    stringsRegisterBenches();
+    eventsRegisterBenches();
+    mathRegisterBenches();
+    resourcesRegisterBenches();
+
+    FDEBUG("Starting benchmarks...");
+
+    u32 regressions = benchMgrRunBenches(&options);
+
+    resourceManagerShutdown(rsState);
+    platformFree(rsState, false);
+    vfsShutdown(vfsState);
+    platformFree(vfsState, false);
+    eventShutdown();
+    platformFree(eventState, false);
+    memoryShutdown();
+
+    return regressions ? 1 : 0;
+}
@@ -0,0 +1,25 @@
+#include <math/fsnmath.h>
+#include "../benchManager.h"
+
+// Each op feeds into the next so the compiler can't hoist anything out.
+static void mat4MulRun(u64 ops) {
+    mat4 a = mat4Translation((vector3){1.0f, 2.0f, 3.0f});
+    mat4 b = mat4EulerXyz(0.01f, 0.02f, 0.03f);
+    for (u64 i = 0; i < ops; ++i) {
+        a = mat4Mul(a, b);
+    }
+    benchSink += (u64)a.data[12];
+}
+
+static void mat4InverseRun(u64 ops) {
+    mat4 a = mat4Mul(mat4Translation((vector3){1.0f, 2.0f, 3.0f}), mat4EulerXyz(0.1f, 0.2f, 0.3f));
+    for (u64 i = 0; i < ops; ++i) {
+        a = mat4Inverse(a);
+    }
+    benchSink += (u64)a.data[12];
+}
+
+void mathRegisterBenches() {
+    benchMgrRegister("mat4Mul", 20000, 0, mat4MulRun, 0);
+    benchMgrRegister("mat4Inverse", 20000, 0, mat4InverseRun, 0);
+}
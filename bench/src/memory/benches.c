@@ -0,0 +1,57 @@
+#include <core/fmemory.h>
+#include "../benchManager.h"
+
+// How many blocks stay alive at once in the mixed benchmark.
+#define LIVE_BLOCKS 64
+
+static void* blocks[LIVE_BLOCKS];
+static u64 blockSizes[LIVE_BLOCKS];
+static u32 rng = 1;
+
+// Cheap xorshift so the size pattern is the same every run.
+static u32 nextRand() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static b8 allocMixSetup() {
+    rng = 1;
+    for (u32 i = 0; i < LIVE_BLOCKS; ++i) {
+        blockSizes[i] = 16 + nextRand() % 4080;
+        blocks[i] = fallocate(blockSizes[i], MEMORY_TAG_APPLICATION);
+    }
+    return true;
+}
+
+// Frees a block and allocates a differently sized one in its place, like a
+// game juggling short lived allocations.
+static void allocMixRun(u64 ops) {
+    for (u64 i = 0; i < ops; ++i) {
+        u32 slot = nextRand() % LIVE_BLOCKS;
+        ffree(blocks[slot], blockSizes[slot], MEMORY_TAG_APPLICATION);
+        blockSizes[slot] = 16 + nextRand() % 4080;
+        blocks[slot] = fallocate(blockSizes[slot], MEMORY_TAG_APPLICATION);
+    }
+}
+
+static void allocMixTeardown() {
+    for (u32 i = 0; i < LIVE_BLOCKS; ++i) {
+        ffree(blocks[i], blockSizes[i], MEMORY_TAG_APPLICATION);
+    }
+}
+
+// Allocates and frees the same small block over and over.
+static void allocSmallRun(u64 ops) {
+    for (u64 i = 0; i < ops; ++i) {
+        void* b = fallocate(64, MEMORY_TAG_APPLICATION);
+        benchSink += (u64)b;
+        ffree(b, 64, MEMORY_TAG_APPLICATION);
+    }
+}
+
+void memoryRegisterBenches() {
+    benchMgrRegister("fallocate/ffree mixed sizes", 2000, allocMixSetup, allocMixRun, allocMixTeardown);
+    benchMgrRegister("fallocate/ffree 64 bytes", 5000, 0, allocSmallRun, 0);
+}
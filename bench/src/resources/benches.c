@@ -0,0 +1,29 @@
+#include <resources/resourceManager.h>
+#include "../benchManager.h"
+
+// Parses Assets/bench.fmat. It has no diffuse map, so nothing goes through
+// the texture system and only the parsing gets timed.
+static void materialParseRun(u64 ops) {
+    for (u64 i = 0; i < ops; ++i) {
+        resource r;
+        if (resourceLoad("bench", RESOURCE_TYPE_MATERIAL, &r)) {
+            benchSink += r.dataSize;
+            resourceUnload(&r);
+        }
+    }
+}
+
+static void imageDecodeRun(u64 ops) {
+    for (u64 i = 0; i < ops; ++i) {
+        resource r;
+        if (resourceLoad("orange_lines_512.png", RESOURCE_TYPE_IMAGE, &r)) {
+            benchSink += r.dataSize;
+            resourceUnload(&r);
+        }
+    }
+}
+
+void resourcesRegisterBenches() {
+    benchMgrRegister("material parse", 100, 0, materialParseRun, 0);
+    benchMgrRegister("image decode 512x512 png", 2, 0, imageDecodeRun, 0);
+}
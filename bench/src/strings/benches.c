@@ -0,0 +1,28 @@
+#include <core/fstring.h>
+#include <helpers/dinoArray.h>
+#include "../benchManager.h"
+
+// Looks like a shader config attribute list.
+static const char* splitLine = "vec3 position, vec3 normal, vec2 texcoord, vec4 color, vec4 tangent, "
+                               "vec4 boneWeights, vec4 boneIndices, vec2 texcoord2,";
+static char** parts;
+
+static b8 splitSetup() {
+    parts = dinoCreate(char*);
+    return true;
+}
+
+static void splitRun(u64 ops) {
+    for (u64 i = 0; i < ops; ++i) {
+        benchSink += strSplit(splitLine, ',', &parts, true, false);
+        strCleanDinoArray(parts);
+    }
+}
+
+static void splitTeardown() {
+    dinoDestroy(parts);
+}
+
+void stringsRegisterBenches() {
+    benchMgrRegister("strSplit 8 fields", 200, splitSetup, splitRun, splitTeardown);
+}
@@ -26,4 +26,15 @@ REM Tests
 make -f "Makefile.tests.windows.mak" all
 IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit)
 
+REM Tools
+make -f "Makefile.flogDecoder.windows.mak" all
+IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit)
+
+make -f "Makefile.fpakPacker.windows.mak" all pack
+IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit)
+
+REM Bench
+make -f "Makefile.bench.windows.mak" all
+IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit)
+
 ECHO "All assemblies built successfully."
\ No newline at end of file
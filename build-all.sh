@@ -28,4 +28,28 @@ then
 echo "Error:"$ERRORLEVEL && exit
 fi
 
+bear -- make -f Makefile.flogDecoder.linux.mak all
+
+ERRORLEVEL=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+echo "Error:"$ERRORLEVEL && exit
+fi
+
+bear -- make -f Makefile.fpakPacker.linux.mak all pack
+
+ERRORLEVEL=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+echo "Error:"$ERRORLEVEL && exit
+fi
+
+bear -- make -f Makefile.bench.linux.mak all
+
+ERRORLEVEL=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+echo "Error:"$ERRORLEVEL && exit
+fi
+
 echo "All assemblies built successfully."
@@ -15,4 +15,15 @@ REM Testbed
 make -f "Makefile.tests.windows.mak" clean
 IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit)
 
+REM Tools
+make -f "Makefile.flogDecoder.windows.mak" clean
+IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit)
+
+make -f "Makefile.fpakPacker.windows.mak" clean
+IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit)
+
+REM Bench
+make -f "Makefile.bench.windows.mak" clean
+IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit)
+
 ECHO "All assemblies cleaned successfully."
\ No newline at end of file
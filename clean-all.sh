@@ -26,6 +26,29 @@ then
 echo "Error:"$ERRORLEVEL && exit
 fi
 
+make -f Makefile.flogDecoder.linux.mak clean
+
+ERRORLEVEL=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+echo "Error:"$ERRORLEVEL && exit
+fi
+make -f Makefile.fpakPacker.linux.mak clean
+
+ERRORLEVEL=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+echo "Error:"$ERRORLEVEL && exit
+fi
+
+make -f Makefile.bench.linux.mak clean
+
+ERRORLEVEL=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+echo "Error:"$ERRORLEVEL && exit
+fi
+
 rm compile_commands.json
 
 echo "Removed all build directories."
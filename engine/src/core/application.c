@@ -5,15 +5,27 @@
 #include "logger.h"
 
 #include "core/clock.h"
+#include "core/counters.h"
 #include "core/event.h"
 #include "core/fmemory.h"
+#include "core/framePacer.h"
+#include "core/frameStats.h"
+#include "core/fsemaphore.h"
 #include "core/fstring.h"
+#include "core/fthread.h"
 #include "core/input.h"
+#include "core/inputRecorder.h"
+#include "core/jobSystem.h"
 #include "core/linearAllocator.h"
+#include "core/profiler.h"
+#include "core/subsystemRegistry.h"
+#include "platform/fileWatch.h"
 #include "platform/platform.h"
 #include "renderer/rendererFront.h"
 
+#include "resources/preload.h"
 #include "resources/resourceManager.h"
+#include "resources/vfs.h"
 #include "systems/cameraSystem.h"
 #include "systems/geometrySystem.h"
 #include "systems/materialSystem.h"
@@ -22,52 +34,91 @@
 // TODO: TEMP
 #include "math/fsnmath.h"
 
+// A frame's render packet. Double buffered when frames are pipelined so one
+// can be drawn while the next is filled out.
+typedef struct appFrame {
+    renderHeader header;
+    // TODO: temp
+    geometryRenderData testGeometry;
+    geometryRenderData testUIGeometry;
+    // TODO: end temp
+} appFrame;
+
+typedef struct appPlatformConfig {
+    const char* appName;
+    i32 x;
+    i32 y;
+    i32 width;
+    i32 height;
+    b8 headless;
+} appPlatformConfig;
+
+typedef struct appRendererConfig {
+    const char* appName;
+    rendererBackendAPI api;
+} appRendererConfig;
+
 typedef struct appState {
     // TODO: temp
     geometry* testGeometry;
     geometry* testUIGeometry;
+    camera* cam1;
+    camera* cam2;
+    b8 firstCam;
     // TODO: end temp
     game* gameInstance;
     clock clock;
 
-    // TODO: Put this crap into another file
-    linearAllocator systemsAllocator;
-    linearAllocator subSystemsAllocator;
-
-    u64 loggerSystemMemoryRequirement;
-    u64 eventSystemMemoryRequirement;
-    u64 memorySystemMemoryRequirement;
-    u64 inputSystemMemoryRequirement;
-    u64 platformSystemMemoryRequirement;
-    u64 resourceManagerMemoryRequirement;
-    u64 rendererSystemMemoryRequirement;
+    // The logger, events and jobs have to be up before the registry can run,
+    // everything else is in the registry.
+    linearAllocator coreSystemsAllocator;
+    void* loggerSystemPtr;
+    void* eventSystemPtr;
+    void* jobSystemPtr;
+    subsystemRegistry subsystems;
+
+    // The subsystems' configs. They're read during init so they live here.
+    appPlatformConfig platformConfig;
+    vfsConfig vfsSettings;
+    fileWatchConfig watchConfig;
+    resourceManagerSettings resourceSettings;
+    appRendererConfig rendererConfig;
+    framePacerConfig pacerConfig;
+    frameStatsConfig statsConfig;
+    inputRecorderConfig recorderConfig;
+    u32 maxCameras;
+    textureSystemSettings textureSettings;
+    materialSystemSettings materialSettings;
+    geometrySystemConfig geometryConfig;
 
-    u64 cameraSystemMemoryRequirement;
-    u64 textureSystemMemoryRequirement;
-    u64 materialSystemMemoryRequirement;
-    u64 geometrySystemMemoryRequirement;
-    // End TODO
+    preloadBatch preload;
 
     b8 isRunning;
     b8 isSuspended;
     i16 width;
     i16 height;
     f64 lastTime;
-
-    // TODO: Put this crap into another file
-    void* loggerSystemPtr;
-    void* eventSystemPtr;
-    void* memorySystemPtr;
-    void* inputSystemPtr;
-    void* platformSystemPtr;
-    void* resourceManagerPtr;
-    void* rendererSystemPtr;
-
-    void* cameraSystemPtr;
-    void* textureSystemPtr;
-    void* materialSystemPtr;
-    void* geometrySystemPtr;
-    // End TODO
+    // Time that hasn't been simulated yet with fixed updates.
+    f64 updateAccumulator;
+    f64 fixedStep;
+    u32 maxUpdateSteps;
+    b8 unthrottled;
+    // The delta the last simulated frame used, for the input recorder.
+    f64 simulatedDelta;
+    // Set when replaying recorded input. The next frame is simulated with
+    // replayDelta instead of the clock's.
+    b8 replaying;
+    f64 replayDelta;
+
+    appFrame frames[2];
+    // Frame pipelining. The main thread signals simulateStart with
+    // simulateFrameIdx set, the simulation thread signals simulateDone.
+    fthread simulateThread;
+    fsemaphore simulateStart;
+    fsemaphore simulateDone;
+    u8 simulateFrameIdx;
+    b8 simulateResult;
+    b8 simulateThreadRunning;
 } appState;
 
 static appState* appstate;
@@ -99,15 +150,11 @@ b8 eventDebug(u16 code, void* sender, void* listener, eventContext data) {
     choice++;
     choice %= 4;
     FINFO("GETTING NEW TEXTURE MAP: %s", names[choice]);
-    // Acquire the new texture.
+    // Acquire the new texture. It loads in the background and the default
+    // gets drawn until it's in.
     if (appstate->testGeometry) {
         appstate->testGeometry->material->diffuseMap.texture =
-            textureSystemTextureGetCreate(names[choice], true);
-        if (!appstate->testGeometry->material->diffuseMap.texture->data) {
-            FWARN("event_on_debug_event no texture! using default");
-            appstate->testGeometry->material->diffuseMap.texture =
-                textureSystemGetDefault();
-        }
+            textureSystemTextureGetCreateAsync(names[choice], true);
         FTRACE("New texture: %s",
                appstate->testGeometry->material->diffuseMap.texture->name);
 
@@ -119,6 +166,172 @@ b8 eventDebug(u16 code, void* sender, void* listener, eventContext data) {
 }
 // TODO: end temp
 
+// Adapters from each subsystem's init and shutdown to the registry's.
+static b8 appPlatformInit(u64* memoryRequirement, void* state, void* config) {
+    appPlatformConfig* c = config;
+    return platformStartup(memoryRequirement, state, c->appName, c->x, c->y,
+                           c->width, c->height, c->headless);
+}
+
+static void appPlatformShutdown(void* state) { platformShutdown(); }
+
+static b8 appInputInit(u64* memoryRequirement, void* state, void* config) {
+    inputInit(memoryRequirement, state);
+    return true;
+}
+
+static b8 appInputRecorderInit(u64* memoryRequirement, void* state,
+                               void* config) {
+    return inputRecorderInit(memoryRequirement, state,
+                             *(inputRecorderConfig*)config);
+}
+
+static b8 appFramePacerInit(u64* memoryRequirement, void* state,
+                            void* config) {
+    return framePacerInit(memoryRequirement, state, *(framePacerConfig*)config);
+}
+
+static b8 appFrameStatsInit(u64* memoryRequirement, void* state,
+                            void* config) {
+    return frameStatsInit(memoryRequirement, state, *(frameStatsConfig*)config);
+}
+
+static b8 appVfsInit(u64* memoryRequirement, void* state, void* config) {
+    return vfsInit(memoryRequirement, state, *(vfsConfig*)config);
+}
+
+static b8 appFileWatchInit(u64* memoryRequirement, void* state, void* config) {
+    return fileWatchInit(memoryRequirement, state, *(fileWatchConfig*)config);
+}
+
+static b8 appResourceManagerInit(u64* memoryRequirement, void* state,
+                                 void* config) {
+    return resourceManagerInit(memoryRequirement, state,
+                               *(resourceManagerSettings*)config);
+}
+
+static b8 appCameraInit(u64* memoryRequirement, void* state, void* config) {
+    cameraSystemInit(memoryRequirement, state, *(u32*)config);
+    return true;
+}
+
+static b8 appRendererInit(u64* memoryRequirement, void* state, void* config) {
+    appRendererConfig* c = config;
+    return rendererInit(memoryRequirement, state, c->appName, c->api);
+}
+
+static void appRendererShutdown(void* state) { rendererShutdown(); }
+
+static b8 appTextureInit(u64* memoryRequirement, void* state, void* config) {
+    textureSystemInit(memoryRequirement, state,
+                      *(textureSystemSettings*)config);
+    return true;
+}
+
+static b8 appMaterialInit(u64* memoryRequirement, void* state, void* config) {
+    materialSystemInit(memoryRequirement, state,
+                       *(materialSystemSettings*)config);
+    return true;
+}
+
+static b8 appGeometryInit(u64* memoryRequirement, void* state, void* config) {
+    return geometrySystemInit(memoryRequirement, state,
+                              *(geometrySystemConfig*)config);
+}
+
+static b8 appRegister(const char* name, PFN_subsystemInit init,
+                      PFN_subsystemShutdown shutdown, void* config,
+                      b8 mainThread, const char* dep0, const char* dep1,
+                      const char* dep2) {
+    subsystemDesc desc = {};
+    desc.name = name;
+    desc.init = init;
+    desc.shutdown = shutdown;
+    desc.config = config;
+    desc.mainThread = mainThread;
+    desc.deps[0] = dep0;
+    desc.deps[1] = dep1;
+    desc.deps[2] = dep2;
+    return subsystemRegister(&appstate->subsystems, desc);
+}
+
+// Declares every subsystem and what it needs. Ones with no deps between them
+// init at the same time on the job system. The window and anything that
+// talks to the GPU stays on the main thread.
+static b8 appRegisterSubsystems(game* gameInst) {
+    appConfig* config = &gameInst->appConfig;
+
+    appstate->platformConfig.appName = config->name;
+    appstate->platformConfig.x = config->startPosX;
+    appstate->platformConfig.y = config->startPosY;
+    appstate->platformConfig.width = config->startWidth;
+    appstate->platformConfig.height = config->startHeight;
+    appstate->platformConfig.headless = config->headless;
+
+    // Debug builds mount the loose assets over the archive so they can be
+    // edited and hot reloaded, release builds the other way around.
+    appstate->vfsSettings.rootAssetPath = "../Assets/";
+    appstate->vfsSettings.pakPath = "assets.fpak";
+
+    // Asset files on disk get watched so edits reload without a restart.
+    appstate->watchConfig.maxWatches = 1024;
+    appstate->watchConfig.debounceMs = 100;
+
+    appstate->resourceSettings.maxManagers = 32;
+    appstate->resourceSettings.cachePath = "cache";
+    appstate->resourceSettings.hashContent = true;
+
+    appstate->rendererConfig.appName = config->name;
+    appstate->rendererConfig.api = config->headless
+                                       ? RENDERER_BACKEND_API_NULL
+                                       : RENDERER_BACKEND_API_VULKAN;
+
+    appstate->pacerConfig.targetFrameRate = config->targetFrameRate;
+
+    appstate->statsConfig.frameCnt = config->frameStatsFrameCnt;
+    appstate->statsConfig.csvPath = config->frameStatsPath;
+
+    appstate->recorderConfig.recordPath = config->inputRecordPath;
+    appstate->recorderConfig.replayPath = config->inputReplayPath;
+    appstate->recorderConfig.replayDelta = config->inputReplayDelta;
+
+    appstate->maxCameras = 24;
+    appstate->textureSettings.maxTextureCnt = 1024;
+    appstate->materialSettings.maxMaterialCnt = 1024;
+    appstate->geometryConfig.maxGeometryCnt = 4096;
+
+    return appRegister("input", appInputInit, inputShutdown, 0, false, 0, 0,
+                       0) &&
+           appRegister("inputRecorder", appInputRecorderInit,
+                       inputRecorderShutdown, &appstate->recorderConfig, false,
+                       "input", 0, 0) &&
+           appRegister("framePacer", appFramePacerInit, framePacerShutdown,
+                       &appstate->pacerConfig, false, 0, 0, 0) &&
+           appRegister("frameStats", appFrameStatsInit, frameStatsShutdown,
+                       &appstate->statsConfig, false, 0, 0, 0) &&
+           appRegister("vfs", appVfsInit, vfsShutdown,
+                       &appstate->vfsSettings, false, 0, 0, 0) &&
+           appRegister("fileWatch", appFileWatchInit, fileWatchShutdown,
+                       &appstate->watchConfig, false, 0, 0, 0) &&
+           appRegister("resourceManager", appResourceManagerInit,
+                       resourceManagerShutdown, &appstate->resourceSettings,
+                       false, "vfs", 0, 0) &&
+           appRegister("camera", appCameraInit, cameraSystemShutdown,
+                       &appstate->maxCameras, false, 0, 0, 0) &&
+           appRegister("platform", appPlatformInit, appPlatformShutdown,
+                       &appstate->platformConfig, true, 0, 0, 0) &&
+           appRegister("renderer", appRendererInit, appRendererShutdown,
+                       &appstate->rendererConfig, true, "platform",
+                       "resourceManager", 0) &&
+           appRegister("texture", appTextureInit, textureSystemShutdown,
+                       &appstate->textureSettings, true, "renderer",
+                       "resourceManager", "fileWatch") &&
+           appRegister("material", appMaterialInit, materialSystemShutdown,
+                       &appstate->materialSettings, true, "texture", 0, 0) &&
+           appRegister("geometry", appGeometryInit, geometrySystemShutdown,
+                       &appstate->geometryConfig, true, "material", 0, 0);
+}
+
 b8 appCreate(game* gameInst) {
     if (gameInst->appState) {
         FERROR("APP: appCreate called more than once.");
@@ -141,64 +354,31 @@ b8 appCreate(game* gameInst) {
     appstate->isRunning = true;
     appstate->isSuspended = false;
 
-    // Initialize subsystems.
-
-    // Get memory requirements for all subsystems
-    u32 subsystemsSize = 0;
-    loggerInit(&appstate->loggerSystemMemoryRequirement, 0);
-    subsystemsSize += appstate->loggerSystemMemoryRequirement;
-    eventInit(&appstate->eventSystemMemoryRequirement, 0);
-    subsystemsSize += appstate->eventSystemMemoryRequirement;
-    inputInit(&appstate->inputSystemMemoryRequirement, 0);
-    subsystemsSize += appstate->inputSystemMemoryRequirement;
-    platformStartup(
-        &appstate->platformSystemMemoryRequirement, 0, gameInst->appConfig.name,
-        gameInst->appConfig.startPosX, gameInst->appConfig.startPosY,
-        gameInst->appConfig.startWidth, gameInst->appConfig.startHeight);
-    subsystemsSize += appstate->platformSystemMemoryRequirement;
-
-    resourceManagerSettings rsSettings;
-    rsSettings.maxManagers = 32;
-    rsSettings.rootAssetPath = "../Assets/";
-    resourceManagerInit(&appstate->resourceManagerMemoryRequirement, 0,
-                        rsSettings);
-    subsystemsSize += appstate->resourceManagerMemoryRequirement;
-
-    rendererInit(&appstate->rendererSystemMemoryRequirement, 0,
-                 appstate->gameInstance->appConfig.name);
-    subsystemsSize += appstate->rendererSystemMemoryRequirement;
-
-    // Create the allocater for the needed required memory for all subsystems
-    linearAllocCreate(subsystemsSize, &appstate->subSystemsAllocator);
-
-    //"Allocate" the memory and give each subsystem it's ptr
-    appstate->loggerSystemPtr =
-        linearAllocAllocate(&appstate->subSystemsAllocator,
-                            appstate->loggerSystemMemoryRequirement);
+    // The logger, events and jobs come first since the registry needs them.
+    jobSystemConfig jobConfig = {};
+    jobConfig.threadCnt = gameInst->appConfig.jobThreadCnt;
+    u64 loggerMemoryRequirement = 0;
+    u64 eventMemoryRequirement = 0;
+    u64 jobSystemMemoryRequirement = 0;
+    loggerInit(&loggerMemoryRequirement, 0);
+    eventInit(&eventMemoryRequirement, 0);
+    jobSystemInit(&jobSystemMemoryRequirement, 0, jobConfig);
+    linearAllocCreate(loggerMemoryRequirement + eventMemoryRequirement +
+                          jobSystemMemoryRequirement,
+                      &appstate->coreSystemsAllocator);
+    appstate->loggerSystemPtr = linearAllocAllocate(
+        &appstate->coreSystemsAllocator, loggerMemoryRequirement);
     appstate->eventSystemPtr = linearAllocAllocate(
-        &appstate->subSystemsAllocator, appstate->eventSystemMemoryRequirement);
-    appstate->memorySystemPtr =
-        linearAllocAllocate(&appstate->subSystemsAllocator,
-                            appstate->memorySystemMemoryRequirement);
-    appstate->inputSystemPtr = linearAllocAllocate(
-        &appstate->subSystemsAllocator, appstate->inputSystemMemoryRequirement);
-    appstate->platformSystemPtr =
-        linearAllocAllocate(&appstate->subSystemsAllocator,
-                            appstate->platformSystemMemoryRequirement);
-    appstate->resourceManagerPtr =
-        linearAllocAllocate(&appstate->subSystemsAllocator,
-                            appstate->resourceManagerMemoryRequirement);
-    appstate->rendererSystemPtr =
-        linearAllocAllocate(&appstate->subSystemsAllocator,
-                            appstate->rendererSystemMemoryRequirement);
-
-    // Actually init all subsystems now that we have the memory allocated
-    loggerInit(&appstate->loggerSystemMemoryRequirement,
-               appstate->loggerSystemPtr);
-    eventInit(&appstate->eventSystemMemoryRequirement,
-              appstate->eventSystemPtr);
-    inputInit(&appstate->inputSystemMemoryRequirement,
-              appstate->inputSystemPtr);
+        &appstate->coreSystemsAllocator, eventMemoryRequirement);
+    appstate->jobSystemPtr = linearAllocAllocate(
+        &appstate->coreSystemsAllocator, jobSystemMemoryRequirement);
+    loggerInit(&loggerMemoryRequirement, appstate->loggerSystemPtr);
+    eventInit(&eventMemoryRequirement, appstate->eventSystemPtr);
+    if (!jobSystemInit(&jobSystemMemoryRequirement, appstate->jobSystemPtr,
+                       jobConfig)) {
+        FWARN("APP: Job system failed to start, initing everything on the "
+              "main thread.");
+    }
 
     // Register the app events before starting the platform
     eventRegister(EVENT_CODE_APPLICATION_QUIT, 0, applicationOnEvent);
@@ -210,75 +390,30 @@ b8 appCreate(game* gameInst) {
     eventRegister(EVENT_CODE_DEBUG0, 0, eventDebug);
     // TODO: end temp
 
-    platformStartup(
-        &appstate->platformSystemMemoryRequirement, appstate->platformSystemPtr,
-        gameInst->appConfig.name, gameInst->appConfig.startPosX,
-        gameInst->appConfig.startPosY, gameInst->appConfig.startWidth,
-        gameInst->appConfig.startHeight);
-
-    resourceManagerInit(&appstate->resourceManagerMemoryRequirement,
-                        appstate->resourceManagerPtr, rsSettings);
-
-    // TODO: Place rendererInit here
-
-    // Get memory requirements for all systems
-    u64 systemsMemRequirement = 0;
-
-    cameraSystemInit(&appstate->cameraSystemMemoryRequirement, 0, 24);
-    systemsMemRequirement += appstate->cameraSystemMemoryRequirement;
-
-    textureSystemSettings textureSettings;
-    textureSettings.maxTextureCnt = 1024;
-    textureSystemInit(&appstate->textureSystemMemoryRequirement, 0,
-                      textureSettings);
-    systemsMemRequirement += appstate->textureSystemMemoryRequirement;
-
-    materialSystemSettings matSettings;
-    matSettings.maxMaterialCnt = 1024;
-    materialSystemInit(&appstate->materialSystemMemoryRequirement, 0,
-                       matSettings);
-    systemsMemRequirement += appstate->materialSystemMemoryRequirement;
-
-    geometrySystemConfig geoConfig;
-    geoConfig.maxGeometryCnt = 4096;
-    geometrySystemInit(&appstate->geometrySystemMemoryRequirement, 0,
-                       geoConfig);
-    systemsMemRequirement += appstate->geometrySystemMemoryRequirement;
-
-    // Allocate the memory needed for the systems
-    linearAllocCreate(systemsMemRequirement, &appstate->systemsAllocator);
-
-    // Actually init all the systems, now that we have the memory requirements
-    appstate->cameraSystemPtr = linearAllocAllocate(
-        &appstate->systemsAllocator, appstate->cameraSystemMemoryRequirement);
-    cameraSystemInit(&appstate->cameraSystemMemoryRequirement,
-                     appstate->cameraSystemPtr, 24);
-
-    // TODO: TEMPorary renderer is placed here cuz some temp code in it needs
-    // the camera system inited. Place under second platformStartup call
-    rendererInit(&appstate->rendererSystemMemoryRequirement,
-                 appstate->rendererSystemPtr,
-                 appstate->gameInstance->appConfig.name);
-
-    appstate->textureSystemPtr = linearAllocAllocate(
-        &appstate->systemsAllocator, appstate->textureSystemMemoryRequirement);
-    textureSystemInit(&appstate->textureSystemMemoryRequirement,
-                      appstate->textureSystemPtr, textureSettings);
-
-    appstate->materialSystemPtr = linearAllocAllocate(
-        &appstate->systemsAllocator, appstate->materialSystemMemoryRequirement);
-    materialSystemInit(&appstate->materialSystemMemoryRequirement,
-                       appstate->materialSystemPtr, matSettings);
-
-    // Geometry system.
-    appstate->geometrySystemPtr = linearAllocAllocate(
-        &appstate->systemsAllocator, appstate->geometrySystemMemoryRequirement);
-    if (!geometrySystemInit(&appstate->geometrySystemMemoryRequirement,
-                            appstate->geometrySystemPtr, geoConfig)) {
-        FFATAL("APP: Failed to initialize geometry system. Application cannot "
+    if (!appRegisterSubsystems(gameInst) ||
+        !subsystemRegistryInitAll(&appstate->subsystems)) {
+        FFATAL("APP: Failed to init the subsystems. Application cannot "
                "continue.");
         return false;
     }
+    appstate->replaying = inputRecorderIsReplaying();
+
+    // There's no loading screen yet, so wait on the preload here.
+    if (gameInst->appConfig.preloadManifest &&
+        preloadBegin(gameInst->appConfig.preloadManifest, &appstate->preload)) {
+        while (!preloadUpdate(&appstate->preload, 0)) {
+            platformSleep(1);
+        }
+    }
+
+    // TODO: temp
+    appstate->firstCam = true;
+    cameraSystemAdd("Cam1");
+    cameraSystemAdd("Cam2");
+    appstate->cam1 = getCamera("Cam1");
+    appstate->cam2 = getCamera("Cam2");
+    cameraMoveBackward(appstate->cam1, 30.0f);
+    cameraMoveBackward(appstate->cam2, 30.0f);
 
     // TODO: temp Need to make some default standard geometry shapes like
     // square/cube, etc
@@ -346,88 +481,309 @@ b8 appCreate(game* gameInst) {
     return true;
 }
 
+// Runs the game's update and render for one frame and fills out the frame's
+// render packet. Runs on the simulation thread when frames are pipelined.
+// TODO: temp
+// Key presses only show up until input moves along, so this runs before
+// every inputUpdate, the same as the game's update.
+static void appCheckPresses() {
+    if (inputIsKeyPressed('K')) {
+        appstate->firstCam = !appstate->firstCam;
+    }
+}
+
+static b8 appSimulateFrame(appFrame* frame) {
+    FPROFILE_FUNC();
+    // Update clock and get delta time.
+    clockUpdate(&appstate->clock);
+    f64 curTime = appstate->clock.elapsed;
+    f64 delta = (curTime - appstate->lastTime);
+    if (appstate->replaying) {
+        delta = appstate->replayDelta;
+    }
+    f32 alpha = 1.0f;
+    f64 fixedStep = appstate->fixedStep;
+    u64 updateStart = platformGetTimestampNs();
+
+    if (fixedStep > 0) {
+        // Unthrottled runs step exactly once a frame no matter how long the
+        // frame really took.
+        if (appstate->unthrottled) {
+            delta = fixedStep;
+        }
+        appstate->updateAccumulator += delta;
+
+        u32 steps = 0;
+        while (appstate->updateAccumulator >= fixedStep &&
+               steps < appstate->maxUpdateSteps) {
+            FPROFILE_SCOPE("gameUpdate");
+            if (!appstate->gameInstance->update(appstate->gameInstance,
+                                                (f32)fixedStep)) {
+                FFATAL("APP: Game update failed, shutting down.");
+                return false;
+            }
+            appstate->updateAccumulator -= fixedStep;
+            steps++;
+            appCheckPresses();
+            // Each step should only see a key press once.
+            inputUpdate(fixedStep);
+        }
+
+        // Too far behind to catch up, drop the extra time instead of falling
+        // further behind every frame.
+        if (appstate->updateAccumulator >= fixedStep) {
+            u64 dropped = (u64)(appstate->updateAccumulator / fixedStep);
+            FDEBUG("APP: Dropped %llu fixed updates to catch up.", dropped);
+            appstate->updateAccumulator -= dropped * fixedStep;
+        }
+        alpha = (f32)(appstate->updateAccumulator / fixedStep);
+    } else {
+        FPROFILE_SCOPE("gameUpdate");
+        if (!appstate->gameInstance->update(appstate->gameInstance,
+                                            (f32)delta)) {
+            FFATAL("APP: Game update failed, shutting down.");
+            return false;
+        }
+        appCheckPresses();
+    }
+
+    u64 renderPrepStart = platformGetTimestampNs();
+    frameStatsAddPhaseTime(FRAME_PHASE_UPDATE, renderPrepStart - updateStart);
+
+    // Call the game's render routine.
+    {
+        FPROFILE_SCOPE("gameRender");
+        if (!appstate->gameInstance->render(appstate->gameInstance, (f32)delta,
+                                            alpha)) {
+            FFATAL("APP: Game render failed, shutting down.");
+            return false;
+        }
+    }
+
+    frame->header.deltaTime = delta;
+    appstate->simulatedDelta = delta;
+    // TODO: temp
+    // Moving the camera reads input, so it happens here rather than while
+    // drawing. The draw can be on another thread by now.
+    camera* cam = appstate->firstCam ? appstate->cam1 : appstate->cam2;
+    f32 spd = 10.0f * (f32)delta;
+    if (inputIsKeyDown('W')) {
+        cameraMoveUp(cam, spd);
+    }
+    if (inputIsKeyDown('S')) {
+        cameraMoveDown(cam, spd);
+    }
+    if (inputIsKeyDown('A')) {
+        cameraMoveLeft(cam, spd);
+    }
+    if (inputIsKeyDown('D')) {
+        cameraMoveRight(cam, spd);
+    }
+    if (inputIsKeyDown('E')) {
+        cameraMoveForward(cam, spd);
+    }
+    if (inputIsKeyDown('Q')) {
+        cameraMoveBackward(cam, spd);
+    }
+    if (inputIsKeyDown('Z')) {
+        cameraYaw(cam, spd);
+    }
+    if (inputIsKeyDown('X')) {
+        cameraYaw(cam, -spd);
+    }
+    frame->header.view = cameraViewGet(cam);
+
+    frame->testGeometry.geometry = appstate->testGeometry;
+    frame->testGeometry.model = mat4Identity();
+    frame->header.geometryCnt = 1;
+    frame->header.geometries = &frame->testGeometry;
+
+    frame->testUIGeometry.geometry = appstate->testUIGeometry;
+    frame->testUIGeometry.model = mat4Translation((vector3){0, 0, 0});
+    frame->header.uiGeometryCnt = 1;
+    frame->header.uiGeometries = &frame->testUIGeometry;
+    // TODO: end temp
+
+    frameStatsAddPhaseTime(FRAME_PHASE_RENDER_PREP,
+                           platformGetTimestampNs() - renderPrepStart);
+    appstate->lastTime = curTime;
+    return true;
+}
+
+static void appDraw(appFrame* frame) {
+    u64 drawStart = platformGetTimestampNs();
+    rendererDraw(&frame->header);
+    frameStatsAddPhaseTime(FRAME_PHASE_DRAW,
+                           platformGetTimestampNs() - drawStart);
+}
+
+// The simulation thread. Waits for the main thread to hand it a frame slot,
+// simulates into it and hands it back.
+static u32 appSimulationThread(void* params) {
+    profilerSetThreadName("simulation");
+    memoryWatchThread();
+    for (;;) {
+        fsemaphoreWait(&appstate->simulateStart, FSEMAPHORE_WAIT_INFINITE);
+        if (!appstate->simulateThreadRunning) {
+            break;
+        }
+        appstate->simulateResult =
+            appSimulateFrame(&appstate->frames[appstate->simulateFrameIdx]);
+        fsemaphoreSignal(&appstate->simulateDone);
+    }
+    return 0;
+}
+
+static b8 appStartSimulationThread() {
+    if (!fsemaphoreCreate(&appstate->simulateStart, 1, 0) ||
+        !fsemaphoreCreate(&appstate->simulateDone, 1, 0)) {
+        FERROR("APP: Failed to create the frame pipeline semaphores.");
+        return false;
+    }
+    appstate->simulateThreadRunning = true;
+    if (!fthreadCreate(appSimulationThread, 0, false,
+                       &appstate->simulateThread)) {
+        FERROR("APP: Failed to start the simulation thread.");
+        appstate->simulateThreadRunning = false;
+        return false;
+    }
+    return true;
+}
+
+static void appStopSimulationThread() {
+    appstate->simulateThreadRunning = false;
+    fsemaphoreSignal(&appstate->simulateStart);
+    fthreadWait(&appstate->simulateThread);
+    fthreadDestroy(&appstate->simulateThread);
+    fsemaphoreDestroy(&appstate->simulateStart);
+    fsemaphoreDestroy(&appstate->simulateDone);
+}
+
 b8 appRun() {
     clockStart(&appstate->clock);
     clockUpdate(&appstate->clock);
     appstate->lastTime = appstate->clock.elapsed;
-    f64 runningTime = 0;
-    u8 frameCount = 0;
-    f64 targetFrameSec = 1.0f / 60;
 
+    appConfig* config = &appstate->gameInstance->appConfig;
+    appstate->fixedStep =
+        config->fixedUpdateRate > 0 ? 1.0 / config->fixedUpdateRate : 0;
+    appstate->maxUpdateSteps =
+        config->maxUpdateSteps ? config->maxUpdateSteps : 8;
+    appstate->unthrottled = config->runUnthrottled && appstate->fixedStep > 0;
+    if (config->runUnthrottled && appstate->fixedStep == 0) {
+        FWARN("APP: runUnthrottled needs a fixedUpdateRate, ignoring it.");
+    }
+    // Replays don't follow the wall clock either, so run them flat out.
+    if (appstate->unthrottled || appstate->replaying) {
+        framePacerSetTargetRate(0);
+    }
+
+    b8 pipelined = config->pipelineFrames;
+    if (pipelined && !appStartSimulationThread()) {
+        FWARN("APP: Falling back to running frames on one thread.");
+        pipelined = false;
+    }
+    // Whether frames[drawIdx] holds a packet that hasn't been drawn yet.
+    b8 haveDrawFrame = false;
+    u8 drawIdx = 0;
+
+    profilerSetThreadName("main");
+    memoryWatchThread();
     printMemoryUsage();
     while (appstate->isRunning) {
+        FPROFILE_SCOPE("frame");
+        frameStatsBeginFrame();
         if (!platformPumpMessages()) {
             appstate->isRunning = false;
         }
+        // Deliver events fired from other threads since last frame.
+        eventFlushDeferred();
+        // Finish the async loads that came in since last frame.
+        resourceManagerUpdate();
 
         if (!appstate->isSuspended) {
-            // Update clock and get delta time.
-            clockUpdate(&appstate->clock);
-            f64 curTime = appstate->clock.elapsed;
-            f64 delta = (curTime - appstate->lastTime);
-            f64 frameStartTime = platformGetAbsoluteTime();
-
-            if (!appstate->gameInstance->update(appstate->gameInstance,
-                                                (f32)delta)) {
-                FFATAL("APP: Game update failed, shutting down.");
-                appstate->isRunning = false;
-                break;
-            }
-
-            // Call the game's render routine.
-            if (!appstate->gameInstance->render(appstate->gameInstance,
-                                                (f32)delta)) {
-                FFATAL("APP: Game render failed, shutting down.");
+            // Feed in this frame's recorded input. Live input from the pump
+            // above was dropped.
+            if (appstate->replaying &&
+                !inputRecorderReplayFrame(&appstate->replayDelta)) {
+                FINFO("APP: Input replay finished, shutting down.");
                 appstate->isRunning = false;
                 break;
             }
 
-            renderHeader header;
-            header.deltaTime = delta;
-            // TODO: temp
-            geometryRenderData testGeoHeader;
-            testGeoHeader.geometry = appstate->testGeometry;
-            testGeoHeader.model = mat4Identity();
-
-            header.geometryCnt = 1;
-            header.geometries = &testGeoHeader;
-
-            geometryRenderData testUIRender;
-            testUIRender.geometry = appstate->testUIGeometry;
-            testUIRender.model = mat4Translation((vector3){0, 0, 0});
-            header.uiGeometryCnt = 1;
-            header.uiGeometries = &testUIRender;
-
-            // TODO: end temp
-            rendererDraw(&header);
-
-            // Figure out how long the frame took
-            f64 frameEndTime = platformGetAbsoluteTime();
-            f64 frameElapsedTime = frameEndTime - frameStartTime;
-            runningTime += frameElapsedTime;
-            f64 remainingSec = targetFrameSec - frameElapsedTime;
-
-            if (remainingSec > 0) {
-                u64 remaining_ms = (remainingSec * 1000);
-
-                // If there is time left, give it back to the OS.
-                b8 limitFrames = false;
-                if (remaining_ms > 0 && limitFrames) {
-                    platformSleep(remaining_ms - 1);
+            if (pipelined) {
+                // Simulate the next frame on the other thread while this one
+                // draws the last one.
+                appstate->simulateFrameIdx = drawIdx ^ 1;
+                fsemaphoreSignal(&appstate->simulateStart);
+                if (haveDrawFrame) {
+                    appDraw(&appstate->frames[drawIdx]);
+                }
+                {
+                    FPROFILE_SCOPE("waitForSimulation");
+                    fsemaphoreWait(&appstate->simulateDone,
+                                   FSEMAPHORE_WAIT_INFINITE);
                 }
 
-                frameCount++;
+                // Hand off. The simulation thread is idle until the next
+                // signal, so it's safe to touch everything again.
+                if (!appstate->simulateResult) {
+                    appstate->isRunning = false;
+                    break;
+                }
+                drawIdx ^= 1;
+                haveDrawFrame = true;
+            } else {
+                if (!appSimulateFrame(&appstate->frames[0])) {
+                    appstate->isRunning = false;
+                    break;
+                }
+                appDraw(&appstate->frames[0]);
+            }
+            // Everything pumped this frame was simulated with this delta.
+            inputRecorderEndFrame(appstate->simulatedDelta);
+
+            // Give the rest of the frame back to the OS.
+            {
+                FPROFILE_SCOPE("framePacerWait");
+                u64 waitStart = platformGetTimestampNs();
+                framePacerWait();
+                frameStatsAddPhaseTime(FRAME_PHASE_PRESENT_WAIT,
+                                       platformGetTimestampNs() - waitStart);
             }
 
-            inputUpdate(0);
+            // Fixed updates already moved input along after each step.
+            if (appstate->fixedStep == 0) {
+                inputUpdate(0);
+            }
+            frameStatsEndFrame();
 
-            appstate->lastTime = curTime;
+            if (config->steadyStateAfterFrames &&
+                frameStatsGetFrameCount() == config->steadyStateAfterFrames) {
+                FINFO("APP: Entering steady state, frames shouldn't allocate "
+                      "from here on.");
+                memorySetSteadyState(true, config->steadyStateAction);
+            }
         }
     }
 
+    if (pipelined) {
+        appStopSimulationThread();
+    }
+
     FINFO("Got out of appstate->isrunning loop");
+    if (config->steadyStateAfterFrames) {
+        memorySetSteadyState(false, config->steadyStateAction);
+        FINFO("APP: %llu allocations/frees happened in steady state.",
+              memoryGetSteadyStateViolations());
+    }
     appstate->isRunning = false;
 
+#ifdef FSN_PROFILE
+    profilerSetEnabled(false);
+    profilerExportChromeTrace("profile.json");
+#endif
+
     // Unregister all application events
     eventUnregister(EVENT_CODE_APPLICATION_QUIT, 0, applicationOnEvent);
     eventUnregister(EVENT_CODE_KEY_DOWN, 0, applicationKeyHeld);
@@ -438,19 +794,14 @@ b8 appRun() {
     eventUnregister(EVENT_CODE_DEBUG0, 0, eventDebug);
     // TODO: end temp
 
-    // Shutdown all systems. The opposite of when they were inited.
-    inputShutdown(appstate->inputSystemPtr);
-
-    geometrySystemShutdown(appstate->geometrySystemPtr);
-    materialSystemShutdown(appstate->materialSystemPtr);
+    preloadEnd(&appstate->preload);
 
-    textureSystemShutdown(appstate->textureSystemPtr);
-    cameraSystemShutdown(appstate->cameraSystemPtr);
-
-    rendererShutdown();
-    resourceManagerShutdown(appstate->resourceManagerPtr);
-    platformShutdown();
+    // Shutdown all systems. The opposite of when they were inited.
+    subsystemRegistryShutdownAll(&appstate->subsystems);
+    jobSystemShutdown(appstate->jobSystemPtr);
     eventShutdown();
+    profilerShutdown();
+    countersShutdown();
     loggerShutdown();
     memoryShutdown();
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "defines.h"
+#include "core/fmemory.h"
 
 struct game;
 
@@ -20,6 +21,67 @@ typedef struct appConfig {
 
     // The application name used in windowing, if applicable.
     char* name;
+
+    // The frame rate to pace frames to. 0 means unlimited.
+    f32 targetFrameRate;
+
+    // How many times a second the game's update gets called with a fixed
+    // delta. 0 means once a frame with the frame's delta.
+    f32 fixedUpdateRate;
+
+    // The most fixed updates to run in one frame to catch up after a slow
+    // frame. Time past this is dropped. 0 defaults to 8.
+    u32 maxUpdateSteps;
+
+    // Runs one fixed update a frame as fast as possible instead of following
+    // the wall clock. For headless batch runs. Needs fixedUpdateRate.
+    b8 runUnthrottled;
+
+    // Runs the game's update and render for the next frame on another thread
+    // while this frame is drawn. Adds a frame of latency. Events fired from
+    // the game during update/render are delivered on the main thread once
+    // the frame is handed off, and the game shouldn't touch renderer
+    // resources directly from update/render.
+    b8 pipelineFrames;
+
+    // Runs without a window or GPU. The platform skips the display connection
+    // and the renderer uses the null backend, which only records draws.
+    b8 headless;
+
+    // How many recent frames to keep timings for. 0 uses the default.
+    u32 frameStatsFrameCnt;
+
+    // Where to write the kept frame timings as CSV on shutdown. 0 to not
+    // write them.
+    const char* frameStatsPath;
+
+    // Records every input event and frame delta to this file. 0 to not
+    // record.
+    const char* inputRecordPath;
+
+    // Plays back a recording from this file instead of taking live
+    // input, then quits when it runs out. Combined with headless this runs
+    // a captured session as a repeatable benchmark.
+    const char* inputReplayPath;
+
+    // Simulates every replayed frame with this delta instead of the
+    // recorded ones. 0 uses the recorded deltas.
+    f64 inputReplayDelta;
+
+    // Declares steady state once this many frames have finished. From then on
+    // every fallocate/ffree on the frame's threads is a violation handled
+    // with steadyStateAction. 0 to never enter steady state.
+    u32 steadyStateAfterFrames;
+
+    // What to do about allocations in steady state.
+    memorySteadyAction steadyStateAction;
+
+    // How many job threads to start. 0 uses one less than the core count.
+    u32 jobThreadCnt;
+
+    // A preload manifest loaded before the game inits, so nothing it lists
+    // gets loaded on first use. What it loaded stays until shutdown. 0 to skip.
+    const char* preloadManifest;
 } appConfig;
 
 
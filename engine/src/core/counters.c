@@ -0,0 +1,142 @@
+#include "counters.h"
+
+#include "core/fstring.h"
+#include "core/logger.h"
+#include "platform/platform.h"
+
+typedef struct counterBlock {
+    // Only written by the owning thread.
+    u64 values[COUNTERS_MAX];
+    // What the snapshot last saw in values. Only touched by the snapshot.
+    u64 seen[COUNTERS_MAX];
+} counterBlock;
+
+// Like the profiler these work before any other system is up, so they don't
+// follow the usual init pattern. Blocks get allocated the first time a thread
+// counts something and live until countersShutdown.
+static const char* names[COUNTERS_MAX];
+static u32 counterCnt;
+static b8 registerLock;
+static counterBlock* blocks[COUNTERS_MAX_THREADS];
+static u32 blockCnt;
+static _Thread_local counterBlock* threadBlock;
+// Set on threads that started after the blocks ran out, so they stop trying.
+static _Thread_local b8 noThreadBlock;
+static b8 warnedFull;
+
+static u64 frameValues[COUNTERS_MAX];
+static u64 totals[COUNTERS_MAX];
+
+static counterBlock* getThreadBlock() {
+    if (!threadBlock && !noThreadBlock) {
+        u32 idx = __atomic_fetch_add(&blockCnt, 1, __ATOMIC_ACQ_REL);
+        if (idx >= COUNTERS_MAX_THREADS) {
+            __atomic_fetch_sub(&blockCnt, 1, __ATOMIC_ACQ_REL);
+            noThreadBlock = true;
+            if (!__atomic_exchange_n(&warnedFull, true, __ATOMIC_RELAXED)) {
+                FWARN("More than %u threads counted things, the rest won't be counted. Raise COUNTERS_MAX_THREADS.",
+                      COUNTERS_MAX_THREADS);
+            }
+            return 0;
+        }
+        counterBlock* b = platformAllocate(sizeof(counterBlock), false);
+        platformZeroMemory(b, sizeof(counterBlock));
+        __atomic_store_n(&blocks[idx], b, __ATOMIC_RELEASE);
+        threadBlock = b;
+    }
+    return threadBlock;
+}
+
+u32 counterRegister(const char* name) {
+    while (__atomic_test_and_set(&registerLock, __ATOMIC_ACQUIRE)) {
+    }
+    u32 id = INVALID_ID;
+    u32 cnt = __atomic_load_n(&counterCnt, __ATOMIC_RELAXED);
+    for (u32 i = 0; i < cnt; ++i) {
+        if (strEqual(names[i], name)) {
+            id = i;
+            break;
+        }
+    }
+    if (id == INVALID_ID) {
+        if (cnt < COUNTERS_MAX) {
+            id = cnt;
+            names[id] = name;
+            __atomic_store_n(&counterCnt, cnt + 1, __ATOMIC_RELEASE);
+        } else {
+            FWARN("Out of counters, '%s' won't be counted. Raise COUNTERS_MAX.", name);
+        }
+    }
+    __atomic_clear(&registerLock, __ATOMIC_RELEASE);
+    return id;
+}
+
+void counterAdd(u32 id, u64 amount) {
+    if (id >= COUNTERS_MAX) {
+        return;
+    }
+    counterBlock* b = getThreadBlock();
+    if (b) {
+        // Only this thread writes its block so it doesn't need an atomic add,
+        // the store just keeps the snapshot from reading half a value.
+        __atomic_store_n(&b->values[id], b->values[id] + amount, __ATOMIC_RELAXED);
+    }
+}
+
+void countersSnapshot() {
+    u32 cnt = __atomic_load_n(&counterCnt, __ATOMIC_ACQUIRE);
+    u32 threads = __atomic_load_n(&blockCnt, __ATOMIC_ACQUIRE);
+    if (threads > COUNTERS_MAX_THREADS) {
+        threads = COUNTERS_MAX_THREADS;
+    }
+    for (u32 i = 0; i < cnt; ++i) {
+        frameValues[i] = 0;
+    }
+    for (u32 t = 0; t < threads; ++t) {
+        counterBlock* b = __atomic_load_n(&blocks[t], __ATOMIC_ACQUIRE);
+        if (!b) {
+            continue;
+        }
+        for (u32 i = 0; i < cnt; ++i) {
+            u64 v = __atomic_load_n(&b->values[i], __ATOMIC_RELAXED);
+            frameValues[i] += v - b->seen[i];
+            b->seen[i] = v;
+        }
+    }
+    for (u32 i = 0; i < cnt; ++i) {
+        totals[i] += frameValues[i];
+    }
+}
+
+u32 countersGetCount() {
+    return __atomic_load_n(&counterCnt, __ATOMIC_ACQUIRE);
+}
+
+const char* counterGetName(u32 id) {
+    return id < countersGetCount() ? names[id] : 0;
+}
+
+u64 counterGetFrameValue(u32 id) {
+    return id < COUNTERS_MAX ? frameValues[id] : 0;
+}
+
+u64 counterGetTotal(u32 id) {
+    return id < COUNTERS_MAX ? totals[id] : 0;
+}
+
+void countersShutdown() {
+    u32 threads = __atomic_load_n(&blockCnt, __ATOMIC_ACQUIRE);
+    if (threads > COUNTERS_MAX_THREADS) {
+        threads = COUNTERS_MAX_THREADS;
+    }
+    for (u32 t = 0; t < threads; ++t) {
+        counterBlock* b = __atomic_exchange_n(&blocks[t], 0, __ATOMIC_ACQ_REL);
+        if (b) {
+            platformFree(b, false);
+        }
+    }
+    __atomic_store_n(&blockCnt, 0, __ATOMIC_RELEASE);
+    // Other threads' cached blocks are gone now, only reset ours.
+    threadBlock = 0;
+    noThreadBlock = false;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "defines.h"
+
+/*
+ * Named counters for seeing what hot code is doing each frame, like how far
+ * hashtable lookups probe. Each thread adds to its own copy so counting is a
+ * load and a store, and once a frame countersSnapshot adds up what every
+ * thread counted since the last snapshot.
+ *
+ * void lookup() {
+ *     FCOUNTER_INC("hashtable.lookups");
+ *     ...
+ *     FCOUNTER_ADD("hashtable.probes", probes);
+ * }
+ */
+
+#define COUNTERS_MAX 32
+#define COUNTERS_MAX_THREADS 32
+
+/**
+ * @brief Gets the counter with a name, registering it the first time.
+ * @param name The counter's name. Must outlive the counters, so use a literal
+ * @returns The counter's id, or INVALID_ID if there's no room for another
+ */
+FSNAPI u32 counterRegister(const char* name);
+
+/**
+ * @brief Adds to a counter on this thread's copy.
+ * @param id The counter from counterRegister
+ * @param amount The amount to add
+ */
+FSNAPI void counterAdd(u32 id, u64 amount);
+
+/**
+ * @brief Adds up what every thread counted since the last snapshot. Call once
+ * a frame from one thread.
+ */
+FSNAPI void countersSnapshot();
+
+/**
+ * @brief Gets how many counters have been registered. Ids go from 0 to this.
+ * @returns The counter count
+ */
+FSNAPI u32 countersGetCount();
+
+/**
+ * @brief Gets a counter's name.
+ * @param id The counter
+ * @returns The name, or 0 if the id isn't registered
+ */
+FSNAPI const char* counterGetName(u32 id);
+
+/**
+ * @brief Gets how much a counter went up between the last two snapshots.
+ * @param id The counter
+ * @returns The amount counted in the last frame
+ */
+FSNAPI u64 counterGetFrameValue(u32 id);
+
+/**
+ * @brief Gets everything a counter has counted up to the last snapshot.
+ * @param id The counter
+ * @returns The total
+ */
+FSNAPI u64 counterGetTotal(u32 id);
+
+/**
+ * @brief Frees every thread's counts. Other threads must be done counting.
+ */
+FSNAPI void countersShutdown();
+
+// Adds to a counter by name. The id gets looked up once per call site.
+#define FCOUNTER_ADD(name, amount)                                         \
+    do {                                                                   \
+        static u32 _counterID = INVALID_ID;                                \
+        u32 _id = __atomic_load_n(&_counterID, __ATOMIC_RELAXED);          \
+        if (_id == INVALID_ID) {                                           \
+            _id = counterRegister(name);                                   \
+            __atomic_store_n(&_counterID, _id, __ATOMIC_RELAXED);          \
+        }                                                                  \
+        counterAdd(_id, amount);                                           \
+    } while (0)
+
+#define FCOUNTER_INC(name) FCOUNTER_ADD(name, 1)
@@ -2,6 +2,9 @@
 #include "core/fmemory.h"
 #include "helpers/dinoArray.h"
 #include "core/logger.h"
+#include "core/fmutex.h"
+#include "core/frameStats.h"
+#include "core/fthread.h"
 
 typedef struct registeredEvent {
     void* listener;
@@ -14,12 +17,28 @@ typedef struct eventCodeEntry {
 
 // This should be more than enough codes...
 #define MAX_MESSAGE_CODES 16384
+// Events fired off the main thread that can be waiting for the next flush.
+#define MAX_DEFERRED_EVENTS 1024
+
+typedef struct deferredEvent {
+    u16 code;
+    void* sender;
+    eventContext context;
+} deferredEvent;
 
 // State structure.
 // List of registered events
 typedef struct eventSystemState {
     // Lookup table for event codes.
     eventCodeEntry registered[MAX_MESSAGE_CODES];
+
+    // Listeners only get called on the thread that inited the event system.
+    u64 mainThreadID;
+    fmutex deferredMutex;
+    u32 deferredCnt;
+    deferredEvent deferred[MAX_DEFERRED_EVENTS];
+    // What eventFlushDeferred is dispatching. Only used on the main thread.
+    deferredEvent flushing[MAX_DEFERRED_EVENTS];
 } eventSystemState;
 
 
@@ -32,6 +51,12 @@ b8 eventInit(u64* memoryRequirement, void* state) {
         return true;
     }
     systemPtr = state;
+    systemPtr->mainThreadID = fthreadCurrentID();
+    systemPtr->deferredCnt = 0;
+    if (!fmutexCreate(&systemPtr->deferredMutex)) {
+        FERROR("Event system failed to create its mutex.");
+        return false;
+    }
     isInit = true;
     return true;
 }
@@ -44,6 +69,8 @@ void eventShutdown() {
             systemPtr->registered[i].events = 0;
         }
     }
+    fmutexDestroy(&systemPtr->deferredMutex);
+    isInit = false;
 }
 
 b8 eventRegister(u16 code, void* listener, PF_on_event on_event) {
@@ -102,6 +129,24 @@ b8 eventFire(u16 code, void* sender, eventContext context) {
     if(isInit == false) {
         return false;
     }
+    frameStatsCount(FRAME_COUNTER_EVENTS, 1);
+
+    // Listeners aren't thread safe, hold onto it for the main thread.
+    if (fthreadCurrentID() != systemPtr->mainThreadID) {
+        fmutexLock(&systemPtr->deferredMutex);
+        b8 queued = systemPtr->deferredCnt < MAX_DEFERRED_EVENTS;
+        if (queued) {
+            deferredEvent* e = &systemPtr->deferred[systemPtr->deferredCnt++];
+            e->code = code;
+            e->sender = sender;
+            e->context = context;
+        }
+        fmutexUnlock(&systemPtr->deferredMutex);
+        if (!queued) {
+            FWARN("Deferred event queue is full, dropping event code %u.", code);
+        }
+        return false;
+    }
 
     // If nothing is registered for the code, boot out.
     if(systemPtr->registered[code].events == 0) {
@@ -120,3 +165,21 @@ b8 eventFire(u16 code, void* sender, eventContext context) {
     // Not found.
     return false;
 }
+
+void eventFlushDeferred() {
+    if(isInit == false) {
+        return;
+    }
+    // Take the events and let go of the lock before dispatching. Listeners
+    // can take a while, like reloading a texture, and other threads firing
+    // events shouldn't have to wait on them.
+    fmutexLock(&systemPtr->deferredMutex);
+    u32 cnt = systemPtr->deferredCnt;
+    fcopyMemory(systemPtr->flushing, systemPtr->deferred, sizeof(deferredEvent) * cnt);
+    systemPtr->deferredCnt = 0;
+    fmutexUnlock(&systemPtr->deferredMutex);
+    for (u32 i = 0; i < cnt; ++i) {
+        deferredEvent* e = &systemPtr->flushing[i];
+        eventFire(e->code, e->sender, e->context);
+    }
+}
@@ -46,8 +46,8 @@ typedef struct eventContext {
  */
 typedef b8 (*PF_on_event)(u16 eventCode, void* sender, void* listenerInstance, eventContext data);
 
-b8 eventInit(u64* memoryRequirement, void* state);
-void eventShutdown();
+FSNAPI b8 eventInit(u64* memoryRequirement, void* state);
+FSNAPI void eventShutdown();
 
 /**
  * Register to listen for when events are sent with the provided code. Events with duplicate
@@ -79,6 +79,13 @@ FSNAPI b8 eventUnregister(u16 code, void* listener, PF_on_event on_event);
  */
 FSNAPI b8 eventFire(u16 code, void* sender, eventContext context);
 
+/**
+ * Delivers events that were fired from threads other than the main thread.
+ * Those get queued instead of calling listeners right away, and eventFire
+ * returns false for them. Must be called from the main thread.
+ */
+FSNAPI void eventFlushDeferred();
+
 
 typedef enum system_event_code {
     /** @brief Shuts the application down on the next frame. */
@@ -1,6 +1,9 @@
 #include "fmemory.h"
 
+#include "core/asserts.h"
 #include "core/dyncamicAllocator.h"
+#include "core/fmutex.h"
+#include "core/frameStats.h"
 #include "core/logger.h"
 #include "platform/platform.h"
 
@@ -19,10 +22,32 @@ typedef struct memorySystemState {
     u64 allocatorMemReq;
     void* allocatorBlock;
     dynaAllocator allocator;
+    // The allocator and stats can be hit from more than one thread.
+    fmutex allocMutex;
 } memorySystemState;
 
 static memorySystemState* systemPtr;
 
+// Steady state works before memoryInit too, so it lives outside the state.
+static b8 steadyState;
+static memorySteadyAction steadyAction;
+static u64 steadyViolations;
+static _Thread_local b8 watchedThread;
+
+static void steadyStateViolation(const char* what, u64 size, memoryTag tag, const char* file, i32 line) {
+    __atomic_fetch_add(&steadyViolations, 1, __ATOMIC_RELAXED);
+    frameStatsCount(FRAME_COUNTER_STEADY_VIOLATIONS, 1);
+    memorySteadyAction action = __atomic_load_n(&steadyAction, __ATOMIC_RELAXED);
+    if (action == MEMORY_STEADY_ACTION_COUNT) {
+        return;
+    }
+    FWARN("Steady state %s of %llu bytes (%s) at %s:%d", what, size, TAG_STRING[tag], file, line);
+    if (action == MEMORY_STEADY_ACTION_ASSERT) {
+        reportAssertFailure("steady state", what, file, line);
+        debugBreak();
+    }
+}
+
 b8 memoryInit(memorySystemSettings settings) {
     u64 stateMemReq = sizeof(memorySystemState);
     u64 ar = 0;
@@ -44,6 +69,10 @@ b8 memoryInit(memorySystemSettings settings) {
         FFATAL("MemoryInit Failed to allocate a dynamicAllocator.");
         return false;
     }
+    if (!fmutexCreate(&systemPtr->allocMutex)) {
+        FFATAL("MemoryInit Failed to create the allocation mutex.");
+        return false;
+    }
     FDEBUG("Memory System allocated %llu bytes", settings.totalSize);
     return true;
 }
@@ -51,25 +80,31 @@ b8 memoryInit(memorySystemSettings settings) {
 void memoryShutdown() {
     if (systemPtr) {
         dynaAllocDestroy(&systemPtr->allocator);
+        fmutexDestroy(&systemPtr->allocMutex);
         platformFree(systemPtr,
                      systemPtr->allocatorMemReq + sizeof(memorySystemState));
     }
     systemPtr = 0;
 }
 
-void* fallocate(u64 size, memoryTag tag) {
+void* fallocateAt(u64 size, memoryTag tag, const char* file, i32 line) {
     if (tag == MEMORY_TAG_UNKNOWN) {
         FWARN("fallocate called using MEMORY_TAG_UNKNOWN. Re-class this "
               "allocation.");
     }
+    if (watchedThread && __atomic_load_n(&steadyState, __ATOMIC_RELAXED)) {
+        steadyStateViolation("allocation", size, tag, file, line);
+    }
 
     void* block = 0;
     if (systemPtr) {
+        fmutexLock(&systemPtr->allocMutex);
         systemPtr->stats.total_allocated += size;
         systemPtr->stats.tagged_allocations[tag] += size;
         systemPtr->allocCnt++;
 
         block = dynaAlloc(&systemPtr->allocator, size);
+        fmutexUnlock(&systemPtr->allocMutex);
 
         // As a fallback incase the dynamicAllocator fails which it should never
         // do
@@ -80,6 +115,7 @@ void* fallocate(u64 size, memoryTag tag) {
     }
 
     if (block) {
+        frameStatsCount(FRAME_COUNTER_ALLOCATIONS, 1);
         platformZeroMemory(block, size);
         return block;
     }
@@ -87,17 +123,23 @@ void* fallocate(u64 size, memoryTag tag) {
     return 0;
 }
 
-void ffree(void* block, u64 size, memoryTag tag) {
+void ffreeAt(void* block, u64 size, memoryTag tag, const char* file, i32 line) {
     if (tag == MEMORY_TAG_UNKNOWN) {
         FWARN(
             "ffree called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
     }
+    if (watchedThread && __atomic_load_n(&steadyState, __ATOMIC_RELAXED)) {
+        steadyStateViolation("free", size, tag, file, line);
+    }
+    frameStatsCount(FRAME_COUNTER_FREES, 1);
 
     if (systemPtr) {
+        fmutexLock(&systemPtr->allocMutex);
         systemPtr->stats.total_allocated -= size;
         systemPtr->stats.tagged_allocations[tag] -= size;
 
         b8 result = dynaAllocFree(&systemPtr->allocator, size, block);
+        fmutexUnlock(&systemPtr->allocMutex);
 
         // If result is false then that means something was allocated before the
         // memory system was inited. Try to free it from the platform.
@@ -111,6 +153,19 @@ void ffree(void* block, u64 size, memoryTag tag) {
     }
 }
 
+void memoryWatchThread() {
+    watchedThread = true;
+}
+
+void memorySetSteadyState(b8 steady, memorySteadyAction action) {
+    __atomic_store_n(&steadyAction, action, __ATOMIC_RELAXED);
+    __atomic_store_n(&steadyState, steady, __ATOMIC_RELAXED);
+}
+
+u64 memoryGetSteadyStateViolations() {
+    return __atomic_load_n(&steadyViolations, __ATOMIC_RELAXED);
+}
+
 void* fzeroMemory(void* block, u64 size) {
     return platformZeroMemory(block, size);
 }
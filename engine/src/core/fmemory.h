@@ -37,6 +37,16 @@ typedef struct memorySystemSettings {
     u64 totalSize;
 } memorySystemSettings;
 
+// What to do when a watched thread allocates or frees in steady state.
+typedef enum memorySteadyAction {
+    // Log the tag, size and call site.
+    MEMORY_STEADY_ACTION_LOG,
+    // Only count it.
+    MEMORY_STEADY_ACTION_COUNT,
+    // Log it then stop in the debugger.
+    MEMORY_STEADY_ACTION_ASSERT,
+} memorySteadyAction;
+
 /**
  * @brief Sets up the memory system. This system will be used to perform most
  * application memory allocations.
@@ -51,23 +61,52 @@ FSNAPI b8 memoryInit(memorySystemSettings settings);
 FSNAPI void memoryShutdown();
 
 /**
- * @brief Allocates memory. (Doesn't actually perform a malloc);
+ * @brief Allocates memory. (Doesn't actually perform a malloc); Use fallocate
+ * instead, which fills in the call site.
  * @param size Size of the block of memory needed
  * @param tag Memory tag used for debugging purposes to see memory leaks
+ * @param file The file it was called from
+ * @param line The line it was called from
  * @returns pointer to a block of memory, 0 if failed and outputs an error
  * message
  */
-FSNAPI void* fallocate(u64 size, memoryTag tag);
+FSNAPI void* fallocateAt(u64 size, memoryTag tag, const char* file, i32 line);
 
 /**
- * @brief Frees a block of memory
+ * @brief Frees a block of memory. Use ffree instead, which fills in the call
+ * site.
  * @param block Pointer to the memory block
  * @param size Size of the block of memory needed to be freed
  * @param tag Memory tag used for debugging purposes to see memory leaks
- * @returns pointer to a block of memory, 0 if failed and outputs an error
- * message
+ * @param file The file it was called from
+ * @param line The line it was called from
+ */
+FSNAPI void ffreeAt(void* block, u64 size, memoryTag tag, const char* file, i32 line);
+
+#define fallocate(size, tag) fallocateAt(size, tag, __FILE__, __LINE__)
+#define ffree(block, size, tag) ffreeAt(block, size, tag, __FILE__, __LINE__)
+
+/**
+ * @brief Makes this thread's allocations count against steady state. Call
+ * from the threads that run the frame.
+ */
+FSNAPI void memoryWatchThread();
+
+/**
+ * @brief Turns steady state on or off. While it's on every fallocate/ffree on
+ * a watched thread is counted and handled with action, since frames past
+ * warm up shouldn't be touching the heap.
+ * @param steady Whether to be in steady state
+ * @param action What to do with each allocation or free
+ */
+FSNAPI void memorySetSteadyState(b8 steady, memorySteadyAction action);
+
+/**
+ * @brief Gets how many allocations and frees happened on watched threads in
+ * steady state.
+ * @returns The count
  */
-FSNAPI void ffree(void* block, u64 size, memoryTag tag);
+FSNAPI u64 memoryGetSteadyStateViolations();
 
 /**
  * @brief Zeros out a block of memory
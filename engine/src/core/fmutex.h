@@ -0,0 +1,38 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @brief A platform mutex. The internal data is owned by the platform layer
+ * and should never be touched directly.
+ */
+typedef struct fmutex {
+    void* internalData;
+} fmutex;
+
+/**
+ * @brief Creates a mutex.
+ * @param outMutex The created mutex
+ * @returns true if successful, false if failed
+ */
+FSNAPI b8 fmutexCreate(fmutex* outMutex);
+
+/**
+ * @brief Destroys a mutex. The mutex must not be locked.
+ * @param mutex The mutex to destroy
+ */
+FSNAPI void fmutexDestroy(fmutex* mutex);
+
+/**
+ * @brief Locks the mutex, blocking until it is available.
+ * @param mutex The mutex to lock
+ * @returns true if successful, false if failed
+ */
+FSNAPI b8 fmutexLock(fmutex* mutex);
+
+/**
+ * @brief Unlocks a mutex previously locked by the calling thread.
+ * @param mutex The mutex to unlock
+ * @returns true if successful, false if failed
+ */
+FSNAPI b8 fmutexUnlock(fmutex* mutex);
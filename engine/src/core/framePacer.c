@@ -0,0 +1,150 @@
+#include "framePacer.h"
+
+#include "core/logger.h"
+#include "platform/platform.h"
+
+// How many frame intervals to keep for the stats.
+#define FRAME_PACER_SAMPLE_CNT 512
+// How many wake ups to look back on when picking the spin margin.
+#define FRAME_PACER_OVERSLEEP_CNT 32
+#define FRAME_PACER_MIN_SPIN_NS 200000ULL
+#define FRAME_PACER_MAX_SPIN_NS 4000000ULL
+
+typedef struct framePacerState {
+    u64 targetIntervalNs;
+    // 0 until the first frame has been waited on.
+    u64 nextDeadlineNs;
+    u64 lastFrameNs;
+
+    // How late the OS woke us up, used to pick how long to spin for.
+    u64 spinMarginNs;
+    u64 oversleepNs[FRAME_PACER_OVERSLEEP_CNT];
+    u32 oversleepIdx;
+
+    u32 sampleCnt;
+    u32 sampleIdx;
+    f64 intervals[FRAME_PACER_SAMPLE_CNT];
+    f64 jitter[FRAME_PACER_SAMPLE_CNT];
+    f64 scratch[FRAME_PACER_SAMPLE_CNT];
+} framePacerState;
+
+static framePacerState* systemPtr;
+
+b8 framePacerInit(u64* memoryRequirement, void* state, framePacerConfig config) {
+    *memoryRequirement = sizeof(framePacerState);
+    if (state == 0) {
+        return true;
+    }
+    systemPtr = state;
+    platformZeroMemory(systemPtr, sizeof(framePacerState));
+    systemPtr->spinMarginNs = 1000000ULL;
+    framePacerSetTargetRate(config.targetFrameRate);
+    return true;
+}
+
+void framePacerShutdown(void* state) {
+    if (!systemPtr) {
+        return;
+    }
+    framePacerStats stats;
+    if (framePacerGetStats(&stats) && stats.interval.count > 0) {
+        FINFO("Frame pacer: target %.3fms, interval p50 %.3fms p95 %.3fms p99 %.3fms max %.3fms, jitter p50 %.3fms p99 %.3fms",
+              stats.targetInterval * 1000.0, stats.interval.p50 * 1000.0, stats.interval.p95 * 1000.0,
+              stats.interval.p99 * 1000.0, stats.interval.max * 1000.0, stats.jitter.p50 * 1000.0,
+              stats.jitter.p99 * 1000.0);
+    }
+    systemPtr = 0;
+}
+
+static void updateSpinMargin(u64 oversleep) {
+    systemPtr->oversleepNs[systemPtr->oversleepIdx] = oversleep;
+    systemPtr->oversleepIdx = (systemPtr->oversleepIdx + 1) % FRAME_PACER_OVERSLEEP_CNT;
+
+    // Spin for a bit longer than the worst recent wake up.
+    u64 worst = 0;
+    for (u32 i = 0; i < FRAME_PACER_OVERSLEEP_CNT; ++i) {
+        if (systemPtr->oversleepNs[i] > worst) {
+            worst = systemPtr->oversleepNs[i];
+        }
+    }
+    u64 margin = worst + 100000ULL;
+    if (margin < FRAME_PACER_MIN_SPIN_NS) {
+        margin = FRAME_PACER_MIN_SPIN_NS;
+    } else if (margin > FRAME_PACER_MAX_SPIN_NS) {
+        margin = FRAME_PACER_MAX_SPIN_NS;
+    }
+    systemPtr->spinMarginNs = margin;
+}
+
+static void recordFrame(u64 now) {
+    if (systemPtr->lastFrameNs) {
+        f64 interval = (f64)(now - systemPtr->lastFrameNs) / 1000000000.0;
+        f64 target = (f64)systemPtr->targetIntervalNs / 1000000000.0;
+        f64 jitter = target > 0 ? interval - target : 0;
+        systemPtr->intervals[systemPtr->sampleIdx] = interval;
+        systemPtr->jitter[systemPtr->sampleIdx] = jitter < 0 ? -jitter : jitter;
+        systemPtr->sampleIdx = (systemPtr->sampleIdx + 1) % FRAME_PACER_SAMPLE_CNT;
+        if (systemPtr->sampleCnt < FRAME_PACER_SAMPLE_CNT) {
+            systemPtr->sampleCnt++;
+        }
+    }
+    systemPtr->lastFrameNs = now;
+}
+
+void framePacerWait() {
+    if (!systemPtr) {
+        return;
+    }
+    u64 now = platformGetTimestampNs();
+    if (systemPtr->targetIntervalNs == 0) {
+        recordFrame(now);
+        return;
+    }
+
+    // Deadlines are chained off the last one instead of now so small
+    // overshoots don't add up. If we're already a whole frame behind, start
+    // over from now rather than rushing frames out to catch up.
+    u64 deadline = systemPtr->nextDeadlineNs + systemPtr->targetIntervalNs;
+    if (systemPtr->nextDeadlineNs == 0 || deadline < now) {
+        deadline = now;
+    }
+    systemPtr->nextDeadlineNs = deadline;
+
+    if (deadline > now + systemPtr->spinMarginNs) {
+        u64 wakeAt = deadline - systemPtr->spinMarginNs;
+        platformSleepUntil(wakeAt);
+        now = platformGetTimestampNs();
+        updateSpinMargin(now > wakeAt ? now - wakeAt : 0);
+    }
+    while (now < deadline) {
+        now = platformGetTimestampNs();
+    }
+
+    recordFrame(now);
+}
+
+void framePacerSetTargetRate(f32 framesPerSecond) {
+    if (!systemPtr) {
+        return;
+    }
+    systemPtr->targetIntervalNs = framesPerSecond > 0 ? (u64)(1000000000.0 / framesPerSecond) : 0;
+    systemPtr->nextDeadlineNs = 0;
+}
+
+f32 framePacerGetTargetRate() {
+    if (!systemPtr || systemPtr->targetIntervalNs == 0) {
+        return 0;
+    }
+    return (f32)(1000000000.0 / systemPtr->targetIntervalNs);
+}
+
+b8 framePacerGetStats(framePacerStats* outStats) {
+    if (!systemPtr) {
+        return false;
+    }
+    outStats->targetInterval = (f64)systemPtr->targetIntervalNs / 1000000000.0;
+    outStats->spinMargin = (f64)systemPtr->spinMarginNs / 1000000000.0;
+    sampleStatsCompute(systemPtr->intervals, systemPtr->sampleCnt, systemPtr->scratch, &outStats->interval);
+    sampleStatsCompute(systemPtr->jitter, systemPtr->sampleCnt, systemPtr->scratch, &outStats->jitter);
+    return true;
+}
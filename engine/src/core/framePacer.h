@@ -0,0 +1,61 @@
+#pragma once
+
+#include "defines.h"
+#include "helpers/sampleStats.h"
+
+typedef struct framePacerConfig {
+    // The frame rate to pace to. 0 means unlimited.
+    f32 targetFrameRate;
+} framePacerConfig;
+
+typedef struct framePacerStats {
+    // The interval being paced to in seconds. 0 if unlimited.
+    f64 targetInterval;
+    // Actual time between frames in seconds.
+    sampleStats interval;
+    // How far off each frame was from the target interval in seconds.
+    sampleStats jitter;
+    // How long before the deadline the pacer stops sleeping and starts spinning.
+    f64 spinMargin;
+} framePacerStats;
+
+/**
+ * @brief Sets up the frame pacer. Keeps frames a steady distance apart by
+ * sleeping most of the remaining time then spinning until the deadline.
+ * @param memoryRequirement Gets set to the memory the pacer needs
+ * @param state The memory for the pacer. Pass 0 to just get the memoryRequirement
+ * @param config The pacer's config
+ * @returns true if successful, false if failed
+ */
+b8 framePacerInit(u64* memoryRequirement, void* state, framePacerConfig config);
+
+/**
+ * @brief Logs a summary of the frame timings and shuts down the pacer.
+ * @param state The pacer's state
+ */
+void framePacerShutdown(void* state);
+
+/**
+ * @brief Waits until the next frame should start. Call once a frame, after the
+ * frame has been presented.
+ */
+void framePacerWait();
+
+/**
+ * @brief Changes the frame rate to pace to.
+ * @param framesPerSecond The new frame rate. 0 means unlimited
+ */
+FSNAPI void framePacerSetTargetRate(f32 framesPerSecond);
+
+/**
+ * @brief Gets the frame rate being paced to.
+ * @returns The frame rate. 0 means unlimited
+ */
+FSNAPI f32 framePacerGetTargetRate();
+
+/**
+ * @brief Gets stats over the last FRAME_PACER_SAMPLE_CNT frames.
+ * @param outStats The stats
+ * @returns true if successful, false if the pacer isn't running
+ */
+FSNAPI b8 framePacerGetStats(framePacerStats* outStats);
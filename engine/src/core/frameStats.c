@@ -0,0 +1,204 @@
+#include "frameStats.h"
+
+#include "core/logger.h"
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include <stdio.h>
+
+typedef struct frameRecord {
+    u64 frame;
+    f64 frameTime;
+    f64 phases[FRAME_PHASE_MAX];
+    u64 counters[FRAME_COUNTER_MAX];
+    u64 namedCounters[COUNTERS_MAX];
+} frameRecord;
+
+typedef struct frameStatsState {
+    u32 frameCnt;
+    const char* csvPath;
+    u64 totalFrames;
+    u64 frameStartNs;
+
+    // The frame being recorded. Added to atomically since the simulation
+    // thread and allocations on other threads write to it.
+    u64 phaseNs[FRAME_PHASE_MAX];
+    u64 counters[FRAME_COUNTER_MAX];
+
+    u32 recordCnt;
+    u32 recordIdx;
+    // frameCnt of each, right after the state.
+    frameRecord* records;
+    f64* samples;
+    f64* scratch;
+} frameStatsState;
+
+static frameStatsState* systemPtr;
+
+b8 frameStatsInit(u64* memoryRequirement, void* state, frameStatsConfig config) {
+    u32 frameCnt = config.frameCnt ? config.frameCnt : FRAME_STATS_DEFAULT_FRAME_CNT;
+    *memoryRequirement = sizeof(frameStatsState) + frameCnt * (sizeof(frameRecord) + sizeof(f64) * 2);
+    if (state == 0) {
+        return true;
+    }
+    systemPtr = state;
+    platformZeroMemory(systemPtr, *memoryRequirement);
+    systemPtr->frameCnt = frameCnt;
+    systemPtr->csvPath = config.csvPath;
+    systemPtr->records = (frameRecord*)(systemPtr + 1);
+    systemPtr->samples = (f64*)(systemPtr->records + frameCnt);
+    systemPtr->scratch = systemPtr->samples + frameCnt;
+    return true;
+}
+
+void frameStatsShutdown(void* state) {
+    if (!systemPtr) {
+        return;
+    }
+    frameStatsSummary summary;
+    if (frameStatsGetSummary(&summary) && summary.frameTime.count > 0) {
+        FINFO("Frame stats over %u frames (%llu total): mean %.3fms p50 %.3fms p95 %.3fms p99 %.3fms max %.3fms",
+              summary.frameTime.count, summary.totalFrames, summary.frameTime.mean * 1000.0,
+              summary.frameTime.p50 * 1000.0, summary.frameTime.p95 * 1000.0, summary.frameTime.p99 * 1000.0,
+              summary.frameTime.max * 1000.0);
+        for (u32 i = 0; i < summary.namedCounterCnt; ++i) {
+            FINFO("  %s: mean %.1f p99 %.0f max %.0f per frame, %llu total", counterGetName(i),
+                  summary.namedCounters[i].mean, summary.namedCounters[i].p99, summary.namedCounters[i].max,
+                  counterGetTotal(i));
+        }
+    }
+    if (systemPtr->csvPath) {
+        frameStatsWriteCsv(systemPtr->csvPath);
+    }
+    systemPtr = 0;
+}
+
+void frameStatsBeginFrame() {
+    if (!systemPtr) {
+        return;
+    }
+    systemPtr->frameStartNs = platformGetTimestampNs();
+}
+
+void frameStatsEndFrame() {
+    if (!systemPtr || systemPtr->frameStartNs == 0) {
+        return;
+    }
+    frameRecord* r = &systemPtr->records[systemPtr->recordIdx];
+    r->frame = systemPtr->totalFrames;
+    r->frameTime = (f64)(platformGetTimestampNs() - systemPtr->frameStartNs) / 1000000000.0;
+    for (u32 i = 0; i < FRAME_PHASE_MAX; ++i) {
+        r->phases[i] = (f64)__atomic_exchange_n(&systemPtr->phaseNs[i], 0, __ATOMIC_RELAXED) / 1000000000.0;
+    }
+    for (u32 i = 0; i < FRAME_COUNTER_MAX; ++i) {
+        r->counters[i] = __atomic_exchange_n(&systemPtr->counters[i], 0, __ATOMIC_RELAXED);
+    }
+    countersSnapshot();
+    for (u32 i = 0; i < COUNTERS_MAX; ++i) {
+        r->namedCounters[i] = counterGetFrameValue(i);
+    }
+
+    systemPtr->recordIdx = (systemPtr->recordIdx + 1) % systemPtr->frameCnt;
+    if (systemPtr->recordCnt < systemPtr->frameCnt) {
+        systemPtr->recordCnt++;
+    }
+    systemPtr->totalFrames++;
+}
+
+void frameStatsAddPhaseTime(frameStatsPhase phase, u64 ns) {
+    if (!systemPtr) {
+        return;
+    }
+    __atomic_fetch_add(&systemPtr->phaseNs[phase], ns, __ATOMIC_RELAXED);
+}
+
+void frameStatsCount(frameStatsCounter counter, u64 amount) {
+    if (!systemPtr) {
+        return;
+    }
+    __atomic_fetch_add(&systemPtr->counters[counter], amount, __ATOMIC_RELAXED);
+}
+
+u64 frameStatsGetFrameCount() {
+    return systemPtr ? systemPtr->totalFrames : 0;
+}
+
+// Index into records of the i'th oldest kept frame.
+static u32 recordAt(u32 i) {
+    return (systemPtr->recordIdx + systemPtr->frameCnt - systemPtr->recordCnt + i) % systemPtr->frameCnt;
+}
+
+b8 frameStatsGetSummary(frameStatsSummary* outSummary) {
+    if (!systemPtr) {
+        return false;
+    }
+    u32 cnt = systemPtr->recordCnt;
+    f64* samples = systemPtr->samples;
+    outSummary->totalFrames = systemPtr->totalFrames;
+
+    for (u32 i = 0; i < cnt; ++i) {
+        samples[i] = systemPtr->records[i].frameTime;
+    }
+    sampleStatsCompute(samples, cnt, systemPtr->scratch, &outSummary->frameTime);
+
+    for (u32 p = 0; p < FRAME_PHASE_MAX; ++p) {
+        for (u32 i = 0; i < cnt; ++i) {
+            samples[i] = systemPtr->records[i].phases[p];
+        }
+        sampleStatsCompute(samples, cnt, systemPtr->scratch, &outSummary->phases[p]);
+    }
+    for (u32 c = 0; c < FRAME_COUNTER_MAX; ++c) {
+        for (u32 i = 0; i < cnt; ++i) {
+            samples[i] = (f64)systemPtr->records[i].counters[c];
+        }
+        sampleStatsCompute(samples, cnt, systemPtr->scratch, &outSummary->counters[c]);
+    }
+    outSummary->namedCounterCnt = countersGetCount();
+    for (u32 c = 0; c < outSummary->namedCounterCnt; ++c) {
+        for (u32 i = 0; i < cnt; ++i) {
+            samples[i] = (f64)systemPtr->records[i].namedCounters[c];
+        }
+        sampleStatsCompute(samples, cnt, systemPtr->scratch, &outSummary->namedCounters[c]);
+    }
+    return true;
+}
+
+b8 frameStatsWriteCsv(const char* path) {
+    if (!systemPtr) {
+        return false;
+    }
+    fileHandle f;
+    if (!fsOpen(path, FILE_MODE_WRITE, false, &f)) {
+        FERROR("Frame stats couldn't open %s to write the CSV.", path);
+        return false;
+    }
+
+    // The named counters get a column each after the built in ones.
+    u32 namedCnt = countersGetCount();
+    char line[2048];
+    u64 len = snprintf(line, sizeof(line), "frame,frameMs,updateMs,renderPrepMs,drawMs,presentWaitMs,gpuMs,draws,allocations,events,frees,steadyViolations");
+    for (u32 c = 0; c < namedCnt && len < sizeof(line); ++c) {
+        len += snprintf(line + len, sizeof(line) - len, ",%s", counterGetName(c));
+    }
+    b8 ok = fsWriteLine(&f, line);
+    for (u32 i = 0; i < systemPtr->recordCnt && ok; ++i) {
+        frameRecord* r = &systemPtr->records[recordAt(i)];
+        len = snprintf(line, sizeof(line), "%llu,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%llu,%llu,%llu,%llu,%llu", r->frame, r->frameTime * 1000.0,
+                       r->phases[FRAME_PHASE_UPDATE] * 1000.0, r->phases[FRAME_PHASE_RENDER_PREP] * 1000.0,
+                       r->phases[FRAME_PHASE_DRAW] * 1000.0, r->phases[FRAME_PHASE_PRESENT_WAIT] * 1000.0,
+                       r->phases[FRAME_PHASE_GPU] * 1000.0,
+                       r->counters[FRAME_COUNTER_DRAWS], r->counters[FRAME_COUNTER_ALLOCATIONS],
+                       r->counters[FRAME_COUNTER_EVENTS], r->counters[FRAME_COUNTER_FREES],
+                       r->counters[FRAME_COUNTER_STEADY_VIOLATIONS]);
+        for (u32 c = 0; c < namedCnt && len < sizeof(line); ++c) {
+            len += snprintf(line + len, sizeof(line) - len, ",%llu", r->namedCounters[c]);
+        }
+        ok = fsWriteLine(&f, line);
+    }
+    fsClose(&f);
+
+    if (!ok) {
+        FERROR("Frame stats failed writing %s", path);
+    }
+    return ok;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "defines.h"
+#include "core/counters.h"
+#include "helpers/sampleStats.h"
+
+// How many frames get kept when frameStatsConfig.frameCnt is 0.
+#define FRAME_STATS_DEFAULT_FRAME_CNT 1024
+
+typedef enum frameStatsPhase {
+    // The game's update, every fixed step of it.
+    FRAME_PHASE_UPDATE,
+    // The game's render and building the render packet.
+    FRAME_PHASE_RENDER_PREP,
+    // rendererDraw, which includes submitting and presenting.
+    FRAME_PHASE_DRAW,
+    // Waiting on the frame pacer for the next frame to start.
+    FRAME_PHASE_PRESENT_WAIT,
+    // How long the GPU took on a frame. Read back without stalling, so it's
+    // the time of a frame a couple of frames ago.
+    FRAME_PHASE_GPU,
+    FRAME_PHASE_MAX
+} frameStatsPhase;
+
+typedef enum frameStatsCounter {
+    FRAME_COUNTER_DRAWS,
+    FRAME_COUNTER_ALLOCATIONS,
+    FRAME_COUNTER_EVENTS,
+    FRAME_COUNTER_FREES,
+    // Allocations and frees on watched threads once in steady state.
+    FRAME_COUNTER_STEADY_VIOLATIONS,
+    FRAME_COUNTER_MAX
+} frameStatsCounter;
+
+typedef struct frameStatsConfig {
+    // How many frames to keep stats for. 0 uses FRAME_STATS_DEFAULT_FRAME_CNT.
+    u32 frameCnt;
+    // Where to write every kept frame as CSV on shutdown. 0 to not write one.
+    const char* csvPath;
+} frameStatsConfig;
+
+typedef struct frameStatsSummary {
+    // Frames since startup.
+    u64 totalFrames;
+    // Whole frame times in seconds.
+    sampleStats frameTime;
+    // Per phase times in seconds.
+    sampleStats phases[FRAME_PHASE_MAX];
+    // Per frame counts.
+    sampleStats counters[FRAME_COUNTER_MAX];
+    // Per frame counts of the registered named counters, by counter id.
+    u32 namedCounterCnt;
+    sampleStats namedCounters[COUNTERS_MAX];
+} frameStatsSummary;
+
+/**
+ * @brief Sets up frame stats. Keeps per phase timings and counters for the
+ * last config.frameCnt frames.
+ * @param memoryRequirement Gets set to the memory frame stats needs
+ * @param state The memory for frame stats. Pass 0 to just get the memoryRequirement
+ * @param config The frame stats config
+ * @returns true if successful, false if failed
+ */
+b8 frameStatsInit(u64* memoryRequirement, void* state, frameStatsConfig config);
+
+/**
+ * @brief Writes the CSV if one was asked for and shuts down frame stats.
+ * @param state The frame stats state
+ */
+void frameStatsShutdown(void* state);
+
+/**
+ * @brief Starts timing a new frame. Call at the top of the frame loop.
+ */
+void frameStatsBeginFrame();
+
+/**
+ * @brief Finishes the frame, snapshots the named counters and pushes it into
+ * the ring.
+ */
+void frameStatsEndFrame();
+
+/**
+ * @brief Adds time to one of the current frame's phases. Adds up if a phase
+ * runs more than once a frame. Safe from any thread.
+ * @param phase The phase
+ * @param ns How long it took in nanoseconds
+ */
+FSNAPI void frameStatsAddPhaseTime(frameStatsPhase phase, u64 ns);
+
+/**
+ * @brief Adds to one of the current frame's counters. Safe from any thread.
+ * @param counter The counter
+ * @param amount How much to add
+ */
+FSNAPI void frameStatsCount(frameStatsCounter counter, u64 amount);
+
+/**
+ * @brief Gets how many frames have finished since startup.
+ * @returns The frame count
+ */
+FSNAPI u64 frameStatsGetFrameCount();
+
+/**
+ * @brief Gets the mean, percentiles and max over the kept frames.
+ * @param outSummary The summary
+ * @returns true if successful, false if frame stats aren't running
+ */
+FSNAPI b8 frameStatsGetSummary(frameStatsSummary* outSummary);
+
+/**
+ * @brief Writes every kept frame to a CSV file, oldest first.
+ * @param path Where to write it
+ * @returns true if successful, false if failed
+ */
+FSNAPI b8 frameStatsWriteCsv(const char* path);
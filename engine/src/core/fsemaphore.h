@@ -0,0 +1,44 @@
+#pragma once
+
+#include "defines.h"
+
+// Pass to fsemaphoreWait to wait without a timeout.
+#define FSEMAPHORE_WAIT_INFINITE 0xFFFFFFFFFFFFFFFFULL
+
+/**
+ * @brief A counting semaphore. The internal data is owned by the platform
+ * layer and should never be touched directly.
+ */
+typedef struct fsemaphore {
+    void* internalData;
+} fsemaphore;
+
+/**
+ * @brief Creates a semaphore.
+ * @param outSemaphore The created semaphore
+ * @param maxCount The maximum count the semaphore can reach
+ * @param startCount The count the semaphore starts at
+ * @returns true if successful, false if failed
+ */
+FSNAPI b8 fsemaphoreCreate(fsemaphore* outSemaphore, u32 maxCount, u32 startCount);
+
+/**
+ * @brief Destroys a semaphore.
+ * @param semaphore The semaphore to destroy
+ */
+FSNAPI void fsemaphoreDestroy(fsemaphore* semaphore);
+
+/**
+ * @brief Increments the semaphore, waking up one waiter.
+ * @param semaphore The semaphore to signal
+ * @returns true if successful, false if failed
+ */
+FSNAPI b8 fsemaphoreSignal(fsemaphore* semaphore);
+
+/**
+ * @brief Waits for the semaphore to be signaled, then decrements it.
+ * @param semaphore The semaphore to wait on
+ * @param timeoutMs How long to wait in milliseconds. FSEMAPHORE_WAIT_INFINITE waits forever
+ * @returns true if the semaphore was signaled, false if it timed out or failed
+ */
+FSNAPI b8 fsemaphoreWait(fsemaphore* semaphore, u64 timeoutMs);
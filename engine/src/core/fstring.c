@@ -377,3 +377,80 @@ b8 strToBool(const char* str, b8* b) {
     *b = strEqual(str, "1") || strEqualI(str, "true");
     return *b;
 }
+
+strView strViewFromCStr(const char* str) {
+    strView v = {str, str ? strLen(str) : 0};
+    return v;
+}
+
+strView strViewTrim(strView view) {
+    while (view.len && isspace((unsigned char)view.str[0])) {
+        view.str++;
+        view.len--;
+    }
+    while (view.len && isspace((unsigned char)view.str[view.len - 1])) {
+        view.len--;
+    }
+    return view;
+}
+
+b8 strViewEqual(strView view, const char* str) {
+    return strncmp(view.str, str, view.len) == 0 && str[view.len] == 0;
+}
+
+b8 strViewEqualI(strView view, const char* str) {
+#if defined(__GNUC__)
+    return strncasecmp(view.str, str, view.len) == 0 && str[view.len] == 0;
+#elif defined(_MSC_VER)
+    return _strnicmp(view.str, str, view.len) == 0 && str[view.len] == 0;
+#endif
+}
+
+i64 strViewIdxOf(strView view, char c) {
+    const char* found = view.len ? memchr(view.str, c, view.len) : 0;
+    return found ? (i64)(found - view.str) : -1;
+}
+
+b8 strViewSplitOnce(strView view, char delimiter, strView* outLeft, strView* outRight) {
+    i64 idx = strViewIdxOf(view, delimiter);
+    if (idx < 0) {
+        return false;
+    }
+    outLeft->str = view.str;
+    outLeft->len = (u64)idx;
+    outRight->str = view.str + idx + 1;
+    outRight->len = view.len - (u64)idx - 1;
+    return true;
+}
+
+b8 strViewNextToken(strView* rest, char delimiter, strView* outToken) {
+    if (!rest->str) {
+        return false;
+    }
+    strView right;
+    if (strViewSplitOnce(*rest, delimiter, outToken, &right)) {
+        *rest = right;
+    } else {
+        // Last token, nothing left after it.
+        *outToken = *rest;
+        rest->str = 0;
+        rest->len = 0;
+    }
+    *outToken = strViewTrim(*outToken);
+    return true;
+}
+
+char* strViewCopy(char* dest, u64 destSize, strView view) {
+    if (!destSize) {
+        return dest;
+    }
+    u64 len = view.len < destSize - 1 ? view.len : destSize - 1;
+    fcopyMemory(dest, view.str, len);
+    dest[len] = 0;
+    return dest;
+}
+
+char* strViewDup(strView view) {
+    char* copy = fallocate(view.len + 1, MEMORY_TAG_STRING);
+    return strViewCopy(copy, view.len + 1, view);
+}
@@ -87,3 +87,60 @@ FSNAPI b8 strToU32(const char* str, u32* u);
 FSNAPI b8 strToU64(const char* str, u64* u);
 
 FSNAPI b8 strToBool(const char* str, b8* b);
+
+/**
+ * @brief A slice of a string that isn't null terminated. Points into someone
+ * else's memory, so it's only good as long as that is.
+ */
+typedef struct strView {
+    const char* str;
+    u64 len;
+} strView;
+
+FSNAPI strView strViewFromCStr(const char* str);
+
+// Drops the whitespace off both ends of the view.
+FSNAPI strView strViewTrim(strView view);
+
+FSNAPI b8 strViewEqual(strView view, const char* str);
+
+FSNAPI b8 strViewEqualI(strView view, const char* str);
+
+// Returns the index of the first c in the view, or -1.
+FSNAPI i64 strViewIdxOf(strView view, char c);
+
+/**
+ * @brief Splits a view in two at the first delimiter, dropping the delimiter.
+ *
+ * @param view The view to split.
+ * @param delimiter The char to split at.
+ * @param outLeft Everything before the delimiter.
+ * @param outRight Everything after the delimiter.
+ * @return False if the delimiter isn't in the view.
+ */
+FSNAPI b8 strViewSplitOnce(strView view, char delimiter, strView* outLeft, strView* outRight);
+
+/**
+ * @brief Takes the next delimiter separated token off the front of rest. Like
+ * strSplit without allocating anything.
+ *
+ * @param rest What's left to tokenize. Gets moved past the token.
+ * @param delimiter The char between tokens.
+ * @param outToken The token, trimmed.
+ * @return False once there's nothing left.
+ */
+FSNAPI b8 strViewNextToken(strView* rest, char delimiter, strView* outToken);
+
+/**
+ * @brief Copies a view into a null terminated buffer, cutting it off if it
+ * doesn't fit.
+ *
+ * @param dest The buffer to copy into.
+ * @param destSize The size of dest, including the null terminator.
+ * @param view The view to copy.
+ * @return dest.
+ */
+FSNAPI char* strViewCopy(char* dest, u64 destSize, strView view);
+
+// Allocates a null terminated copy of the view. Free it like a strDup'd string.
+FSNAPI char* strViewDup(strView view);
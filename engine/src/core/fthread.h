@@ -0,0 +1,60 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @brief A platform thread handle. The internal data is owned by the platform
+ * layer and should never be touched directly.
+ */
+typedef struct fthread {
+    void* internalData;
+    u64 threadID;
+} fthread;
+
+/**
+ * @brief The entry point of a thread.
+ * @param params The params passed to fthreadCreate
+ * @returns The thread's exit code
+ */
+typedef u32 (*PFN_threadStart)(void* params);
+
+/**
+ * @brief Creates and starts a new thread.
+ * @param startFunc The function the thread will run
+ * @param params Passed straight through to startFunc. Must outlive the thread
+ * @param autoDetach If true the thread is detached right away and cleans up
+ * after itself. outThread is left zeroed
+ * @param outThread The created thread
+ * @returns true if successful, false if failed
+ */
+FSNAPI b8 fthreadCreate(PFN_threadStart startFunc, void* params, b8 autoDetach, fthread* outThread);
+
+/**
+ * @brief Frees the thread handle. Does not stop the thread, use fthreadWait first.
+ * @param thread The thread to destroy
+ */
+FSNAPI void fthreadDestroy(fthread* thread);
+
+/**
+ * @brief Detaches the thread so it releases its resources when it exits.
+ * @param thread The thread to detach
+ */
+FSNAPI void fthreadDetach(fthread* thread);
+
+/**
+ * @brief Blocks until the thread has exited.
+ * @param thread The thread to wait on
+ * @returns true if the thread was joined, false if failed
+ */
+FSNAPI b8 fthreadWait(fthread* thread);
+
+/**
+ * @brief Gives the rest of the calling thread's timeslice back to the OS.
+ */
+FSNAPI void fthreadYield();
+
+/**
+ * @brief Gets the id of the calling thread.
+ * @returns The id of the calling thread
+ */
+FSNAPI u64 fthreadCurrentID();
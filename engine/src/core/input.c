@@ -1,5 +1,6 @@
 #include "core/input.h"
 #include "core/fmemory.h"
+#include "core/inputRecorder.h"
 #include "core/event.h"
 #include "core/logger.h"
 
@@ -57,6 +58,9 @@ void inputShutdown(void* state) {
 }
 
 void inputProcessKey(keys key, b8 pressed) {
+    if (!inputRecorderOnKey(key, pressed)) {
+        return;
+    }
     eventContext context;
     context.data.u16[0] = key;
     systemPtr->keyboardCur.keys[key].isDown = pressed;
@@ -70,6 +74,9 @@ void inputProcessKey(keys key, b8 pressed) {
 }
 
 void inputProcessButton(buttons button, b8 pressed) {
+    if (!inputRecorderOnButton(button, pressed)) {
+        return;
+    }
     eventContext context;
     context.data.u16[0] = button;
     systemPtr->mouseCur.buttons[button].isDown = pressed;
@@ -82,6 +89,9 @@ void inputProcessButton(buttons button, b8 pressed) {
 }
 
 void inputProcessMouseMove(i16 x, i16 y) {
+    if (!inputRecorderOnMouseMove(x, y)) {
+        return;
+    }
     // Only process if actually different
     if (systemPtr->mouseCur.x != x || systemPtr->mouseCur.y != y) {
         // Update internal systemPtr->
@@ -97,6 +107,9 @@ void inputProcessMouseMove(i16 x, i16 y) {
 }
 
 void inputProcessMouseWheel(i8 zDelta) {
+    if (!inputRecorderOnMouseWheel(zDelta)) {
+        return;
+    }
     // Fire the event.
     eventContext context;
     context.data.u8[0] = zDelta;
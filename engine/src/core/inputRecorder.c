@@ -0,0 +1,294 @@
+#include "inputRecorder.h"
+
+#include "core/fmemory.h"
+#include "core/logger.h"
+#include "platform/filesystem.h"
+
+typedef struct inputRecorderHeader {
+    u32 magic;
+    u32 version;
+} inputRecorderHeader;
+
+typedef struct inputRecorderState {
+    fileHandle file;
+    b8 recording;
+    b8 replaying;
+    // Set while a replay is feeding events so they aren't dropped as live input.
+    b8 feeding;
+    b8 failed;
+    f64 replayDelta;
+    u64 frameCnt;
+    u64 eventCnt;
+
+    // Recording fills it up to used then writes it out. Replaying reads into
+    // it and consumes it from pos to used.
+    u32 used;
+    u32 pos;
+    u8 buffer[INPUT_RECORDER_BUFFER_SIZE];
+} inputRecorderState;
+
+static inputRecorderState* systemPtr;
+
+static void flush() {
+    if (systemPtr->used == 0 || systemPtr->failed) {
+        return;
+    }
+    u64 written = 0;
+    if (!fsWrite(&systemPtr->file, systemPtr->used, systemPtr->buffer, &written) || written != systemPtr->used) {
+        FERROR("Input recorder failed to write, the rest of the session won't be recorded.");
+        systemPtr->failed = true;
+    }
+    systemPtr->used = 0;
+}
+
+static void writeRecord(u8 type, const void* data, u32 size) {
+    if (systemPtr->used + 1 + size > INPUT_RECORDER_BUFFER_SIZE) {
+        flush();
+    }
+    systemPtr->buffer[systemPtr->used++] = type;
+    fcopyMemory(systemPtr->buffer + systemPtr->used, data, size);
+    systemPtr->used += size;
+}
+
+// Makes sure size bytes can be read from pos, reading more of the file in if
+// needed. False at the end of the file.
+static b8 readAvailable(u32 size) {
+    u32 remaining = systemPtr->used - systemPtr->pos;
+    if (remaining >= size) {
+        return true;
+    }
+    if (systemPtr->failed) {
+        return false;
+    }
+    // Less than a record is left so a byte at a time is fine. Copying forward
+    // is safe even if the ranges overlap.
+    for (u32 i = 0; i < remaining; ++i) {
+        systemPtr->buffer[i] = systemPtr->buffer[systemPtr->pos + i];
+    }
+    systemPtr->pos = 0;
+    systemPtr->used = remaining;
+    u64 read = 0;
+    // A short read means the end of the file, what was read is still good.
+    if (!fsRead(&systemPtr->file, INPUT_RECORDER_BUFFER_SIZE - remaining, systemPtr->buffer + remaining, &read)) {
+        systemPtr->failed = true;
+    }
+    systemPtr->used += (u32)read;
+    return systemPtr->used >= size;
+}
+
+// The bytes after a record's first byte.
+static u32 recordDataSize(u8 type) {
+    switch (type) {
+    case INPUT_RECORD_FRAME:
+        return sizeof(f64);
+    case INPUT_RECORD_KEY:
+    case INPUT_RECORD_BUTTON:
+        return sizeof(u8);
+    case INPUT_RECORD_MOUSE_MOVE:
+        return sizeof(i16) * 2;
+    case INPUT_RECORD_MOUSE_WHEEL:
+        return sizeof(i8);
+    default:
+        return INVALID_ID;
+    }
+}
+
+static void readData(void* outData, u32 size) {
+    fcopyMemory(outData, systemPtr->buffer + systemPtr->pos, size);
+    systemPtr->pos += size;
+}
+
+b8 inputRecorderInit(u64* memoryRequirement, void* state, inputRecorderConfig config) {
+    *memoryRequirement = sizeof(inputRecorderState);
+    if (state == 0) {
+        return true;
+    }
+    systemPtr = state;
+    fzeroMemory(systemPtr, sizeof(inputRecorderState));
+
+    if (config.replayPath) {
+        if (config.recordPath) {
+            FWARN("Input recorder can't record and replay at once, only replaying '%s'.", config.replayPath);
+        }
+        inputRecorderHeader header;
+        u64 read = 0;
+        if (!fsOpen(config.replayPath, FILE_MODE_READ, true, &systemPtr->file)) {
+            FERROR("Input recorder couldn't open '%s' to replay.", config.replayPath);
+            return false;
+        }
+        if (!fsRead(&systemPtr->file, sizeof(header), &header, &read) || read != sizeof(header) ||
+            header.magic != INPUT_RECORDER_MAGIC || header.version != INPUT_RECORDER_VERSION) {
+            FERROR("'%s' isn't an input recording this version can replay.", config.replayPath);
+            fsClose(&systemPtr->file);
+            return false;
+        }
+        systemPtr->replaying = true;
+        systemPtr->replayDelta = config.replayDelta;
+        FINFO("Replaying input from '%s'.", config.replayPath);
+    } else if (config.recordPath) {
+        if (!fsOpen(config.recordPath, FILE_MODE_WRITE, true, &systemPtr->file)) {
+            FERROR("Input recorder couldn't open '%s' to record to.", config.recordPath);
+            return false;
+        }
+        inputRecorderHeader header = {INPUT_RECORDER_MAGIC, INPUT_RECORDER_VERSION};
+        u64 written = 0;
+        if (!fsWrite(&systemPtr->file, sizeof(header), &header, &written) || written != sizeof(header)) {
+            FERROR("Input recorder couldn't write to '%s'.", config.recordPath);
+            fsClose(&systemPtr->file);
+            return false;
+        }
+        systemPtr->recording = true;
+        FINFO("Recording input to '%s'.", config.recordPath);
+    }
+    return true;
+}
+
+void inputRecorderShutdown(void* state) {
+    if (!systemPtr) {
+        return;
+    }
+    if (systemPtr->recording) {
+        flush();
+        FINFO("Recorded %llu frames and %llu input events.", systemPtr->frameCnt, systemPtr->eventCnt);
+    } else if (systemPtr->replaying) {
+        FINFO("Replayed %llu frames and %llu input events.", systemPtr->frameCnt, systemPtr->eventCnt);
+    }
+    if (systemPtr->recording || systemPtr->replaying) {
+        fsClose(&systemPtr->file);
+    }
+    systemPtr = 0;
+}
+
+b8 inputRecorderIsReplaying() {
+    return systemPtr && systemPtr->replaying;
+}
+
+b8 inputRecorderIsRecording() {
+    return systemPtr && systemPtr->recording;
+}
+
+b8 inputRecorderReplayFrame(f64* outDelta) {
+    if (!systemPtr || !systemPtr->replaying) {
+        return false;
+    }
+    systemPtr->feeding = true;
+    b8 gotFrame = false;
+    while (!gotFrame && readAvailable(1)) {
+        u8 head = systemPtr->buffer[systemPtr->pos];
+        u8 type = head & INPUT_RECORD_TYPE_MASK;
+        b8 pressed = (head & INPUT_RECORD_PRESSED_BIT) != 0;
+        u32 dataSize = recordDataSize(type);
+        if (dataSize == INVALID_ID) {
+            FERROR("Input recording has an unknown record type %u, stopping the replay.", head);
+            systemPtr->failed = true;
+            break;
+        }
+        if (!readAvailable(1 + dataSize)) {
+            FWARN("Input recording ends partway through a record, stopping the replay.");
+            break;
+        }
+        systemPtr->pos++;
+
+        switch (type) {
+        case INPUT_RECORD_FRAME: {
+            f64 delta;
+            readData(&delta, sizeof(delta));
+            *outDelta = systemPtr->replayDelta > 0 ? systemPtr->replayDelta : delta;
+            systemPtr->frameCnt++;
+            gotFrame = true;
+        } break;
+        case INPUT_RECORD_KEY: {
+            u8 key;
+            readData(&key, sizeof(key));
+            inputProcessKey((keys)key, pressed);
+            systemPtr->eventCnt++;
+        } break;
+        case INPUT_RECORD_BUTTON: {
+            u8 button;
+            readData(&button, sizeof(button));
+            inputProcessButton((buttons)button, pressed);
+            systemPtr->eventCnt++;
+        } break;
+        case INPUT_RECORD_MOUSE_MOVE: {
+            i16 pos[2];
+            readData(pos, sizeof(pos));
+            inputProcessMouseMove(pos[0], pos[1]);
+            systemPtr->eventCnt++;
+        } break;
+        case INPUT_RECORD_MOUSE_WHEEL: {
+            i8 zDelta;
+            readData(&zDelta, sizeof(zDelta));
+            inputProcessMouseWheel(zDelta);
+            systemPtr->eventCnt++;
+        } break;
+        }
+    }
+    systemPtr->feeding = false;
+    return gotFrame;
+}
+
+void inputRecorderEndFrame(f64 delta) {
+    if (!systemPtr || !systemPtr->recording) {
+        return;
+    }
+    writeRecord(INPUT_RECORD_FRAME, &delta, sizeof(delta));
+    systemPtr->frameCnt++;
+}
+
+// Live input is dropped during a replay, anything else gets recorded if
+// recording.
+static b8 onInput() {
+    if (!systemPtr) {
+        return true;
+    }
+    if (systemPtr->replaying) {
+        return systemPtr->feeding;
+    }
+    if (systemPtr->recording) {
+        systemPtr->eventCnt++;
+    }
+    return true;
+}
+
+b8 inputRecorderOnKey(keys key, b8 pressed) {
+    if (!onInput()) {
+        return false;
+    }
+    if (systemPtr && systemPtr->recording) {
+        u8 data = (u8)key;
+        writeRecord(INPUT_RECORD_KEY | (pressed ? INPUT_RECORD_PRESSED_BIT : 0), &data, sizeof(data));
+    }
+    return true;
+}
+
+b8 inputRecorderOnButton(buttons button, b8 pressed) {
+    if (!onInput()) {
+        return false;
+    }
+    if (systemPtr && systemPtr->recording) {
+        u8 data = (u8)button;
+        writeRecord(INPUT_RECORD_BUTTON | (pressed ? INPUT_RECORD_PRESSED_BIT : 0), &data, sizeof(data));
+    }
+    return true;
+}
+
+b8 inputRecorderOnMouseMove(i16 x, i16 y) {
+    if (!onInput()) {
+        return false;
+    }
+    if (systemPtr && systemPtr->recording) {
+        i16 data[2] = {x, y};
+        writeRecord(INPUT_RECORD_MOUSE_MOVE, data, sizeof(data));
+    }
+    return true;
+}
+
+b8 inputRecorderOnMouseWheel(i8 zDelta) {
+    if (!onInput()) {
+        return false;
+    }
+    if (systemPtr && systemPtr->recording) {
+        writeRecord(INPUT_RECORD_MOUSE_WHEEL, &zDelta, sizeof(zDelta));
+    }
+    return true;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "defines.h"
+#include "core/input.h"
+
+#define INPUT_RECORDER_MAGIC 0x524E4946 // "FINR"
+#define INPUT_RECORDER_VERSION 1
+// How much of the file is kept in memory at once while recording/replaying.
+#define INPUT_RECORDER_BUFFER_SIZE KIBIBYTES(64)
+
+// Record types in the low bits of a record's first byte.
+typedef enum inputRecordType {
+    // Ends a frame. Followed by the frame's delta as an f64.
+    INPUT_RECORD_FRAME = 0,
+    // Followed by the key as a u8.
+    INPUT_RECORD_KEY = 1,
+    // Followed by the button as a u8.
+    INPUT_RECORD_BUTTON = 2,
+    // Followed by x and y as i16s.
+    INPUT_RECORD_MOUSE_MOVE = 3,
+    // Followed by the wheel delta as an i8.
+    INPUT_RECORD_MOUSE_WHEEL = 4,
+} inputRecordType;
+
+// Set on a key/button record's first byte if it was a press.
+#define INPUT_RECORD_PRESSED_BIT 0x10
+#define INPUT_RECORD_TYPE_MASK 0x0F
+
+typedef struct inputRecorderConfig {
+    // Writes every input event and frame delta here. 0 to not record.
+    const char* recordPath;
+    // Plays back a recording from here instead of taking live input. 0 to
+    // not replay. Wins over recordPath if both are set.
+    const char* replayPath;
+    // Replaces the recorded deltas while replaying. 0 uses the recorded ones.
+    f64 replayDelta;
+} inputRecorderConfig;
+
+/**
+ * @brief Sets up the input recorder. Records or replays the input events and
+ * frame deltas of a session so it can be run again exactly.
+ * @param memoryRequirement Gets set to the memory the recorder needs
+ * @param state The memory for the recorder. Pass 0 to just get the memoryRequirement
+ * @param config The recorder's config
+ * @returns true if successful, false if the file couldn't be opened
+ */
+b8 inputRecorderInit(u64* memoryRequirement, void* state, inputRecorderConfig config);
+
+/**
+ * @brief Writes out anything left to record and closes the file.
+ * @param state The recorder's state
+ */
+void inputRecorderShutdown(void* state);
+
+/**
+ * @brief Whether a recording is being played back. Live input is dropped
+ * while it is.
+ * @returns true if replaying
+ */
+FSNAPI b8 inputRecorderIsReplaying();
+
+/**
+ * @brief Whether the session is being recorded.
+ * @returns true if recording
+ */
+FSNAPI b8 inputRecorderIsRecording();
+
+/**
+ * @brief Feeds the next recorded frame's input through the input system.
+ * Call once a frame after the platform's messages have been pumped.
+ * @param outDelta Gets set to the delta to simulate the frame with
+ * @returns true if a frame was fed, false if the recording has run out
+ */
+b8 inputRecorderReplayFrame(f64* outDelta);
+
+/**
+ * @brief Ends the recorded frame. Everything recorded since the last call
+ * gets played back before the frame with this delta.
+ * @param delta The delta the frame was simulated with
+ */
+void inputRecorderEndFrame(f64 delta);
+
+/**
+ * @brief Records a key event. Called by the input system.
+ * @param key The key
+ * @param pressed Whether it was pressed
+ * @returns true if the event should be processed, false if it's live input
+ * that should be dropped for a replay
+ */
+b8 inputRecorderOnKey(keys key, b8 pressed);
+
+/**
+ * @brief Records a mouse button event. Called by the input system.
+ * @param button The button
+ * @param pressed Whether it was pressed
+ * @returns true if the event should be processed, false if it should be dropped
+ */
+b8 inputRecorderOnButton(buttons button, b8 pressed);
+
+/**
+ * @brief Records a mouse move. Called by the input system.
+ * @param x The mouse's x
+ * @param y The mouse's y
+ * @returns true if the event should be processed, false if it should be dropped
+ */
+b8 inputRecorderOnMouseMove(i16 x, i16 y);
+
+/**
+ * @brief Records a mouse wheel scroll. Called by the input system.
+ * @param zDelta The scroll amount
+ * @returns true if the event should be processed, false if it should be dropped
+ */
+b8 inputRecorderOnMouseWheel(i8 zDelta);
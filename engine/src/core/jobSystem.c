@@ -0,0 +1,160 @@
+#include "jobSystem.h"
+
+#include "core/fmemory.h"
+#include "core/fmutex.h"
+#include "core/fsemaphore.h"
+#include "core/fstring.h"
+#include "core/fthread.h"
+#include "core/logger.h"
+#include "core/profiler.h"
+#include "platform/platform.h"
+
+#define JOB_SYSTEM_DEFAULT_QUEUE_SIZE 256
+
+typedef struct jobInfo {
+    PFN_jobStart start;
+    void* params;
+} jobInfo;
+
+typedef struct jobSystemState {
+    b8 running;
+    u32 threadCnt;
+    fthread* threads;
+
+    // Ring of waiting jobs, guarded by queueMutex. jobsAvailable gets
+    // signaled once per queued job and once per worker at shutdown.
+    fmutex queueMutex;
+    fsemaphore jobsAvailable;
+    jobInfo* queue;
+    u32 queueSize;
+    u32 head;
+    u32 queuedCnt;
+} jobSystemState;
+
+static jobSystemState* systemPtr;
+
+static u32 getThreadCount(jobSystemConfig config) {
+    u32 threadCnt = config.threadCnt;
+    if (!threadCnt) {
+        i32 cores = platformGetProcessorCount();
+        threadCnt = cores > 1 ? (u32)(cores - 1) : 0;
+    }
+    return threadCnt < JOB_SYSTEM_MAX_THREADS ? threadCnt : JOB_SYSTEM_MAX_THREADS;
+}
+
+static b8 popJob(jobInfo* outJob) {
+    b8 got = false;
+    fmutexLock(&systemPtr->queueMutex);
+    if (systemPtr->queuedCnt > 0) {
+        *outJob = systemPtr->queue[systemPtr->head];
+        systemPtr->head = (systemPtr->head + 1) % systemPtr->queueSize;
+        systemPtr->queuedCnt--;
+        got = true;
+    }
+    fmutexUnlock(&systemPtr->queueMutex);
+    return got;
+}
+
+static u32 jobWorkerThread(void* params) {
+    char name[32];
+    strFmt(name, "job %u", (u32)(u64)params);
+    profilerSetThreadName(name);
+    for (;;) {
+        fsemaphoreWait(&systemPtr->jobsAvailable, FSEMAPHORE_WAIT_INFINITE);
+        jobInfo job;
+        // Queued jobs still get run after shutdown starts, workers only leave
+        // once the queue is empty.
+        if (popJob(&job)) {
+            job.start(job.params);
+        } else if (!__atomic_load_n(&systemPtr->running, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+    }
+    return 0;
+}
+
+b8 jobSystemInit(u64* memoryRequirement, void* state, jobSystemConfig config) {
+    u32 threadCnt = getThreadCount(config);
+    u32 queueSize = config.maxQueuedJobs ? config.maxQueuedJobs : JOB_SYSTEM_DEFAULT_QUEUE_SIZE;
+    *memoryRequirement = sizeof(jobSystemState) + sizeof(fthread) * threadCnt + sizeof(jobInfo) * queueSize;
+    if (state == 0) {
+        return true;
+    }
+    systemPtr = state;
+    fzeroMemory(systemPtr, *memoryRequirement);
+    systemPtr->threads = (fthread*)((u8*)state + sizeof(jobSystemState));
+    systemPtr->queue = (jobInfo*)((u8*)systemPtr->threads + sizeof(fthread) * threadCnt);
+    systemPtr->queueSize = queueSize;
+
+    if (!fmutexCreate(&systemPtr->queueMutex)) {
+        FERROR("Job system failed to create its queue mutex.");
+        systemPtr = 0;
+        return false;
+    }
+    if (!fsemaphoreCreate(&systemPtr->jobsAvailable, queueSize + threadCnt, 0)) {
+        FERROR("Job system failed to create its semaphore.");
+        fmutexDestroy(&systemPtr->queueMutex);
+        systemPtr = 0;
+        return false;
+    }
+
+    systemPtr->running = true;
+    for (u32 i = 0; i < threadCnt; ++i) {
+        if (!fthreadCreate(jobWorkerThread, (void*)(u64)i, false, &systemPtr->threads[i])) {
+            FWARN("Job system could only start %u of %u worker threads.", i, threadCnt);
+            break;
+        }
+        systemPtr->threadCnt++;
+    }
+    FINFO("Job system started with %u worker threads.", systemPtr->threadCnt);
+    return true;
+}
+
+void jobSystemShutdown(void* state) {
+    if (!systemPtr) {
+        return;
+    }
+    __atomic_store_n(&systemPtr->running, false, __ATOMIC_RELEASE);
+    for (u32 i = 0; i < systemPtr->threadCnt; ++i) {
+        fsemaphoreSignal(&systemPtr->jobsAvailable);
+    }
+    for (u32 i = 0; i < systemPtr->threadCnt; ++i) {
+        fthreadWait(&systemPtr->threads[i]);
+        fthreadDestroy(&systemPtr->threads[i]);
+    }
+    fsemaphoreDestroy(&systemPtr->jobsAvailable);
+    fmutexDestroy(&systemPtr->queueMutex);
+    systemPtr = 0;
+}
+
+void jobSubmit(PFN_jobStart start, void* params) {
+    if (!jobSystemIsRunning()) {
+        start(params);
+        return;
+    }
+    b8 queued = false;
+    fmutexLock(&systemPtr->queueMutex);
+    if (systemPtr->queuedCnt < systemPtr->queueSize) {
+        u32 tail = (systemPtr->head + systemPtr->queuedCnt) % systemPtr->queueSize;
+        systemPtr->queue[tail].start = start;
+        systemPtr->queue[tail].params = params;
+        systemPtr->queuedCnt++;
+        queued = true;
+    }
+    fmutexUnlock(&systemPtr->queueMutex);
+
+    if (queued) {
+        fsemaphoreSignal(&systemPtr->jobsAvailable);
+    } else {
+        FWARN("Job queue is full, running the job on the submitting thread.");
+        start(params);
+    }
+}
+
+b8 jobSystemIsRunning() {
+    return systemPtr && systemPtr->threadCnt > 0 && __atomic_load_n(&systemPtr->running, __ATOMIC_ACQUIRE);
+}
+
+u32 jobSystemGetThreadCount() {
+    return systemPtr ? systemPtr->threadCnt : 0;
+}
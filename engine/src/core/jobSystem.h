@@ -0,0 +1,59 @@
+#pragma once
+
+#include "defines.h"
+
+// The most worker threads the job system starts. The counters and profiler
+// only keep data for a fixed number of threads, so this leaves them room for
+// the engine's other threads.
+#define JOB_SYSTEM_MAX_THREADS 16
+
+/**
+ * @brief A job's entry point.
+ * @param params The params passed to jobSubmit
+ */
+typedef void (*PFN_jobStart)(void* params);
+
+typedef struct jobSystemConfig {
+    // How many worker threads to start. 0 uses one less than the core count
+    // so the main thread keeps a core to itself. Either way it's capped at
+    // JOB_SYSTEM_MAX_THREADS.
+    u32 threadCnt;
+    // How many jobs can be waiting at once. 0 uses 256. Jobs submitted past
+    // this run right away on the submitting thread.
+    u32 maxQueuedJobs;
+} jobSystemConfig;
+
+/**
+ * @brief Starts the job system's worker threads.
+ * @param memoryRequirement Gets set to the memory the job system needs
+ * @param state The memory for the job system. Pass 0 to just get the memoryRequirement
+ * @param config The job system's config
+ * @returns true if successful, false if failed
+ */
+b8 jobSystemInit(u64* memoryRequirement, void* state, jobSystemConfig config);
+
+/**
+ * @brief Runs any jobs still queued then stops and joins the worker threads.
+ * @param state The job system's state
+ */
+void jobSystemShutdown(void* state);
+
+/**
+ * @brief Queues a job to run on a worker thread. Runs it right away on the
+ * calling thread if there are no workers or the queue is full.
+ * @param start The job's entry point
+ * @param params Passed straight through to start. Must outlive the job
+ */
+FSNAPI void jobSubmit(PFN_jobStart start, void* params);
+
+/**
+ * @brief Whether the job system is up and has worker threads to run jobs on.
+ * @returns true if jobs run on other threads
+ */
+FSNAPI b8 jobSystemIsRunning();
+
+/**
+ * @brief Gets how many worker threads the job system started.
+ * @returns The worker count
+ */
+FSNAPI u32 jobSystemGetThreadCount();
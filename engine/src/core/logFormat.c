@@ -0,0 +1,265 @@
+#include "logFormat.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// Walks to the end of the conversion spec starting after the '%'. Returns the
+// conversion character's pointer and how many 'l's were in the length modifier.
+static const char* parseSpec(const char* c, u8* outLongCnt, b8* outUnsupported){
+    *outLongCnt = 0;
+    *outUnsupported = false;
+    // Flags, width and precision
+    while (*c && strchr("-+ #0123456789.*", *c)){
+        if (*c == '*'){
+            *outUnsupported = true;
+        }
+        c++;
+    }
+    // Length modifiers
+    while (*c && strchr("hlLqjzt", *c)){
+        if (*c == 'l'){
+            (*outLongCnt)++;
+        }else if (*c != 'h'){
+            *outUnsupported = true;
+        }
+        c++;
+    }
+    return c;
+}
+
+b8 logFormatParse(const char* format, u8* outKinds, u8* outArgCnt){
+    u8 cnt = 0;
+    for (const char* c = format; *c; ++c){
+        if (*c != '%'){
+            continue;
+        }
+        c++;
+        if (*c == '%'){
+            continue;
+        }
+        u8 longCnt;
+        b8 unsupported;
+        c = parseSpec(c, &longCnt, &unsupported);
+        if (unsupported || *c == 0 || cnt == LOG_FORMAT_MAX_ARGS){
+            return false;
+        }
+        switch (*c){
+            case 'd': case 'i':
+                outKinds[cnt++] = longCnt > 1 ? LOG_ARG_I64 : (longCnt ? LOG_ARG_LONG : LOG_ARG_I32);
+                break;
+            case 'u': case 'x': case 'X': case 'o':
+                outKinds[cnt++] = longCnt > 1 ? LOG_ARG_I64 : (longCnt ? LOG_ARG_ULONG : LOG_ARG_I32);
+                break;
+            case 'c':
+                outKinds[cnt++] = LOG_ARG_I32;
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                outKinds[cnt++] = LOG_ARG_F64;
+                break;
+            case 's':
+                outKinds[cnt++] = LOG_ARG_STR;
+                break;
+            case 'p':
+                outKinds[cnt++] = LOG_ARG_PTR;
+                break;
+            default:
+                return false;
+        }
+    }
+    *outArgCnt = cnt;
+    return true;
+}
+
+u32 logFormatEncodeArgs(const u8* kinds, u8 argCnt, u8* out, u32 outSize, void* args){
+    va_list* va = args;
+    u32 size = 0;
+    for (u8 i = 0; i < argCnt; ++i){
+        switch (kinds[i]){
+            case LOG_ARG_I32: {
+                i32 v = va_arg(*va, i32);
+                if (size + 4 > outSize) return size;
+                memcpy(out + size, &v, 4);
+                size += 4;
+            } break;
+            case LOG_ARG_I64:
+            case LOG_ARG_LONG:
+            case LOG_ARG_ULONG: {
+                i64 v;
+                if (kinds[i] == LOG_ARG_LONG){
+                    v = (i64)va_arg(*va, long);
+                }else if (kinds[i] == LOG_ARG_ULONG){
+                    v = (i64)va_arg(*va, unsigned long);
+                }else{
+                    v = va_arg(*va, i64);
+                }
+                if (size + 8 > outSize) return size;
+                memcpy(out + size, &v, 8);
+                size += 8;
+            } break;
+            case LOG_ARG_F64: {
+                f64 v = va_arg(*va, f64);
+                if (size + 8 > outSize) return size;
+                memcpy(out + size, &v, 8);
+                size += 8;
+            } break;
+            case LOG_ARG_PTR: {
+                u64 v = (u64)va_arg(*va, void*);
+                if (size + 8 > outSize) return size;
+                memcpy(out + size, &v, 8);
+                size += 8;
+            } break;
+            case LOG_ARG_STR: {
+                const char* s = va_arg(*va, const char*);
+                if (!s){
+                    s = "(null)";
+                }
+                if (size + 2 > outSize) return size;
+                u64 len = strlen(s);
+                if (len > outSize - size - 2){
+                    len = outSize - size - 2;
+                }
+                u16 l = (u16)len;
+                memcpy(out + size, &l, 2);
+                memcpy(out + size + 2, s, l);
+                size += 2 + l;
+            } break;
+        }
+    }
+    return size;
+}
+
+u64 logFormatDecode(const char* format, const u8* kinds, u8 argCnt,
+                    const u8* payload, u32 payloadSize, char* out, u64 outSize){
+    if (outSize == 0){
+        return 0;
+    }
+    u64 len = 0;
+    u32 read = 0;
+    u8 arg = 0;
+    // Leave room for the null terminator.
+    u64 cap = outSize - 1;
+    for (const char* c = format; *c && len < cap; ++c){
+        if (*c != '%'){
+            out[len++] = *c;
+            continue;
+        }
+        if (c[1] == '%'){
+            out[len++] = '%';
+            c++;
+            continue;
+        }
+
+        const char* start = c;
+        u8 longCnt;
+        b8 unsupported;
+        c = parseSpec(c + 1, &longCnt, &unsupported);
+        if (*c == 0){
+            break;
+        }
+
+        // Rebuild the spec without its length modifier so it can be given
+        // the widened value.
+        char spec[32];
+        u64 specLen = 0;
+        for (const char* s = start; s < c && specLen < sizeof(spec) - 4; ++s){
+            if (!strchr("hlLqjzt", *s)){
+                spec[specLen++] = *s;
+            }
+        }
+
+        i32 written = 0;
+        u64 remaining = outSize - len;
+        u8 kind = arg < argCnt ? kinds[arg] : 0xFF;
+        arg++;
+        switch (kind){
+            case LOG_ARG_I32: {
+                i32 v = 0;
+                if (read + 4 > payloadSize) goto truncated;
+                memcpy(&v, payload + read, 4);
+                read += 4;
+                // Keep h/hh so the value gets narrowed the same way.
+                u64 fullLen = c - start;
+                if (fullLen < sizeof(spec) - 2){
+                    memcpy(spec, start, fullLen);
+                    specLen = fullLen;
+                }
+                spec[specLen] = *c;
+                spec[specLen + 1] = 0;
+                written = snprintf(out + len, remaining, spec, v);
+            } break;
+            case LOG_ARG_I64:
+            case LOG_ARG_LONG:
+            case LOG_ARG_ULONG: {
+                i64 v = 0;
+                if (read + 8 > payloadSize) goto truncated;
+                memcpy(&v, payload + read, 8);
+                read += 8;
+                spec[specLen] = 'l';
+                spec[specLen + 1] = 'l';
+                spec[specLen + 2] = *c;
+                spec[specLen + 3] = 0;
+                written = snprintf(out + len, remaining, spec, (long long)v);
+            } break;
+            case LOG_ARG_F64: {
+                f64 v = 0;
+                if (read + 8 > payloadSize) goto truncated;
+                memcpy(&v, payload + read, 8);
+                read += 8;
+                spec[specLen] = *c;
+                spec[specLen + 1] = 0;
+                written = snprintf(out + len, remaining, spec, v);
+            } break;
+            case LOG_ARG_PTR: {
+                u64 v = 0;
+                if (read + 8 > payloadSize) goto truncated;
+                memcpy(&v, payload + read, 8);
+                read += 8;
+                spec[specLen] = *c;
+                spec[specLen + 1] = 0;
+                written = snprintf(out + len, remaining, spec, (void*)v);
+            } break;
+            case LOG_ARG_STR: {
+                u16 l = 0;
+                if (read + 2 > payloadSize) goto truncated;
+                memcpy(&l, payload + read, 2);
+                read += 2;
+                if (read + l > payloadSize) goto truncated;
+                // Precision limits the string since it isn't null terminated.
+                spec[specLen] = 0;
+                char prec[16];
+                const char* dot = strchr(spec, '.');
+                i32 p = l;
+                if (dot){
+                    i32 userPrec = 0;
+                    sscanf(dot + 1, "%d", &userPrec);
+                    if (userPrec < p){
+                        p = userPrec;
+                    }
+                    spec[dot - spec] = 0;
+                }
+                snprintf(prec, sizeof(prec), ".%d", p);
+                char full[48];
+                snprintf(full, sizeof(full), "%s%ss", spec, prec);
+                written = snprintf(out + len, remaining, full, (const char*)(payload + read));
+                read += l;
+            } break;
+            default:
+                goto truncated;
+        }
+        if (written > 0){
+            len += (u64)written < remaining ? (u64)written : remaining - 1;
+        }
+    }
+    out[len] = 0;
+    return len;
+
+truncated:
+    // Payload doesn't match the format. Show what we have.
+    if (len + 3 < outSize){
+        memcpy(out + len, "<?>", 3);
+        len += 3;
+    }
+    out[len] = 0;
+    return len;
+}
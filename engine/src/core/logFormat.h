@@ -0,0 +1,82 @@
+#pragma once
+
+#include "defines.h"
+
+/*
+ * Binary log (.flog) layout. Everything is little endian and unpadded.
+ *
+ * File header:
+ *   u32 magic (FLOG_MAGIC), u16 version (FLOG_VERSION), u16 reserved
+ *
+ * Then a stream of entries, each starting with a u8 FLOG_ENTRY_* type:
+ *   FLOG_ENTRY_FORMAT: u32 formatID, u8 argCnt, u8 kinds[argCnt], u16 formatLen, char format[formatLen]
+ *   FLOG_ENTRY_RECORD: u32 formatID, u8 level, u64 timestampNs, u16 payloadSize, u8 payload[payloadSize]
+ *   FLOG_ENTRY_TEXT:   u8 level, u64 timestampNs, u16 textLen, char text[textLen]
+ *
+ * A format entry is always written before the first record that uses it.
+ * Text entries are messages that couldn't be logged in binary, like messages
+ * with a format string that isn't a literal.
+ */
+
+#define FLOG_MAGIC 0x474F4C46 // "FLOG"
+#define FLOG_VERSION 1
+
+#define FLOG_ENTRY_FORMAT 1
+#define FLOG_ENTRY_RECORD 2
+#define FLOG_ENTRY_TEXT 3
+
+#define LOG_FORMAT_MAX_ARGS 16
+
+// How a single printf argument is stored in a record's payload.
+typedef enum logArgKind {
+    // 4 bytes. Anything that gets promoted to int. d, i, u, x, X, o, c
+    LOG_ARG_I32 = 0,
+    // 8 bytes. ll integers.
+    LOG_ARG_I64 = 1,
+    // 8 bytes. f, F, e, E, g, G, a, A
+    LOG_ARG_F64 = 2,
+    // u16 length then the characters, no null terminator.
+    LOG_ARG_STR = 3,
+    // 8 bytes. p
+    LOG_ARG_PTR = 4,
+    // 8 bytes. l integers, widened to 64 bits since long is 4 bytes on windows.
+    LOG_ARG_LONG = 5,
+    // 8 bytes. l unsigned integers, zero extended.
+    LOG_ARG_ULONG = 6
+} logArgKind;
+
+/**
+ * @brief Parses a printf style format string into the kinds of it's arguments.
+ * @param format The format string
+ * @param outKinds Array of at least LOG_FORMAT_MAX_ARGS kinds
+ * @param outArgCnt The number of arguments the format takes
+ * @returns false if the format uses something that can't be stored in binary
+ * (* width/precision, %n, long double or more than LOG_FORMAT_MAX_ARGS args)
+ */
+FSNAPI b8 logFormatParse(const char* format, u8* outKinds, u8* outArgCnt);
+
+/**
+ * @brief Copies the raw arguments into a record payload. Strings that don't
+ * fit get truncated.
+ * @param kinds The kinds from logFormatParse
+ * @param argCnt The number of kinds
+ * @param out The payload buffer
+ * @param outSize The size of the payload buffer
+ * @param args Pointer to the va_list holding the arguments
+ * @returns The number of bytes written to out
+ */
+FSNAPI u32 logFormatEncodeArgs(const u8* kinds, u8 argCnt, u8* out, u32 outSize, void* args);
+
+/**
+ * @brief Formats a record payload back into text.
+ * @param format The format string the record was logged with
+ * @param kinds The kinds from logFormatParse
+ * @param argCnt The number of kinds
+ * @param payload The record payload
+ * @param payloadSize The size of the payload
+ * @param out The text buffer. Always null terminated
+ * @param outSize The size of the text buffer
+ * @returns The length of the text written, not including the null terminator
+ */
+FSNAPI u64 logFormatDecode(const char* format, const u8* kinds, u8 argCnt,
+                           const u8* payload, u32 payloadSize, char* out, u64 outSize);
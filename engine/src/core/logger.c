@@ -1,5 +1,9 @@
 #include "logger.h"
 #include "asserts.h"
+#include "core/fmutex.h"
+#include "core/fsemaphore.h"
+#include "core/fthread.h"
+#include "core/logFormat.h"
 #include "platform/platform.h"
 #include "platform/filesystem.h"
 
@@ -8,96 +12,550 @@
 #include <string.h>
 #include <stdarg.h>
 
+// Must be a power of 2.
+#define LOGGER_RING_CAPACITY 1024
+#define LOGGER_RECORD_SIZE 1024
+// How often the flush thread wakes up on its own.
+#define LOGGER_FLUSH_INTERVAL_MS 16
+#define LOGGER_CONSOLE_BATCH_SIZE KIBIBYTES(16)
+#define LOGGER_FILE_BATCH_SIZE KIBIBYTES(64)
+#define LOGGER_MAX_FORMATS 4096
+// Format ID for call sites whose format can't be logged in binary.
+#define LOGGER_FORMAT_ID_TEXT INVALID_ID
+
+typedef enum logRecordType {
+    LOG_RECORD_TEXT = 0,
+    LOG_RECORD_BINARY = 1
+} logRecordType;
+
+/**
+ * @brief A single slot in the ring. Producers format straight into text, the
+ * level prefix and newline are added when the record is flushed. Binary
+ * records hold the encoded args in text instead.
+ * Messages longer than LOGGER_RECORD_TEXT_SIZE get truncated.
+ */
+typedef struct logRecord {
+    // Vyukov style sequence. Equals the slot's position when it's free to
+    // write and position + 1 once it holds a record.
+    u64 sequence;
+    // Only set in binary mode.
+    u64 timestamp;
+    u32 formatID;
+    u8 type;
+    u8 level;
+    b8 toConsole;
+    b8 toFile;
+    u16 length;
+    char text[LOGGER_RECORD_SIZE - 32];
+} logRecord;
+
+typedef struct logFormatEntry {
+    const char* format;
+    u8 argCnt;
+    u8 kinds[LOG_FORMAT_MAX_ARGS];
+} logFormatEntry;
+
+#define LOGGER_RECORD_TEXT_SIZE (sizeof(((logRecord*)0)->text))
+STATIC_ASSERT(sizeof(logRecord) == LOGGER_RECORD_SIZE, "logRecord should be exactly LOGGER_RECORD_SIZE bytes.");
+
 typedef struct loggerState{
-    char* logQueue;
-    u64 fileLogQueueCnt;
     fileHandle fileHandle;
+    logRecord* ring;
+    // Next position a producer will claim. Shared by every producer.
+    u64 enqueuePos;
+    // Next position to flush. Only written while holding drainMutex.
+    u64 dequeuePos;
+
+    u64 droppedCnt;
+    u64 reportedDroppedCnt;
+    logOverflowPolicy overflowPolicy;
+
+    b8 running;
+    // False if the flush thread couldn't be started. Messages get written out
+    // on the thread that logged them instead.
+    b8 hasFlushThread;
+    b8 wakePending;
+    fthread thread;
+    fsemaphore wakeSemaphore;
+    fmutex drainMutex;
+
+    u64 consoleBatchLen;
+    u8 consoleBatchLevel;
+    u64 fileBatchLen;
+    char consoleBatch[LOGGER_CONSOLE_BATCH_SIZE];
+    char fileBatch[LOGGER_FILE_BATCH_SIZE];
+
+    // Binary mode format registry. Entries never change once their ID is handed out.
+    fmutex registryMutex;
+    u32 formatCnt;
+    logFormatEntry formats[LOGGER_MAX_FORMATS];
+    // Which formats have been written to the file. Only touched while draining.
+    u8 formatWritten[LOGGER_MAX_FORMATS / 8];
+    char decodeBuffer[LOGGER_RECORD_SIZE * 2];
 } loggerState;
 
 static loggerState* systemPtr;
 
-void sendTextToFile(const char* m){
-    u64 l = strlen(m);
+static const char* levelStr[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]:  ", "[INFO]:  ", "[DEBUG]: ", "[TRACE]: "};
+static const u8 levelStrLen = 9;
+
+void sendTextToFile(const char* m, u64 l){
     u64 written = 0;
     if (!fsWrite(&systemPtr->fileHandle, l, m, &written)){
-        FERROR("Failed to write to log file");
+        // Can't go through the logger here, we might be holding the drain lock.
+        platformConsoleWriteError("[ERROR]: Failed to write to log file\n", LOG_LEVEL_ERROR);
+    }
+}
+
+static void writeConsole(const char* m, u8 level){
+    if (level < LOG_LEVEL_WARN){
+        platformConsoleWriteError(m, level);
+    }else{
+        platformConsoleWrite(m, level);
+    }
+}
+
+static void flushConsoleBatch(){
+    if (systemPtr->consoleBatchLen == 0){
+        return;
+    }
+    systemPtr->consoleBatch[systemPtr->consoleBatchLen] = 0;
+    writeConsole(systemPtr->consoleBatch, systemPtr->consoleBatchLevel);
+    systemPtr->consoleBatchLen = 0;
+}
+
+static void flushFileBatch(){
+    if (systemPtr->fileBatchLen == 0){
+        return;
+    }
+    if (systemPtr->fileHandle.handle){
+        sendTextToFile(systemPtr->fileBatch, systemPtr->fileBatchLen);
+    }
+    systemPtr->fileBatchLen = 0;
+}
+
+// Appends a finished line to the console batch. Output gets coalesced per run
+// of the same level since each level has it's own colour.
+static void batchConsole(u8 level, const char* text, u64 len){
+    u64 lineLen = levelStrLen + len + 1;
+    if (lineLen >= LOGGER_CONSOLE_BATCH_SIZE){
+        len = LOGGER_CONSOLE_BATCH_SIZE - levelStrLen - 2;
+        lineLen = levelStrLen + len + 1;
+    }
+    if (systemPtr->consoleBatchLevel != level ||
+        systemPtr->consoleBatchLen + lineLen >= LOGGER_CONSOLE_BATCH_SIZE){
+        flushConsoleBatch();
+        systemPtr->consoleBatchLevel = level;
+    }
+    char* dst = systemPtr->consoleBatch + systemPtr->consoleBatchLen;
+    memcpy(dst, levelStr[level], levelStrLen);
+    memcpy(dst + levelStrLen, text, len);
+    dst[lineLen - 1] = '\n';
+    systemPtr->consoleBatchLen += lineLen;
+}
+
+// Reserves size bytes at the end of the file batch.
+static char* reserveFileBatch(u64 size){
+    if (systemPtr->fileBatchLen + size > LOGGER_FILE_BATCH_SIZE){
+        flushFileBatch();
+    }
+    char* dst = systemPtr->fileBatch + systemPtr->fileBatchLen;
+    systemPtr->fileBatchLen += size;
+    return dst;
+}
+
+#if FSN_LOG_BINARY == 1
+static char* writeBytes(char* dst, const void* src, u64 size){
+    memcpy(dst, src, size);
+    return dst + size;
+}
+
+static void batchFileText(u8 level, u64 timestamp, const char* text, u64 len){
+    u16 l = (u16)len;
+    u8 type = FLOG_ENTRY_TEXT;
+    char* dst = reserveFileBatch(1 + 1 + 8 + 2 + l);
+    dst = writeBytes(dst, &type, 1);
+    dst = writeBytes(dst, &level, 1);
+    dst = writeBytes(dst, &timestamp, 8);
+    dst = writeBytes(dst, &l, 2);
+    writeBytes(dst, text, l);
+}
+
+static void batchFileFormat(u32 id){
+    u32 idx = id - 1;
+    if (systemPtr->formatWritten[idx / 8] & (1 << (idx % 8))){
+        return;
+    }
+    systemPtr->formatWritten[idx / 8] |= 1 << (idx % 8);
+
+    logFormatEntry* e = &systemPtr->formats[idx];
+    u64 fmtLen = strlen(e->format);
+    u16 l = fmtLen > LOGGER_RECORD_SIZE ? LOGGER_RECORD_SIZE : (u16)fmtLen;
+    u8 type = FLOG_ENTRY_FORMAT;
+    char* dst = reserveFileBatch(1 + 4 + 1 + e->argCnt + 2 + l);
+    dst = writeBytes(dst, &type, 1);
+    dst = writeBytes(dst, &id, 4);
+    dst = writeBytes(dst, &e->argCnt, 1);
+    dst = writeBytes(dst, e->kinds, e->argCnt);
+    dst = writeBytes(dst, &l, 2);
+    writeBytes(dst, e->format, l);
+}
+
+static void batchFileRecord(logRecord* r){
+    batchFileFormat(r->formatID);
+    u8 type = FLOG_ENTRY_RECORD;
+    char* dst = reserveFileBatch(1 + 4 + 1 + 8 + 2 + r->length);
+    dst = writeBytes(dst, &type, 1);
+    dst = writeBytes(dst, &r->formatID, 4);
+    dst = writeBytes(dst, &r->level, 1);
+    dst = writeBytes(dst, &r->timestamp, 8);
+    dst = writeBytes(dst, &r->length, 2);
+    writeBytes(dst, r->text, r->length);
+}
+#else
+static void batchFileText(u8 level, u64 timestamp, const char* text, u64 len){
+    char* dst = reserveFileBatch(levelStrLen + len + 1);
+    memcpy(dst, levelStr[level], levelStrLen);
+    memcpy(dst + levelStrLen, text, len);
+    dst[levelStrLen + len] = '\n';
+}
+#endif
+
+static void batchRecord(logRecord* r){
+#if FSN_LOG_BINARY == 1
+    if (r->type == LOG_RECORD_BINARY){
+        if (r->toConsole){
+            logFormatEntry* e = &systemPtr->formats[r->formatID - 1];
+            u64 len = logFormatDecode(e->format, e->kinds, e->argCnt, (u8*)r->text, r->length,
+                                      systemPtr->decodeBuffer, sizeof(systemPtr->decodeBuffer));
+            batchConsole(r->level, systemPtr->decodeBuffer, len);
+        }
+        if (r->toFile){
+            batchFileRecord(r);
+        }
+        return;
+    }
+#endif
+    if (r->toConsole){
+        batchConsole(r->level, r->text, r->length);
+    }
+    if (r->toFile){
+        batchFileText(r->level, r->timestamp, r->text, r->length);
+    }
+}
+
+// Writes out everything currently in the ring. drainMutex must be held.
+static void drainRing(){
+    u64 pos = systemPtr->dequeuePos;
+    for (;;){
+        logRecord* r = &systemPtr->ring[pos & (LOGGER_RING_CAPACITY - 1)];
+        u64 seq = __atomic_load_n(&r->sequence, __ATOMIC_ACQUIRE);
+        if (seq != pos + 1){
+            // Empty, or the producer hasn't finished writing this slot yet.
+            break;
+        }
+        batchRecord(r);
+        __atomic_store_n(&r->sequence, pos + LOGGER_RING_CAPACITY, __ATOMIC_RELEASE);
+        pos++;
+    }
+    __atomic_store_n(&systemPtr->dequeuePos, pos, __ATOMIC_RELAXED);
+
+    u64 dropped = __atomic_load_n(&systemPtr->droppedCnt, __ATOMIC_RELAXED);
+    if (dropped != systemPtr->reportedDroppedCnt){
+        char msg[96];
+        i32 len = snprintf(msg, sizeof(msg), "Logger dropped %llu messages, the ring buffer was full.",
+                           dropped - systemPtr->reportedDroppedCnt);
+        batchConsole(LOG_LEVEL_WARN, msg, len);
+        if (systemPtr->fileHandle.handle){
+            batchFileText(LOG_LEVEL_WARN, platformGetTimestampNs(), msg, len);
+        }
+        systemPtr->reportedDroppedCnt = dropped;
+    }
+
+    flushConsoleBatch();
+    flushFileBatch();
+}
+
+static u32 loggerThreadProc(void* params){
+    while (__atomic_load_n(&systemPtr->running, __ATOMIC_ACQUIRE)){
+        fsemaphoreWait(&systemPtr->wakeSemaphore, LOGGER_FLUSH_INTERVAL_MS);
+        __atomic_store_n(&systemPtr->wakePending, false, __ATOMIC_RELEASE);
+        fmutexLock(&systemPtr->drainMutex);
+        drainRing();
+        fmutexUnlock(&systemPtr->drainMutex);
+    }
+    return 0;
+}
+
+static void wakeFlushThread(){
+    if (!systemPtr->hasFlushThread){
+        loggerFlush();
+        return;
+    }
+    if (!__atomic_exchange_n(&systemPtr->wakePending, true, __ATOMIC_ACQ_REL)){
+        fsemaphoreSignal(&systemPtr->wakeSemaphore);
     }
 }
 
 b8 loggerInit(u64* memoryRequirement, void* state) {
-    *memoryRequirement = sizeof(loggerState);
+    // Pad so the ring can be cache line aligned.
+    *memoryRequirement = sizeof(loggerState) + 64 + sizeof(logRecord) * LOGGER_RING_CAPACITY;
     if (state == 0){
         return true;
     }
-    systemPtr = state;
+    loggerState* s = state;
+    platformZeroMemory(s, sizeof(loggerState));
+    s->ring = (logRecord*)(((u64)(s + 1) + 63) & ~(u64)63);
+    for (u64 i = 0; i < LOGGER_RING_CAPACITY; ++i){
+        s->ring[i].sequence = i;
+    }
+    s->overflowPolicy = LOG_OVERFLOW_DROP;
+    s->consoleBatchLevel = LOG_LEVEL_INFO;
 
-    if (!fsOpen("appLogger.log", FILE_MODE_WRITE, false, &systemPtr->fileHandle)){
+#if FSN_LOG_BINARY == 1
+    if (!fsOpen("appLogger.flog", FILE_MODE_WRITE, true, &s->fileHandle)){
+        FERROR("Couldn't open appLogger.flog to write logs.");
+        return false;
+    }
+    u32 magic = FLOG_MAGIC;
+    u16 version = FLOG_VERSION;
+    u16 reserved = 0;
+    u64 written = 0;
+    fsWrite(&s->fileHandle, 4, &magic, &written);
+    fsWrite(&s->fileHandle, 2, &version, &written);
+    fsWrite(&s->fileHandle, 2, &reserved, &written);
+#else
+    if (!fsOpen("appLogger.log", FILE_MODE_WRITE, false, &s->fileHandle)){
         FERROR("Couldn't open appLogger.log to write logs.");
         return false;
     }
+#endif
+
+    if (!fmutexCreate(&s->drainMutex) || !fmutexCreate(&s->registryMutex) ||
+        !fsemaphoreCreate(&s->wakeSemaphore, LOGGER_RING_CAPACITY, 0)){
+        FERROR("Logger failed to create its sync objects.");
+        fsClose(&s->fileHandle);
+        return false;
+    }
+
+    s->running = true;
+    s->hasFlushThread = true;
+    systemPtr = s;
+    if (!fthreadCreate(loggerThreadProc, 0, false, &s->thread)){
+        // Stay usable, just flush on every message instead.
+        s->running = false;
+        s->hasFlushThread = false;
+        FERROR("Logger failed to start its flush thread. Writing logs synchronously.");
+    }
     return true;
 }
 
 void loggerShutdown() {
+    if (!systemPtr){
+        return;
+    }
+    if (systemPtr->hasFlushThread){
+        __atomic_store_n(&systemPtr->running, false, __ATOMIC_RELEASE);
+        fsemaphoreSignal(&systemPtr->wakeSemaphore);
+        fthreadWait(&systemPtr->thread);
+        fthreadDestroy(&systemPtr->thread);
+    }
+
+    loggerFlush();
+
+    fsClose(&systemPtr->fileHandle);
+    fsemaphoreDestroy(&systemPtr->wakeSemaphore);
+    fmutexDestroy(&systemPtr->drainMutex);
+    fmutexDestroy(&systemPtr->registryMutex);
     systemPtr = 0;
-    // TODO: cleanup logging/write queued entries.
 }
 
-void logToFile(logLevel level, b8 logToConsole, const char* message, ...){
-    const char* levelStr[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]:  ", "[INFO]:  ", "[DEBUG]: ", "[TRACE]: "};
-    b8 isError = level < 2;
-
-    // Technically imposes a 32k character limit on a single log entry, but...
-    // DON'T DO THAT!
-    char outMessage[32000];
-    memset(outMessage, 0, sizeof(outMessage));
-
-    // Format original message.
-    __builtin_va_list arg_ptr;
-    va_start(arg_ptr, message);
-    vsnprintf(outMessage, 32000, message, arg_ptr);
-    va_end(arg_ptr);
-
-    char finalMessage[32000];
-    sprintf(finalMessage, "%s%s\n", levelStr[level], outMessage);
-
-    if (logToConsole){
-        if(isError){
-            platformConsoleWriteError(finalMessage,level);
+void loggerFlush(){
+    if (!systemPtr){
+        return;
+    }
+    fmutexLock(&systemPtr->drainMutex);
+    drainRing();
+    fmutexUnlock(&systemPtr->drainMutex);
+}
+
+void loggerSetOverflowPolicy(logOverflowPolicy policy){
+    if (systemPtr){
+        systemPtr->overflowPolicy = policy;
+    }
+}
+
+u64 loggerGetDroppedCount(){
+    return systemPtr ? __atomic_load_n(&systemPtr->droppedCnt, __ATOMIC_RELAXED) : 0;
+}
+
+// Claims a slot in the ring. Returns 0 if the ring is full.
+static logRecord* tryClaimRecord(u64* outPos){
+    u64 pos = __atomic_load_n(&systemPtr->enqueuePos, __ATOMIC_RELAXED);
+    for (;;){
+        logRecord* r = &systemPtr->ring[pos & (LOGGER_RING_CAPACITY - 1)];
+        u64 seq = __atomic_load_n(&r->sequence, __ATOMIC_ACQUIRE);
+        i64 diff = (i64)seq - (i64)pos;
+        if (diff == 0){
+            if (__atomic_compare_exchange_n(&systemPtr->enqueuePos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+                *outPos = pos;
+                return r;
+            }
+            // pos got updated by the failed exchange, try again.
+        }else if (diff < 0){
+            return 0;
         }else{
-            platformConsoleWrite(finalMessage,level);
+            pos = __atomic_load_n(&systemPtr->enqueuePos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Writes a message straight out. Used before init and after shutdown.
+static void logSync(logLevel level, b8 toConsole, const char* message, __builtin_va_list args){
+    char outMessage[LOGGER_RECORD_SIZE * 4];
+    memcpy(outMessage, levelStr[level], levelStrLen);
+    i32 len = vsnprintf(outMessage + levelStrLen, sizeof(outMessage) - levelStrLen - 1, message, args);
+    if (len < 0){
+        len = 0;
+    }else if (len > (i32)(sizeof(outMessage) - levelStrLen - 2)){
+        len = sizeof(outMessage) - levelStrLen - 2;
+    }
+    outMessage[levelStrLen + len] = '\n';
+    outMessage[levelStrLen + len + 1] = 0;
+    if (toConsole){
+        writeConsole(outMessage, level);
+    }
+}
+
+// Claims a slot, waiting or dropping based on the overflow policy. Returns 0
+// if the message got dropped.
+static logRecord* claimRecord(logLevel level, u64* outPos){
+    logRecord* r = tryClaimRecord(outPos);
+    if (!r){
+        if (systemPtr->overflowPolicy == LOG_OVERFLOW_DROP && level != LOG_LEVEL_FATAL){
+            __atomic_fetch_add(&systemPtr->droppedCnt, 1, __ATOMIC_RELAXED);
+            wakeFlushThread();
+            return 0;
+        }
+        while (!(r = tryClaimRecord(outPos))){
+            wakeFlushThread();
+            fthreadYield();
         }
     }
+    return r;
+}
+
+static void publishRecord(logRecord* r, u64 pos, logLevel level){
+    __atomic_store_n(&r->sequence, pos + 1, __ATOMIC_RELEASE);
+
+    // Don't wait for the timer if the ring is filling up.
+    if (pos - __atomic_load_n(&systemPtr->dequeuePos, __ATOMIC_RELAXED) >= LOGGER_RING_CAPACITY / 2){
+        wakeFlushThread();
+    }
+
+    if (level == LOG_LEVEL_FATAL || !systemPtr->hasFlushThread){
+        loggerFlush();
+    }
+}
+
+static void logQueue(logLevel level, b8 toConsole, b8 toFile, const char* message, __builtin_va_list args){
+    if (!systemPtr){
+        logSync(level, toConsole, message, args);
+        return;
+    }
+
+    u64 pos = 0;
+    logRecord* r = claimRecord(level, &pos);
+    if (!r){
+        return;
+    }
+
+    i32 len = vsnprintf(r->text, LOGGER_RECORD_TEXT_SIZE, message, args);
+    if (len < 0){
+        len = 0;
+    }else if (len >= (i32)LOGGER_RECORD_TEXT_SIZE){
+        len = LOGGER_RECORD_TEXT_SIZE - 1;
+    }
+    r->type = LOG_RECORD_TEXT;
+    r->length = (u16)len;
+    r->level = level;
+    r->toConsole = toConsole;
+    r->toFile = toFile;
+#if FSN_LOG_BINARY == 1
+    r->timestamp = platformGetTimestampNs();
+#endif
+    publishRecord(r, pos, level);
+}
+
+static u32 registerFormat(const char* format){
+    if (systemPtr->formatCnt == LOGGER_MAX_FORMATS){
+        return LOGGER_FORMAT_ID_TEXT;
+    }
+    logFormatEntry* e = &systemPtr->formats[systemPtr->formatCnt];
+    if (!logFormatParse(format, e->kinds, &e->argCnt)){
+        return LOGGER_FORMAT_ID_TEXT;
+    }
+    e->format = format;
+    // 0 means not registered yet, so IDs start at 1.
+    return ++systemPtr->formatCnt;
+}
 
-    sendTextToFile(finalMessage);
+void logToFile(logLevel level, b8 logToConsole, const char* message, ...){
+    __builtin_va_list args;
+    va_start(args, message);
+    logQueue(level, logToConsole, true, message, args);
+    va_end(args);
 }
 
 void logOutput(logLevel level, const char* message, ...) {
-    const char* levelStr[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]:  ", "[INFO]:  ", "[DEBUG]: ", "[TRACE]: "};
-    b8 isError = level < 2;
-
-    // Technically imposes a 32k character limit on a single log entry, but...
-    // DON'T DO THAT!
-    char outMessage[32000];
-    memset(outMessage, 0, sizeof(outMessage));
-
-    // Format original message.
-    __builtin_va_list arg_ptr;
-    va_start(arg_ptr, message);
-    vsnprintf(outMessage, 32000, message, arg_ptr);
-    va_end(arg_ptr);
-
-    char finalMessage[32000];
-    sprintf(finalMessage, "%s%s\n", levelStr[level], outMessage);
-
-    // TODO: platform-specific output.
-    if(isError){
-        platformConsoleWriteError(finalMessage,level);
-    }else{
-        platformConsoleWrite(finalMessage,level);
+    __builtin_va_list args;
+    va_start(args, message);
+    logQueue(level, true, false, message, args);
+    va_end(args);
+}
+
+void logBinary(u32* formatID, logLevel level, b8 toConsole, b8 toFile, const char* message, ...){
+    __builtin_va_list args;
+    va_start(args, message);
+    if (!systemPtr){
+        logSync(level, toConsole, message, args);
+        va_end(args);
+        return;
+    }
+
+    u32 id = __atomic_load_n(formatID, __ATOMIC_ACQUIRE);
+    if (id == 0){
+        fmutexLock(&systemPtr->registryMutex);
+        id = *formatID;
+        if (id == 0){
+            id = registerFormat(message);
+            __atomic_store_n(formatID, id, __ATOMIC_RELEASE);
+        }
+        fmutexUnlock(&systemPtr->registryMutex);
+    }
+    if (id == LOGGER_FORMAT_ID_TEXT){
+        logQueue(level, toConsole, toFile, message, args);
+        va_end(args);
+        return;
+    }
+
+    u64 pos = 0;
+    logRecord* r = claimRecord(level, &pos);
+    if (r){
+        logFormatEntry* e = &systemPtr->formats[id - 1];
+        r->length = (u16)logFormatEncodeArgs(e->kinds, e->argCnt, (u8*)r->text, LOGGER_RECORD_TEXT_SIZE, &args);
+        r->type = LOG_RECORD_BINARY;
+        r->formatID = id;
+        r->level = level;
+        r->toConsole = toConsole;
+        r->toFile = toFile;
+        r->timestamp = platformGetTimestampNs();
+        publishRecord(r, pos, level);
     }
+    va_end(args);
 }
 
 void reportAssertFailure(const char* expression, const char* message, const char* file, i32 line) {
-    logOutput(LOG_LEVEL_FATAL, "Assertion Failure: %s, message: '%s', in file: %s, line: %d\n", expression, message, file, line);
+    logOutput(LOG_LEVEL_FATAL, "Assertion Failure: %s, message: '%s', in file: %s, line: %d", expression, message, file, line);
 }
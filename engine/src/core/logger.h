@@ -2,15 +2,28 @@
 
 #include "defines.h"
 
-#define LOG_WARN_ENABLED 1
-#define LOG_INFO_ENABLED 1
-#define LOG_DEBUG_ENABLED 1
-#define LOG_TRACE_ENABLED 1
-
+// The most verbose level that gets compiled in. Anything past it is stripped
+// out by the macros below, args and all. Override with -DFSN_LOG_LEVEL=<n>.
+#ifndef FSN_LOG_LEVEL
 // Disable debug and trace logging for release builds.
 #if FSNRELEASE == 1
-#define LOG_DEBUG_ENABLED 0
-#define LOG_TRACE_ENABLED 0
+#define FSN_LOG_LEVEL 3
+#else
+#define FSN_LOG_LEVEL 5
+#endif
+#endif
+
+#define LOG_WARN_ENABLED (FSN_LOG_LEVEL >= 2)
+#define LOG_INFO_ENABLED (FSN_LOG_LEVEL >= 3)
+#define LOG_DEBUG_ENABLED (FSN_LOG_LEVEL >= 4)
+#define LOG_TRACE_ENABLED (FSN_LOG_LEVEL >= 5)
+
+// Build with -DFSN_LOG_BINARY=1 to log in binary. Call sites only store a
+// format ID, a timestamp and the raw args and the formatting happens on the
+// flush thread. The log file becomes appLogger.flog, which flogDecoder turns
+// back into text. Must be the same for the engine and everything using it.
+#ifndef FSN_LOG_BINARY
+#define FSN_LOG_BINARY 0
 #endif
 
 typedef enum logLevel {
@@ -22,57 +35,130 @@ typedef enum logLevel {
     LOG_LEVEL_TRACE = 5
 } logLevel;
 
+typedef enum logOverflowPolicy {
+    // Drop the message and count it. The count is reported on the next flush.
+    LOG_OVERFLOW_DROP = 0,
+    // Wait for the flush thread to make room.
+    LOG_OVERFLOW_BLOCK = 1
+} logOverflowPolicy;
+
+/**
+ * @brief Sets up the logger. Messages are queued into a ring buffer and written
+ * out by a background thread. Before init and after shutdown messages are
+ * written synchronously.
+ * @param memoryRequirement Gets set to the memory the logger needs
+ * @param state The memory for the logger. Pass 0 to just get the memoryRequirement
+ * @returns true if successful, false if failed
+ */
 b8 loggerInit(u64* memoryRequirement, void* state);
+
+/**
+ * @brief Flushes every queued message, stops the flush thread and closes the log file.
+ */
 void loggerShutdown();
 
+/**
+ * @brief Writes every queued message out before returning. Safe to call from any thread.
+ */
+FSNAPI void loggerFlush();
+
+/**
+ * @brief Sets what happens when the ring buffer is full. Defaults to LOG_OVERFLOW_DROP.
+ * FATAL messages always block.
+ * @param policy The new overflow policy
+ */
+FSNAPI void loggerSetOverflowPolicy(logOverflowPolicy policy);
+
+/**
+ * @brief Gets how many messages have been dropped because the ring buffer was full.
+ * @returns The number of dropped messages since init
+ */
+FSNAPI u64 loggerGetDroppedCount();
+
 FSNAPI void logToFile(logLevel level, b8 logToConsole, const char* message, ...);
 
 FSNAPI void logOutput(logLevel level, const char* message, ...);
 
+/**
+ * @brief Logs a message in binary. Use the macros instead of calling this directly.
+ * @param formatID The call site's format ID. Should be a static starting at 0,
+ * it gets registered on the first call
+ * @param level The log level
+ * @param toConsole If the message should go to the console
+ * @param toFile If the message should go to the log file
+ * @param message The format string. Must be a string literal
+ */
+FSNAPI void logBinary(u32* formatID, logLevel level, b8 toConsole, b8 toFile, const char* message, ...);
+
+#if FSN_LOG_BINARY == 1
+// Only literal format strings can be logged in binary, the rest fall back to text.
+#define FLOG_OUTPUT(level, message, ...)                                                \
+    do {                                                                                \
+        static u32 flogFormatID = 0;                                                    \
+        if (__builtin_constant_p(message)) {                                            \
+            logBinary(&flogFormatID, level, true, false, message, ##__VA_ARGS__);       \
+        } else {                                                                        \
+            logOutput(level, message, ##__VA_ARGS__);                                   \
+        }                                                                               \
+    } while (0)
+#define FLOG_FILE(level, toConsole, message, ...)                                       \
+    do {                                                                                \
+        static u32 flogFormatID = 0;                                                    \
+        if (__builtin_constant_p(message)) {                                            \
+            logBinary(&flogFormatID, level, toConsole, true, message, ##__VA_ARGS__);   \
+        } else {                                                                        \
+            logToFile(level, toConsole, message, ##__VA_ARGS__);                        \
+        }                                                                               \
+    } while (0)
+#else
+#define FLOG_OUTPUT(level, message, ...) logOutput(level, message, ##__VA_ARGS__)
+#define FLOG_FILE(level, toConsole, message, ...) logToFile(level, toConsole, message, ##__VA_ARGS__)
+#endif
+
 // Logs a fatal-level message.
-#define FFATAL(message, ...) logOutput(LOG_LEVEL_FATAL, message, ##__VA_ARGS__);
-#define FFATALF(message, toConsole, ...) logToFile(LOG_LEVEL_FATAL, toConsole, message, ##__VA_ARGS__);
+#define FFATAL(message, ...) FLOG_OUTPUT(LOG_LEVEL_FATAL, message, ##__VA_ARGS__);
+#define FFATALF(message, toConsole, ...) FLOG_FILE(LOG_LEVEL_FATAL, toConsole, message, ##__VA_ARGS__);
 
 #ifndef FERROR
 // Logs an error-level message.
-#define FERROR(message, ...) logOutput(LOG_LEVEL_ERROR, message, ##__VA_ARGS__);
-#define FERRORF(message, toConsole, ...) logToFile(LOG_LEVEL_ERROR, toConsole, message, ##__VA_ARGS__);
+#define FERROR(message, ...) FLOG_OUTPUT(LOG_LEVEL_ERROR, message, ##__VA_ARGS__);
+#define FERRORF(message, toConsole, ...) FLOG_FILE(LOG_LEVEL_ERROR, toConsole, message, ##__VA_ARGS__);
 #endif
 
-#if LOG_WARN_ENABLED == 1
+#if LOG_WARN_ENABLED
 // Logs a warning-level message.
-#define FWARN(message, ...) logOutput(LOG_LEVEL_WARN, message, ##__VA_ARGS__);
-#define FWARNF(message, toConsole, ...) logToFile(LOG_LEVEL_WARN, toConsole, message, ##__VA_ARGS__);
+#define FWARN(message, ...) FLOG_OUTPUT(LOG_LEVEL_WARN, message, ##__VA_ARGS__);
+#define FWARNF(message, toConsole, ...) FLOG_FILE(LOG_LEVEL_WARN, toConsole, message, ##__VA_ARGS__);
 #else
 // Does nothing when LOG_WARN_ENABLED is false
 #define FWARN(message, ...)
 #define FWARNF(message, toConsole, ...)
 #endif
 
-#if LOG_INFO_ENABLED == 1
+#if LOG_INFO_ENABLED
 // Logs a info-level message.
-#define FINFO(message, ...) logOutput(LOG_LEVEL_INFO, message, ##__VA_ARGS__);
-#define FINFOF(message, toConsole, ...) logToFile(LOG_LEVEL_INFO, toConsole, message, ##__VA_ARGS__);
+#define FINFO(message, ...) FLOG_OUTPUT(LOG_LEVEL_INFO, message, ##__VA_ARGS__);
+#define FINFOF(message, toConsole, ...) FLOG_FILE(LOG_LEVEL_INFO, toConsole, message, ##__VA_ARGS__);
 #else
 // Does nothing when LOG_INFO_ENABLED is false
 #define FINFO(message, ...)
 #define FINFOF(message, toConsole, ...)
 #endif
 
-#if LOG_DEBUG_ENABLED == 1
+#if LOG_DEBUG_ENABLED
 // Logs a debug-level message.
-#define FDEBUG(message, ...) logOutput(LOG_LEVEL_DEBUG, message, ##__VA_ARGS__);
-#define FDEBUGF(message, toConsole, ...) logToFile(LOG_LEVEL_DEBUG, toConsole, message, ##__VA_ARGS__);
+#define FDEBUG(message, ...) FLOG_OUTPUT(LOG_LEVEL_DEBUG, message, ##__VA_ARGS__);
+#define FDEBUGF(message, toConsole, ...) FLOG_FILE(LOG_LEVEL_DEBUG, toConsole, message, ##__VA_ARGS__);
 #else
 // Does nothing when LOG_DEBUG_ENABLED is false
 #define FDEBUG(message, ...)
 #define FDEBUGF(message, toConsole, ...)
 #endif
 
-#if LOG_TRACE_ENABLED == 1
+#if LOG_TRACE_ENABLED
 // Logs a trace-level message.
-#define FTRACE(message, ...) logOutput(LOG_LEVEL_TRACE, message, ##__VA_ARGS__);
-#define FTRACEF(message, toConsole, ...) logToFile(LOG_LEVEL_TRACE, toConsole, message, ##__VA_ARGS__);
+#define FTRACE(message, ...) FLOG_OUTPUT(LOG_LEVEL_TRACE, message, ##__VA_ARGS__);
+#define FTRACEF(message, toConsole, ...) FLOG_FILE(LOG_LEVEL_TRACE, toConsole, message, ##__VA_ARGS__);
 #else
 // Does nothing when LOG_TRACE_ENABLED is false
 #define FTRACE(message, ...)
@@ -0,0 +1,252 @@
+#include "profiler.h"
+
+#include "core/fthread.h"
+#include "core/logger.h"
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include <stdio.h>
+
+typedef struct profileEvent {
+    const char* name;
+    u64 start;
+    u64 end;
+} profileEvent;
+
+typedef struct profilerTrack {
+    // 0 for tracks made with profilerCreateTrack.
+    u64 threadID;
+    char name[32];
+    // Total zones ever written, the ring index is written % PROFILER_ZONES_PER_THREAD.
+    u64 written;
+    profileEvent events[PROFILER_ZONES_PER_THREAD];
+} profilerTrack;
+
+// Tracks get allocated the first time a thread records a zone and live until
+// profilerShutdown. The profiler works before any other system is up, so
+// this doesn't follow the usual init pattern.
+static profilerTrack* tracks[PROFILER_MAX_THREADS];
+static u32 trackCnt;
+static b8 enabled = true;
+static _Thread_local profilerTrack* threadTrack;
+// Set on threads that started after the tracks ran out, so they stop trying.
+static _Thread_local b8 noThreadTrack;
+static b8 warnedFull;
+
+static profilerTrack* createTrack(const char* name, u64 threadID) {
+    u32 idx = __atomic_fetch_add(&trackCnt, 1, __ATOMIC_ACQ_REL);
+    if (idx >= PROFILER_MAX_THREADS) {
+        __atomic_fetch_sub(&trackCnt, 1, __ATOMIC_ACQ_REL);
+        if (!__atomic_exchange_n(&warnedFull, true, __ATOMIC_RELAXED)) {
+            FWARN("Out of profiler tracks, '%s' and anything after it won't be recorded. Raise PROFILER_MAX_THREADS.", name);
+        }
+        return 0;
+    }
+    profilerTrack* t = platformAllocate(sizeof(profilerTrack), false);
+    platformZeroMemory(t, sizeof(profilerTrack));
+    t->threadID = threadID;
+    snprintf(t->name, sizeof(t->name), "%s", name);
+    __atomic_store_n(&tracks[idx], t, __ATOMIC_RELEASE);
+    return t;
+}
+
+static profilerTrack* getThreadTrack() {
+    if (!threadTrack && !noThreadTrack) {
+        // Set first, logging that it failed could record a zone on this thread.
+        noThreadTrack = true;
+        char name[32];
+        snprintf(name, sizeof(name), "thread %llu", (unsigned long long)__atomic_load_n(&trackCnt, __ATOMIC_ACQUIRE));
+        threadTrack = createTrack(name, fthreadCurrentID());
+        noThreadTrack = threadTrack == 0;
+    }
+    return threadTrack;
+}
+
+static void pushEvent(profilerTrack* t, const char* name, u64 start, u64 end) {
+    // Only the owning thread writes to a thread's track, so no need for a CAS.
+    u64 w = t->written;
+    profileEvent* e = &t->events[w % PROFILER_ZONES_PER_THREAD];
+    e->name = name;
+    e->start = start;
+    e->end = end;
+    __atomic_store_n(&t->written, w + 1, __ATOMIC_RELEASE);
+}
+
+profileZone profileBeginZone(const char* name) {
+    profileZone z = {0, 0};
+    if (__atomic_load_n(&enabled, __ATOMIC_RELAXED)) {
+        z.name = name;
+        z.start = platformGetRawTimestampNs();
+    }
+    return z;
+}
+
+void profileEndZone(profileZone* zone) {
+    if (!zone->name) {
+        return;
+    }
+    u64 end = platformGetRawTimestampNs();
+    profilerTrack* t = getThreadTrack();
+    if (t) {
+        pushEvent(t, zone->name, zone->start, end);
+    }
+}
+
+void profilerRecordZone(u32 track, const char* name, u64 start, u64 end) {
+    if (track >= PROFILER_MAX_THREADS || !__atomic_load_n(&enabled, __ATOMIC_RELAXED)) {
+        return;
+    }
+    profilerTrack* t = __atomic_load_n(&tracks[track], __ATOMIC_ACQUIRE);
+    if (t) {
+        pushEvent(t, name, start, end);
+    }
+}
+
+u32 profilerCreateTrack(const char* name) {
+    profilerTrack* t = createTrack(name, 0);
+    if (!t) {
+        return INVALID_ID;
+    }
+    for (u32 i = 0; i < PROFILER_MAX_THREADS; ++i) {
+        if (__atomic_load_n(&tracks[i], __ATOMIC_ACQUIRE) == t) {
+            return i;
+        }
+    }
+    return INVALID_ID;
+}
+
+void profilerSetThreadName(const char* name) {
+    profilerTrack* t = getThreadTrack();
+    if (t) {
+        snprintf(t->name, sizeof(t->name), "%s", name);
+    }
+}
+
+void profilerSetEnabled(b8 e) {
+    __atomic_store_n(&enabled, e, __ATOMIC_RELAXED);
+}
+
+typedef struct traceWriter {
+    fileHandle file;
+    u64 len;
+    b8 ok;
+    char buffer[KIBIBYTES(64)];
+} traceWriter;
+
+static void traceFlush(traceWriter* w) {
+    u64 written = 0;
+    if (w->len && !fsWrite(&w->file, w->len, w->buffer, &written)) {
+        w->ok = false;
+    }
+    w->len = 0;
+}
+
+static void traceAppend(traceWriter* w, const char* fmt, ...) {
+    if (w->len + 512 > sizeof(w->buffer)) {
+        traceFlush(w);
+    }
+    __builtin_va_list args;
+    __builtin_va_start(args, fmt);
+    i32 n = vsnprintf(w->buffer + w->len, sizeof(w->buffer) - w->len, fmt, args);
+    __builtin_va_end(args);
+    if (n > 0) {
+        w->len += (u64)n < sizeof(w->buffer) - w->len ? (u64)n : sizeof(w->buffer) - w->len - 1;
+    }
+}
+
+// Names are usually literals but escape them anyway so the JSON stays valid.
+static const char* escapeName(const char* name, char* out, u64 outSize) {
+    u64 j = 0;
+    for (const char* c = name; *c && j + 2 < outSize; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out[j++] = '\\';
+        }
+        out[j++] = (*c < 0x20) ? ' ' : *c;
+    }
+    out[j] = 0;
+    return out;
+}
+
+b8 profilerExportChromeTrace(const char* path) {
+    traceWriter* w = platformAllocate(sizeof(traceWriter), false);
+    w->len = 0;
+    w->ok = true;
+    if (!fsOpen(path, FILE_MODE_WRITE, false, &w->file)) {
+        FERROR("Profiler couldn't open %s to export the trace.", path);
+        platformFree(w, false);
+        return false;
+    }
+
+    u32 cnt = __atomic_load_n(&trackCnt, __ATOMIC_ACQUIRE);
+    if (cnt > PROFILER_MAX_THREADS) {
+        cnt = PROFILER_MAX_THREADS;
+    }
+
+    // Timestamps are relative to the earliest zone so the numbers stay small.
+    u64 base = ~0ULL;
+    for (u32 i = 0; i < cnt; ++i) {
+        profilerTrack* t = __atomic_load_n(&tracks[i], __ATOMIC_ACQUIRE);
+        if (!t) continue;
+        u64 written = __atomic_load_n(&t->written, __ATOMIC_ACQUIRE);
+        u64 n = written < PROFILER_ZONES_PER_THREAD ? written : PROFILER_ZONES_PER_THREAD;
+        for (u64 e = written - n; e < written; ++e) {
+            u64 s = t->events[e % PROFILER_ZONES_PER_THREAD].start;
+            if (s < base) base = s;
+        }
+    }
+
+    char escaped[128];
+    b8 first = true;
+    u64 zoneCnt = 0;
+    traceAppend(w, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (u32 i = 0; i < cnt; ++i) {
+        profilerTrack* t = __atomic_load_n(&tracks[i], __ATOMIC_ACQUIRE);
+        if (!t) continue;
+        traceAppend(w, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                    first ? "" : ",", i + 1, escapeName(t->name, escaped, sizeof(escaped)));
+        traceAppend(w, ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"sort_index\":%u}}",
+                    i + 1, i);
+        first = false;
+
+        u64 written = __atomic_load_n(&t->written, __ATOMIC_ACQUIRE);
+        u64 n = written < PROFILER_ZONES_PER_THREAD ? written : PROFILER_ZONES_PER_THREAD;
+        for (u64 e = written - n; e < written; ++e) {
+            profileEvent* ev = &t->events[e % PROFILER_ZONES_PER_THREAD];
+            f64 ts = (f64)(ev->start - base) / 1000.0;
+            f64 dur = (f64)(ev->end - ev->start) / 1000.0;
+            traceAppend(w, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                        escapeName(ev->name, escaped, sizeof(escaped)), i + 1, ts, dur);
+            zoneCnt++;
+        }
+    }
+    traceAppend(w, "\n]}\n");
+    traceFlush(w);
+    fsClose(&w->file);
+
+    b8 ok = w->ok;
+    platformFree(w, false);
+    if (ok) {
+        FINFO("Profiler exported %llu zones to %s", zoneCnt, path);
+    } else {
+        FERROR("Profiler failed writing the trace to %s", path);
+    }
+    return ok;
+}
+
+void profilerShutdown() {
+    profilerSetEnabled(false);
+    u32 cnt = __atomic_load_n(&trackCnt, __ATOMIC_ACQUIRE);
+    if (cnt > PROFILER_MAX_THREADS) {
+        cnt = PROFILER_MAX_THREADS;
+    }
+    for (u32 i = 0; i < cnt; ++i) {
+        profilerTrack* t = __atomic_exchange_n(&tracks[i], 0, __ATOMIC_ACQ_REL);
+        if (t) {
+            platformFree(t, false);
+        }
+    }
+    __atomic_store_n(&trackCnt, 0, __ATOMIC_RELEASE);
+    // Other threads' cached tracks are gone now, only reset ours.
+    threadTrack = 0;
+    noThreadTrack = false;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "defines.h"
+
+/*
+ * Scoped CPU profiler. Build with -DFSN_PROFILE to turn the macros on, without
+ * it they compile to nothing. Zones get recorded into a ring buffer per thread
+ * and can be exported to the Chrome trace format, which chrome://tracing and
+ * ui.perfetto.dev both open.
+ *
+ * void foo() {
+ *     FPROFILE_FUNC();
+ *     ...
+ *     {
+ *         FPROFILE_SCOPE("inner bit");
+ *         ...
+ *     }
+ * }
+ */
+
+// How many zones each thread keeps before the oldest get overwritten.
+#define PROFILER_ZONES_PER_THREAD 16384
+#define PROFILER_MAX_THREADS 32
+
+/** @brief An open zone. Ended automatically when it goes out of scope. */
+typedef struct profileZone {
+    const char* name;
+    u64 start;
+} profileZone;
+
+/**
+ * @brief Starts a zone. Use FPROFILE_SCOPE instead of calling this directly.
+ * @param name The zone's name. Must outlive the profiler, so use a literal
+ * @returns The open zone
+ */
+FSNAPI profileZone profileBeginZone(const char* name);
+
+/**
+ * @brief Ends a zone and records it. Use FPROFILE_SCOPE instead of calling this directly.
+ * @param zone The zone to end
+ */
+FSNAPI void profileEndZone(profileZone* zone);
+
+/**
+ * @brief Records a zone that was timed some other way, like on the GPU.
+ * @param track The thread/track to put it on. Tracks are made with profilerCreateTrack
+ * @param name The zone's name. Must outlive the profiler
+ * @param start When the zone started in platformGetRawTimestampNs time
+ * @param end When the zone ended in platformGetRawTimestampNs time
+ */
+FSNAPI void profilerRecordZone(u32 track, const char* name, u64 start, u64 end);
+
+/**
+ * @brief Makes a track that isn't tied to a thread, for zones recorded with
+ * profilerRecordZone.
+ * @param name The track's name
+ * @returns The track, or INVALID_ID if there's no room for another
+ */
+FSNAPI u32 profilerCreateTrack(const char* name);
+
+/**
+ * @brief Names the calling thread's track in exported traces.
+ * @param name The thread's name
+ */
+FSNAPI void profilerSetThreadName(const char* name);
+
+/**
+ * @brief Pauses or resumes recording. Pause before exporting so threads
+ * aren't writing while the rings get read.
+ * @param enabled Whether zones should be recorded
+ */
+FSNAPI void profilerSetEnabled(b8 enabled);
+
+/**
+ * @brief Writes every recorded zone out as a Chrome trace JSON file.
+ * @param path Where to write the trace
+ * @returns true if successful, false if failed
+ */
+FSNAPI b8 profilerExportChromeTrace(const char* path);
+
+/**
+ * @brief Frees every track's ring buffer.
+ */
+FSNAPI void profilerShutdown();
+
+#ifdef FSN_PROFILE
+#define FPROFILE_CONCAT_INNER(a, b) a##b
+#define FPROFILE_CONCAT(a, b) FPROFILE_CONCAT_INNER(a, b)
+// Profiles from here to the end of the enclosing scope.
+#define FPROFILE_SCOPE(name) \
+    profileZone FPROFILE_CONCAT(fprofileZone, __LINE__) __attribute__((cleanup(profileEndZone))) = profileBeginZone(name)
+// Profiles the rest of the enclosing function.
+#define FPROFILE_FUNC() FPROFILE_SCOPE(__func__)
+#else
+#define FPROFILE_SCOPE(name)
+#define FPROFILE_FUNC()
+#endif
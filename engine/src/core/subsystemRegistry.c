@@ -0,0 +1,250 @@
+#include "subsystemRegistry.h"
+
+#include "core/fmemory.h"
+#include "core/fstring.h"
+#include "core/jobSystem.h"
+#include "core/logger.h"
+#include "core/profiler.h"
+#include "platform/platform.h"
+
+// Each subsystem's memory starts on its own cache line so ones initing at the
+// same time don't share any.
+#define SUBSYSTEM_STATE_ALIGNMENT 64
+
+static u32 findEntry(subsystemRegistry* registry, const char* name) {
+    for (u32 i = 0; i < registry->entryCnt; ++i) {
+        if (strEqual(registry->entries[i].desc.name, name)) {
+            return i;
+        }
+    }
+    return INVALID_ID;
+}
+
+b8 subsystemRegister(subsystemRegistry* registry, subsystemDesc desc) {
+    if (!desc.name || !desc.init) {
+        FERROR("subsystemRegister needs a name and an init function.");
+        return false;
+    }
+    if (registry->entryCnt >= SUBSYSTEM_MAX) {
+        FERROR("Can't register subsystem '%s', raise SUBSYSTEM_MAX.", desc.name);
+        return false;
+    }
+    if (findEntry(registry, desc.name) != INVALID_ID) {
+        FERROR("A subsystem named '%s' is already registered.", desc.name);
+        return false;
+    }
+
+    subsystemEntry* e = &registry->entries[registry->entryCnt];
+    fzeroMemory(e, sizeof(subsystemEntry));
+    e->desc = desc;
+    for (u32 i = 0; i < SUBSYSTEM_MAX_DEPS && desc.deps[i]; ++i) {
+        u32 dep = findEntry(registry, desc.deps[i]);
+        if (dep == INVALID_ID) {
+            FERROR("Subsystem '%s' depends on '%s' which isn't registered before it.", desc.name, desc.deps[i]);
+            return false;
+        }
+        e->depIdxs[e->depCnt++] = dep;
+    }
+    registry->entryCnt++;
+    return true;
+}
+
+static void runInit(subsystemEntry* e) {
+    FPROFILE_SCOPE(e->desc.name);
+    e->startNs = platformGetTimestampNs();
+    e->result = e->desc.init(&e->memoryRequirement, e->state, e->desc.config);
+    e->endNs = platformGetTimestampNs();
+}
+
+static void initJob(void* params) {
+    subsystemEntry* e = params;
+    e->ranOnJob = true;
+    runInit(e);
+    __atomic_store_n(&e->status, SUBSYSTEM_STATUS_FINISHED, __ATOMIC_RELEASE);
+    fsemaphoreSignal(e->doneSemaphore);
+}
+
+// Jobs set their own status when they finish so it's read atomically.
+static subsystemStatus getStatus(subsystemEntry* e) {
+    return __atomic_load_n(&e->status, __ATOMIC_ACQUIRE);
+}
+
+static b8 depsInited(subsystemRegistry* registry, subsystemEntry* e) {
+    for (u32 i = 0; i < e->depCnt; ++i) {
+        if (getStatus(&registry->entries[e->depIdxs[i]]) != SUBSYSTEM_STATUS_INITED) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Moves a subsystem that's done running its init to INITED or FAILED.
+static b8 finishEntry(subsystemRegistry* registry, u32 idx) {
+    subsystemEntry* e = &registry->entries[idx];
+    if (!e->result) {
+        FERROR("Subsystem '%s' failed to init.", e->desc.name);
+        e->status = SUBSYSTEM_STATUS_FAILED;
+        return false;
+    }
+    e->status = SUBSYSTEM_STATUS_INITED;
+    registry->initOrder[registry->initedCnt++] = idx;
+    return true;
+}
+
+static void logTimeline(subsystemRegistry* registry, u64 startNs, u64 endNs) {
+    // Sort by when they started so things that overlapped are next to each other.
+    u32 order[SUBSYSTEM_MAX];
+    u32 cnt = registry->initedCnt;
+    u64 busyNs = 0;
+    for (u32 i = 0; i < cnt; ++i) {
+        u32 idx = registry->initOrder[i];
+        u32 j = i;
+        while (j > 0 && registry->entries[order[j - 1]].startNs > registry->entries[idx].startNs) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = idx;
+        busyNs += registry->entries[idx].endNs - registry->entries[idx].startNs;
+    }
+
+    FINFO("Startup took %.3fms for %.3fms of subsystem init on %u job threads:", (endNs - startNs) / 1000000.0,
+          busyNs / 1000000.0, jobSystemGetThreadCount());
+    for (u32 i = 0; i < cnt; ++i) {
+        subsystemEntry* e = &registry->entries[order[i]];
+        FINFO("  %-16s +%8.3fms %8.3fms  %s", e->desc.name, (e->startNs - startNs) / 1000000.0,
+              (e->endNs - e->startNs) / 1000000.0, e->ranOnJob ? "job" : "main");
+    }
+}
+
+b8 subsystemRegistryInitAll(subsystemRegistry* registry) {
+    FPROFILE_FUNC();
+    u64 startNs = platformGetTimestampNs();
+
+    // Every subsystem's memory comes out of one allocation.
+    u64 totalSize = 0;
+    for (u32 i = 0; i < registry->entryCnt; ++i) {
+        subsystemEntry* e = &registry->entries[i];
+        if (!e->desc.init(&e->memoryRequirement, 0, e->desc.config)) {
+            FERROR("Subsystem '%s' failed to get its memory requirement.", e->desc.name);
+            return false;
+        }
+        totalSize += (e->memoryRequirement + SUBSYSTEM_STATE_ALIGNMENT - 1) & ~(u64)(SUBSYSTEM_STATE_ALIGNMENT - 1);
+    }
+    // The allocation itself is only as aligned as the allocator makes it, so
+    // leave room to line up the first state.
+    linearAllocCreate(totalSize + SUBSYSTEM_STATE_ALIGNMENT, &registry->allocator);
+    u64 misalign = (u64)registry->allocator.memory & (SUBSYSTEM_STATE_ALIGNMENT - 1);
+    if (misalign) {
+        linearAllocAllocate(&registry->allocator, SUBSYSTEM_STATE_ALIGNMENT - misalign);
+    }
+    for (u32 i = 0; i < registry->entryCnt; ++i) {
+        subsystemEntry* e = &registry->entries[i];
+        u64 size = (e->memoryRequirement + SUBSYSTEM_STATE_ALIGNMENT - 1) & ~(u64)(SUBSYSTEM_STATE_ALIGNMENT - 1);
+        e->state = linearAllocAllocate(&registry->allocator, size);
+    }
+
+    fsemaphore doneSemaphore;
+    b8 useJobs = jobSystemIsRunning();
+    if (useJobs && !fsemaphoreCreate(&doneSemaphore, SUBSYSTEM_MAX, 0)) {
+        FWARN("Subsystem registry couldn't create its semaphore, initing everything on this thread.");
+        useJobs = false;
+    }
+
+    u32 remaining = registry->entryCnt;
+    u32 inFlight = 0;
+    // Every job signals once after setting its status. The status says which
+    // one finished, the waits make sure none are still signalling once the
+    // semaphore's destroyed.
+    u32 submitted = 0;
+    u32 waited = 0;
+    b8 failed = false;
+    while (remaining > 0 && !failed) {
+        // Pick up whatever the jobs finished.
+        for (u32 i = 0; i < registry->entryCnt; ++i) {
+            subsystemEntry* e = &registry->entries[i];
+            if (getStatus(e) == SUBSYSTEM_STATUS_FINISHED) {
+                inFlight--;
+                remaining--;
+                if (!finishEntry(registry, i)) {
+                    failed = true;
+                }
+            }
+        }
+        if (failed) {
+            break;
+        }
+
+        // Start every job that's ready first so they run while this thread
+        // does a main thread init.
+        u32 mainReady = INVALID_ID;
+        for (u32 i = 0; i < registry->entryCnt; ++i) {
+            subsystemEntry* e = &registry->entries[i];
+            if (getStatus(e) != SUBSYSTEM_STATUS_PENDING || !depsInited(registry, e)) {
+                continue;
+            }
+            if (useJobs && !e->desc.mainThread) {
+                e->status = SUBSYSTEM_STATUS_QUEUED;
+                e->doneSemaphore = &doneSemaphore;
+                inFlight++;
+                submitted++;
+                jobSubmit(initJob, e);
+            } else if (mainReady == INVALID_ID) {
+                mainReady = i;
+            }
+        }
+
+        if (mainReady != INVALID_ID) {
+            runInit(&registry->entries[mainReady]);
+            remaining--;
+            if (!finishEntry(registry, mainReady)) {
+                failed = true;
+            }
+        } else if (inFlight > 0) {
+            fsemaphoreWait(&doneSemaphore, FSEMAPHORE_WAIT_INFINITE);
+            waited++;
+        } else if (remaining > 0) {
+            // Deps are always registered first, so this only happens if
+            // something it depends on never got the chance to init.
+            FERROR("Subsystem registry has %u subsystems left it can't init.", remaining);
+            failed = true;
+        }
+    }
+
+    // Jobs still running have to finish before their results can be dropped.
+    while (waited < submitted) {
+        fsemaphoreWait(&doneSemaphore, FSEMAPHORE_WAIT_INFINITE);
+        waited++;
+    }
+    for (u32 i = 0; inFlight > 0 && i < registry->entryCnt; ++i) {
+        if (getStatus(&registry->entries[i]) == SUBSYSTEM_STATUS_FINISHED) {
+            inFlight--;
+            finishEntry(registry, i);
+        }
+    }
+    if (useJobs) {
+        fsemaphoreDestroy(&doneSemaphore);
+    }
+    if (failed) {
+        return false;
+    }
+
+    logTimeline(registry, startNs, platformGetTimestampNs());
+    return true;
+}
+
+void subsystemRegistryShutdownAll(subsystemRegistry* registry) {
+    for (i32 i = (i32)registry->initedCnt - 1; i >= 0; --i) {
+        subsystemEntry* e = &registry->entries[registry->initOrder[i]];
+        if (e->desc.shutdown) {
+            e->desc.shutdown(e->state);
+        }
+        e->status = SUBSYSTEM_STATUS_PENDING;
+    }
+    registry->initedCnt = 0;
+    linearAllocDestroy(&registry->allocator);
+}
+
+void* subsystemGetState(subsystemRegistry* registry, const char* name) {
+    u32 idx = findEntry(registry, name);
+    return idx != INVALID_ID ? registry->entries[idx].state : 0;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "defines.h"
+#include "core/fsemaphore.h"
+#include "core/linearAllocator.h"
+
+/*
+ * Declares the engine's subsystems and what each one needs to be up before it
+ * can init. subsystemRegistryInitAll asks every subsystem for its memory in one
+ * pass, hands each its slice of one allocation, then inits them in dependency
+ * order. Subsystems that don't depend on each other init at the same time on
+ * the job system, and how long each took gets logged as a startup timeline.
+ *
+ * subsystemDesc desc = {};
+ * desc.name = "texture";
+ * desc.init = textureInit;
+ * desc.shutdown = textureSystemShutdown;
+ * desc.config = &textureSettings;
+ * desc.deps[0] = "renderer";
+ * subsystemRegister(&registry, desc);
+ */
+
+#define SUBSYSTEM_MAX 32
+#define SUBSYSTEM_MAX_DEPS 4
+
+/**
+ * @brief Inits a subsystem the usual two pass way.
+ * @param memoryRequirement Gets set to the memory the subsystem needs
+ * @param state The subsystem's memory. 0 to just get the memoryRequirement
+ * @param config The desc's config
+ * @returns true if successful, false if the subsystem failed to init
+ */
+typedef b8 (*PFN_subsystemInit)(u64* memoryRequirement, void* state, void* config);
+
+/**
+ * @brief Shuts a subsystem down.
+ * @param state The subsystem's memory
+ */
+typedef void (*PFN_subsystemShutdown)(void* state);
+
+typedef struct subsystemDesc {
+    // Used for deps and the timeline. Must outlive the registry, so use a literal.
+    const char* name;
+    PFN_subsystemInit init;
+    // Optional.
+    PFN_subsystemShutdown shutdown;
+    // Passed to init. Must outlive subsystemRegistryInitAll.
+    void* config;
+    // Names of subsystems that have to finish init first. They must already be
+    // registered, which also keeps cycles out.
+    const char* deps[SUBSYSTEM_MAX_DEPS];
+    // Inits on the thread calling subsystemRegistryInitAll instead of a job,
+    // for things like windows and GPU work that have to stay on one thread.
+    b8 mainThread;
+} subsystemDesc;
+
+typedef enum subsystemStatus {
+    SUBSYSTEM_STATUS_PENDING,
+    SUBSYSTEM_STATUS_QUEUED,
+    // Set by the job when it's done. The registry then moves it to INITED or FAILED.
+    SUBSYSTEM_STATUS_FINISHED,
+    SUBSYSTEM_STATUS_INITED,
+    SUBSYSTEM_STATUS_FAILED,
+} subsystemStatus;
+
+typedef struct subsystemEntry {
+    subsystemDesc desc;
+    u32 depIdxs[SUBSYSTEM_MAX_DEPS];
+    u32 depCnt;
+    u64 memoryRequirement;
+    void* state;
+    subsystemStatus status;
+    b8 result;
+    b8 ranOnJob;
+    u64 startNs;
+    u64 endNs;
+    fsemaphore* doneSemaphore;
+} subsystemEntry;
+
+typedef struct subsystemRegistry {
+    subsystemEntry entries[SUBSYSTEM_MAX];
+    u32 entryCnt;
+    // Indexes in the order they finished init. Shutdown goes backwards through it.
+    u32 initOrder[SUBSYSTEM_MAX];
+    u32 initedCnt;
+    linearAllocator allocator;
+} subsystemRegistry;
+
+/**
+ * @brief Adds a subsystem to the registry.
+ * @param registry The registry
+ * @param desc The subsystem
+ * @returns true if registered, false if the name is taken, a dep isn't
+ * registered yet or the registry is full
+ */
+FSNAPI b8 subsystemRegister(subsystemRegistry* registry, subsystemDesc desc);
+
+/**
+ * @brief Allocates every registered subsystem's memory and inits them in
+ * dependency order, using the job system for ones that can run at once. Logs
+ * the startup timeline when done.
+ * @param registry The registry
+ * @returns true if everything inited, false if one failed. The ones that did
+ * init can still be shut down with subsystemRegistryShutdownAll
+ */
+FSNAPI b8 subsystemRegistryInitAll(subsystemRegistry* registry);
+
+/**
+ * @brief Shuts down every inited subsystem in the opposite order they inited
+ * in and frees their memory.
+ * @param registry The registry
+ */
+FSNAPI void subsystemRegistryShutdownAll(subsystemRegistry* registry);
+
+/**
+ * @brief Gets a subsystem's memory.
+ * @param registry The registry
+ * @param name The subsystem's name
+ * @returns The subsystem's state, or 0 if there isn't one by that name or it
+ * hasn't been allocated
+ */
+FSNAPI void* subsystemGetState(subsystemRegistry* registry, const char* name);
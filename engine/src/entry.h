@@ -13,7 +13,7 @@ extern b8 createGame(game* outGame);
  */
 int main(void) {
     // Request the game instance from the application.
-    game gameInstance;
+    game gameInstance = {};
     if (!createGame(&gameInstance)) {
         FFATAL("Could not create game!");
         return -1;
@@ -13,11 +13,14 @@ typedef struct game {
     // Function pointer to game's initialize function.
     b8 (*initialize)(struct game* gameInstance);
 
-    // Function pointer to game's update function.
+    // Function pointer to game's update function. Gets the fixed delta if
+    // appConfig.fixedUpdateRate is set.
     b8 (*update)(struct game* gameInstance, f32 deltaTime);
 
-    // Function pointer to game's render function.
-    b8 (*render)(struct game* gameInstance, f32 deltaTime);
+    // Function pointer to game's render function. alpha is how far between the
+    // last two fixed updates this frame is, from 0 to 1. Always 1 without
+    // fixed updates.
+    b8 (*render)(struct game* gameInstance, f32 deltaTime, f32 alpha);
 
     // Function pointer to handle resizes, if applicable.
     void (*onResize)(struct game* gameInstance, u32 width, u32 height);
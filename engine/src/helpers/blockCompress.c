@@ -0,0 +1,444 @@
+#include "blockCompress.h"
+
+#include <string.h>
+
+#define HASH_LOG 12
+#define MIN_MATCH 4
+// The format ends every block with at least this many literals...
+#define LAST_LITERALS 5
+// ...and no match starts in the last MF_LIMIT bytes.
+#define MF_LIMIT 12
+#define MAX_OFFSET 65535
+// How many misses before the search starts skipping ahead faster.
+#define SKIP_TRIGGER 6
+
+typedef enum decodeStage {
+    STAGE_TOKEN,
+    STAGE_LIT_LEN,
+    STAGE_LITERALS,
+    STAGE_OFFSET_LO,
+    STAGE_OFFSET_HI,
+    STAGE_MATCH_LEN,
+} decodeStage;
+
+static inline u32 read32(const u8* p) {
+    u32 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline u64 read64(const u8* p) {
+    u64 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void copy8(u8* dst, const u8* src) {
+    memcpy(dst, src, 8);
+}
+
+static inline void copy16(u8* dst, const u8* src) {
+    memcpy(dst, src, 16);
+}
+
+static inline u32 hash4(u32 v) {
+    return (v * 2654435761U) >> (32 - HASH_LOG);
+}
+
+static u8* writeLen(u8* op, u64 len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (u8)len;
+    return op;
+}
+
+// Writes a literal run and the start of its token. Returns 0 if it won't fit.
+static u8* writeLiterals(u8* op, u8* oend, const u8* lits, u64 litLen, u8** outToken) {
+    if ((u64)(oend - op) < 1 + litLen / 255 + 1 + litLen) {
+        return 0;
+    }
+    u8* token = op++;
+    if (litLen >= 15) {
+        *token = 15 << 4;
+        op = writeLen(op, litLen - 15);
+    } else {
+        *token = (u8)(litLen << 4);
+    }
+    memcpy(op, lits, litLen);
+    *outToken = token;
+    return op + litLen;
+}
+
+u64 blockCompressBound(u64 srcSize) {
+    return srcSize + srcSize / 255 + 16;
+}
+
+u64 blockCompress(const void* src, u64 srcSize, void* dst, u64 dstCapacity) {
+    if (srcSize > 0xFFFFFFFFULL) {
+        return 0;
+    }
+    const u8* base = src;
+    const u8* ip = base;
+    const u8* anchor = base;
+    const u8* iend = base + srcSize;
+    u8* op = dst;
+    u8* oend = op + dstCapacity;
+    u8* token;
+
+    if (srcSize > MF_LIMIT) {
+        // Offsets from base of the last position seen with each hash.
+        u32 table[1 << HASH_LOG] = {0};
+        const u8* mflimit = iend - MF_LIMIT;
+        const u8* matchlimit = iend - LAST_LITERALS;
+        ip++;
+
+        for (;;) {
+            const u8* ref;
+            u32 step = 1;
+            u32 searchCnt = 1 << SKIP_TRIGGER;
+            for (;;) {
+                if (ip > mflimit) {
+                    goto last;
+                }
+                u32 h = hash4(read32(ip));
+                ref = base + table[h];
+                table[h] = (u32)(ip - base);
+                if (ref < ip && ip - ref <= MAX_OFFSET && read32(ref) == read32(ip)) {
+                    break;
+                }
+                ip += step;
+                step = searchCnt++ >> SKIP_TRIGGER;
+            }
+            while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+                ip--;
+                ref--;
+            }
+
+            op = writeLiterals(op, oend, anchor, (u64)(ip - anchor), &token);
+            if (!op || oend - op < 2) {
+                return 0;
+            }
+            u32 offset = (u32)(ip - ref);
+            *op++ = (u8)offset;
+            *op++ = (u8)(offset >> 8);
+
+            ip += MIN_MATCH;
+            ref += MIN_MATCH;
+            const u8* matchStart = ip;
+            while (ip < matchlimit - 7) {
+                u64 diff = read64(ip) ^ read64(ref);
+                if (diff) {
+                    ip += __builtin_ctzll(diff) >> 3;
+                    goto counted;
+                }
+                ip += 8;
+                ref += 8;
+            }
+            while (ip < matchlimit && *ip == *ref) {
+                ip++;
+                ref++;
+            }
+        counted:;
+            // The 8 byte compare can run past matchlimit.
+            if (ip > matchlimit) {
+                ip = matchlimit;
+            }
+            u64 matchLen = (u64)(ip - matchStart);
+            if ((u64)(oend - op) < 1 + matchLen / 255) {
+                return 0;
+            }
+            if (matchLen >= 15) {
+                *token |= 15;
+                op = writeLen(op, matchLen - 15);
+            } else {
+                *token |= (u8)matchLen;
+            }
+            anchor = ip;
+            if (ip > mflimit) {
+                break;
+            }
+            table[hash4(read32(ip - 2))] = (u32)(ip - 2 - base);
+        }
+    }
+
+last:
+    op = writeLiterals(op, oend, anchor, (u64)(iend - anchor), &token);
+    if (!op) {
+        return 0;
+    }
+    return (u64)(op - (u8*)dst);
+}
+
+// Copies a match out of the output already written. Fine with the match
+// overlapping where it's copied to.
+static inline void copyMatch(u8* op, u8* oend, u32 offset, u64 len) {
+    const u8* match = op - offset;
+    u8* end = op + len;
+    if ((u64)(oend - op) < len + 16) {
+        while (op < end) {
+            *op++ = *match++;
+        }
+        return;
+    }
+    if (offset >= 16) {
+        for (; op < end; op += 16, match += 16) {
+            copy16(op, match);
+        }
+        return;
+    }
+    if (offset < 8) {
+        // Repeat short patterns, like runs of the same pixel, until the match
+        // is at least 8 back so the rest can go 8 bytes at a time.
+        static const u32 inc[8] = {0, 1, 2, 1, 0, 4, 4, 4};
+        static const i32 dec[8] = {0, 0, 0, -1, -4, 1, 2, 3};
+        op[0] = match[0];
+        op[1] = match[1];
+        op[2] = match[2];
+        op[3] = match[3];
+        match += inc[offset];
+        memcpy(op + 4, match, 4);
+        match -= dec[offset];
+    } else {
+        copy8(op, match);
+        match += 8;
+    }
+    for (op += 8; op < end; op += 8, match += 8) {
+        copy8(op, match);
+    }
+}
+
+// Decodes whole sequences while they're all in the input. Leaves the decoder
+// at the start of the first one that isn't.
+static const u8* decodeFast(blockDecoder* d, const u8* ip, const u8* iend) {
+    u8* const ostart = d->dst;
+    u8* const oend = d->dst + d->dstSize;
+    u8* op = ostart + d->dstPos;
+
+    while (ip < iend) {
+        const u8* seq = ip;
+        u32 token = *ip++;
+
+        // Most sequences are short with a nearby match, so copy those as a
+        // few fixed size chunks without any of the checks below.
+        u32 shortLit = token >> 4;
+        u32 shortMatch = token & 15;
+        if (shortLit < 15 && shortMatch < 15 && iend - ip >= 16 && oend - op >= 40) {
+            copy16(op, ip);
+            op += shortLit;
+            ip += shortLit;
+            u32 offset = ip[0] | ((u32)ip[1] << 8);
+            if (offset >= 8 && offset <= (u64)(op - ostart)) {
+                ip += 2;
+                const u8* match = op - offset;
+                copy8(op, match);
+                copy8(op + 8, match + 8);
+                copy8(op + 16, match + 16);
+                op += shortMatch + MIN_MATCH;
+                continue;
+            }
+            // Take the long way with the literals already copied.
+            op -= shortLit;
+            ip -= shortLit;
+        }
+
+        u64 litLen = token >> 4;
+        if (litLen == 15) {
+            u32 b;
+            do {
+                if (ip >= iend) {
+                    ip = seq;
+                    goto out;
+                }
+                b = *ip++;
+                litLen += b;
+            } while (b == 255);
+        }
+        if ((u64)(iend - ip) < litLen) {
+            ip = seq;
+            goto out;
+        }
+        if ((u64)(oend - op) < litLen) {
+            d->result = BLOCK_DECODER_CORRUPT;
+            goto out;
+        }
+        if ((u64)(oend - op) >= litLen + 16 && (u64)(iend - ip) >= litLen + 16) {
+            for (u64 i = 0; i < litLen; i += 16) {
+                copy16(op + i, ip + i);
+            }
+        } else {
+            memcpy(op, ip, litLen);
+        }
+        op += litLen;
+        ip += litLen;
+        if (op == oend) {
+            d->result = BLOCK_DECODER_DONE;
+            goto out;
+        }
+
+        if (iend - ip < 2) {
+            op -= litLen;
+            ip = seq;
+            goto out;
+        }
+        u32 offset = ip[0] | ((u32)ip[1] << 8);
+        ip += 2;
+        u64 matchLen = token & 15;
+        if (matchLen == 15) {
+            u32 b;
+            do {
+                if (ip >= iend) {
+                    op -= litLen;
+                    ip = seq;
+                    goto out;
+                }
+                b = *ip++;
+                matchLen += b;
+            } while (b == 255);
+        }
+        matchLen += MIN_MATCH;
+        if (offset == 0 || offset > (u64)(op - ostart) || (u64)(oend - op) < matchLen) {
+            d->result = BLOCK_DECODER_CORRUPT;
+            goto out;
+        }
+        copyMatch(op, oend, offset, matchLen);
+        op += matchLen;
+    }
+
+out:
+    d->dstPos = (u64)(op - ostart);
+    return ip;
+}
+
+// Steps through a sequence a byte at a time for when it's split across pieces.
+// Stops once the sequence is done or the input runs out.
+static const u8* decodeSlow(blockDecoder* d, const u8* ip, const u8* iend) {
+    for (;;) {
+        switch (d->stage) {
+            case STAGE_TOKEN: {
+                if (ip >= iend) {
+                    return ip;
+                }
+                u8 token = *ip++;
+                d->litRemaining = token >> 4;
+                d->matchLen = token & 15;
+                d->stage = d->litRemaining == 15 ? STAGE_LIT_LEN : STAGE_LITERALS;
+            } break;
+            case STAGE_LIT_LEN: {
+                if (ip >= iend) {
+                    return ip;
+                }
+                u8 b = *ip++;
+                d->litRemaining += b;
+                if (b != 255) {
+                    d->stage = STAGE_LITERALS;
+                }
+            } break;
+            case STAGE_LITERALS: {
+                if (d->dstSize - d->dstPos < d->litRemaining) {
+                    d->result = BLOCK_DECODER_CORRUPT;
+                    return ip;
+                }
+                u64 n = (u64)(iend - ip);
+                if (n > d->litRemaining) {
+                    n = d->litRemaining;
+                }
+                memcpy(d->dst + d->dstPos, ip, n);
+                d->dstPos += n;
+                d->litRemaining -= n;
+                ip += n;
+                if (d->litRemaining) {
+                    return ip;
+                }
+                if (d->dstPos == d->dstSize) {
+                    d->result = BLOCK_DECODER_DONE;
+                    return ip;
+                }
+                d->stage = STAGE_OFFSET_LO;
+            } break;
+            case STAGE_OFFSET_LO: {
+                if (ip >= iend) {
+                    return ip;
+                }
+                d->offset = *ip++;
+                d->stage = STAGE_OFFSET_HI;
+            } break;
+            case STAGE_OFFSET_HI:
+            case STAGE_MATCH_LEN: {
+                if (ip >= iend) {
+                    return ip;
+                }
+                u8 b = *ip++;
+                if (d->stage == STAGE_OFFSET_HI) {
+                    d->offset |= (u32)b << 8;
+                    if (d->matchLen == 15) {
+                        d->stage = STAGE_MATCH_LEN;
+                        break;
+                    }
+                } else {
+                    d->matchLen += b;
+                    if (b == 255) {
+                        break;
+                    }
+                }
+                u64 matchLen = d->matchLen + MIN_MATCH;
+                if (d->offset == 0 || d->offset > d->dstPos || d->dstSize - d->dstPos < matchLen) {
+                    d->result = BLOCK_DECODER_CORRUPT;
+                    return ip;
+                }
+                copyMatch(d->dst + d->dstPos, d->dst + d->dstSize, d->offset, matchLen);
+                d->dstPos += matchLen;
+                d->stage = STAGE_TOKEN;
+                return ip;
+            }
+        }
+    }
+}
+
+b8 blockDecompress(const void* src, u64 srcSize, void* dst, u64 dstSize) {
+    blockDecoder d;
+    blockDecoderBegin(&d, dst, dstSize);
+    return blockDecoderUpdate(&d, src, srcSize) == BLOCK_DECODER_DONE;
+}
+
+void blockDecoderBegin(blockDecoder* decoder, void* dst, u64 dstSize) {
+    decoder->dst = dst;
+    decoder->dstSize = dstSize;
+    decoder->dstPos = 0;
+    decoder->stage = STAGE_TOKEN;
+    decoder->litRemaining = 0;
+    decoder->matchLen = 0;
+    decoder->offset = 0;
+    decoder->result = BLOCK_DECODER_NEED_INPUT;
+}
+
+blockDecoderResult blockDecoderUpdate(blockDecoder* decoder, const void* src, u64 srcSize) {
+    if (decoder->result != BLOCK_DECODER_NEED_INPUT) {
+        if (decoder->result == BLOCK_DECODER_DONE && srcSize > 0) {
+            decoder->result = BLOCK_DECODER_CORRUPT;
+        }
+        return decoder->result;
+    }
+
+    const u8* ip = src;
+    const u8* iend = ip + srcSize;
+    for (;;) {
+        if (decoder->stage == STAGE_TOKEN) {
+            ip = decodeFast(decoder, ip, iend);
+            if (decoder->result != BLOCK_DECODER_NEED_INPUT) {
+                break;
+            }
+        }
+        ip = decodeSlow(decoder, ip, iend);
+        // Stopping partway through a sequence means the input ran out.
+        if (decoder->result != BLOCK_DECODER_NEED_INPUT || decoder->stage != STAGE_TOKEN || ip >= iend) {
+            break;
+        }
+    }
+
+    if (decoder->result == BLOCK_DECODER_DONE && ip != iend) {
+        decoder->result = BLOCK_DECODER_CORRUPT;
+    }
+    return decoder->result;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "defines.h"
+
+/*
+ * LZ4 style block compression. Blocks use the LZ4 block format: sequences of
+ * literals followed by a match up to 64 KiB back. Made for assets, so it
+ * favours decode speed over ratio. Nothing here keeps global state, so
+ * blocks can be compressed and decompressed on any thread.
+ */
+
+typedef enum blockDecoderResult {
+    // Everything given so far was decoded, the block needs more input.
+    BLOCK_DECODER_NEED_INPUT,
+    // The destination is full and the block ended cleanly.
+    BLOCK_DECODER_DONE,
+    // The block is corrupt or doesn't fit the destination.
+    BLOCK_DECODER_CORRUPT,
+} blockDecoderResult;
+
+/**
+ * @brief Decodes a block handed over in pieces, like reads off of disk,
+ * straight into its final buffer. Matches are copied out of that buffer so
+ * no history or staging copy is kept.
+ */
+typedef struct blockDecoder {
+    u8* dst;
+    u64 dstSize;
+    u64 dstPos;
+    // Where a sequence split across pieces left off.
+    u32 stage;
+    u64 litRemaining;
+    u64 matchLen;
+    u32 offset;
+    blockDecoderResult result;
+} blockDecoder;
+
+/**
+ * @brief Gets the most a compressed block can take up.
+ *
+ * @param srcSize The size of the data to compress.
+ * @returns The size a destination needs to be so compression can't fail.
+ */
+FSNAPI u64 blockCompressBound(u64 srcSize);
+
+/**
+ * @brief Compresses data into one block.
+ *
+ * @param src The data to compress.
+ * @param srcSize The data's size. Has to be under 4 GiB.
+ * @param dst Where to write the block.
+ * @param dstCapacity The size of dst.
+ * @returns The block's size, or 0 if it didn't fit in dst.
+ */
+FSNAPI u64 blockCompress(const void* src, u64 srcSize, void* dst, u64 dstCapacity);
+
+/**
+ * @brief Decompresses a whole block.
+ *
+ * @param src The block.
+ * @param srcSize The block's size.
+ * @param dst Where to write the data.
+ * @param dstSize The decompressed size. Has to match exactly.
+ * @returns true if the block decoded to exactly dstSize bytes.
+ */
+FSNAPI b8 blockDecompress(const void* src, u64 srcSize, void* dst, u64 dstSize);
+
+/**
+ * @brief Starts decoding a block into dst.
+ *
+ * @param decoder The decoder.
+ * @param dst Where to write the data. Must stay alive until the decoder is done.
+ * @param dstSize The decompressed size.
+ */
+FSNAPI void blockDecoderBegin(blockDecoder* decoder, void* dst, u64 dstSize);
+
+/**
+ * @brief Decodes the next piece of a block. Pieces can be split anywhere.
+ *
+ * @param decoder The decoder.
+ * @param src The next piece of the block.
+ * @param srcSize The piece's size.
+ * @returns Whether the block needs more, is done, or is corrupt. Input past
+ * the end of the block is corrupt.
+ */
+FSNAPI blockDecoderResult blockDecoderUpdate(blockDecoder* decoder, const void* src, u64 srcSize);
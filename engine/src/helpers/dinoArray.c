@@ -57,7 +57,7 @@ void _dino_field_set(void* array, u64 field, u64 value){
 void* _dino_push(void* array, const void* valuePtr){
     u64 length = dinoLength(array);
     u64 stride = dinoStride(array);
-    if (length >= DINOARRAY_MAX_SIZE){
+    if (length >= dinoMaxSize(array)){
         array = _dino_resize(array);
     }
     u64 idx = (u64)array;
@@ -75,7 +75,7 @@ void* _dino_insert_at(void* array, u64 idx, void* valuePtr){
         FERROR("DINO ERROR: Index was more than array length")
         return array;
     }
-    if (length >= DINOARRAY_MAX_SIZE){
+    if (length >= dinoMaxSize(array)){
         array = _dino_resize(array);
     }
     u64 memIdx = (u64)array;
@@ -1,5 +1,6 @@
 #include "freelist.h"
 
+#include "core/counters.h"
 #include "core/fmemory.h"
 #include "core/logger.h"
 
@@ -69,7 +70,9 @@ b8 freelistAllocateBlock(freelist* list, u64 size, u64* outOffset) {
     internalState* state = list->memory;
     freelistNode* node = state->head;
     freelistNode* previous = 0;
+    FCOUNTER_INC("freelist.allocations");
     while (node) {
+        FCOUNTER_INC("freelist.nodesWalked");
         if (node->size == size) {
             // Exact match. Just return the node.
             *outOffset = node->offset;
@@ -1,4 +1,5 @@
 #include "hashtable.h"
+#include "core/counters.h"
 #include "core/logger.h"
 #include "core/fmemory.h"
 #include "core/fstring.h"
@@ -66,7 +67,7 @@ b8 hashtableSet(hashtable* ht, const char* key, void* value){
             entry t;
             strNCpy(t.key, temp, 50);
             t.value = value;
-            fcopyMemory(e, &t, sizeof(entry) + ht->elementStride);
+            fcopyMemory(e, &t, sizeof(entry));
             return true;
         }
         y++;
@@ -79,8 +80,10 @@ b8 hashtableSet(hashtable* ht, const char* key, void* value){
 b8 hashtableGet(hashtable* ht, const char* key, void* outValue){
     int h = hash(key, ht->elementLength);
     int y = h;
+    FCOUNTER_INC("hashtable.lookups");
     for (int i = 0; i < ht->elementLength; i++) {
         entry* e = (entry*)(ht->memory + (sizeof(entry) * y));
+        FCOUNTER_INC("hashtable.probes");
         if (strEqual(e->key, INVALID_KEY)) {
             return false;
         }
@@ -101,8 +104,10 @@ b8 hashtableGet(hashtable* ht, const char* key, void* outValue){
 b8 hashtableGetID(hashtable* ht, const char* key, u64* outValue){
     int h = hash(key, ht->elementLength);
     int y = h;
+    FCOUNTER_INC("hashtable.lookups");
     for (int i = 0; i < ht->elementLength; i++) {
         entry* e = (entry*)(ht->memory + (sizeof(entry) * y));
+        FCOUNTER_INC("hashtable.probes");
         if (strEqual(e->key, INVALID_KEY)) {
             *outValue = y;
             return false;
@@ -0,0 +1,56 @@
+#include "sampleStats.h"
+
+#include "core/fmemory.h"
+#include "math/fsnmath.h"
+
+#include <stdlib.h>
+
+static int compareF64(const void* a, const void* b) {
+    f64 x = *(const f64*)a;
+    f64 y = *(const f64*)b;
+    return (x > y) - (x < y);
+}
+
+void sampleStatsCompute(const f64* samples, u32 count, f64* scratch,
+                        sampleStats* outStats) {
+    fzeroMemory(outStats, sizeof(sampleStats));
+    if (count == 0) {
+        return;
+    }
+
+    fcopyMemory(scratch, samples, sizeof(f64) * count);
+    qsort(scratch, count, sizeof(f64), compareF64);
+
+    f64 sum = 0;
+    for (u32 i = 0; i < count; ++i) {
+        sum += scratch[i];
+    }
+    f64 mean = sum / count;
+    f64 variance = 0;
+    for (u32 i = 0; i < count; ++i) {
+        f64 d = scratch[i] - mean;
+        variance += d * d;
+    }
+
+    outStats->count = count;
+    outStats->min = scratch[0];
+    outStats->max = scratch[count - 1];
+    outStats->mean = mean;
+    outStats->stddev = count > 1 ? fsnSqrt(variance / (count - 1)) : 0;
+    outStats->p50 = sampleStatsPercentile(scratch, count, 50);
+    outStats->p95 = sampleStatsPercentile(scratch, count, 95);
+    outStats->p99 = sampleStatsPercentile(scratch, count, 99);
+}
+
+f64 sampleStatsPercentile(const f64* sorted, u32 count, f64 percentile) {
+    if (count == 0) {
+        return 0;
+    }
+    f64 rank = (percentile / 100.0) * (count - 1);
+    u32 lo = (u32)rank;
+    if (lo >= count - 1) {
+        return sorted[count - 1];
+    }
+    f64 t = rank - lo;
+    return sorted[lo] + (sorted[lo + 1] - sorted[lo]) * t;
+}
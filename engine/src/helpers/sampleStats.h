@@ -0,0 +1,41 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @brief Summary of a set of samples.
+ */
+typedef struct sampleStats {
+    u32 count;
+    f64 min;
+    f64 max;
+    f64 mean;
+    f64 stddev;
+    f64 p50;
+    f64 p95;
+    f64 p99;
+} sampleStats;
+
+/**
+ * @brief Computes the min, max, mean, standard deviation and percentiles of a
+ * set of samples.
+ *
+ * @param samples The samples. Left untouched.
+ * @param count The number of samples.
+ * @param scratch A buffer of at least count f64s used for sorting. Holds the
+ * sorted samples afterwards.
+ * @param outStats A pointer to hold the stats.
+ */
+FSNAPI void sampleStatsCompute(const f64* samples, u32 count, f64* scratch,
+                               sampleStats* outStats);
+
+/**
+ * @brief Gets a percentile from sorted samples, interpolating between the
+ * closest two.
+ *
+ * @param sorted The samples sorted low to high.
+ * @param count The number of samples.
+ * @param percentile The percentile to get, from 0 to 100.
+ * @returns The percentile, or 0 if there are no samples.
+ */
+FSNAPI f64 sampleStatsPercentile(const f64* sorted, u32 count, f64 percentile);
@@ -0,0 +1,313 @@
+#include "fileWatch.h"
+
+#include "core/event.h"
+#include "core/fmemory.h"
+#include "core/fmutex.h"
+#include "core/fstring.h"
+#include "core/fthread.h"
+#include "core/logger.h"
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include <sys/stat.h>
+
+#if FSNPLATFORM_LINUX
+#include <errno.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#define FILE_WATCH_PATH_MAX 256
+// How often the thread checks whether it should stop when nothing changes.
+#define FILE_WATCH_IDLE_MS 250
+
+typedef struct watchedFile {
+    char path[FILE_WATCH_PATH_MAX];
+    // Where the file's name starts in path.
+    u32 nameOffset;
+    u32 refCnt;
+    // Changed since its last event and waiting to sit still.
+    b8 dirty;
+    u64 lastChangeNs;
+#if FSNPLATFORM_LINUX
+    // The inotify watch on the file's directory. Shared by files in the same directory.
+    i32 dirWd;
+#else
+    i64 modifiedTime;
+    i64 size;
+#endif
+} watchedFile;
+
+typedef struct fileWatchState {
+    fileWatchConfig config;
+    watchedFile* watches;
+    // Guards watches, the thread reads them while the main thread adds more.
+    fmutex mutex;
+    fthread thread;
+    b8 running;
+#if FSNPLATFORM_LINUX
+    i32 inotifyFd;
+#endif
+} fileWatchState;
+
+static fileWatchState* systemPtr;
+
+#if FSNPLATFORM_LINUX
+
+static void markChanged(i32 wd, const char* name, u64 now){
+    fmutexLock(&systemPtr->mutex);
+    for (u32 i = 0; i < systemPtr->config.maxWatches; ++i){
+        watchedFile* w = &systemPtr->watches[i];
+        if (w->refCnt && w->dirWd == wd && strEqual(w->path + w->nameOffset, name)){
+            w->dirty = true;
+            w->lastChangeNs = now;
+        }
+    }
+    fmutexUnlock(&systemPtr->mutex);
+}
+
+// Reads whatever inotify has, waiting up to timeoutMs for something to show up.
+static void readChanges(u32 timeoutMs){
+    struct pollfd pfd = {systemPtr->inotifyFd, POLLIN, 0};
+    if (poll(&pfd, 1, (int)timeoutMs) <= 0){
+        return;
+    }
+    _Alignas(struct inotify_event) char buffer[4096];
+    u64 now = platformGetTimestampNs();
+    for (;;){
+        ssize_t len = read(systemPtr->inotifyFd, buffer, sizeof(buffer));
+        if (len <= 0){
+            break;
+        }
+        for (char* p = buffer; p < buffer + len;){
+            struct inotify_event* e = (struct inotify_event*)p;
+            if (e->len){
+                markChanged(e->wd, e->name, now);
+            }
+            p += sizeof(struct inotify_event) + e->len;
+        }
+    }
+}
+
+#else
+
+static void readChanges(u32 timeoutMs){
+    platformSleep(timeoutMs);
+    u64 now = platformGetTimestampNs();
+    fmutexLock(&systemPtr->mutex);
+    for (u32 i = 0; i < systemPtr->config.maxWatches; ++i){
+        watchedFile* w = &systemPtr->watches[i];
+        if (!w->refCnt){
+            continue;
+        }
+        struct stat st;
+        i64 modifiedTime = -1;
+        i64 size = -1;
+        if (stat(w->path, &st) == 0){
+            modifiedTime = (i64)st.st_mtime;
+            size = (i64)st.st_size;
+        }
+        if (modifiedTime != w->modifiedTime || size != w->size){
+            w->modifiedTime = modifiedTime;
+            w->size = size;
+            w->dirty = true;
+            w->lastChangeNs = now;
+        }
+    }
+    fmutexUnlock(&systemPtr->mutex);
+}
+
+#endif
+
+// Fires events for files that have sat still long enough. Returns how long
+// until the next dirty file will have, or FILE_WATCH_IDLE_MS if none are dirty.
+static u32 fireSettled(){
+    u64 now = platformGetTimestampNs();
+    u64 debounceNs = (u64)systemPtr->config.debounceMs * 1000 * 1000;
+    u64 nextNs = (u64)FILE_WATCH_IDLE_MS * 1000 * 1000;
+    u32 settled[32];
+    b8 settledExists[32];
+    u32 settledCnt = 0;
+    fmutexLock(&systemPtr->mutex);
+    for (u32 i = 0; i < systemPtr->config.maxWatches && settledCnt < 32; ++i){
+        watchedFile* w = &systemPtr->watches[i];
+        if (!w->refCnt || !w->dirty){
+            continue;
+        }
+        u64 quietNs = now - w->lastChangeNs;
+        if (quietNs >= debounceNs){
+            w->dirty = false;
+            // Whether it's still there once things settled down is what
+            // counts. A save that replaced the file is just a write.
+            settledExists[settledCnt] = fsExists(w->path);
+            settled[settledCnt++] = i;
+        } else if (debounceNs - quietNs < nextNs){
+            nextNs = debounceNs - quietNs;
+        }
+    }
+    fmutexUnlock(&systemPtr->mutex);
+
+    for (u32 i = 0; i < settledCnt; ++i){
+        eventContext context = {};
+        context.data.u32[0] = settled[i];
+        eventFire(settledExists[i] ? EVENT_CODE_WATCHED_FILE_WRITTEN : EVENT_CODE_WATCHED_FILE_DELETED, 0, context);
+    }
+    // More might have settled than fit, come straight back for them.
+    if (settledCnt == 32){
+        return 0;
+    }
+    return (u32)(nextNs / (1000 * 1000)) + 1;
+}
+
+static u32 fileWatchThread(void* params){
+    while (__atomic_load_n(&systemPtr->running, __ATOMIC_ACQUIRE)){
+        u32 timeoutMs = fireSettled();
+        readChanges(timeoutMs);
+    }
+    return 0;
+}
+
+b8 fileWatchInit(u64* memoryRequirement, void* state, fileWatchConfig config){
+    if (config.maxWatches == 0){
+        config.maxWatches = 256;
+    }
+    if (config.debounceMs == 0){
+        config.debounceMs = 100;
+    }
+    *memoryRequirement = sizeof(fileWatchState) + sizeof(watchedFile) * config.maxWatches;
+    if (state == 0){
+        return true;
+    }
+    fzeroMemory(state, *memoryRequirement);
+    systemPtr = state;
+    systemPtr->config = config;
+    systemPtr->watches = (watchedFile*)(systemPtr + 1);
+
+    // Nothing needs watching to run, so failing here just turns hot reload off.
+#if FSNPLATFORM_LINUX
+    systemPtr->inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (systemPtr->inotifyFd < 0){
+        FWARN("File watch couldn't init inotify, errno %i. Files won't be watched.", errno);
+        systemPtr = 0;
+        return true;
+    }
+#endif
+    b8 mutexCreated = fmutexCreate(&systemPtr->mutex);
+    systemPtr->running = true;
+    if (!mutexCreated || !fthreadCreate(fileWatchThread, 0, false, &systemPtr->thread)){
+        FERROR("File watch couldn't start its thread.");
+        if (mutexCreated){
+            fmutexDestroy(&systemPtr->mutex);
+        }
+#if FSNPLATFORM_LINUX
+        close(systemPtr->inotifyFd);
+#endif
+        systemPtr = 0;
+        return false;
+    }
+    return true;
+}
+
+void fileWatchShutdown(void* state){
+    if (!systemPtr){
+        return;
+    }
+    __atomic_store_n(&systemPtr->running, false, __ATOMIC_RELEASE);
+    fthreadWait(&systemPtr->thread);
+    fthreadDestroy(&systemPtr->thread);
+#if FSNPLATFORM_LINUX
+    // Closing it drops every watch.
+    close(systemPtr->inotifyFd);
+#endif
+    fmutexDestroy(&systemPtr->mutex);
+    systemPtr = 0;
+}
+
+u32 fileWatchAdd(const char* path){
+    if (!systemPtr || !path){
+        return INVALID_ID;
+    }
+    u32 pathLen = strLen(path);
+    if (pathLen >= FILE_WATCH_PATH_MAX){
+        FWARN("File watch path is too long: %s", path);
+        return INVALID_ID;
+    }
+
+    fmutexLock(&systemPtr->mutex);
+    u32 freeIdx = INVALID_ID;
+    for (u32 i = 0; i < systemPtr->config.maxWatches; ++i){
+        watchedFile* w = &systemPtr->watches[i];
+        if (w->refCnt && strEqual(w->path, path)){
+            w->refCnt++;
+            fmutexUnlock(&systemPtr->mutex);
+            return i;
+        }
+        if (!w->refCnt && freeIdx == INVALID_ID){
+            freeIdx = i;
+        }
+    }
+    if (freeIdx == INVALID_ID){
+        fmutexUnlock(&systemPtr->mutex);
+        FWARN("File watch is out of watches, not watching %s", path);
+        return INVALID_ID;
+    }
+
+    watchedFile* w = &systemPtr->watches[freeIdx];
+    strNCpy(w->path, path, FILE_WATCH_PATH_MAX);
+    w->nameOffset = 0;
+    for (u32 i = 0; i < pathLen; ++i){
+        if (path[i] == '/' || path[i] == '\\'){
+            w->nameOffset = i + 1;
+        }
+    }
+    w->dirty = false;
+#if FSNPLATFORM_LINUX
+    // Watch the directory, editors often replace files instead of writing to them.
+    char dir[FILE_WATCH_PATH_MAX];
+    if (w->nameOffset){
+        strNCpy(dir, path, w->nameOffset);
+        dir[w->nameOffset - 1] = 0;
+    } else {
+        strCpy(dir, ".");
+    }
+    w->dirWd = inotify_add_watch(systemPtr->inotifyFd, dir[0] ? dir : "/", IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_MOVED_FROM);
+    if (w->dirWd < 0){
+        fmutexUnlock(&systemPtr->mutex);
+        FWARN("File watch couldn't watch %s, errno %i", path, errno);
+        return INVALID_ID;
+    }
+#else
+    struct stat st;
+    w->modifiedTime = stat(path, &st) == 0 ? (i64)st.st_mtime : -1;
+    w->size = w->modifiedTime == -1 ? -1 : (i64)st.st_size;
+#endif
+    w->refCnt = 1;
+    fmutexUnlock(&systemPtr->mutex);
+    return freeIdx;
+}
+
+void fileWatchRemove(u32 watchId){
+    if (!systemPtr || watchId >= systemPtr->config.maxWatches){
+        return;
+    }
+    fmutexLock(&systemPtr->mutex);
+    watchedFile* w = &systemPtr->watches[watchId];
+    if (w->refCnt && --w->refCnt == 0){
+        w->dirty = false;
+#if FSNPLATFORM_LINUX
+        // The directory's watch goes once nothing else in it is watched.
+        b8 shared = false;
+        for (u32 i = 0; i < systemPtr->config.maxWatches; ++i){
+            if (systemPtr->watches[i].refCnt && systemPtr->watches[i].dirWd == w->dirWd){
+                shared = true;
+                break;
+            }
+        }
+        if (!shared){
+            inotify_rm_watch(systemPtr->inotifyFd, w->dirWd);
+        }
+#endif
+    }
+    fmutexUnlock(&systemPtr->mutex);
+}
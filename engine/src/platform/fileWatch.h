@@ -0,0 +1,52 @@
+#pragma once
+
+#include "defines.h"
+
+/*
+ * Watches files on disk from a background thread and fires
+ * EVENT_CODE_WATCHED_FILE_WRITTEN or EVENT_CODE_WATCHED_FILE_DELETED with the
+ * watch's id in context.data.u32[0]. Saving usually touches a file a few
+ * times in a row, so an event only fires once the file has gone debounceMs
+ * without changing. The events come from another thread, so they get
+ * delivered on the main thread by eventFlushDeferred.
+ *
+ * Linux uses inotify on the file's directory, which also catches editors that
+ * save by writing a new file and renaming it over the old one. Everywhere
+ * else the files' modified times get polled.
+ */
+
+typedef struct fileWatchConfig {
+    // 0 uses 256.
+    u32 maxWatches;
+    // How long a file has to sit still before its event fires. 0 uses 100.
+    u32 debounceMs;
+} fileWatchConfig;
+
+/**
+ * @brief Inits the file watcher and starts its thread.
+ * @param memoryRequirement Gets set to the memory the watcher needs
+ * @param state The watcher's memory. 0 to just get the memoryRequirement
+ * @param config The watcher's config
+ * @returns true if successful, false if failed
+ */
+b8 fileWatchInit(u64* memoryRequirement, void* state, fileWatchConfig config);
+
+/**
+ * @brief Stops the watcher's thread and drops every watch.
+ * @param state The watcher's memory
+ */
+void fileWatchShutdown(void* state);
+
+/**
+ * @brief Starts watching a file. Watching a file again gives the same id,
+ * and it has to be removed as many times as it was added.
+ * @param path The file. It has to exist
+ * @returns The watch's id, or INVALID_ID if it can't be watched
+ */
+FSNAPI u32 fileWatchAdd(const char* path);
+
+/**
+ * @brief Stops watching a file. Events already fired for it still get delivered.
+ * @param watchId The watch's id
+ */
+FSNAPI void fileWatchRemove(u32 watchId);
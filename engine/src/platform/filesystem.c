@@ -7,9 +7,26 @@
 #include <string.h>
 #include <sys/stat.h>
 
+#if FSNPLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 b8 fsExists(const char* path){
     struct stat x;
-    return stat(path,&x);
+    return stat(path,&x) == 0;
+}
+
+b8 fsCreateDirectory(const char* path){
+#if FSNPLATFORM_WINDOWS
+    return CreateDirectoryA(path, 0) || GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+#endif
 }
 
 b8 fsOpen(const char* path, fileModes mode, b8 binary, fileHandle* outHandle){
@@ -24,11 +41,14 @@ b8 fsOpen(const char* path, fileModes mode, b8 binary, fileHandle* outHandle){
         str = binary ? "rb" : "r";
     }else if ((mode & FILE_MODE_WRITE) != 0 && (mode & FILE_MODE_READ) == 0){
         str = binary ? "wb" : "w";
+    }else{
+        FERROR("FS: Opening '%s' needs a read or write mode", path);
+        return false;
     }
     //Open the file
     FILE* file = fopen(path, str);
     if (!file){
-        FERROR("FS: Failed to open file");
+        FERROR("FS: Failed to open file '%s'", path);
         return false;
     }
     //Set the outHandle
@@ -82,10 +102,13 @@ b8 fsRead(fileHandle* fh, u64 dataSize, void* outData, u64* outBytesRead){
 }
 
 b8 fsSize(fileHandle* handle, u64* outSize){
-    if (handle->handle) {
-        fseek((FILE*)handle->handle, 0, SEEK_END);
-        *outSize = ftell((FILE*)handle->handle);
-        rewind((FILE*)handle->handle);
+    if (handle->handle && outSize) {
+        // Ask the OS instead of seeking so the read position is left alone.
+        struct stat st;
+        if (fstat(fileno((FILE*)handle->handle), &st) != 0) {
+            return false;
+        }
+        *outSize = (u64)st.st_size;
         return true;
     }
     return false;
@@ -98,6 +121,7 @@ b8 fsReadFileBytes(fileHandle* fh, u8* outData, u64* outBytesRead){
         if(!fsSize(fh, &size)) {
             return false;
         }
+        rewind((FILE*)fh->handle);
 
         *outBytesRead = fread(outData, 1, size, (FILE*)fh->handle);
         return *outBytesRead == size;
@@ -112,6 +136,7 @@ b8 fsReadFileChars(fileHandle* handle, char* outChars, u64* outBytesRead){
         if(!fsSize(handle, &size)) {
             return false;
         }
+        rewind((FILE*)handle->handle);
 
         *outBytesRead = fread(outChars, 1, size, (FILE*)handle->handle);
         return *outBytesRead == size;
@@ -132,3 +157,173 @@ b8 fsWrite(fileHandle* fh, u64 dataSize, const void* data, u64* outBytesWritten)
     return false;
 }
 
+b8 fsMap(const char* path, fileMapHints hints, fileMapping* outMapping){
+    if (!path || !outMapping){
+        return false;
+    }
+    outMapping->data = 0;
+    outMapping->size = 0;
+#if FSNPLATFORM_WINDOWS
+    DWORD flags = FILE_ATTRIBUTE_NORMAL;
+    if (hints & FILE_MAP_HINT_SEQUENTIAL){
+        flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+    }
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, flags, 0);
+    if (file == INVALID_HANDLE_VALUE){
+        FERROR("FS: Failed to open '%s' to map", path);
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)){
+        FERROR("FS: Failed to get the size of '%s' to map", path);
+        CloseHandle(file);
+        return false;
+    }
+    if (size.QuadPart == 0){
+        // Empty files can't be mapped, there's nothing to view anyway.
+        CloseHandle(file);
+        return true;
+    }
+    HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+    const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : 0;
+    // The view keeps the file mapped on its own.
+    if (mapping){
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+    if (!view){
+        FERROR("FS: Failed to map '%s'", path);
+        return false;
+    }
+    if (hints & FILE_MAP_HINT_WILL_NEED){
+        WIN32_MEMORY_RANGE_ENTRY range = {(void*)view, (SIZE_T)size.QuadPart};
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+    outMapping->data = view;
+    outMapping->size = (u64)size.QuadPart;
+    return true;
+#else
+    i32 fd = open(path, O_RDONLY);
+    if (fd < 0){
+        FERROR("FS: Failed to open '%s' to map", path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0){
+        FERROR("FS: Failed to get the size of '%s' to map", path);
+        close(fd);
+        return false;
+    }
+    if (st.st_size == 0){
+        // Empty files can't be mapped, there's nothing to view anyway.
+        close(fd);
+        return true;
+    }
+    void* view = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file open on its own.
+    close(fd);
+    if (view == MAP_FAILED){
+        FERROR("FS: Failed to map '%s'", path);
+        return false;
+    }
+    if (hints & FILE_MAP_HINT_SEQUENTIAL){
+        madvise(view, (size_t)st.st_size, MADV_SEQUENTIAL);
+    }
+    if (hints & FILE_MAP_HINT_WILL_NEED){
+        madvise(view, (size_t)st.st_size, MADV_WILLNEED);
+    }
+    outMapping->data = view;
+    outMapping->size = (u64)st.st_size;
+    return true;
+#endif
+}
+
+void fsUnmap(fileMapping* mapping){
+    if (!mapping || !mapping->data){
+        return;
+    }
+#if FSNPLATFORM_WINDOWS
+    UnmapViewOfFile(mapping->data);
+#else
+    munmap((void*)mapping->data, (size_t)mapping->size);
+#endif
+    mapping->data = 0;
+    mapping->size = 0;
+}
+
+b8 fsReaderOpen(const char* path, fsReader* outReader){
+    if (!path || !outReader){
+        return false;
+    }
+    outReader->data = 0;
+    outReader->size = 0;
+    outReader->pos = 0;
+    outReader->lineNumber = 0;
+    outReader->mapping.data = 0;
+    outReader->mapping.size = 0;
+
+    fileHandle f;
+    if (!fsOpen(path, FILE_MODE_READ, true, &f)){
+        return false;
+    }
+    u64 size = 0;
+    if (!fsSize(&f, &size)){
+        FERROR("FS: Failed to get the size of '%s'", path);
+        fsClose(&f);
+        return false;
+    }
+    if (size <= FS_READER_BUFFER_SIZE){
+        u64 read = 0;
+        b8 ok = size == 0 || fsRead(&f, size, outReader->buffer, &read);
+        fsClose(&f);
+        if (!ok){
+            FERROR("FS: Failed to read '%s'", path);
+            return false;
+        }
+        outReader->data = outReader->buffer;
+        outReader->size = size;
+        return true;
+    }
+
+    fsClose(&f);
+    if (!fsMap(path, FILE_MAP_HINT_SEQUENTIAL, &outReader->mapping)){
+        return false;
+    }
+    outReader->data = outReader->mapping.data;
+    outReader->size = outReader->mapping.size;
+    return true;
+}
+
+void fsReaderOpenMemory(const void* data, u64 size, fsReader* outReader){
+    outReader->data = data;
+    outReader->size = size;
+    outReader->pos = 0;
+    outReader->lineNumber = 0;
+    outReader->mapping.data = 0;
+    outReader->mapping.size = 0;
+}
+
+b8 fsReaderNextLine(fsReader* reader, strView* outLine){
+    if (reader->pos >= reader->size){
+        return false;
+    }
+    const char* start = reader->data + reader->pos;
+    u64 remaining = reader->size - reader->pos;
+    const char* end = memchr(start, '\n', remaining);
+    u64 len = end ? (u64)(end - start) : remaining;
+    reader->pos += end ? len + 1 : len;
+    if (len && start[len - 1] == '\r'){
+        len--;
+    }
+    outLine->str = start;
+    outLine->len = len;
+    reader->lineNumber++;
+    return true;
+}
+
+void fsReaderClose(fsReader* reader){
+    fsUnmap(&reader->mapping);
+    reader->data = 0;
+    reader->size = 0;
+    reader->pos = 0;
+}
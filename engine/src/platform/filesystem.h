@@ -1,6 +1,7 @@
 #pragma once
 
 #include "defines.h"
+#include "core/fstring.h"
 
 // Holds a handle to a file.
 typedef struct fileHandle {
@@ -14,6 +15,49 @@ typedef enum fileModes {
     FILE_MODE_WRITE = 0x2
 } fileModes;
 
+// Hints for how a mapped file is going to be read.
+typedef enum fileMapHints {
+    FILE_MAP_HINT_NONE = 0x0,
+    // Read front to back, so the OS can read ahead and drop pages behind.
+    FILE_MAP_HINT_SEQUENTIAL = 0x1,
+    // All of it is needed soon, start paging it in now.
+    FILE_MAP_HINT_WILL_NEED = 0x2
+} fileMapHints;
+
+// A read-only view of a whole file in memory.
+typedef struct fileMapping {
+    // Writing through this faults. 0 for an empty file.
+    const void* data;
+    u64 size;
+} fileMapping;
+
+// Gets called once an async read is done. bytesRead comes up short when the
+// read ran past the end of the file.
+typedef void (*PFN_fsReadComplete)(void* userData, b8 success, u64 bytesRead);
+
+// Keeps many reads in flight from one thread. Reads are queued with
+// fsReadAsync, handed to the OS together by fsAsyncSubmit, and their callbacks
+// run on whichever thread calls fsAsyncPoll. On Linux that's one io_uring
+// submission, elsewhere or if io_uring isn't allowed the reads run as jobs.
+typedef struct fsAsyncQueue {
+    void* internalData;
+} fsAsyncQueue;
+
+// Files up to this size get read into an fsReader in one go, bigger ones get mapped.
+#define FS_READER_BUFFER_SIZE KIBIBYTES(16)
+
+// Hands out a text file's lines as views into one buffer instead of copying
+// each line out. The views are good until fsReaderClose.
+typedef struct fsReader {
+    const char* data;
+    u64 size;
+    u64 pos;
+    // The line number of the last line read, starting at 1. For error messages.
+    u32 lineNumber;
+    fileMapping mapping;
+    char buffer[FS_READER_BUFFER_SIZE];
+} fsReader;
+
 /**
  * Checks if a file with the given path exists.
  * @param path The path of the file to be checked.
@@ -21,6 +65,13 @@ typedef enum fileModes {
  */
 FSNAPI b8 fsExists(const char* path);
 
+/**
+ * Creates a directory if it isn't there already. Parent directories have to exist.
+ * @param path The path of the directory.
+ * @returns True if the directory exists afterwards; otherwise false.
+ */
+FSNAPI b8 fsCreateDirectory(const char* path);
+
 /** 
  * Attempt to open file located at path.
  * @param path The path of the file to be opened.
@@ -103,4 +154,109 @@ FSNAPI b8 fsReadFileChars(fileHandle* handle, char* outChars, u64* outBytesRead)
  * @param outBytesWritten A pointer to a number which will be populated with the number of bytes actually written to the file.
  * @returns True if successful; otherwise false.
  */
-FSNAPI b8 fsWrite(fileHandle* handle, u64 dataSize, const void* data, u64* outBytesWritten);
\ No newline at end of file
+FSNAPI b8 fsWrite(fileHandle* handle, u64 dataSize, const void* data, u64* outBytesWritten);
+
+/**
+ * Maps a whole file into memory read-only. Pages get read in as they're touched
+ * so nothing is copied and nothing comes off the heap.
+ * @param path The path of the file to map.
+ * @param hints How the mapping is going to be read. See fileMapHints.
+ * @param outMapping Gets the mapped view and its size.
+ * @returns True if mapped; otherwise false.
+ */
+FSNAPI b8 fsMap(const char* path, fileMapHints hints, fileMapping* outMapping);
+
+/**
+ * Unmaps a file mapped with fsMap. Its data can't be used after this.
+ * @param mapping The mapping to unmap.
+ */
+FSNAPI void fsUnmap(fileMapping* mapping);
+
+/**
+ * Opens a text file to read it line by line. Small files are read in with one
+ * read, big ones are mapped. Either way the file is only touched here.
+ * @param path The path of the file to read.
+ * @param outReader The reader. Big, keep it somewhere it can live until closed.
+ * @returns True if opened; otherwise false.
+ */
+FSNAPI b8 fsReaderOpen(const char* path, fsReader* outReader);
+
+/**
+ * Reads lines out of text that's already in memory, like an archive entry.
+ * @param data The text. Must outlive the reader.
+ * @param size The text's size.
+ * @param outReader The reader.
+ */
+FSNAPI void fsReaderOpenMemory(const void* data, u64 size, fsReader* outReader);
+
+/**
+ * Gets the next line, without its line ending.
+ * @param reader The reader.
+ * @param outLine A view of the line, good until the reader is closed.
+ * @returns True if there was a line; false at the end of the file.
+ */
+FSNAPI b8 fsReaderNextLine(fsReader* reader, strView* outLine);
+
+/**
+ * Closes the reader. Views of its lines can't be used after this.
+ * @param reader The reader.
+ */
+FSNAPI void fsReaderClose(fsReader* reader);
+
+/**
+ * Creates a queue for async reads.
+ * @param depth The most reads that can be queued or in flight at once.
+ * @param outQueue The queue.
+ * @returns True if created; otherwise false.
+ */
+FSNAPI b8 fsAsyncQueueCreate(u32 depth, fsAsyncQueue* outQueue);
+
+/**
+ * Waits for every read still in flight, without calling their callbacks, and
+ * destroys the queue.
+ * @param queue The queue.
+ */
+FSNAPI void fsAsyncQueueDestroy(fsAsyncQueue* queue);
+
+/**
+ * Queues a read from an offset in a file. Nothing is read until the queue is
+ * submitted. It doesn't move the handle's position.
+ * @param queue The queue.
+ * @param handle The file. Must stay open until the read is done.
+ * @param offset Where in the file to start reading.
+ * @param size How many bytes to read. Has to be under 2 GiB.
+ * @param outData Where to read to. Must stay alive until the read is done.
+ * @param callback Called from fsAsyncPoll once the read is done. Can queue more reads.
+ * @param userData Passed to the callback.
+ * @returns True if queued; false if the queue is full or the read is invalid.
+ */
+FSNAPI b8 fsReadAsync(fsAsyncQueue* queue, fileHandle* handle, u64 offset, u64 size, void* outData, PFN_fsReadComplete callback, void* userData);
+
+/**
+ * Hands every queued read to the OS at once.
+ * @param queue The queue.
+ * @returns How many reads were submitted.
+ */
+FSNAPI u32 fsAsyncSubmit(fsAsyncQueue* queue);
+
+/**
+ * Submits anything queued, then calls the callbacks of every read that's done.
+ * @param queue The queue.
+ * @param wait Whether to wait for at least one read if none are done yet.
+ * @returns How many reads finished.
+ */
+FSNAPI u32 fsAsyncPoll(fsAsyncQueue* queue, b8 wait);
+
+/**
+ * Gets how many reads are queued or in flight.
+ * @param queue The queue.
+ * @returns The number of reads that haven't had their callback called yet.
+ */
+FSNAPI u32 fsAsyncPendingCount(fsAsyncQueue* queue);
+
+/**
+ * Checks if the queue is running on io_uring instead of jobs.
+ * @param queue The queue.
+ * @returns True if the OS is doing the reads itself.
+ */
+FSNAPI b8 fsAsyncIsNative(fsAsyncQueue* queue);
@@ -0,0 +1,517 @@
+#include "filesystem.h"
+
+#include "core/fmemory.h"
+#include "core/fmutex.h"
+#include "core/fsemaphore.h"
+#include "core/jobSystem.h"
+#include "core/logger.h"
+
+#include <stdio.h>
+
+#if FSNPLATFORM_WINDOWS
+#include <io.h>
+#include <windows.h>
+#else
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+#if FSNPLATFORM_LINUX && !defined(FS_ASYNC_NO_IO_URING)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define FS_ASYNC_IO_URING 1
+#endif
+#endif
+
+// Reads that big can't report how much they read through io_uring.
+#define FS_ASYNC_MAX_READ 0x7FFFF000ULL
+
+typedef struct asyncRead {
+    struct asyncQueueState* queue;
+    fileHandle handle;
+    u64 offset;
+    u64 size;
+    void* dst;
+    PFN_fsReadComplete callback;
+    void* userData;
+    // Bytes read, or -1 if the read failed. Set by the job in the fallback.
+    i64 result;
+    // The next free read, when this one is free.
+    u32 nextFree;
+#if FS_ASYNC_IO_URING
+    struct iovec iov;
+#endif
+} asyncRead;
+
+typedef struct asyncQueueState {
+    u32 depth;
+    asyncRead* reads;
+    u32 freeHead;
+    // Reads queued but not submitted yet, in the order they were queued.
+    u32* queued;
+    u32 queuedCnt;
+    u32 inFlightCnt;
+    b8 native;
+
+    // The fallback's finished reads. Jobs push to done, fsAsyncPoll swaps it out.
+    fmutex doneMutex;
+    fsemaphore doneSignal;
+    u32* done;
+    u32 doneCnt;
+    u32* reaping;
+    // Signals a wait already took, owed to the reads that sent them.
+    u32 signalCredit;
+
+#if FS_ASYNC_IO_URING
+    i32 ringFd;
+    void* sqRing;
+    u64 sqRingSize;
+    void* cqRing;
+    u64 cqRingSize;
+    struct io_uring_sqe* sqes;
+    u64 sqesSize;
+    u32* sqTail;
+    u32 sqMask;
+    u32* sqArray;
+    u32* cqHead;
+    u32* cqTail;
+    u32 cqMask;
+    struct io_uring_cqe* cqes;
+    // Written to the submission ring but not taken by the kernel yet.
+    u32 ringUnsubmitted;
+#endif
+} asyncQueueState;
+
+static u64 queueMemorySize(u32 depth){
+    return sizeof(asyncQueueState) + sizeof(asyncRead) * depth + sizeof(u32) * depth * 3;
+}
+
+static void releaseRead(asyncQueueState* q, u32 index){
+    q->reads[index].nextFree = q->freeHead;
+    q->freeHead = index;
+}
+
+// Takes a finished read off the queue and calls its callback. The read is
+// freed first so the callback can queue another one in its place.
+static void finishRead(asyncQueueState* q, u32 index, i64 result){
+    asyncRead* r = &q->reads[index];
+    PFN_fsReadComplete callback = r->callback;
+    void* userData = r->userData;
+    releaseRead(q, index);
+    q->inFlightCnt--;
+    if (callback){
+        callback(userData, result >= 0, result >= 0 ? (u64)result : 0);
+    }
+}
+
+#if FS_ASYNC_IO_URING
+
+static i32 ioUringSetup(u32 entries, struct io_uring_params* params){
+    return (i32)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static i32 ioUringEnter(i32 fd, u32 toSubmit, u32 minComplete, u32 flags){
+    return (i32)syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, 0, 0);
+}
+
+static void ringDestroy(asyncQueueState* q){
+    if (q->sqes){
+        munmap(q->sqes, q->sqesSize);
+    }
+    if (q->cqRing && q->cqRing != q->sqRing){
+        munmap(q->cqRing, q->cqRingSize);
+    }
+    if (q->sqRing){
+        munmap(q->sqRing, q->sqRingSize);
+    }
+    if (q->ringFd >= 0){
+        close(q->ringFd);
+    }
+    q->ringFd = -1;
+}
+
+// Sets up the rings. Fails on kernels without io_uring or where it's blocked,
+// which is fine, the jobs take over.
+static b8 ringCreate(asyncQueueState* q){
+    struct io_uring_params params = {0};
+    q->ringFd = ioUringSetup(q->depth, &params);
+    if (q->ringFd < 0){
+        q->ringFd = -1;
+        return false;
+    }
+
+    q->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(u32);
+    q->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    b8 singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap){
+        q->sqRingSize = q->sqRingSize > q->cqRingSize ? q->sqRingSize : q->cqRingSize;
+        q->cqRingSize = q->sqRingSize;
+    }
+    q->sqRing = mmap(0, q->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, q->ringFd, IORING_OFF_SQ_RING);
+    if (q->sqRing == MAP_FAILED){
+        q->sqRing = 0;
+        ringDestroy(q);
+        return false;
+    }
+    if (singleMap){
+        q->cqRing = q->sqRing;
+    } else {
+        q->cqRing = mmap(0, q->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, q->ringFd, IORING_OFF_CQ_RING);
+        if (q->cqRing == MAP_FAILED){
+            q->cqRing = 0;
+            ringDestroy(q);
+            return false;
+        }
+    }
+    q->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    q->sqes = mmap(0, q->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, q->ringFd, IORING_OFF_SQES);
+    if (q->sqes == MAP_FAILED){
+        q->sqes = 0;
+        ringDestroy(q);
+        return false;
+    }
+
+    u8* sq = q->sqRing;
+    u8* cq = q->cqRing;
+    q->sqTail = (u32*)(sq + params.sq_off.tail);
+    q->sqMask = *(u32*)(sq + params.sq_off.ring_mask);
+    q->sqArray = (u32*)(sq + params.sq_off.array);
+    q->cqHead = (u32*)(cq + params.cq_off.head);
+    q->cqTail = (u32*)(cq + params.cq_off.tail);
+    q->cqMask = *(u32*)(cq + params.cq_off.ring_mask);
+    q->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    q->ringUnsubmitted = 0;
+    return true;
+}
+
+// Tells the kernel about everything in the submission ring, optionally waiting
+// for a read to finish too.
+static void ringEnter(asyncQueueState* q, u32 minComplete){
+    u32 flags = minComplete ? IORING_ENTER_GETEVENTS : 0;
+    for (;;){
+        i32 submitted = ioUringEnter(q->ringFd, q->ringUnsubmitted, minComplete, flags);
+        if (submitted >= 0){
+            q->ringUnsubmitted -= (u32)submitted;
+            return;
+        }
+        if (errno == EINTR){
+            continue;
+        }
+        // EAGAIN and EBUSY mean the kernel is out of room for now. Whatever it
+        // didn't take stays in the ring for the next enter.
+        if (errno != EAGAIN && errno != EBUSY){
+            FERROR("FS: io_uring_enter failed with errno %i", errno);
+        }
+        return;
+    }
+}
+
+static u32 ringSubmit(asyncQueueState* q){
+    u32 tail = *q->sqTail;
+    for (u32 i = 0; i < q->queuedCnt; ++i){
+        u32 index = q->queued[i];
+        asyncRead* r = &q->reads[index];
+        r->iov.iov_base = r->dst;
+        r->iov.iov_len = (size_t)r->size;
+
+        u32 slot = tail & q->sqMask;
+        struct io_uring_sqe* sqe = &q->sqes[slot];
+        fzeroMemory(sqe, sizeof(*sqe));
+        // READV instead of READ so kernels from before 5.6 work too.
+        sqe->opcode = IORING_OP_READV;
+        sqe->fd = fileno((FILE*)r->handle.handle);
+        sqe->off = r->offset;
+        sqe->addr = (u64)&r->iov;
+        sqe->len = 1;
+        sqe->user_data = index;
+        q->sqArray[slot] = slot;
+        tail++;
+    }
+    // The kernel can't see the entries until the tail moves past them.
+    __atomic_store_n(q->sqTail, tail, __ATOMIC_RELEASE);
+    q->ringUnsubmitted += q->queuedCnt;
+    ringEnter(q, 0);
+    return q->queuedCnt;
+}
+
+static u32 ringReap(asyncQueueState* q, b8 callCallbacks){
+    u32 finished = 0;
+    u32 head = *q->cqHead;
+    u32 tail = __atomic_load_n(q->cqTail, __ATOMIC_ACQUIRE);
+    while (head != tail){
+        struct io_uring_cqe* cqe = &q->cqes[head & q->cqMask];
+        u32 index = (u32)cqe->user_data;
+        i64 result = cqe->res;
+        head++;
+        // Hand the slot back before the callback, which might queue more.
+        __atomic_store_n(q->cqHead, head, __ATOMIC_RELEASE);
+        if (callCallbacks){
+            finishRead(q, index, result);
+        } else {
+            releaseRead(q, index);
+            q->inFlightCnt--;
+        }
+        finished++;
+    }
+    return finished;
+}
+
+#endif
+
+// Reads on a job thread for when io_uring isn't there.
+static void asyncReadJob(void* params){
+    asyncRead* r = params;
+    asyncQueueState* q = r->queue;
+    u8* dst = r->dst;
+    u64 total = 0;
+    b8 failed = false;
+#if FSNPLATFORM_WINDOWS
+    HANDLE file = (HANDLE)_get_osfhandle(_fileno((FILE*)r->handle.handle));
+    while (total < r->size){
+        OVERLAPPED ov = {0};
+        u64 offset = r->offset + total;
+        ov.Offset = (DWORD)offset;
+        ov.OffsetHigh = (DWORD)(offset >> 32);
+        DWORD got = 0;
+        if (!ReadFile(file, dst + total, (DWORD)(r->size - total), &got, &ov)){
+            failed = GetLastError() != ERROR_HANDLE_EOF;
+            break;
+        }
+        if (got == 0){
+            break;
+        }
+        total += got;
+    }
+#else
+    i32 fd = fileno((FILE*)r->handle.handle);
+    while (total < r->size){
+        ssize_t got = pread(fd, dst + total, (size_t)(r->size - total), (off_t)(r->offset + total));
+        if (got < 0){
+            if (errno == EINTR){
+                continue;
+            }
+            failed = true;
+            break;
+        }
+        if (got == 0){
+            break;
+        }
+        total += (u64)got;
+    }
+#endif
+    r->result = failed ? -1 : (i64)total;
+
+    u32 index = (u32)(r - q->reads);
+    fmutexLock(&q->doneMutex);
+    q->done[q->doneCnt++] = index;
+    fmutexUnlock(&q->doneMutex);
+    fsemaphoreSignal(&q->doneSignal);
+}
+
+static u32 jobsSubmit(asyncQueueState* q){
+    // Count them in flight before submitting, a job can finish right away.
+    u32 cnt = q->queuedCnt;
+    for (u32 i = 0; i < cnt; ++i){
+        jobSubmit(asyncReadJob, &q->reads[q->queued[i]]);
+    }
+    return cnt;
+}
+
+static u32 jobsReap(asyncQueueState* q, b8 callCallbacks){
+    fmutexLock(&q->doneMutex);
+    u32 cnt = q->doneCnt;
+    fcopyMemory(q->reaping, q->done, sizeof(u32) * cnt);
+    q->doneCnt = 0;
+    fmutexUnlock(&q->doneMutex);
+
+    for (u32 i = 0; i < cnt; ++i){
+        u32 index = q->reaping[i];
+        // Every finished read signals once. Take it so the count doesn't build up.
+        if (q->signalCredit){
+            q->signalCredit--;
+        } else {
+            fsemaphoreWait(&q->doneSignal, 0);
+        }
+        if (callCallbacks){
+            finishRead(q, index, q->reads[index].result);
+        } else {
+            releaseRead(q, index);
+            q->inFlightCnt--;
+        }
+    }
+    return cnt;
+}
+
+// Waits until at least one read is done.
+static void waitForRead(asyncQueueState* q){
+#if FS_ASYNC_IO_URING
+    if (q->native){
+        ringEnter(q, 1);
+        return;
+    }
+#endif
+    if (fsemaphoreWait(&q->doneSignal, FSEMAPHORE_WAIT_INFINITE)){
+        q->signalCredit++;
+    }
+}
+
+static u32 reap(asyncQueueState* q, b8 callCallbacks){
+#if FS_ASYNC_IO_URING
+    if (q->native){
+        return ringReap(q, callCallbacks);
+    }
+#endif
+    return jobsReap(q, callCallbacks);
+}
+
+b8 fsAsyncQueueCreate(u32 depth, fsAsyncQueue* outQueue){
+    if (!outQueue || depth == 0){
+        return false;
+    }
+    outQueue->internalData = 0;
+    u64 memSize = queueMemorySize(depth);
+    asyncQueueState* q = fallocate(memSize, MEMORY_TAG_FILE_DATA);
+    fzeroMemory(q, memSize);
+    q->depth = depth;
+    q->reads = (asyncRead*)(q + 1);
+    q->queued = (u32*)(q->reads + depth);
+    q->done = q->queued + depth;
+    q->reaping = q->done + depth;
+    for (u32 i = 0; i < depth; ++i){
+        q->reads[i].queue = q;
+        q->reads[i].nextFree = i + 1;
+    }
+    q->freeHead = 0;
+
+    if (!fmutexCreate(&q->doneMutex) || !fsemaphoreCreate(&q->doneSignal, depth, 0)){
+        FERROR("FS: Failed to create the async queue's sync objects");
+        ffree(q, memSize, MEMORY_TAG_FILE_DATA);
+        return false;
+    }
+
+#if FS_ASYNC_IO_URING
+    q->native = ringCreate(q);
+    if (!q->native){
+        FINFO("FS: io_uring isn't available, async reads will run as jobs.");
+    }
+#endif
+
+    outQueue->internalData = q;
+    return true;
+}
+
+void fsAsyncQueueDestroy(fsAsyncQueue* queue){
+    if (!queue || !queue->internalData){
+        return;
+    }
+    asyncQueueState* q = queue->internalData;
+    // Queued reads never started, the rest are writing into someone's memory.
+    for (u32 i = 0; i < q->queuedCnt; ++i){
+        releaseRead(q, q->queued[i]);
+    }
+    q->inFlightCnt -= q->queuedCnt;
+    q->queuedCnt = 0;
+    while (q->inFlightCnt > 0){
+        if (!reap(q, false)){
+            waitForRead(q);
+        }
+    }
+
+#if FS_ASYNC_IO_URING
+    if (q->native){
+        ringDestroy(q);
+    }
+#endif
+    fsemaphoreDestroy(&q->doneSignal);
+    fmutexDestroy(&q->doneMutex);
+    ffree(q, queueMemorySize(q->depth), MEMORY_TAG_FILE_DATA);
+    queue->internalData = 0;
+}
+
+b8 fsReadAsync(fsAsyncQueue* queue, fileHandle* handle, u64 offset, u64 size, void* outData, PFN_fsReadComplete callback, void* userData){
+    if (!queue || !queue->internalData || !handle || !handle->isValid || (!outData && size)){
+        return false;
+    }
+    if (size > FS_ASYNC_MAX_READ){
+        FERROR("FS: Async reads have to be under 2 GiB, got %llu bytes", size);
+        return false;
+    }
+    asyncQueueState* q = queue->internalData;
+    if (q->freeHead >= q->depth){
+        return false;
+    }
+    u32 index = q->freeHead;
+    asyncRead* r = &q->reads[index];
+    q->freeHead = r->nextFree;
+
+    r->handle = *handle;
+    r->offset = offset;
+    r->size = size;
+    r->dst = outData;
+    r->callback = callback;
+    r->userData = userData;
+    r->result = 0;
+    q->queued[q->queuedCnt++] = index;
+    // Counted from here so the pending count covers queued reads too.
+    q->inFlightCnt++;
+    return true;
+}
+
+u32 fsAsyncSubmit(fsAsyncQueue* queue){
+    if (!queue || !queue->internalData){
+        return 0;
+    }
+    asyncQueueState* q = queue->internalData;
+    if (q->queuedCnt == 0){
+        return 0;
+    }
+    u32 submitted;
+#if FS_ASYNC_IO_URING
+    if (q->native){
+        submitted = ringSubmit(q);
+    } else {
+        submitted = jobsSubmit(q);
+    }
+#else
+    submitted = jobsSubmit(q);
+#endif
+    q->queuedCnt = 0;
+    return submitted;
+}
+
+u32 fsAsyncPoll(fsAsyncQueue* queue, b8 wait){
+    if (!queue || !queue->internalData){
+        return 0;
+    }
+    asyncQueueState* q = queue->internalData;
+    fsAsyncSubmit(queue);
+#if FS_ASYNC_IO_URING
+    // Anything the kernel couldn't take last time gets another go.
+    if (q->native && q->ringUnsubmitted){
+        ringEnter(q, 0);
+    }
+#endif
+    u32 finished = reap(q, true);
+    while (!finished && wait && q->inFlightCnt > 0){
+        waitForRead(q);
+        finished = reap(q, true);
+    }
+    return finished;
+}
+
+u32 fsAsyncPendingCount(fsAsyncQueue* queue){
+    if (!queue || !queue->internalData){
+        return 0;
+    }
+    return ((asyncQueueState*)queue->internalData)->inFlightCnt;
+}
+
+b8 fsAsyncIsNative(fsAsyncQueue* queue){
+    if (!queue || !queue->internalData){
+        return false;
+    }
+    return ((asyncQueueState*)queue->internalData)->native;
+}
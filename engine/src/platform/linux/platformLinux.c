@@ -6,6 +6,9 @@
 #include "core/event.h"
 #include "core/input.h"
 #include "core/logger.h"
+#include "core/fthread.h"
+#include "core/fmutex.h"
+#include "core/fsemaphore.h"
 #include "helpers/dinoArray.h"
 #include "renderer/vulkan/vulkanPlatform.h"
 
@@ -18,10 +21,13 @@
 
 #if _POSIX_C_SOURCE >= 199309L
 #include <time.h> // nanosleep
-#else
-#include <unistd.h> // usleep
 #endif
+#include <unistd.h> // usleep, sysconf
 
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -39,6 +45,7 @@ typedef struct platformState {
     xcb_atom_t wm_protocols;
     xcb_atom_t wm_delete_win;
     VkSurfaceKHR surface;
+    b8 headless;
 } platformState;
 
 static platformState* systemPtr;
@@ -46,12 +53,17 @@ static platformState* systemPtr;
 keys translateKeycodeWinToXCB(u32 x_keycode);
 
 b8 platformStartup(u64* memoryRequirement, void* state, const char* appName,
-                    i32 x, i32 y, i32 width, i32 height) {
+                    i32 x, i32 y, i32 width, i32 height, b8 headless) {
     *memoryRequirement = sizeof(platformState);
     if (state == 0) {
         return true;
     }
     systemPtr = state;
+    systemPtr->headless = headless;
+    if (headless) {
+        FINFO("Platform running headless, no window will be made.");
+        return true;
+    }
 
     // Connect to X
     systemPtr->display = XOpenDisplay(NULL);
@@ -150,6 +162,9 @@ b8 platformStartup(u64* memoryRequirement, void* state, const char* appName,
 }
 
 void platformShutdown() {
+    if (systemPtr->headless) {
+        return;
+    }
     // Turn key repeats back on since this is global for the OS... just... wow.
     //XAutoRepeatOn(systemPtr->display);
 
@@ -161,6 +176,9 @@ b8 platformPumpMessages() {
     xcb_client_message_event_t* cm;
 
     b8 quit_flagged = false;
+    if (systemPtr->headless) {
+        return true;
+    }
 
     // Poll for events until null is returned.
     while (event != 0) {
@@ -291,6 +309,18 @@ f64 platformGetAbsoluteTime() {
     return now.tv_sec + now.tv_nsec * 0.000000001;
 }
 
+u64 platformGetTimestampNs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * 1000000000ULL + (u64)now.tv_nsec;
+}
+
+u64 platformGetRawTimestampNs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+    return (u64)now.tv_sec * 1000000000ULL + (u64)now.tv_nsec;
+}
+
 void platformSleep(u64 ms) {
 #if _POSIX_C_SOURCE >= 199309L
     struct timespec ts;
@@ -305,12 +335,178 @@ void platformSleep(u64 ms) {
 #endif
 }
 
+// Threads
+typedef struct linuxThreadStart {
+    PFN_threadStart func;
+    void* params;
+} linuxThreadStart;
+
+static void* linuxThreadProc(void* p) {
+    linuxThreadStart start = *(linuxThreadStart*)p;
+    free(p);
+    return (void*)(u64)start.func(start.params);
+}
+
+b8 fthreadCreate(PFN_threadStart startFunc, void* params, b8 autoDetach, fthread* outThread) {
+    if (!startFunc || !outThread) {
+        return false;
+    }
+    outThread->internalData = 0;
+    outThread->threadID = 0;
+
+    linuxThreadStart* start = malloc(sizeof(linuxThreadStart));
+    start->func = startFunc;
+    start->params = params;
+
+    pthread_t* handle = malloc(sizeof(pthread_t));
+    i32 result = pthread_create(handle, 0, linuxThreadProc, start);
+    if (result != 0) {
+        FERROR("fthreadCreate: pthread_create failed with error %d", result);
+        free(start);
+        free(handle);
+        return false;
+    }
+
+    if (autoDetach) {
+        pthread_detach(*handle);
+        free(handle);
+        return true;
+    }
+    outThread->internalData = handle;
+    outThread->threadID = (u64)*handle;
+    return true;
+}
+
+void fthreadDestroy(fthread* thread) {
+    if (thread && thread->internalData) {
+        free(thread->internalData);
+        thread->internalData = 0;
+        thread->threadID = 0;
+    }
+}
+
+void fthreadDetach(fthread* thread) {
+    if (thread && thread->internalData) {
+        pthread_detach(*(pthread_t*)thread->internalData);
+        fthreadDestroy(thread);
+    }
+}
+
+b8 fthreadWait(fthread* thread) {
+    if (!thread || !thread->internalData) {
+        return false;
+    }
+    return pthread_join(*(pthread_t*)thread->internalData, 0) == 0;
+}
+
+void fthreadYield() {
+    sched_yield();
+}
+
+u64 fthreadCurrentID() {
+    return (u64)pthread_self();
+}
+
+// Mutexes
+b8 fmutexCreate(fmutex* outMutex) {
+    pthread_mutex_t* m = malloc(sizeof(pthread_mutex_t));
+    if (pthread_mutex_init(m, 0) != 0) {
+        free(m);
+        outMutex->internalData = 0;
+        return false;
+    }
+    outMutex->internalData = m;
+    return true;
+}
+
+void fmutexDestroy(fmutex* mutex) {
+    if (mutex && mutex->internalData) {
+        pthread_mutex_destroy(mutex->internalData);
+        free(mutex->internalData);
+        mutex->internalData = 0;
+    }
+}
+
+b8 fmutexLock(fmutex* mutex) {
+    return pthread_mutex_lock(mutex->internalData) == 0;
+}
+
+b8 fmutexUnlock(fmutex* mutex) {
+    return pthread_mutex_unlock(mutex->internalData) == 0;
+}
+
+// Semaphores
+b8 fsemaphoreCreate(fsemaphore* outSemaphore, u32 maxCount, u32 startCount) {
+    // POSIX semaphores don't have a max count. It's only used on Windows.
+    sem_t* sem = malloc(sizeof(sem_t));
+    if (sem_init(sem, 0, startCount) != 0) {
+        free(sem);
+        outSemaphore->internalData = 0;
+        return false;
+    }
+    outSemaphore->internalData = sem;
+    return true;
+}
+
+void fsemaphoreDestroy(fsemaphore* semaphore) {
+    if (semaphore && semaphore->internalData) {
+        sem_destroy(semaphore->internalData);
+        free(semaphore->internalData);
+        semaphore->internalData = 0;
+    }
+}
+
+b8 fsemaphoreSignal(fsemaphore* semaphore) {
+    return sem_post(semaphore->internalData) == 0;
+}
+
+b8 fsemaphoreWait(fsemaphore* semaphore, u64 timeoutMs) {
+    sem_t* sem = semaphore->internalData;
+    i32 result;
+    if (timeoutMs == FSEMAPHORE_WAIT_INFINITE) {
+        while ((result = sem_wait(sem)) == -1 && errno == EINTR) {
+        }
+        return result == 0;
+    }
+
+    // sem_timedwait takes an absolute CLOCK_REALTIME deadline.
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeoutMs / 1000;
+    ts.tv_nsec += (timeoutMs % 1000) * 1000 * 1000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec += 1;
+        ts.tv_nsec -= 1000000000;
+    }
+    while ((result = sem_timedwait(sem, &ts)) == -1 && errno == EINTR) {
+    }
+    return result == 0;
+}
+
+void platformSleepUntil(u64 deadlineNs) {
+    struct timespec ts;
+    ts.tv_sec = deadlineNs / 1000000000ULL;
+    ts.tv_nsec = deadlineNs % 1000000000ULL;
+    // Restart if a signal interrupts the sleep, the deadline stays the same.
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0) == EINTR) {
+    }
+}
+
+i32 platformGetProcessorCount() {
+    long cnt = sysconf(_SC_NPROCESSORS_ONLN);
+    return cnt > 0 ? (i32)cnt : 1;
+}
+
 void platformGetRequiredExts(const char*** array) {
     dinoPush(*array, &"VK_KHR_xcb_surface");
 }
 
 // Surface creation for Vulkan
 b8 platformCreateVulkanSurface(vulkanHeader* header) {
+    if (systemPtr->headless) {
+        FERROR("Can't make a Vulkan surface while running headless.");
+        return false;
+    }
     VkXcbSurfaceCreateInfoKHR createInfo = {
         VK_STRUCTURE_TYPE_XCB_SURFACE_CREATE_INFO_KHR};
     createInfo.connection = systemPtr->connection;
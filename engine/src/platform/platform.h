@@ -2,6 +2,12 @@
 
 #include "defines.h"
 
+/**
+ * @brief Starts the platform layer and opens the window.
+ * @param headless Skips the window and display connection entirely. Used with
+ * the null renderer on machines with no display. Vulkan surfaces can't be made
+ * in this mode.
+ */
 b8 platformStartup(
     u64* memoryRequirement,
     void* state,
@@ -9,16 +15,17 @@ b8 platformStartup(
     i32 x,
     i32 y,
     i32 width,
-    i32 height
+    i32 height,
+    b8 headless
     );
 
 void platformShutdown();
 
 b8 platformPumpMessages();
 
-void* platformAllocate(u64 size, b8 aligned);
-void platformFree(void* block, b8 aligned);
-void* platformZeroMemory(void* block, u64 size);
+FSNAPI void* platformAllocate(u64 size, b8 aligned);
+FSNAPI void platformFree(void* block, b8 aligned);
+FSNAPI void* platformZeroMemory(void* block, u64 size);
 void* platformCopyMemory(void* dest,const void* src, u64 size);
 void* platformSetMemory(void* dest, i32 val, u64 size);
 
@@ -27,4 +34,30 @@ void platformConsoleWriteError(const char* msg, u8 color);
 
 f64 platformGetAbsoluteTime();
 
+/**
+ * @brief Gets a monotonic timestamp in nanoseconds. Unlike
+ * platformGetAbsoluteTime it's safe to call before platformStartup.
+ */
+FSNAPI u64 platformGetTimestampNs();
+
+/**
+ * @brief Gets a raw hardware timestamp in nanoseconds that isn't adjusted by
+ * NTP. Cheapest clock available, meant for profiling. Only compare it with
+ * other raw timestamps.
+ */
+FSNAPI u64 platformGetRawTimestampNs();
+
 void platformSleep(u64 ms);
+
+/**
+ * @brief Sleeps until an absolute deadline. Can still wake up a bit late, so
+ * spin for the last part of the wait if it needs to be precise.
+ * @param deadlineNs The deadline in platformGetTimestampNs time
+ */
+void platformSleepUntil(u64 deadlineNs);
+
+/**
+ * @brief Gets how many logical processors the machine has.
+ * @returns The processor count, at least 1
+ */
+i32 platformGetProcessorCount();
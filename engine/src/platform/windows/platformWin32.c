@@ -8,6 +8,9 @@
 #include "helpers/dinoArray.h"
 #include "renderer/vulkan/vulkanPlatform.h"
 #include "core/event.h"
+#include "core/fthread.h"
+#include "core/fmutex.h"
+#include "core/fsemaphore.h"
 
 #include <windows.h>
 #include <windowsx.h>  //param input extraction
@@ -24,6 +27,7 @@ typedef struct platformState {
     VkSurfaceKHR surface;
     f64 clockFreq;
     LARGE_INTEGER startTime;
+    b8 headless;
 } platformState;
 
 static platformState* systemPtr;
@@ -37,13 +41,27 @@ b8 platformStartup(
     i32 x,
     i32 y,
     i32 width,
-    i32 height) {
+    i32 height,
+    b8 headless) {
     *memoryRequirement = sizeof(platformState);
     if (state == 0){
         return true;
     }
     systemPtr = state;
     systemPtr->hInstance = GetModuleHandleA(0);
+    systemPtr->hwnd = 0;
+    systemPtr->headless = headless;
+
+    //Clock setup
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    systemPtr->clockFreq = 1.0 / (f64)frequency.QuadPart;
+    QueryPerformanceCounter(&systemPtr->startTime);
+
+    if (headless) {
+        FINFO("Platform running headless, no window will be made.");
+        return true;
+    }
 
     //Setup and register window class.
     HICON icon = LoadIcon(systemPtr->hInstance, IDI_APPLICATION);
@@ -123,12 +141,6 @@ b8 platformStartup(
     //If initially maximized, use SW_SHOWMAXIMIZED : SW_MAXIMIZE
     ShowWindow(systemPtr->hwnd, show_window_command_flags);
 
-    //Clock setup
-    LARGE_INTEGER frequency;
-    QueryPerformanceFrequency(&frequency);
-    systemPtr->clockFreq = 1.0 / (f64)frequency.QuadPart;
-    QueryPerformanceCounter(&systemPtr->startTime);
-
     return true;
 }
 
@@ -203,16 +215,187 @@ f64 platformGetAbsoluteTime() {
     return (f64)now_time.QuadPart * systemPtr->clockFreq;
 }
 
+u64 platformGetTimestampNs() {
+    static LARGE_INTEGER frequency;
+    if (!frequency.QuadPart) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    // Split up so the multiply doesn't overflow.
+    u64 secs = now.QuadPart / frequency.QuadPart;
+    u64 rem = now.QuadPart % frequency.QuadPart;
+    return secs * 1000000000ULL + (rem * 1000000000ULL) / frequency.QuadPart;
+}
+
+u64 platformGetRawTimestampNs() {
+    // QPC is already unadjusted on Windows.
+    return platformGetTimestampNs();
+}
+
 void platformSleep(u64 ms) {
     Sleep(ms);
 }
 
+// Threads
+typedef struct win32ThreadStart {
+    PFN_threadStart func;
+    void* params;
+} win32ThreadStart;
+
+static DWORD WINAPI win32ThreadProc(LPVOID p) {
+    win32ThreadStart start = *(win32ThreadStart*)p;
+    free(p);
+    return (DWORD)start.func(start.params);
+}
+
+b8 fthreadCreate(PFN_threadStart startFunc, void* params, b8 autoDetach, fthread* outThread) {
+    if (!startFunc || !outThread) {
+        return false;
+    }
+    outThread->internalData = 0;
+    outThread->threadID = 0;
+
+    win32ThreadStart* start = malloc(sizeof(win32ThreadStart));
+    start->func = startFunc;
+    start->params = params;
+
+    DWORD id = 0;
+    HANDLE handle = CreateThread(0, 0, win32ThreadProc, start, 0, &id);
+    if (!handle) {
+        FERROR("fthreadCreate: CreateThread failed with error %lu", GetLastError());
+        free(start);
+        return false;
+    }
+
+    if (autoDetach) {
+        CloseHandle(handle);
+        return true;
+    }
+    outThread->internalData = handle;
+    outThread->threadID = id;
+    return true;
+}
+
+void fthreadDestroy(fthread* thread) {
+    if (thread && thread->internalData) {
+        CloseHandle((HANDLE)thread->internalData);
+        thread->internalData = 0;
+        thread->threadID = 0;
+    }
+}
+
+void fthreadDetach(fthread* thread) {
+    fthreadDestroy(thread);
+}
+
+b8 fthreadWait(fthread* thread) {
+    if (!thread || !thread->internalData) {
+        return false;
+    }
+    return WaitForSingleObject((HANDLE)thread->internalData, INFINITE) == WAIT_OBJECT_0;
+}
+
+void fthreadYield() {
+    SwitchToThread();
+}
+
+u64 fthreadCurrentID() {
+    return (u64)GetCurrentThreadId();
+}
+
+// Mutexes
+b8 fmutexCreate(fmutex* outMutex) {
+    CRITICAL_SECTION* cs = malloc(sizeof(CRITICAL_SECTION));
+    InitializeCriticalSection(cs);
+    outMutex->internalData = cs;
+    return true;
+}
+
+void fmutexDestroy(fmutex* mutex) {
+    if (mutex && mutex->internalData) {
+        DeleteCriticalSection(mutex->internalData);
+        free(mutex->internalData);
+        mutex->internalData = 0;
+    }
+}
+
+b8 fmutexLock(fmutex* mutex) {
+    EnterCriticalSection(mutex->internalData);
+    return true;
+}
+
+b8 fmutexUnlock(fmutex* mutex) {
+    LeaveCriticalSection(mutex->internalData);
+    return true;
+}
+
+// Semaphores
+b8 fsemaphoreCreate(fsemaphore* outSemaphore, u32 maxCount, u32 startCount) {
+    outSemaphore->internalData = CreateSemaphoreA(0, startCount, maxCount, 0);
+    return outSemaphore->internalData != 0;
+}
+
+void fsemaphoreDestroy(fsemaphore* semaphore) {
+    if (semaphore && semaphore->internalData) {
+        CloseHandle((HANDLE)semaphore->internalData);
+        semaphore->internalData = 0;
+    }
+}
+
+b8 fsemaphoreSignal(fsemaphore* semaphore) {
+    return ReleaseSemaphore((HANDLE)semaphore->internalData, 1, 0) != 0;
+}
+
+b8 fsemaphoreWait(fsemaphore* semaphore, u64 timeoutMs) {
+    DWORD ms = timeoutMs == FSEMAPHORE_WAIT_INFINITE ? INFINITE : (DWORD)timeoutMs;
+    return WaitForSingleObject((HANDLE)semaphore->internalData, ms) == WAIT_OBJECT_0;
+}
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+void platformSleepUntil(u64 deadlineNs) {
+    u64 now = platformGetTimestampNs();
+    if (deadlineNs <= now) {
+        return;
+    }
+    // High resolution timers are only on Windows 10 1803+. Fall back to a
+    // regular one, which is only as good as the scheduler tick.
+    static HANDLE timer = 0;
+    if (!timer) {
+        timer = CreateWaitableTimerExW(0, 0, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (!timer) {
+            timer = CreateWaitableTimerExW(0, 0, 0, TIMER_ALL_ACCESS);
+        }
+    }
+    // Negative means relative, in 100ns units.
+    LARGE_INTEGER due;
+    due.QuadPart = -(LONGLONG)((deadlineNs - now) / 100);
+    if (timer && SetWaitableTimer(timer, &due, 0, 0, 0, FALSE)) {
+        WaitForSingleObject(timer, INFINITE);
+    } else {
+        Sleep((DWORD)((deadlineNs - now) / 1000000));
+    }
+}
+
+i32 platformGetProcessorCount() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (i32)info.dwNumberOfProcessors : 1;
+}
+
 void platformGetRequiredExts(const char*** array){
     dinoPush(*array,&"VK_KHR_win32_surface");
 }
 
 // Surface creation for Vulkan
 b8 platformCreateVulkanSurface(vulkanHeader *header) {
+    if (systemPtr->headless) {
+        FERROR("Can't make a Vulkan surface while running headless.");
+        return false;
+    }
     VkWin32SurfaceCreateInfoKHR createInfo = {VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR};
     createInfo.hinstance = systemPtr->hInstance;
     createInfo.hwnd = systemPtr->hwnd;
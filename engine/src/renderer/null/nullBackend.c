@@ -0,0 +1,282 @@
+#include "nullBackend.h"
+
+#include "core/fmemory.h"
+#include "core/logger.h"
+
+typedef struct nullTexture {
+    b8 inUse;
+    u64 bytes;
+} nullTexture;
+
+typedef struct nullGeometry {
+    b8 inUse;
+    u32 generation;
+    u64 bytes;
+} nullGeometry;
+
+typedef struct nullBackendState {
+    b8 inFrame;
+    // INVALID_ID when no renderpass has begun.
+    u32 renderpassID;
+    u32 lastGeometryID;
+    u32 lastMaterialID;
+    nullBackendStats stats;
+
+    nullTexture textures[NULL_BACKEND_MAX_TEXTURES];
+    b8 materials[NULL_BACKEND_MAX_MATERIALS];
+    nullGeometry geometries[NULL_BACKEND_MAX_GEOMETRIES];
+
+    // The frame being recorded and the last finished one. Swapped at endFrame.
+    nullDrawCmd* recording;
+    u32 recordingCnt;
+    nullDrawCmd* finished;
+    u32 finishedCnt;
+} nullBackendState;
+
+static nullBackendState* state;
+
+b8 nullInit(struct rendererBackend* backend, const char* appName) {
+    state = fallocate(sizeof(nullBackendState), MEMORY_TAG_RENDERER);
+    state->recording = fallocate(sizeof(nullDrawCmd) * NULL_BACKEND_MAX_DRAWS, MEMORY_TAG_RENDERER);
+    state->finished = fallocate(sizeof(nullDrawCmd) * NULL_BACKEND_MAX_DRAWS, MEMORY_TAG_RENDERER);
+    state->renderpassID = INVALID_ID;
+    state->lastGeometryID = INVALID_ID;
+    state->lastMaterialID = INVALID_ID;
+    FINFO("Null renderer backend inited for %s. Nothing will be drawn.", appName);
+    return true;
+}
+
+void nullShutdown(struct rendererBackend* backend) {
+    if (!state) {
+        return;
+    }
+    nullBackendStats* s = &state->stats;
+    FINFO("Null renderer: %llu frames, %llu draws, %llu geometry binds, %llu material binds, %llu renderpasses",
+          s->frames, s->draws, s->geometryBinds, s->materialBinds, s->renderpassBegins);
+    if (s->liveTextures || s->liveMaterials || s->liveGeometries) {
+        FWARN("Null renderer shut down with live resources: %u textures, %u materials, %u geometries",
+              s->liveTextures, s->liveMaterials, s->liveGeometries);
+    }
+    if (s->invalidDestroys) {
+        FWARN("Null renderer saw %llu destroys of unknown or already destroyed resources.", s->invalidDestroys);
+    }
+    ffree(state->recording, sizeof(nullDrawCmd) * NULL_BACKEND_MAX_DRAWS, MEMORY_TAG_RENDERER);
+    ffree(state->finished, sizeof(nullDrawCmd) * NULL_BACKEND_MAX_DRAWS, MEMORY_TAG_RENDERER);
+    ffree(state, sizeof(nullBackendState), MEMORY_TAG_RENDERER);
+    state = 0;
+}
+
+void nullResized(struct rendererBackend* backend, u16 width, u16 height) {
+}
+
+void nullUpdateGlobalState(mat4 projection, mat4 view, vector3 viewPos, vector4 ambientColor, i32 mode) {
+    state->stats.globalStateUpdates++;
+}
+
+void nullUpdateUIState(mat4 projection, mat4 view, i32 mode) {
+    state->stats.globalStateUpdates++;
+}
+
+void nullDrawGeometry(geometryRenderData data) {
+    state->stats.draws++;
+    if (state->renderpassID == INVALID_ID) {
+        state->stats.strayDraws++;
+    }
+
+    u32 geometryID = data.geometry ? data.geometry->internalID : INVALID_ID;
+    u32 materialID = (data.geometry && data.geometry->material) ? data.geometry->material->internalID : INVALID_ID;
+    if (geometryID != state->lastGeometryID) {
+        state->stats.geometryBinds++;
+        state->lastGeometryID = geometryID;
+    }
+    if (materialID != state->lastMaterialID) {
+        state->stats.materialBinds++;
+        state->lastMaterialID = materialID;
+    }
+
+    if (state->recordingCnt >= NULL_BACKEND_MAX_DRAWS) {
+        state->stats.droppedDraws++;
+        return;
+    }
+    nullDrawCmd* cmd = &state->recording[state->recordingCnt++];
+    cmd->frame = state->stats.frames;
+    cmd->renderpassID = (u8)state->renderpassID;
+    cmd->geometryID = geometryID;
+    cmd->materialID = materialID;
+    cmd->model = data.model;
+}
+
+b8 nullBeginFrame(struct rendererBackend* backend, f32 deltaTime) {
+    if (state->inFrame) {
+        FWARN("nullBeginFrame called twice without an nullEndFrame.");
+    }
+    state->inFrame = true;
+    state->recordingCnt = 0;
+    // A real backend starts each frame with nothing bound.
+    state->lastGeometryID = INVALID_ID;
+    state->lastMaterialID = INVALID_ID;
+    return true;
+}
+
+b8 nullEndFrame(struct rendererBackend* backend, f32 deltaTime) {
+    if (!state->inFrame) {
+        FERROR("nullEndFrame called without a nullBeginFrame.");
+        return false;
+    }
+    nullDrawCmd* tmp = state->finished;
+    state->finished = state->recording;
+    state->finishedCnt = state->recordingCnt;
+    state->recording = tmp;
+    state->recordingCnt = 0;
+    state->inFrame = false;
+    state->stats.frames++;
+    return true;
+}
+
+b8 nullBeginRenderpass(struct rendererBackend* backend, u8 renderpassID) {
+    if (state->renderpassID != INVALID_ID) {
+        FERROR("nullBeginRenderpass: renderpass %u began while %u was still going.", renderpassID,
+               state->renderpassID);
+        return false;
+    }
+    state->renderpassID = renderpassID;
+    state->stats.renderpassBegins++;
+    return true;
+}
+
+b8 nullEndRenderpass(struct rendererBackend* backend, u8 renderpassID) {
+    if (state->renderpassID != renderpassID) {
+        FERROR("nullEndRenderpass: tried to end renderpass %u but %u is the one going.", renderpassID,
+               state->renderpassID);
+        return false;
+    }
+    state->renderpassID = INVALID_ID;
+    return true;
+}
+
+b8 nullCreateTexture(const u8* pixels, texture* outTexture) {
+    for (u32 i = 0; i < NULL_BACKEND_MAX_TEXTURES; ++i) {
+        nullTexture* t = &state->textures[i];
+        if (!t->inUse) {
+            t->inUse = true;
+            t->bytes = (u64)outTexture->width * outTexture->height * outTexture->channelCnt;
+            outTexture->data = t;
+            outTexture->generation++;
+            state->stats.liveTextures++;
+            state->stats.texturesCreated++;
+            state->stats.textureBytes += t->bytes;
+            return true;
+        }
+    }
+    FERROR("nullCreateTexture: out of texture slots. Adjust NULL_BACKEND_MAX_TEXTURES.");
+    return false;
+}
+
+void nullDestroyTexture(texture* texture) {
+    nullTexture* t = (nullTexture*)texture->data;
+    if (t >= state->textures && t < state->textures + NULL_BACKEND_MAX_TEXTURES && t->inUse) {
+        state->stats.liveTextures--;
+        state->stats.textureBytes -= t->bytes;
+        t->inUse = false;
+        t->bytes = 0;
+    } else {
+        state->stats.invalidDestroys++;
+    }
+    fzeroMemory(texture, sizeof(struct texture));
+}
+
+b8 nullCreateMaterial(material* m) {
+    if (!m) {
+        return false;
+    }
+    for (u32 i = 0; i < NULL_BACKEND_MAX_MATERIALS; ++i) {
+        if (!state->materials[i]) {
+            state->materials[i] = true;
+            m->internalID = i;
+            state->stats.liveMaterials++;
+            state->stats.materialsCreated++;
+            return true;
+        }
+    }
+    FERROR("nullCreateMaterial: out of material slots. Adjust NULL_BACKEND_MAX_MATERIALS.");
+    return false;
+}
+
+void nullDestroyMaterial(material* m) {
+    if (m && m->internalID < NULL_BACKEND_MAX_MATERIALS && state->materials[m->internalID]) {
+        state->materials[m->internalID] = false;
+        state->stats.liveMaterials--;
+        m->internalID = INVALID_ID;
+    } else {
+        state->stats.invalidDestroys++;
+    }
+}
+
+b8 nullCreateGeometry(geometry* geometry, u32 vertexStride, u32 vertexCnt, const void* vertices, u32 indexStride,
+                      u32 indexCnt, const void* indices) {
+    if (!vertexCnt || !vertices) {
+        FERROR("nullCreateGeometry requires vertex data, and none was supplied. vertexCnt=%d, vertices=%p", vertexCnt,
+               vertices);
+        return false;
+    }
+
+    nullGeometry* g = 0;
+    if (geometry->internalID != INVALID_ID && geometry->internalID < NULL_BACKEND_MAX_GEOMETRIES &&
+        state->geometries[geometry->internalID].inUse) {
+        // Re-upload.
+        g = &state->geometries[geometry->internalID];
+        state->stats.geometryBytes -= g->bytes;
+        g->generation++;
+    } else {
+        for (u32 i = 0; i < NULL_BACKEND_MAX_GEOMETRIES; ++i) {
+            if (!state->geometries[i].inUse) {
+                g = &state->geometries[i];
+                g->inUse = true;
+                g->generation = 0;
+                geometry->internalID = i;
+                state->stats.liveGeometries++;
+                state->stats.geometriesCreated++;
+                break;
+            }
+        }
+    }
+    if (!g) {
+        FERROR("nullCreateGeometry: out of geometry slots. Adjust NULL_BACKEND_MAX_GEOMETRIES.");
+        return false;
+    }
+
+    g->bytes = (u64)vertexStride * vertexCnt;
+    if (indexCnt && indices) {
+        g->bytes += (u64)indexStride * indexCnt;
+    }
+    state->stats.geometryBytes += g->bytes;
+    return true;
+}
+
+void nullDestroyGeometry(geometry* g) {
+    if (g && g->internalID < NULL_BACKEND_MAX_GEOMETRIES && state->geometries[g->internalID].inUse) {
+        nullGeometry* ng = &state->geometries[g->internalID];
+        state->stats.geometryBytes -= ng->bytes;
+        state->stats.liveGeometries--;
+        fzeroMemory(ng, sizeof(nullGeometry));
+    } else {
+        state->stats.invalidDestroys++;
+    }
+}
+
+b8 nullBackendGetStats(nullBackendStats* outStats) {
+    if (!state) {
+        return false;
+    }
+    *outStats = state->stats;
+    return true;
+}
+
+const nullDrawCmd* nullBackendGetDrawStream(u32* outCnt) {
+    if (!state) {
+        *outCnt = 0;
+        return 0;
+    }
+    *outCnt = state->finishedCnt;
+    return state->finished;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "renderer/renderTypes.h"
+
+/*
+ * A renderer backend that doesn't touch a GPU. It keeps track of the
+ * resources made through it, records every draw into a buffer and counts the
+ * state changes a real backend would have had to make. Used for headless runs
+ * and benchmarking the CPU side of a frame.
+ */
+
+#define NULL_BACKEND_MAX_TEXTURES 1024
+#define NULL_BACKEND_MAX_MATERIALS 1024
+#define NULL_BACKEND_MAX_GEOMETRIES 4096
+// Draws past this in one frame still get counted but not recorded.
+#define NULL_BACKEND_MAX_DRAWS 4096
+
+/** @brief One recorded draw. */
+typedef struct nullDrawCmd {
+    u64 frame;
+    u8 renderpassID;
+    u32 geometryID;
+    u32 materialID;
+    mat4 model;
+} nullDrawCmd;
+
+typedef struct nullBackendStats {
+    u64 frames;
+    u32 liveTextures;
+    u32 liveMaterials;
+    u32 liveGeometries;
+    u64 texturesCreated;
+    u64 materialsCreated;
+    u64 geometriesCreated;
+    // How much memory the live resources would use on a GPU.
+    u64 textureBytes;
+    u64 geometryBytes;
+
+    u64 draws;
+    // Draws that didn't fit in the draw stream.
+    u64 droppedDraws;
+    // Draws made outside of a renderpass.
+    u64 strayDraws;
+    u64 renderpassBegins;
+    u64 globalStateUpdates;
+    // Draws that used a different geometry than the one before them.
+    u64 geometryBinds;
+    // Draws that used a different material than the one before them.
+    u64 materialBinds;
+    // Destroys of resources that weren't made by this backend or were already destroyed.
+    u64 invalidDestroys;
+} nullBackendStats;
+
+b8 nullInit(struct rendererBackend* backend, const char* appName);
+
+void nullShutdown(struct rendererBackend* backend);
+
+void nullResized(struct rendererBackend* backend, u16 width, u16 height);
+void nullUpdateGlobalState(mat4 projection, mat4 view, vector3 viewPos, vector4 ambientColor, i32 mode);
+void nullUpdateUIState(mat4 projection, mat4 view, i32 mode);
+void nullDrawGeometry(geometryRenderData data);
+
+b8 nullBeginFrame(struct rendererBackend* backend, f32 deltaTime);
+b8 nullEndFrame(struct rendererBackend* backend, f32 deltaTime);
+
+b8 nullBeginRenderpass(struct rendererBackend* backend, u8 renderpassID);
+b8 nullEndRenderpass(struct rendererBackend* backend, u8 renderpassID);
+
+b8 nullCreateTexture(const u8* pixels, texture* outTexture);
+void nullDestroyTexture(struct texture* texture);
+
+b8 nullCreateMaterial(struct material* m);
+void nullDestroyMaterial(struct material* m);
+
+b8 nullCreateGeometry(geometry* geometry, u32 vertexStride, u32 vertexCnt, const void* vertices, u32 indexStride, u32 indexCnt, const void* indices);
+void nullDestroyGeometry(struct geometry* g);
+
+/**
+ * @brief Gets the resource and state change counts so far.
+ * @param outStats The stats
+ * @returns true if successful, false if the null backend isn't running
+ */
+FSNAPI b8 nullBackendGetStats(nullBackendStats* outStats);
+
+/**
+ * @brief Gets the draws recorded in the last finished frame. Stays valid until
+ * the next frame ends.
+ * @param outCnt Gets set to how many draws there are
+ * @returns The draws, or 0 if the null backend isn't running
+ */
+FSNAPI const nullDrawCmd* nullBackendGetDrawStream(u32* outCnt);
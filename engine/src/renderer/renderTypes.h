@@ -12,7 +12,9 @@ typedef enum builtinRenderpass {
 typedef enum rendererBackendAPI {
     RENDERER_BACKEND_API_VULKAN,
     RENDERER_BACKEND_API_OPENGL,
-    RENDERER_BACKEND_API_DIRECTX
+    RENDERER_BACKEND_API_DIRECTX,
+    // Draws nothing. For headless runs and CPU side benchmarks.
+    RENDERER_BACKEND_API_NULL
 } rendererBackendAPI;
 
 
@@ -39,6 +41,9 @@ typedef struct rendererBackend {
     b8 (*endFrame)(struct rendererBackend* backend, f32 deltaTime);
     b8 (*beginRenderpass)(struct rendererBackend* backend, u8 renderpassID);
     b8 (*endRenderpass)(struct rendererBackend* backend, u8 renderpassID);
+    // Optional. Time a scope on the GPU, backends that can't leave them 0.
+    void (*beginGpuScope)(const char* name);
+    void (*endGpuScope)();
 
     b8 (*createTexture)(const u8* pixels, texture* outTexture);
     void (*destroyTexture)(texture* texture);
@@ -58,4 +63,7 @@ typedef struct renderHeader {
     geometryRenderData* uiGeometries;
     
     f32 deltaTime;
+    // The world camera's view, taken when the packet was filled out. The
+    // packet can be drawn on another thread while the camera keeps moving.
+    mat4 view;
 } renderHeader;
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "rendererBack.h"
 
 #include "vulkan/backend.h"
+#include "null/nullBackend.h"
 
 b8 rendererCreate(rendererBackendAPI api, rendererBackend* rb){
     if (api == RENDERER_BACKEND_API_VULKAN){
@@ -14,6 +15,8 @@ b8 rendererCreate(rendererBackendAPI api, rendererBackend* rb){
         rb->endFrame = vulkanEndFrame;
         rb->beginRenderpass = vulkanBeginRenderpass;
         rb->endRenderpass = vulkanEndRenderpass;
+        rb->beginGpuScope = vulkanBeginGpuScope;
+        rb->endGpuScope = vulkanEndGpuScope;
         rb->createTexture = vulkanCreateTexture;
         rb->destroyTexture = vulkanDestroyTexture;
         rb->createMaterial = vulkanCreateMaterial;
@@ -23,6 +26,28 @@ b8 rendererCreate(rendererBackendAPI api, rendererBackend* rb){
 
         return true;
     }
+    if (api == RENDERER_BACKEND_API_NULL){
+        rb->init = nullInit;
+        rb->shutdown = nullShutdown;
+        rb->resized = nullResized;
+        rb->updateGlobalState = nullUpdateGlobalState;
+        rb->updateGlobalUIState = nullUpdateUIState;
+        rb->drawGeometry = nullDrawGeometry;
+        rb->beginFrame = nullBeginFrame;
+        rb->endFrame = nullEndFrame;
+        rb->beginRenderpass = nullBeginRenderpass;
+        rb->endRenderpass = nullEndRenderpass;
+        rb->beginGpuScope = 0;
+        rb->endGpuScope = 0;
+        rb->createTexture = nullCreateTexture;
+        rb->destroyTexture = nullDestroyTexture;
+        rb->createMaterial = nullCreateMaterial;
+        rb->destroyMaterial = nullDestroyMaterial;
+        rb->createGeometry = nullCreateGeometry;
+        rb->destroyGeometry = nullDestroyGeometry;
+
+        return true;
+    }
     return false;
 }
 
@@ -37,6 +62,8 @@ b8 rendererDestroy(rendererBackend* rb){
     rb->endFrame = 0;
     rb->beginRenderpass = 0;
     rb->endRenderpass = 0;
+    rb->beginGpuScope = 0;
+    rb->endGpuScope = 0;
     rb->createTexture = 0;
     rb->destroyTexture = 0;
     rb->createMaterial = 0;
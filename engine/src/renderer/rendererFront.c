@@ -2,9 +2,8 @@
 #include "renderer/rendererBack.h"
 #include "math/fsnmath.h"
 #include "core/logger.h"
-//TODO: TEMP
-#include "systems/cameraSystem.h"
-#include "core/input.h"
+#include "core/profiler.h"
+#include "core/frameStats.h"
 
 typedef struct rendererSystem{
     rendererBackend rb;
@@ -17,16 +16,11 @@ typedef struct rendererSystem{
     u32 frameBufferHeight;
     f32 nearClip;
     f32 farClip;
-    //TODO: TEMP
-    camera* camm;
-    camera* cam1;
-    camera* cam2;
-    b8 first;
 } rendererSystem;
 
 static rendererSystem* systemPtr;
 
-b8 rendererInit(u64* memoryRequirement, void* memoryState, const char* appName){
+b8 rendererInit(u64* memoryRequirement, void* memoryState, const char* appName, rendererBackendAPI api){
     *memoryRequirement = sizeof(rendererSystem);
     if (memoryState == 0){
         return true;
@@ -42,7 +36,7 @@ b8 rendererInit(u64* memoryRequirement, void* memoryState, const char* appName){
     systemPtr->uiView = mat4Inverse(mat4Identity());
 
     //Assign the pointer functions to the real functions
-    if(!rendererCreate(RENDERER_BACKEND_API_VULKAN, &systemPtr->rb)){
+    if(!rendererCreate(api, &systemPtr->rb)){
         FERROR("Renderer Create Failed");
         return false;
     }
@@ -52,16 +46,6 @@ b8 rendererInit(u64* memoryRequirement, void* memoryState, const char* appName){
         FERROR("Renderer Init Failed");
         return false;
     }
-    //TODO: TEMP
-    systemPtr->first = true;
-    cameraSystemAdd("Cam1");
-    cameraSystemAdd("Cam2");
-    systemPtr->camm = getCamera("main");
-    systemPtr->cam1 = getCamera("Cam1");
-    systemPtr->cam2 = getCamera("Cam2");
-    cameraMoveBackward(systemPtr->cam1, 30.0f);
-    cameraMoveBackward(systemPtr->cam2, 30.0f);
-    //TODO: END TEMP
     return true;
 }
 
@@ -81,6 +65,7 @@ void rendererOnResize(u16 width, u16 height){
 }
 
 b8 rendererDraw(renderHeader* renderHeader){
+    FPROFILE_FUNC();
     //If beginFrame fails the app might be able to recover
     //and sometimes when we redo the swapchain we'll want it to fail
 	if (systemPtr->rb.beginFrame(&systemPtr->rb, renderHeader->deltaTime)){
@@ -88,48 +73,13 @@ b8 rendererDraw(renderHeader* renderHeader){
             FERROR("BeginRenderpass for BUILTIN_RENDERPASS_WORLD failed.");
             return false;
         }
-        // TEMP
-        camera* cam = systemPtr->cam1;
-        if (systemPtr->first){
-            cam = systemPtr->cam1;
-        }else{
-            cam = systemPtr->cam2;
-        }
-        f32 spd = 10.0f * renderHeader->deltaTime;
-        if (inputIsKeyPressed('K')){
-            systemPtr->first = !systemPtr->first;
-        }
-        if (inputIsKeyDown('W')){
-            cameraMoveUp(cam, spd);
-        }
-        if (inputIsKeyDown('S')){
-            cameraMoveDown(cam, spd);
-        }
-        if (inputIsKeyDown('A')){
-            cameraMoveLeft(cam, spd);
-        }
-        if (inputIsKeyDown('D')){
-            cameraMoveRight(cam, spd);
-        }
-        if (inputIsKeyDown('E')){
-            cameraMoveForward(cam, spd);
-        }
-        if (inputIsKeyDown('Q')){
-            cameraMoveBackward(cam, spd);
-        }
-        if (inputIsKeyDown('Z')){
-            cameraYaw(cam, spd);
-        }
-        if (inputIsKeyDown('X')){
-            cameraYaw(cam, -spd);
-        }
-        // END TEMP
-        systemPtr->rb.updateGlobalState(systemPtr->projection, cameraViewGet(cam), vec3Zero(), vec4One(), 0);
+        systemPtr->rb.updateGlobalState(systemPtr->projection, renderHeader->view, vec3Zero(), vec4One(), 0);
         
         u32 count = renderHeader->geometryCnt;
         for (u32 i = 0; i < count; i++){
             systemPtr->rb.drawGeometry(renderHeader->geometries[i]);
         }
+        frameStatsCount(FRAME_COUNTER_DRAWS, count);
 
         if (!systemPtr->rb.endRenderpass(&systemPtr->rb, BUILTIN_RENDERPASS_WORLD)){
             FERROR("EndRenderpass for BUILTIN_RENDERPASS_WORLD failed.");
@@ -148,6 +98,7 @@ b8 rendererDraw(renderHeader* renderHeader){
         for (u32 i = 0; i < uiCount; i++){
             systemPtr->rb.drawGeometry(renderHeader->uiGeometries[i]);
         }
+        frameStatsCount(FRAME_COUNTER_DRAWS, uiCount);
 
         if (!systemPtr->rb.endRenderpass(&systemPtr->rb, BUILTIN_RENDERPASS_UI)){
             FERROR("EndRenderpass for BUILTIN_RENDERPASS_UI failed.");
@@ -164,6 +115,18 @@ b8 rendererDraw(renderHeader* renderHeader){
     return true;
 }
 
+void rendererBeginGpuScope(const char* name) {
+    if (systemPtr && systemPtr->rb.beginGpuScope) {
+        systemPtr->rb.beginGpuScope(name);
+    }
+}
+
+void rendererEndGpuScope() {
+    if (systemPtr && systemPtr->rb.endGpuScope) {
+        systemPtr->rb.endGpuScope();
+    }
+}
+
 void rendererCreateTexture(const u8* pixels, struct texture* texture) {
     systemPtr->rb.createTexture(pixels, texture);
 }
@@ -4,13 +4,26 @@
 
 struct platformState;
 
-b8 rendererInit(u64* memoryRequirement, void* memoryState, const char* appName);
+b8 rendererInit(u64* memoryRequirement, void* memoryState, const char* appName, rendererBackendAPI api);
 void rendererShutdown();
 
 void rendererOnResize(u16 width, u16 height);
 
 b8 rendererDraw(renderHeader* header);
 
+/**
+ * @brief Starts timing a scope on the GPU. Results show up on the profiler's
+ * GPU track a couple of frames later. Only records while a frame is being
+ * drawn, so call it from inside rendererDraw.
+ * @param name The scope's name. Must outlive the profiler, so use a literal
+ */
+FSNAPI void rendererBeginGpuScope(const char* name);
+
+/**
+ * @brief Ends the last GPU scope started.
+ */
+FSNAPI void rendererEndGpuScope();
+
 void rendererCreateTexture(const u8* pixels, struct texture* texture);
 void rendererDestroyTexture(struct texture* texture);
 
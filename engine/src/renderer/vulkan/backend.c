@@ -8,8 +8,10 @@
 #include "vulkanImage.h"
 #include "vulkanPlatform.h"
 #include "vulkanSwapchain.h"
+#include "vulkanTimestamps.h"
 
 #include "core/application.h"
+#include "core/counters.h"
 #include "core/fmemory.h"
 #include "core/fstring.h"
 #include "core/logger.h"
@@ -60,6 +62,8 @@ b8 uploadDataViaStagingBuffer(vulkanHeader* header, VkCommandPool pool,
                        true, true, &vb);
 
     vulkanBufferLoadData(header, &vb, 0, size, 0, data);
+    FCOUNTER_INC("vulkan.stagingUploads");
+    FCOUNTER_ADD("vulkan.stagingBytes", size);
 
     // Vulkan copy buffers
     vulkanBufferCopyTo(header, pool, fence, queue, vb.buffer, 0, buffer->buffer,
@@ -98,6 +102,25 @@ b8 createBuffers(vulkanHeader* header) {
     return true;
 }
 
+// Destroys the textures no frame in flight can be using anymore, or all of
+// them if the device is idle.
+static void destroyRetiredTextures(b8 all) {
+    u64 cnt = dinoLength(header.retiredTextures);
+    u64 kept = 0;
+    for (u64 i = 0; i < cnt; ++i) {
+        vulkanRetiredTexture* r = &header.retiredTextures[i];
+        if (!all && header.fenceWaitCnt < r->retireAt) {
+            header.retiredTextures[kept++] = *r;
+            continue;
+        }
+        vulkanImageDestroy(&header, &r->data->image);
+        vkDestroySampler(header.device.logicalDevice, r->data->sampler,
+                         header.allocator);
+        ffree(r->data, sizeof(vulkanTextureData), MEMORY_TAG_TEXTURE);
+    }
+    dinoLengthSet(header.retiredTextures, kept);
+}
+
 b8 vulkanInit(struct rendererBackend* backend, const char* appName) {
 
     header.findMemoryIdx = findMemoryIdx;
@@ -302,11 +325,17 @@ b8 vulkanInit(struct rendererBackend* backend, const char* appName) {
     // Create buffers
     createBuffers(&header);
 
+    if (!vulkanTimestampsCreate(&header)) {
+        FWARN("Failed to set up GPU timing, carrying on without it.");
+    }
+
     // Mark all geometries as invalid
     for (u32 i = 0; i < VULKAN_MAX_GEOMETRY_COUNT; ++i) {
         header.geometries[i].id = INVALID_ID;
     }
 
+    header.retiredTextures = dinoCreateReserve(64, vulkanRetiredTexture);
+
     FINFO("Vulkan Rendering subsystem inited");
     return true;
 }
@@ -315,6 +344,11 @@ void vulkanShutdown(struct rendererBackend* backend) {
     vkDeviceWaitIdle(header.device.logicalDevice);
 
     // Destroy in the opposite order of creation.
+    destroyRetiredTextures(true);
+    dinoDestroy(header.retiredTextures);
+    header.retiredTextures = 0;
+
+    vulkanTimestampsDestroy(&header);
 
     vulkanBufferDestroy(&header, &header.objectVertexBuffer);
     vulkanBufferDestroy(&header, &header.objectIndexBuffer);
@@ -509,6 +543,8 @@ b8 vulkanBeginFrame(struct rendererBackend* backend, f32 deltaTime) {
                vulkanResultStr(result, true));
         return false;
     }
+    header.fenceWaitCnt++;
+    destroyRetiredTextures(false);
 
     if (!vulkanSwapchainGetNextImgIdx(
             &header, &header.swapchain, UINT64_MAX,
@@ -521,6 +557,7 @@ b8 vulkanBeginFrame(struct rendererBackend* backend, f32 deltaTime) {
     vulkanCommandBuffer* cb = &header.graphicsCommandBuffers[header.imageIdx];
     vulkanCommandBufferReset(cb);
     vulkanCommandBufferBegin(cb, false, false, false);
+    vulkanTimestampsBeginFrame(&header, cb);
 
     // Dynamic state
     // Start at the bottom left corner
@@ -552,6 +589,7 @@ b8 vulkanBeginFrame(struct rendererBackend* backend, f32 deltaTime) {
 b8 vulkanEndFrame(struct rendererBackend* backend, f32 deltaTime) {
     vulkanCommandBuffer* cb = &header.graphicsCommandBuffers[header.imageIdx];
 
+    vulkanTimestampsEndFrame(&header, cb);
     vulkanCommandBufferEnd(cb);
 
     if (header.imagesInFlight[header.imageIdx] != VK_NULL_HANDLE) {
@@ -615,17 +653,20 @@ b8 vulkanEndFrame(struct rendererBackend* backend, f32 deltaTime) {
 b8 vulkanBeginRenderpass(struct rendererBackend* backend, u8 renderpassID) {
     VkFramebuffer fb = 0;
     vulkanRenderpass* rp = 0;
+    const char* scopeName = 0;
     vulkanCommandBuffer* cb = &header.graphicsCommandBuffers[header.imageIdx];
 
     switch (renderpassID) {
         case BUILTIN_RENDERPASS_WORLD: {
             fb = header.worldFrameBuffers[header.imageIdx];
             rp = &header.mainRenderpass;
+            scopeName = "worldPass";
             break;
         }
         case BUILTIN_RENDERPASS_UI: {
             fb = header.swapchain.framebuffers[header.imageIdx];
             rp = &header.uiRenderpass;
+            scopeName = "uiPass";
             break;
         }
         default: {
@@ -635,6 +676,7 @@ b8 vulkanBeginRenderpass(struct rendererBackend* backend, u8 renderpassID) {
         }
     }
 
+    vulkanTimestampBeginScope(&header, cb, scopeName);
     vulkanRenderpassBegin(cb, rp, fb);
 
     switch (renderpassID) {
@@ -672,9 +714,21 @@ b8 vulkanEndRenderpass(struct rendererBackend* backend, u8 renderpassID) {
     }
 
     vulkanRenderpassEnd(cb, rp);
+    vulkanTimestampEndScope(&header, cb);
     return true;
 }
 
+void vulkanBeginGpuScope(const char* name) {
+    vulkanTimestampBeginScope(&header,
+                              &header.graphicsCommandBuffers[header.imageIdx],
+                              name);
+}
+
+void vulkanEndGpuScope() {
+    vulkanTimestampEndScope(&header,
+                            &header.graphicsCommandBuffers[header.imageIdx]);
+}
+
 VKAPI_ATTR VkBool32 VKAPI_CALL vk_debugCallback(
     VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
     VkDebugUtilsMessageTypeFlagsEXT messageTypes,
@@ -878,6 +932,10 @@ b8 vulkanCreateTexture(const u8* pixels, texture* outTexture) {
                          outTexture->width * outTexture->height *
                              outTexture->channelCnt,
                          0, pixels);
+    FCOUNTER_INC("vulkan.stagingUploads");
+    FCOUNTER_ADD("vulkan.stagingBytes", outTexture->width *
+                                            outTexture->height *
+                                            outTexture->channelCnt);
 
     // TODO: Make this work for other textures
     //  NOTE: Lots of assumptions here, different texture types will require
@@ -936,11 +994,14 @@ b8 vulkanCreateTexture(const u8* pixels, texture* outTexture) {
 void vulkanDestroyTexture(texture* texture) {
     vulkanTextureData* data = (vulkanTextureData*)texture->data;
     if (data) {
-        vulkanImageDestroy(&header, &data->image);
-        vkDestroySampler(header.device.logicalDevice, data->sampler,
-                         header.allocator);
-        data->sampler = 0;
-        ffree(texture->data, sizeof(vulkanTextureData), MEMORY_TAG_TEXTURE);
+        // Textures get swapped out by reloads and async loads while frames
+        // in flight could still be using them, so the destroy waits until
+        // every frame begun so far has finished.
+        vulkanRetiredTexture retired;
+        retired.data = data;
+        retired.retireAt =
+            header.fenceWaitCnt + header.swapchain.maxNumOfFramesInFlight + 1;
+        dinoPush(header.retiredTextures, retired);
     }
     fzeroMemory(texture, sizeof(struct texture));
 }
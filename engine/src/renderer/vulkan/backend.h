@@ -17,6 +17,9 @@ b8 vulkanEndFrame(struct rendererBackend* backend, f32 deltaTime);
 b8 vulkanBeginRenderpass(struct rendererBackend* backend, u8 renderpassID);
 b8 vulkanEndRenderpass(struct rendererBackend* backend, u8 renderpassID);
 
+void vulkanBeginGpuScope(const char* name);
+void vulkanEndGpuScope();
+
 b8 vulkanCreateTexture(const u8* pixels, texture* outTexture);
 void vulkanDestroyTexture(struct texture* texture);
 
@@ -1,4 +1,5 @@
 #include "vulkanMaterialShader.h"
+#include "core/counters.h"
 #include "core/fmemory.h"
 #include "core/fstring.h"
 #include "core/logger.h"
@@ -413,7 +414,9 @@ void vulkanMaterialShaderApplyMaterial(vulkanHeader* header,
         }
     }
 
+    FCOUNTER_INC("vulkan.materialApplies");
     if (descriptorUpdatedCnt > 0) {
+        FCOUNTER_ADD("vulkan.descriptorWrites", descriptorUpdatedCnt);
         vkUpdateDescriptorSets(header->device.logicalDevice,
                                descriptorUpdatedCnt, descriptorWrites, 0, 0);
     }
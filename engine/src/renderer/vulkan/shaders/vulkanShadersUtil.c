@@ -11,7 +11,7 @@ b8 createShaderModule(vulkanHeader* header, char* name, char* shaderType,
     strFmt(filename, "shaders/%s.%s.spv", name, shaderType);
 
     resource binRes;
-    if (!resourceLoad(filename, RESOURCE_TYPE_BINARY, &binRes)) {
+    if (!resourceLoad(filename, RESOURCE_TYPE_BINARY_MAPPED, &binRes)) {
         FERROR("Unable to read shader file: %s", filename);
         return false;
     }
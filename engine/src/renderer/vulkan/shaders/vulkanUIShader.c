@@ -1,4 +1,5 @@
 #include "vulkanUIShader.h"
+#include "core/counters.h"
 #include "core/fmemory.h"
 #include "core/fstring.h"
 #include "core/logger.h"
@@ -408,7 +409,9 @@ void vulkanUIShaderApplyMaterial(vulkanHeader* header,
         }
     }
 
+    FCOUNTER_INC("vulkan.materialApplies");
     if (descriptorUpdatedCnt > 0) {
+        FCOUNTER_ADD("vulkan.descriptorWrites", descriptorUpdatedCnt);
         vkUpdateDescriptorSets(header->device.logicalDevice,
                                descriptorUpdatedCnt, descriptorWrites, 0, 0);
     }
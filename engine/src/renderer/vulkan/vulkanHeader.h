@@ -14,6 +14,11 @@
 #define VULKAN_OVERALL_MAX_OBJECT_COUNT 1024
 #define MATERIAL_SHADER_STAGE_COUNT 2
 
+// GPU timing scopes a frame can record, including the whole frame's.
+#define VULKAN_MAX_TIMESTAMP_SCOPES 32
+// How deep timing scopes can nest.
+#define VULKAN_MAX_TIMESTAMP_DEPTH 8
+
 // Checks the given expression's return value is OK.
 #define VULKANSUCCESS(expr)          \
     {                                \
@@ -256,6 +261,41 @@ typedef struct vulkanTextureData {
     VkSampler sampler;
 } vulkanTextureData;
 
+// A destroyed texture's data, kept until no frame in flight can be using it.
+typedef struct vulkanRetiredTexture {
+    vulkanTextureData* data;
+    // Safe to destroy once fenceWaitCnt gets here.
+    u64 retireAt;
+} vulkanRetiredTexture;
+
+// One frame in flight's timestamp queries. Scope i writes queries 2i and 2i+1.
+typedef struct vulkanTimestampFrame {
+    VkQueryPool pool;
+    u32 scopeCnt;
+    const char* names[VULKAN_MAX_TIMESTAMP_SCOPES];
+    // When the frame was submitted, in platformGetRawTimestampNs time.
+    u64 submitNs;
+    // Submitted and not read back yet.
+    b8 pending;
+} vulkanTimestampFrame;
+
+typedef struct vulkanTimestamps {
+    // False if the graphics queue can't write timestamps.
+    b8 supported;
+    // Nanoseconds per timestamp tick.
+    f64 period;
+    // The bits of a timestamp that are valid.
+    u64 validMask;
+    // The profiler track results go on.
+    u32 profilerTrack;
+    // One per frame in flight.
+    vulkanTimestampFrame frames[3];
+    // The frame being recorded, 0 outside of a frame.
+    vulkanTimestampFrame* recording;
+    u32 openScopes[VULKAN_MAX_TIMESTAMP_DEPTH];
+    u32 openCnt;
+} vulkanTimestamps;
+
 typedef struct vulkanHeader{
     VkInstance instance;
     VkAllocationCallbacks* allocator;
@@ -292,6 +332,11 @@ typedef struct vulkanHeader{
 
     u32 imageIdx;
     u32 currentFrame;
+    // How many times beginFrame has waited on an in flight fence.
+    u64 fenceWaitCnt;
+
+    //Dino Array
+    vulkanRetiredTexture* retiredTextures;
 
     b8 recreatingSwapchain;
 
@@ -314,4 +359,6 @@ typedef struct vulkanHeader{
 
     vulkanOverallShader materialShader;
     vulkanOverallShader uiShader;
+
+    vulkanTimestamps timestamps;
 } vulkanHeader;
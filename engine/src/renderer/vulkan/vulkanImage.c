@@ -83,7 +83,8 @@ void vulkanImageViewCreate(
 }
 
 void vulkanImageDestroy(vulkanHeader* header, vulkanImage* image) {
-    vkDeviceWaitIdle(header->device.logicalDevice);
+    // Callers make sure the GPU is done with it. Idling here would stall
+    // every texture release.
     if (image){
         if (image->view) {
             vkDestroyImageView(header->device.logicalDevice, image->view, header->allocator);
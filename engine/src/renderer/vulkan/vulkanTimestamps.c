@@ -0,0 +1,163 @@
+#include "vulkanTimestamps.h"
+
+#include "core/fmemory.h"
+#include "core/frameStats.h"
+#include "core/logger.h"
+#include "core/profiler.h"
+#include "platform/platform.h"
+
+// Marks a scope that didn't get queries so ending it still pops the stack.
+#define NO_SCOPE INVALID_ID
+
+b8 vulkanTimestampsCreate(vulkanHeader* header) {
+    vulkanTimestamps* ts = &header->timestamps;
+    fzeroMemory(ts, sizeof(vulkanTimestamps));
+
+    u32 familyCnt = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(header->device.physicalDevice, &familyCnt, 0);
+    VkQueueFamilyProperties families[32];
+    if (familyCnt > 32) {
+        familyCnt = 32;
+    }
+    vkGetPhysicalDeviceQueueFamilyProperties(header->device.physicalDevice, &familyCnt, families);
+
+    u32 validBits = 0;
+    if (header->device.graphicsQueueIdx >= 0 && (u32)header->device.graphicsQueueIdx < familyCnt) {
+        validBits = families[header->device.graphicsQueueIdx].timestampValidBits;
+    }
+    if (validBits == 0) {
+        FWARN("The graphics queue can't write timestamps, GPU timing is off.");
+        return true;
+    }
+    ts->validMask = validBits >= 64 ? ~(u64)0 : (((u64)1 << validBits) - 1);
+    ts->period = header->device.properties.limits.timestampPeriod;
+
+    VkQueryPoolCreateInfo poolInfo = {VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = VULKAN_MAX_TIMESTAMP_SCOPES * 2;
+    for (u32 i = 0; i < 3; ++i) {
+        VkResult res = vkCreateQueryPool(header->device.logicalDevice, &poolInfo, header->allocator,
+                                         &ts->frames[i].pool);
+        if (res != VK_SUCCESS) {
+            FERROR("Failed to create a timestamp query pool.");
+            vulkanTimestampsDestroy(header);
+            return false;
+        }
+    }
+
+    ts->profilerTrack = profilerCreateTrack("GPU");
+    ts->supported = true;
+    FDEBUG("GPU timing on, %u valid timestamp bits, %.3fns a tick.", validBits, ts->period);
+    return true;
+}
+
+void vulkanTimestampsDestroy(vulkanHeader* header) {
+    vulkanTimestamps* ts = &header->timestamps;
+    for (u32 i = 0; i < 3; ++i) {
+        if (ts->frames[i].pool) {
+            vkDestroyQueryPool(header->device.logicalDevice, ts->frames[i].pool, header->allocator);
+            ts->frames[i].pool = 0;
+        }
+    }
+    ts->supported = false;
+}
+
+// Hands a finished frame's scopes to the profiler. The GPU's clock isn't the
+// CPU's, so the frame is lined up to start when it was submitted. Good enough
+// to see how the GPU's work lines up with the CPU frames around it.
+static void readBack(vulkanHeader* header, vulkanTimestampFrame* f) {
+    vulkanTimestamps* ts = &header->timestamps;
+    f->pending = false;
+    if (f->scopeCnt == 0) {
+        return;
+    }
+
+    u64 results[VULKAN_MAX_TIMESTAMP_SCOPES * 2];
+    VkResult res = vkGetQueryPoolResults(header->device.logicalDevice, f->pool, 0, f->scopeCnt * 2,
+                                         sizeof(results), results, sizeof(u64), VK_QUERY_RESULT_64_BIT);
+    // Never wait on them. Not ready means the frame never got submitted.
+    if (res != VK_SUCCESS) {
+        return;
+    }
+
+    u64 base = results[0];
+    for (u32 i = 0; i < f->scopeCnt; ++i) {
+        u64 start = (u64)(((results[i * 2] - base) & ts->validMask) * ts->period);
+        u64 end = (u64)(((results[i * 2 + 1] - base) & ts->validMask) * ts->period);
+        profilerRecordZone(ts->profilerTrack, f->names[i], f->submitNs + start, f->submitNs + end);
+    }
+    // Scope 0 is the whole frame.
+    frameStatsAddPhaseTime(FRAME_PHASE_GPU, (u64)(((results[1] - base) & ts->validMask) * ts->period));
+}
+
+void vulkanTimestampsBeginFrame(vulkanHeader* header, vulkanCommandBuffer* commandBuffer) {
+    vulkanTimestamps* ts = &header->timestamps;
+    if (!ts->supported) {
+        return;
+    }
+    vulkanTimestampFrame* f = &ts->frames[header->currentFrame];
+    // The frame's fence was just waited on so its results are in.
+    if (f->pending) {
+        readBack(header, f);
+    }
+
+    vkCmdResetQueryPool(commandBuffer->handle, f->pool, 0, VULKAN_MAX_TIMESTAMP_SCOPES * 2);
+    f->scopeCnt = 0;
+    ts->openCnt = 0;
+    ts->recording = f;
+    vulkanTimestampBeginScope(header, commandBuffer, "gpuFrame");
+}
+
+void vulkanTimestampsEndFrame(vulkanHeader* header, vulkanCommandBuffer* commandBuffer) {
+    vulkanTimestamps* ts = &header->timestamps;
+    if (!ts->recording) {
+        return;
+    }
+    if (ts->openCnt > 1) {
+        FWARN("%u GPU timing scopes were left open at the end of the frame.", ts->openCnt - 1);
+    }
+    while (ts->openCnt > 0) {
+        vulkanTimestampEndScope(header, commandBuffer);
+    }
+    ts->recording->submitNs = platformGetRawTimestampNs();
+    ts->recording->pending = true;
+    ts->recording = 0;
+}
+
+void vulkanTimestampBeginScope(vulkanHeader* header, vulkanCommandBuffer* commandBuffer, const char* name) {
+    vulkanTimestamps* ts = &header->timestamps;
+    vulkanTimestampFrame* f = ts->recording;
+    if (!f) {
+        return;
+    }
+    // Still counted so the matching end pops the right scope.
+    if (ts->openCnt >= VULKAN_MAX_TIMESTAMP_DEPTH) {
+        FWARN("GPU timing scopes nested too deep, '%s' won't be timed.", name);
+        ts->openCnt++;
+        return;
+    }
+
+    u32 scope = NO_SCOPE;
+    if (f->scopeCnt < VULKAN_MAX_TIMESTAMP_SCOPES) {
+        scope = f->scopeCnt++;
+        f->names[scope] = name;
+        vkCmdWriteTimestamp(commandBuffer->handle, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, f->pool, scope * 2);
+    }
+    ts->openScopes[ts->openCnt++] = scope;
+}
+
+void vulkanTimestampEndScope(vulkanHeader* header, vulkanCommandBuffer* commandBuffer) {
+    vulkanTimestamps* ts = &header->timestamps;
+    vulkanTimestampFrame* f = ts->recording;
+    if (!f || ts->openCnt == 0) {
+        return;
+    }
+    ts->openCnt--;
+    if (ts->openCnt >= VULKAN_MAX_TIMESTAMP_DEPTH) {
+        return;
+    }
+    u32 scope = ts->openScopes[ts->openCnt];
+    if (scope != NO_SCOPE) {
+        vkCmdWriteTimestamp(commandBuffer->handle, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, f->pool, scope * 2 + 1);
+    }
+}
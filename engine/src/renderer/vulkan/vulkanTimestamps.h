@@ -0,0 +1,49 @@
+#pragma once
+#include "vulkanHeader.h"
+
+/**
+ * @brief Creates a timestamp query pool per frame in flight. Leaves GPU
+ * timing off if the graphics queue can't write timestamps.
+ * @param header The vulkan header
+ * @returns true if successful, false if a pool couldn't be created
+ */
+b8 vulkanTimestampsCreate(vulkanHeader* header);
+
+/**
+ * @brief Destroys the query pools. The device must be idle.
+ * @param header The vulkan header
+ */
+void vulkanTimestampsDestroy(vulkanHeader* header);
+
+/**
+ * @brief Reads back the results from the last time this frame in flight was
+ * used and hands them to the profiler, then resets its queries and opens the
+ * frame's scope. Call after the frame's fence has been waited on, right after
+ * the command buffer begins.
+ * @param header The vulkan header
+ * @param commandBuffer The frame's command buffer
+ */
+void vulkanTimestampsBeginFrame(vulkanHeader* header, vulkanCommandBuffer* commandBuffer);
+
+/**
+ * @brief Closes any open scopes and the frame's scope. Call right before the
+ * command buffer ends.
+ * @param header The vulkan header
+ * @param commandBuffer The frame's command buffer
+ */
+void vulkanTimestampsEndFrame(vulkanHeader* header, vulkanCommandBuffer* commandBuffer);
+
+/**
+ * @brief Starts timing a scope on the GPU. Scopes nest.
+ * @param header The vulkan header
+ * @param commandBuffer The frame's command buffer
+ * @param name The scope's name. Must outlive the profiler, so use a literal
+ */
+void vulkanTimestampBeginScope(vulkanHeader* header, vulkanCommandBuffer* commandBuffer, const char* name);
+
+/**
+ * @brief Ends the last scope started.
+ * @param header The vulkan header
+ * @param commandBuffer The frame's command buffer
+ */
+void vulkanTimestampEndScope(vulkanHeader* header, vulkanCommandBuffer* commandBuffer);
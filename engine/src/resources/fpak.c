@@ -0,0 +1,157 @@
+#include "fpak.h"
+
+#include "core/fmemory.h"
+#include "core/fstring.h"
+#include "core/logger.h"
+
+#include <string.h>
+
+#define FPAK_PRIME0 0x9E3779B185EBCA87ULL
+#define FPAK_PRIME1 0xC2B2AE3D27D4EB4FULL
+
+static inline u64 read64(const u8* p) {
+    u64 v;
+    __builtin_memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline u64 rotl64(u64 v, u32 r) {
+    return (v << r) | (v >> (64 - r));
+}
+
+static inline u64 mixLane(u64 lane, u64 v) {
+    return rotl64(lane ^ (v * FPAK_PRIME1), 31) * FPAK_PRIME0;
+}
+
+u64 fpakHashName(const char* name, u64 len) {
+    // FNV-1a
+    u64 hash = 0xCBF29CE484222325ULL;
+    for (u64 i = 0; i < len; ++i) {
+        hash ^= (u8)name[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+u64 fpakChecksum(const void* data, u64 size) {
+    const u8* p = data;
+    const u8* end = p + size;
+    // Four lanes that don't depend on each other so they can run in parallel.
+    u64 lanes[4] = {FPAK_PRIME0, FPAK_PRIME1, FPAK_PRIME0 ^ FPAK_PRIME1, FPAK_PRIME0 + FPAK_PRIME1};
+    while (end - p >= 32) {
+        lanes[0] = mixLane(lanes[0], read64(p));
+        lanes[1] = mixLane(lanes[1], read64(p + 8));
+        lanes[2] = mixLane(lanes[2], read64(p + 16));
+        lanes[3] = mixLane(lanes[3], read64(p + 24));
+        p += 32;
+    }
+    u64 hash = rotl64(lanes[0], 1) + rotl64(lanes[1], 7) + rotl64(lanes[2], 12) + rotl64(lanes[3], 18);
+    hash += size;
+    while (end - p >= 8) {
+        hash = mixLane(hash, read64(p));
+        p += 8;
+    }
+    while (p < end) {
+        hash = mixLane(hash, *p++);
+    }
+    // Final avalanche.
+    hash ^= hash >> 33;
+    hash *= FPAK_PRIME1;
+    hash ^= hash >> 29;
+    hash *= FPAK_PRIME0;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+b8 fpakOpen(const char* path, fpak* outPak) {
+    fzeroMemory(outPak, sizeof(fpak));
+    if (!fsMap(path, FILE_MAP_HINT_NONE, &outPak->mapping)) {
+        return false;
+    }
+
+    const u8* base = outPak->mapping.data;
+    u64 size = outPak->mapping.size;
+    const fpakHeader* header = (const fpakHeader*)base;
+    if (size < sizeof(fpakHeader) || header->magic != FPAK_MAGIC || header->version != FPAK_VERSION) {
+        FERROR("'%s' isn't an archive this version can read.", path);
+        fpakClose(outPak);
+        return false;
+    }
+    u64 tocSize = (u64)header->entryCnt * sizeof(fpakEntry);
+    if (header->tocOffset % sizeof(u64) != 0 || header->tocOffset > size || tocSize > size - header->tocOffset || header->namesOffset > size ||
+        header->namesSize > size - header->namesOffset || header->namesOffset != header->tocOffset + tocSize) {
+        FERROR("Archive '%s' is truncated or corrupt.", path);
+        fpakClose(outPak);
+        return false;
+    }
+    if (fpakChecksum(base + header->tocOffset, tocSize + header->namesSize) != header->tocChecksum) {
+        FERROR("Archive '%s' has a corrupt table of contents.", path);
+        fpakClose(outPak);
+        return false;
+    }
+
+    const fpakEntry* entries = (const fpakEntry*)(base + header->tocOffset);
+    for (u32 i = 0; i < header->entryCnt; ++i) {
+        const fpakEntry* e = &entries[i];
+        if (e->offset > header->tocOffset || e->size > header->tocOffset - e->offset ||
+            (u64)e->nameOffset + e->nameLen > header->namesSize) {
+            FERROR("Archive '%s' has an entry outside of the archive.", path);
+            fpakClose(outPak);
+            return false;
+        }
+    }
+
+    outPak->header = header;
+    outPak->entries = entries;
+    outPak->names = (const char*)(base + header->namesOffset);
+    FINFO("Opened archive '%s' with %u entries.", path, header->entryCnt);
+    return true;
+}
+
+void fpakClose(fpak* pak) {
+    fsUnmap(&pak->mapping);
+    pak->header = 0;
+    pak->entries = 0;
+    pak->names = 0;
+}
+
+const fpakEntry* fpakFind(const fpak* pak, const char* name) {
+    if (!pak->header) {
+        return 0;
+    }
+    u64 len = strLen(name);
+    u64 hash = fpakHashName(name, len);
+
+    // Lower bound of the hash.
+    u32 lo = 0;
+    u32 hi = pak->header->entryCnt;
+    while (lo < hi) {
+        u32 mid = lo + (hi - lo) / 2;
+        if (pak->entries[mid].nameHash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    // Names with the same hash are next to each other.
+    for (u32 i = lo; i < pak->header->entryCnt && pak->entries[i].nameHash == hash; ++i) {
+        const fpakEntry* e = &pak->entries[i];
+        if (e->nameLen == len && memcmp(pak->names + e->nameOffset, name, len) == 0) {
+            return e;
+        }
+    }
+    return 0;
+}
+
+const void* fpakEntryData(const fpak* pak, const fpakEntry* entry) {
+    return (const u8*)pak->mapping.data + entry->offset;
+}
+
+b8 fpakVerifyEntry(const fpak* pak, const fpakEntry* entry) {
+    return fpakChecksum(fpakEntryData(pak, entry), entry->size) == entry->checksum;
+}
+
+b8 fpakContains(const fpak* pak, const void* ptr) {
+    const u8* base = pak->mapping.data;
+    return base && (const u8*)ptr >= base && (const u8*)ptr < base + pak->mapping.size;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "defines.h"
+#include "platform/filesystem.h"
+
+/*
+ * .fpak asset archives. Everything under Assets/ goes into one file so a load
+ * is a lookup into one mapping instead of an open and stat per file.
+ *
+ * Layout:
+ *   fpakHeader
+ *   entry data, each entry starting on an FPAK_ALIGNMENT boundary
+ *   fpakEntry table of contents, sorted by nameHash
+ *   entry names, not null terminated
+ */
+
+#define FPAK_MAGIC 0x4B415046 // "FPAK"
+#define FPAK_VERSION 1
+#define FPAK_ALIGNMENT 4096
+
+typedef enum fpakCompression {
+    FPAK_COMPRESSION_NONE = 0,
+    // One helpers/blockCompress block.
+    FPAK_COMPRESSION_LZ4 = 1,
+} fpakCompression;
+
+typedef struct fpakHeader {
+    u32 magic;
+    u32 version;
+    u32 entryCnt;
+    u32 reserved;
+    u64 tocOffset;
+    u64 namesOffset;
+    u64 namesSize;
+    // fpakChecksum of the table of contents and names together.
+    u64 tocChecksum;
+} fpakHeader;
+
+typedef struct fpakEntry {
+    // fpakHashName of the entry's name.
+    u64 nameHash;
+    // Where the entry's data starts in the archive.
+    u64 offset;
+    // How many bytes the entry takes up in the archive.
+    u64 size;
+    // How big the entry is once decompressed. The same as size if it isn't.
+    u64 rawSize;
+    // fpakChecksum of the size bytes at offset.
+    u64 checksum;
+    // Where the name starts in the names block.
+    u32 nameOffset;
+    u16 nameLen;
+    // An fpakCompression.
+    u8 compression;
+    u8 reserved;
+} fpakEntry;
+
+// An open archive. Everything points into its mapping.
+typedef struct fpak {
+    fileMapping mapping;
+    const fpakHeader* header;
+    const fpakEntry* entries;
+    const char* names;
+} fpak;
+
+/**
+ * @brief Hashes an entry name for the table of contents.
+ * @param name The name, a path relative to the packed directory using '/'
+ * @param len The name's length
+ * @returns The hash
+ */
+FSNAPI u64 fpakHashName(const char* name, u64 len);
+
+/**
+ * @brief Checksums entry data. Runs close to memory speed so loads can afford it.
+ * @param data The data
+ * @param size The data's size
+ * @returns The checksum
+ */
+FSNAPI u64 fpakChecksum(const void* data, u64 size);
+
+/**
+ * @brief Maps an archive and checks its table of contents.
+ * @param path The archive's path
+ * @param outPak The opened archive
+ * @returns true if opened, false if it's missing or not a valid archive
+ */
+FSNAPI b8 fpakOpen(const char* path, fpak* outPak);
+
+/**
+ * @brief Unmaps an archive. Nothing from it can be used after this.
+ * @param pak The archive
+ */
+FSNAPI void fpakClose(fpak* pak);
+
+/**
+ * @brief Finds an entry by name.
+ * @param pak The archive
+ * @param name The entry's name, a path relative to the packed directory
+ * @returns The entry, or 0 if it isn't in the archive
+ */
+FSNAPI const fpakEntry* fpakFind(const fpak* pak, const char* name);
+
+/**
+ * @brief Gets an entry's data as it's stored, so still compressed if it is.
+ * @param pak The archive
+ * @param entry The entry
+ * @returns A read-only view of the entry's size bytes
+ */
+FSNAPI const void* fpakEntryData(const fpak* pak, const fpakEntry* entry);
+
+/**
+ * @brief Checks an entry's data against its checksum.
+ * @param pak The archive
+ * @param entry The entry
+ * @returns true if it matches
+ */
+FSNAPI b8 fpakVerifyEntry(const fpak* pak, const fpakEntry* entry);
+
+/**
+ * @brief Whether a pointer points into the archive's mapping.
+ * @param pak The archive
+ * @param ptr The pointer
+ * @returns true if it's archive memory
+ */
+FSNAPI b8 fpakContains(const fpak* pak, const void* ptr);
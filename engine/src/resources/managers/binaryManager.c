@@ -7,44 +7,38 @@
 #include "resources/resourcesTypes.h"
 
 #include "platform/filesystem.h"
+#include "resources/vfs.h"
 
 b8 binaryManagerLoad(resourceManager* self, const char* name, resource* outRes){
     if (!self || !name || !outRes){
         return false;
     }
 
-    char* fmtStr = "%s/%s%s";
-    char path[512];
-    strFmt(path, fmtStr, resourceManagerRootAssetPath(), name, "");
-
-    fileHandle fh;
-    if (!fsOpen(path, FILE_MODE_READ, true, &fh)){
-        FERROR("Binary Manager unable to load binary file: %s", path);
+    vfsMapping mapping;
+    if (!vfsMap(name, FILE_MAP_HINT_SEQUENTIAL, &mapping)){
+        FERROR("Binary Manager unable to load binary file: %s", name);
         return false;
     }
-
-    //TODO: Could be memory leaks
-    outRes->fullPath = strDup(path);
-
-    u64 fileSize = 0;
-    if (!fsSize(&fh, &fileSize)){
-        FERROR("Failed to get binary file size: %s", path);
+    if (mapping.size > 0xFFFFFFFFULL){
+        FERROR("Binary file is too big for a resource: %s", mapping.path);
+        vfsUnmap(&mapping);
         return false;
     }
 
-    u8* resData = fallocate(sizeof(u8*) * fileSize, MEMORY_TAG_ARRAY);
-    u64 readSize = 0;
-    if (!fsReadFileBytes(&fh, resData, &readSize)){
-        FERROR("Failed to read binary file: %s", path);
-        fsClose(&fh);
-        return false;
+    // Decompressed archive entries are already an allocation of their own to keep.
+    void* resData = mapping.owned;
+    if (resData){
+        mapping.owned = 0;
+    } else {
+        resData = fallocate(mapping.size, MEMORY_TAG_ARRAY);
+        fcopyMemory(resData, mapping.data, mapping.size);
     }
 
-    fsClose(&fh);
-
+    outRes->fullPath = strDup(mapping.path);
     outRes->data = resData;
-    outRes->dataSize = readSize;
+    outRes->dataSize = (u32)mapping.size;
     outRes->name = name;
+    vfsUnmap(&mapping);
 
     return true;
 }
@@ -74,5 +68,67 @@ resourceManager binaryManagerCreate(){
     m.id = RESOURCE_TYPE_BINARY;
     m.load = binaryManagerLoad;
     m.unload = binaryManagerUnload;
+    m.mainThreadOnly = false;
+    return m;
+}
+
+b8 binaryMappedManagerLoad(resourceManager* self, const char* name, resource* outRes){
+    if (!self || !name || !outRes){
+        return false;
+    }
+
+    // Archive and overlay files are already in memory, so they're handed out as is.
+    vfsMapping mapping;
+    if (!vfsMap(name, FILE_MAP_HINT_SEQUENTIAL | FILE_MAP_HINT_WILL_NEED, &mapping)){
+        FERROR("Binary Manager unable to map binary file: %s", name);
+        return false;
+    }
+    if (mapping.size > 0xFFFFFFFFULL){
+        FERROR("Binary file is too big for a resource: %s", mapping.path);
+        vfsUnmap(&mapping);
+        return false;
+    }
+    // Decompressed archive entries are an allocation, which the plain binary
+    // manager knows how to free.
+    if (mapping.owned){
+        outRes->managerID = RESOURCE_TYPE_BINARY;
+    }
+
+    outRes->fullPath = strDup(mapping.path);
+    outRes->data = (void*)mapping.data;
+    outRes->dataSize = (u32)mapping.size;
+    outRes->name = name;
+    return true;
+}
+
+void binaryMappedManagerUnload(resourceManager* self, resource* res){
+    if (!self || !res){
+        FWARN("BinaryMappedManagerUnload - Manager or Resource is null.");
+        return;
+    }
+
+    u32 pathLen = strLen(res->fullPath);
+    if (pathLen){
+        ffree(res->fullPath, sizeof(char) * pathLen + 1, MEMORY_TAG_STRING);
+        res->fullPath = 0;
+    }
+
+    // Archive and overlay views go away with their mount.
+    if (!vfsIsMountMemory(res->data)){
+        fileMapping mapping = {res->data, res->dataSize};
+        fsUnmap(&mapping);
+    }
+    res->data = 0;
+    res->dataSize = 0;
+    res->managerID = INVALID_ID;
+}
+
+resourceManager binaryMappedManagerCreate(){
+    resourceManager m;
+    m.resourceType = RESOURCE_TYPE_BINARY_MAPPED;
+    m.id = RESOURCE_TYPE_BINARY_MAPPED;
+    m.load = binaryMappedManagerLoad;
+    m.unload = binaryMappedManagerUnload;
+    m.mainThreadOnly = false;
     return m;
 }
@@ -1,3 +1,9 @@
 #include "resources/resourceManager.h"
 
-resourceManager binaryManagerCreate();
\ No newline at end of file
+resourceManager binaryManagerCreate();
+
+/**
+ * @brief Creates the manager for RESOURCE_TYPE_BINARY_MAPPED. It maps the file
+ * and hands out a read-only view of it, so loading costs no copies and no heap.
+ */
+resourceManager binaryMappedManagerCreate();
\ No newline at end of file
@@ -2,58 +2,193 @@
 #include "core/logger.h"
 #include "core/fstring.h"
 #include "core/fmemory.h"
+#include "helpers/blockCompress.h"
+#include "platform/filesystem.h"
+#include "resources/fpak.h"
+#include "resources/resourceManager.h"
+#include "resources/vfs.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_FAILURE_USERMSG
 #include "dependencies/stb_image.h"
 
-b8 imageManagerLoad(resourceManager* self, const char* name, resource* outResource){
-    char* formatStr = "%s/%s";
-    const i32 reqChannelCnt = 4;
-    stbi_set_flip_vertically_on_load(true);
-    char fullFilePath[512];
+#define IMAGE_CACHE_MAGIC 0x58455446 // "FTEX"
+#define IMAGE_CACHE_VERSION 1
+#define IMAGE_CACHE_READ_SIZE KIBIBYTES(64)
 
-    strFmt(fullFilePath, formatStr, resourceManagerRootAssetPath(), name);
+// A decoded image in the cache, followed by its pixels as one blockCompress
+// block, so each PNG/JPG only gets decoded once.
+typedef struct imageCacheHeader {
+    u32 magic;
+    u32 version;
+    // fpakChecksum of the source image, so changing it misses the cache.
+    u64 sourceChecksum;
+    u32 width;
+    u32 height;
+    u32 channelCnt;
+    u32 reserved;
+    u64 pixelsSize;
+    u64 compressedSize;
+} imageCacheHeader;
 
-    i32 width;
-    i32 height;
-    i32 channelCnt;
+static void cacheFilePath(char* out, const char* name){
+    u64 dirLen = strFmt(out, "%s/", resourceManagerCachePath());
+    strFmt(out + dirLen, "%s.ftex", name);
+    // Keep the cache flat.
+    for (char* c = out + dirLen; *c; ++c){
+        if (*c == '/' || *c == '\\'){
+            *c = '_';
+        }
+    }
+}
 
-    u8* data = stbi_load(
-        fullFilePath,
-        &width,
-        &height,
-        &channelCnt,
-        reqChannelCnt);
+// Reads a cached image into an imageRS with its pixels in the same
+// allocation, decompressing as it reads so there's no staging copy.
+static imageRS* loadCached(const char* path, u64 sourceChecksum, u64* outSize){
+    fileHandle fh;
+    if (!fsExists(path) || !fsOpen(path, FILE_MODE_READ, true, &fh)){
+        return 0;
+    }
+    imageCacheHeader header;
+    u64 read = 0;
+    if (!fsRead(&fh, sizeof(header), &header, &read) || read != sizeof(header) ||
+        header.magic != IMAGE_CACHE_MAGIC || header.version != IMAGE_CACHE_VERSION ||
+        header.sourceChecksum != sourceChecksum || header.pixelsSize == 0 ||
+        header.pixelsSize != (u64)header.width * header.height * header.channelCnt ||
+        header.pixelsSize > 0xFFFFFFFFULL - sizeof(imageRS)){
+        fsClose(&fh);
+        return 0;
+    }
 
-    const char* failReason = stbi_failure_reason();
+    u64 size = sizeof(imageRS) + header.pixelsSize;
+    imageRS* irs = fallocate(size, MEMORY_TAG_TEXTURE);
+    irs->pixels = (u8*)(irs + 1);
 
-    if (data == NULL && failReason){
-        FERROR("Image Manager failed to get image %s", name);
-        stbi__err(0,0);
-        if (data){
-            stbi_image_free(data);
+    blockDecoder decoder;
+    blockDecoderBegin(&decoder, irs->pixels, header.pixelsSize);
+    blockDecoderResult result = BLOCK_DECODER_NEED_INPUT;
+    u8 chunk[IMAGE_CACHE_READ_SIZE];
+    u64 remaining = header.compressedSize;
+    while (remaining && result == BLOCK_DECODER_NEED_INPUT){
+        u64 want = remaining < sizeof(chunk) ? remaining : sizeof(chunk);
+        if (!fsRead(&fh, want, chunk, &read) || read == 0){
+            break;
         }
-        return false;
+        remaining -= read;
+        result = blockDecoderUpdate(&decoder, chunk, read);
     }
+    fsClose(&fh);
 
-    outResource->fullPath = strDup(fullFilePath);
+    if (result != BLOCK_DECODER_DONE || remaining){
+        FWARN("Image cache %s is corrupt, decoding the source again.", path);
+        ffree(irs, size, MEMORY_TAG_TEXTURE);
+        return 0;
+    }
+    irs->width = header.width;
+    irs->height = header.height;
+    irs->channelCnt = header.channelCnt;
+    *outSize = size;
+    return irs;
+}
 
-    imageRS* irs = fallocate(sizeof(imageRS), MEMORY_TAG_TEXTURE);
-    irs->width = width;
-    irs->height = height;
-    //TODO: Make it so it can use only 3 channels.
-    irs->channelCnt = reqChannelCnt;
-    //irs->channelCnt = channelCnt;
-    irs->pixels = data;
+static void writeCached(const char* path, u64 sourceChecksum, const imageRS* irs){
+    imageCacheHeader header = {0};
+    header.magic = IMAGE_CACHE_MAGIC;
+    header.version = IMAGE_CACHE_VERSION;
+    header.sourceChecksum = sourceChecksum;
+    header.width = irs->width;
+    header.height = irs->height;
+    header.channelCnt = irs->channelCnt;
+    header.pixelsSize = (u64)irs->width * irs->height * irs->channelCnt;
 
+    u64 bound = blockCompressBound(header.pixelsSize);
+    u8* compressed = fallocate(bound, MEMORY_TAG_ARRAY);
+    header.compressedSize = blockCompress(irs->pixels, header.pixelsSize, compressed, bound);
+
+    fileHandle fh;
+    u64 written = 0;
+    if (!header.compressedSize || !fsOpen(path, FILE_MODE_WRITE, true, &fh)){
+        FWARN("Couldn't write image cache %s", path);
+    } else {
+        fsWrite(&fh, sizeof(header), &header, &written);
+        fsWrite(&fh, header.compressedSize, compressed, &written);
+        fsClose(&fh);
+    }
+    ffree(compressed, bound, MEMORY_TAG_ARRAY);
+}
+
+b8 imageManagerLoadFromMemory(const char* name, const void* source, u64 sourceSize, const char* fullPath, resource* outResource){
+    const i32 reqChannelCnt = 4;
+    stbi_set_flip_vertically_on_load(true);
+
+    char cacheFile[512];
+    b8 useCache = resourceManagerCachePath() != 0;
+    u64 sourceChecksum = 0;
+    imageRS* irs = 0;
+    u64 irsSize = sizeof(imageRS);
+    if (useCache || resourceManagerHashesContent()){
+        sourceChecksum = fpakChecksum(source, sourceSize);
+        // 0 means it wasn't hashed.
+        sourceChecksum = sourceChecksum ? sourceChecksum : 1;
+    }
+    if (useCache){
+        cacheFilePath(cacheFile, name);
+        irs = loadCached(cacheFile, sourceChecksum, &irsSize);
+    }
+
+    if (!irs){
+        i32 width;
+        i32 height;
+        i32 channelCnt;
+        u8* data = stbi_load_from_memory(
+            source,
+            (i32)sourceSize,
+            &width,
+            &height,
+            &channelCnt,
+            reqChannelCnt);
+
+        if (data == NULL){
+            FERROR("Image Manager failed to get image %s: %s", name, stbi_failure_reason());
+            stbi__err(0,0);
+            return false;
+        }
+
+        irs = fallocate(sizeof(imageRS), MEMORY_TAG_TEXTURE);
+        irs->width = width;
+        irs->height = height;
+        //TODO: Make it so it can use only 3 channels.
+        irs->channelCnt = reqChannelCnt;
+        //irs->channelCnt = channelCnt;
+        irs->pixels = data;
+        irsSize = sizeof(imageRS);
+
+        if (useCache){
+            writeCached(cacheFile, sourceChecksum, irs);
+        }
+    }
+    outResource->managerID = RESOURCE_TYPE_IMAGE;
+    outResource->fullPath = strDup(fullPath);
     outResource->data = irs;
-    outResource->dataSize = sizeof(imageRS);
+    outResource->dataSize = (u32)irsSize;
+    outResource->contentHash = resourceManagerHashesContent() ? sourceChecksum : 0;
     outResource->name = name;
 
     return true;
 }
 
+b8 imageManagerLoad(resourceManager* self, const char* name, resource* outResource){
+    // The encoded image, from whichever mount has it.
+    vfsMapping mapping;
+    if (!vfsMap(name, FILE_MAP_HINT_SEQUENTIAL, &mapping)){
+        FERROR("Image Manager failed to get image %s", name);
+        return false;
+    }
+    b8 result = imageManagerLoadFromMemory(name, mapping.data, mapping.size, mapping.path, outResource);
+    vfsUnmap(&mapping);
+    return result;
+}
+
 void imageManagerUnload(resourceManager* self, resource* resource){
     if (!self || !resource){
         FWARN("Can't unload image without self or resource structs.");
@@ -66,6 +201,12 @@ void imageManagerUnload(resourceManager* self, resource* resource){
     }
 
     if (resource->data){
+        // stb_image decodes into its own allocation. Images out of the cache
+        // have their pixels right after the imageRS.
+        imageRS* irs = resource->data;
+        if (resource->dataSize == sizeof(imageRS)){
+            stbi_image_free(irs->pixels);
+        }
         ffree(resource->data, resource->dataSize, MEMORY_TAG_TEXTURE);
         resource->dataSize = 0;
         resource->data = 0;
@@ -79,5 +220,6 @@ resourceManager imageManagerCreate(){
     m.id = RESOURCE_TYPE_IMAGE;
     m.load = imageManagerLoad;
     m.unload = imageManagerUnload;
+    m.mainThreadOnly = false;
     return m;
 }
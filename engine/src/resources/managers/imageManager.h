@@ -3,3 +3,15 @@
 #include "resources/resourceManager.h"
 
 resourceManager imageManagerCreate();
+
+/**
+ * @brief Decodes an image that's already been read, the same way loading it
+ * as RESOURCE_TYPE_IMAGE would. Free it with resourceUnload.
+ * @param name The image's name. Must outlive the resource
+ * @param source The encoded image
+ * @param sourceSize The size of source
+ * @param fullPath Where it was read from, for the resource's fullPath
+ * @param outResource The loaded image
+ * @returns true if it decoded
+ */
+b8 imageManagerLoadFromMemory(const char* name, const void* source, u64 sourceSize, const char* fullPath, resource* outResource);
@@ -6,17 +6,20 @@
 #include "resources/resourcesTypes.h"
 #include "core/fmemory.h"
 #include "core/logger.h"
+#include "resources/resourceManager.h"
+#include "resources/vfs.h"
 
 b8 materialManagerLoad(resourceManager* self, const char* name, resource* outResource){
-    char* fmtStr = "../Assets/%s.fmat";
-    char fileLocation[512];
-    strFmt(fileLocation, fmtStr, name);
-    fileHandle f;
-    if (!fsOpen(fileLocation, FILE_MODE_READ, false, &f)){
-        FERROR("Could not open file: %s", name);
+    char fileName[512];
+    strFmt(fileName, "%s.fmat", name);
+    fsReader reader;
+    char location[VFS_MAX_PATH];
+    if (!vfsOpen(fileName, &reader, location)){
+        FERROR("Could not open file: %s", fileName);
         return false;
     }
-    outResource->fullPath = strDup(fileLocation);
+    outResource->fullPath = strDup(location);
+    const char* fileLocation = outResource->fullPath;
 
     material* resmat = fallocate(sizeof(material), MEMORY_TAG_MATERIAL_INSTANCE);
     resmat->autoDelete = true;
@@ -24,42 +27,34 @@ b8 materialManagerLoad(resourceManager* self, const char* name, resource* outRes
     strNCpy(resmat->name, name, MATERIAL_MAX_LENGTH);
 
     // Read the config file
-    char lineBuffer[512] = "";
-    char* c = &lineBuffer[0];
-    u64 lineLen = 0;
-    while(fsReadLine(&f, 511, &c, &lineLen)){
-        char* trimmed = strTrim(lineBuffer);
-        lineLen = strLen(trimmed);
+    strView line;
+    while(fsReaderNextLine(&reader, &line)){
+        line = strViewTrim(line);
         //Skip blank or comments (#)
-        if (lineLen < 1 || trimmed[0] == '#'){
+        if (line.len < 1 || line.str[0] == '#'){
             continue;
         }
-        i32 equalIdx = strIdxOf(trimmed, '=');
-        if (equalIdx == -1){
-            FERROR("Formating error in %s. Skipping Line.", fileLocation);
+        strView var;
+        strView val;
+        if (!strViewSplitOnce(line, '=', &var, &val)){
+            FERROR("Formating error in %s:%u. Skipping Line.", fileLocation, reader.lineNumber);
             continue;
         }
-
-        char varName[64];
-        fzeroMemory(varName, sizeof(char) * 64);
-        strCut(varName, trimmed, 0, equalIdx);
-        char* tvar = strTrim(varName);
-
-        char value[446];
-        fzeroMemory(value, sizeof(char) * 446);
-        strCut(value, trimmed, equalIdx + 1, -1);
-        char* tval = strTrim(value);
+        var = strViewTrim(var);
+        // The parsers below want a null terminated string.
+        char tval[446];
+        strViewCopy(tval, sizeof(tval), strViewTrim(val));
         
-        if (strEqualI(tvar, "Name")){
-            strCpy(resmat->name, tval);
-        } else if (strEqualI(tvar, "DiffuseMapName")) { //TODO: TEMP
+        if (strViewEqualI(var, "Name")){
+            strViewCopy(resmat->name, sizeof(resmat->name), strViewTrim(val));
+        } else if (strViewEqualI(var, "DiffuseMapName")) { //TODO: TEMP
             resmat->diffuseMap.texture = textureSystemTextureGetCreate(tval, true);
-        } else if (strEqualI(tvar, "DiffuseColor")) {
+        } else if (strViewEqualI(var, "DiffuseColor")) {
             // Parse the colour
             if (!strToVec4(tval, &resmat->diffuseColor)) {
-                FWARN("Error parsing diffuseColor in file '%s'. Using default of white instead.", fileLocation);
+                FWARN("Error parsing diffuseColor in file '%s:%u'. Using default of white instead.", fileLocation, reader.lineNumber);
             }
-        } else if (strEqualI(tvar, "Type")){
+        } else if (strViewEqualI(var, "Type")){
             if (strEqualI(tval, "World")){
                 resmat->type = MATERIAL_TYPE_WORLD;
             } else if (strEqualI(tval, "UI")){
@@ -70,7 +65,7 @@ b8 materialManagerLoad(resourceManager* self, const char* name, resource* outRes
             }
         }
     }
-    fsClose(&f);
+    fsReaderClose(&reader);
     resmat->generation = 0;
     resmat->refCnt = 1;
 
@@ -105,5 +100,7 @@ resourceManager materialManagerCreate(){
     m.id = RESOURCE_TYPE_MATERIAL;
     m.load = materialManagerLoad;
     m.unload = materialManagerUnload;
+    // Loading a material creates its textures.
+    m.mainThreadOnly = true;
     return m;
 }
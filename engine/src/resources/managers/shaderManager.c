@@ -7,18 +7,34 @@
 #include "platform/filesystem.h"
 #include "resources/resourceManager.h"
 #include "resources/resourcesTypes.h"
+#include "resources/vfs.h"
+
+// Splits a comma separated value into up to maxFields views. Returns how many
+// fields there were, which can be more than maxFields.
+static u32 shaderSplitFields(strView value, strView* outFields, u32 maxFields) {
+    u32 cnt = 0;
+    strView field;
+    while (strViewNextToken(&value, ',', &field)) {
+        if (cnt < maxFields) {
+            outFields[cnt] = field;
+        }
+        cnt++;
+    }
+    return cnt;
+}
 
 b8 shaderManagerLoad(resourceManager* self, const char* name,
                      resource* outResource) {
-    char* fmtStr = "../Assets/%s.shadercfg";
-    char fileLocation[512];
-    strFmt(fileLocation, fmtStr, name);
-    fileHandle f;
-    if (!fsOpen(fileLocation, FILE_MODE_READ, false, &f)) {
-        FERROR("Could not open file: %s", name);
+    char fileName[512];
+    strFmt(fileName, "%s.shadercfg", name);
+    fsReader reader;
+    char location[VFS_MAX_PATH];
+    if (!vfsOpen(fileName, &reader, location)) {
+        FERROR("Could not open file: %s", fileName);
         return false;
     }
-    outResource->fullPath = strDup(fileLocation);
+    outResource->fullPath = strDup(location);
+    const char* fileLocation = outResource->fullPath;
 
     shaderConfig* r = fallocate(sizeof(shaderConfig), MEMORY_TAG_RESOURCE);
     r->name = 0;
@@ -35,38 +51,31 @@ b8 shaderManagerLoad(resourceManager* self, const char* name,
     r->stageFiles = dinoCreate(char*);
     r->renderpassName = 0;
 
-    char line[512] = "";
-    char* p = &line[0];
-    u64 lineLen = 0;
-    while (fsReadLine(&f, 511, &p, &lineLen)) {
-        char* ln = strTrim(line);
-        lineLen = strLen(ln);
+    strView line;
+    while (fsReaderNextLine(&reader, &line)) {
+        line = strViewTrim(line);
 
-        if (lineLen < 1 || ln[0] == '#') {
+        if (line.len < 1 || line.str[0] == '#') {
             continue;
         }
 
-        i32 equalIdx = strIdxOf(ln, '=');
-        if (equalIdx == -1) {
-            FERROR("Formating error in %s. Skipping Line.", fileLocation);
+        strView tvar;
+        strView val;
+        if (!strViewSplitOnce(line, '=', &tvar, &val)) {
+            FERROR("Formating error in %s:%u. Skipping Line.", fileLocation, reader.lineNumber);
             continue;
         }
+        tvar = strViewTrim(tvar);
+        val = strViewTrim(val);
 
-        char varName[64];
-        fzeroMemory(varName, sizeof(char) * 64);
-        strCut(varName, ln, 0, equalIdx);
-        char* tvar = strTrim(varName);
-
-        char value[446];
-        fzeroMemory(value, sizeof(char) * 446);
-        strCut(value, ln, equalIdx + 1, -1);
-        char* tval = strTrim(value);
-
-        if (strEqualI(tvar, "Name")) {
-            r->name = strDup(tval);
-        } else if (strEqualI(tvar, "renderpass")) {
-            r->renderpassName = strDup(tval);
-        } else if (strEqualI(tvar, "stages")) {
+        if (strViewEqualI(tvar, "Name")) {
+            r->name = strViewDup(val);
+        } else if (strViewEqualI(tvar, "renderpass")) {
+            r->renderpassName = strViewDup(val);
+        } else if (strViewEqualI(tvar, "stages")) {
+            // The stage names are kept, so these still get split into strings.
+            char tval[446];
+            strViewCopy(tval, sizeof(tval), val);
             r->stageCnt = strSplit(tval, ',', &r->stageNames, true, true);
             for (u8 i = 0; i < r->stageCnt; i++) {
                 if (strSub(r->stageNames[i], "frag")) {
@@ -79,49 +88,50 @@ b8 shaderManagerLoad(resourceManager* self, const char* name,
                     dinoPush(r->stages, SHADER_STAGE_COMPUTE);
                 }
             }
-        } else if (strEqualI(tvar, "stagefiles")) {
+        } else if (strViewEqualI(tvar, "stagefiles")) {
+            char tval[446];
+            strViewCopy(tval, sizeof(tval), val);
             r->stageCnt = strSplit(tval, ',', &r->stageFiles, true, true);
-        } else if (strEqualI(tvar, "hasInstances")) {
-            strToBool(tval, &r->hasInstances);
-        } else if (strEqualI(tvar, "hasLocals")) {
-            strToBool(tval, &r->hasLocal);
-        } else if (strEqualI(tvar, "attribute")) {
-            char** fields = dinoCreate(char*);
-            u32 fieldAmt = strSplit(tval, ',', &fields, true, true);
-            if (fieldAmt != 2) {
-                FERROR("ShaderCfg %s: Incorrect attribute syntax", r->name);
+        } else if (strViewEqualI(tvar, "hasInstances")) {
+            r->hasInstances = strViewEqualI(val, "true") || strViewEqual(val, "1");
+        } else if (strViewEqualI(tvar, "hasLocals")) {
+            r->hasLocal = strViewEqualI(val, "true") || strViewEqual(val, "1");
+        } else if (strViewEqualI(tvar, "attribute")) {
+            strView fields[2];
+            if (shaderSplitFields(val, fields, 2) != 2) {
+                FERROR("ShaderCfg %s:%u: Incorrect attribute syntax", fileLocation, reader.lineNumber);
                 continue;
             }
             shaderAttributeConfig at;
             // Parse field type
-            if (strEqualI(fields[0], "f32")) {
+            if (strViewEqualI(fields[0], "f32")) {
                 at.type = SHADER_ATTRIB_TYPE_FLOAT32;
                 at.size = 4;
-            } else if (strEqualI(fields[0], "vec2")) {
+            } else if (strViewEqualI(fields[0], "vec2")) {
                 at.type = SHADER_ATTRIB_TYPE_FLOAT32_2;
                 at.size = 8;
-            } else if (strEqualI(fields[0], "vec3")) {
+            } else if (strViewEqualI(fields[0], "vec3")) {
                 at.type = SHADER_ATTRIB_TYPE_FLOAT32_3;
                 at.size = 12;
-            } else if (strEqualI(fields[0], "vec4")) {
+            } else if (strViewEqualI(fields[0], "vec4")) {
                 at.type = SHADER_ATTRIB_TYPE_FLOAT32_4;
                 at.size = 16;
-            } else if (strEqualI(fields[0], "u8")) {
+            } else if (strViewEqualI(fields[0], "u8")) {
                 at.type = SHADER_ATTRIB_TYPE_UINT8;
                 at.size = 1;
-            } else if (strEqualI(fields[0], "u16")) {
+            } else if (strViewEqualI(fields[0], "u16")) {
                 at.type = SHADER_ATTRIB_TYPE_UINT16;
                 at.size = 2;
-            } else if (strEqualI(fields[0], "u32")) {
+            } else if (strViewEqualI(fields[0], "u32")) {
                 at.type = SHADER_ATTRIB_TYPE_UINT32;
                 at.size = 4;
-            } else if (strEqualI(fields[0], "i8")) {
+            } else if (strViewEqualI(fields[0], "i8")) {
                 at.type = SHADER_ATTRIB_TYPE_INT8;
                 at.size = 1;
-            } else if (strEqualI(fields[0], "i16")) {
+            } else if (strViewEqualI(fields[0], "i16")) {
                 at.type = SHADER_ATTRIB_TYPE_INT16;
                 at.size = 2;
-            } else if (strEqualI(fields[0], "i32")) {
+            } else if (strViewEqualI(fields[0], "i32")) {
                 at.type = SHADER_ATTRIB_TYPE_INT32;
                 at.size = 4;
             } else {
@@ -130,85 +140,77 @@ b8 shaderManagerLoad(resourceManager* self, const char* name,
                 at.type = SHADER_ATTRIB_TYPE_FLOAT32;
                 at.size = 4;
             }
-            at.name = strDup(fields[1]);
-            at.nameLen = strLen(fields[1]);
+            at.name = strViewDup(fields[1]);
+            at.nameLen = fields[1].len;
             dinoPush(r->attributes, at);
             r->attributeCnt++;
-
-            strCleanDinoArray(fields);
-            dinoDestroy(fields);
-        } else if (strEqualI(tvar, "uniform")) {
-            char** fields = dinoCreate(char*);
-            u32 fieldAmt = strSplit(tval, ',', &fields, true, true);
-            if (fieldAmt != 3) {
-                FERROR("ShaderCfg %s: Incorrect uniform syntax", r->name);
+        } else if (strViewEqualI(tvar, "uniform")) {
+            strView fields[3];
+            if (shaderSplitFields(val, fields, 3) != 3) {
+                FERROR("ShaderCfg %s:%u: Incorrect uniform syntax", fileLocation, reader.lineNumber);
                 continue;
             }
             shaderUniformConfig un;
             // Parse field type
-            if (strEqualI(fields[0], "f32")) {
+            if (strViewEqualI(fields[0], "f32")) {
                 un.type = SHADER_UNIFORM_TYPE_FLOAT32;
                 un.size = 4;
-            } else if (strEqualI(fields[0], "vec2")) {
+            } else if (strViewEqualI(fields[0], "vec2")) {
                 un.type = SHADER_UNIFORM_TYPE_FLOAT32_2;
                 un.size = 8;
-            } else if (strEqualI(fields[0], "vec3")) {
+            } else if (strViewEqualI(fields[0], "vec3")) {
                 un.type = SHADER_UNIFORM_TYPE_FLOAT32_3;
                 un.size = 12;
-            } else if (strEqualI(fields[0], "vec4")) {
+            } else if (strViewEqualI(fields[0], "vec4")) {
                 un.type = SHADER_UNIFORM_TYPE_FLOAT32_4;
                 un.size = 16;
-            } else if (strEqualI(fields[0], "u8")) {
+            } else if (strViewEqualI(fields[0], "u8")) {
                 un.type = SHADER_UNIFORM_TYPE_UINT8;
                 un.size = 1;
-            } else if (strEqualI(fields[0], "u16")) {
+            } else if (strViewEqualI(fields[0], "u16")) {
                 un.type = SHADER_UNIFORM_TYPE_UINT16;
                 un.size = 2;
-            } else if (strEqualI(fields[0], "u32")) {
+            } else if (strViewEqualI(fields[0], "u32")) {
                 un.type = SHADER_UNIFORM_TYPE_UINT32;
                 un.size = 4;
-            } else if (strEqualI(fields[0], "i8")) {
+            } else if (strViewEqualI(fields[0], "i8")) {
                 un.type = SHADER_UNIFORM_TYPE_INT8;
                 un.size = 1;
-            } else if (strEqualI(fields[0], "i16")) {
+            } else if (strViewEqualI(fields[0], "i16")) {
                 un.type = SHADER_UNIFORM_TYPE_INT16;
                 un.size = 2;
-            } else if (strEqualI(fields[0], "i32")) {
+            } else if (strViewEqualI(fields[0], "i32")) {
                 un.type = SHADER_UNIFORM_TYPE_INT32;
                 un.size = 4;
-            } else if (strEqualI(fields[0], "mat4")) {
+            } else if (strViewEqualI(fields[0], "mat4")) {
                 un.type = SHADER_UNIFORM_TYPE_MATRIX_4;
                 un.size = 64;
-            } else if (strEqualI(fields[0], "sampler") || strEqualI(fields[0], "samp")) {
+            } else if (strViewEqualI(fields[0], "sampler") || strViewEqualI(fields[0], "samp")) {
                 un.type = SHADER_UNIFORM_TYPE_SAMPLER;
                 un.size = 0;
                 FINFO("Sampler read");
             } else {
-                FERROR("ShaderCfg %s: Invalid uniform type used. %s", r->name, fields[0]);
+                FERROR("ShaderCfg %s: Invalid uniform type used. %.*s", r->name, (i32)fields[0].len, fields[0].str);
                 FWARN("Defaulting to f32.");
                 un.type = SHADER_UNIFORM_TYPE_FLOAT32;
                 un.size = 4;
             }
 
-            if (strEqualI(fields[1], "0")){
+            if (strViewEqualI(fields[1], "0")){
                 un.scope = SHADER_SCOPE_GLOBAL;
-            }else if (strEqualI(fields[1], "1")){
+            }else if (strViewEqualI(fields[1], "1")){
                 un.scope = SHADER_SCOPE_INSTANCE;
-            }else if (strEqualI(fields[1], "2")){
+            }else if (strViewEqualI(fields[1], "2")){
                 un.scope = SHADER_SCOPE_LOCAL;
             }
 
-            un.name = strDup(fields[2]);
-            un.nameLen = strLen(fields[2]);
+            un.name = strViewDup(fields[2]);
+            un.nameLen = fields[2].len;
             dinoPush(r->uniforms, un);
             r->uniformCnt++;
-
-            strCleanDinoArray(fields);
-            dinoDestroy(fields);
         }
-        fzeroMemory(ln, sizeof(char) * 512);
     }
-    fsClose(&f);
+    fsReaderClose(&reader);
     outResource->data = r;
     outResource->dataSize = sizeof(shaderConfig);
     return true;
@@ -255,5 +257,6 @@ resourceManager shaderManagerCreate() {
     m.id = RESOURCE_TYPE_SHADER;
     m.load = shaderManagerLoad;
     m.unload = shaderManagerUnload;
+    m.mainThreadOnly = false;
     return m;
 }
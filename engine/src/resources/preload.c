@@ -0,0 +1,408 @@
+#include "preload.h"
+
+#include "core/fmemory.h"
+#include "core/fstring.h"
+#include "core/jobSystem.h"
+#include "core/logger.h"
+#include "helpers/dinoArray.h"
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+#include "resources/managers/imageManager.h"
+#include "resources/resourceManager.h"
+#include "resources/resourcesTypes.h"
+#include "resources/vfs.h"
+#include "systems/materialSystem.h"
+#include "systems/textureSystem.h"
+
+typedef enum preloadNodeType {
+    PRELOAD_NODE_TEXTURE,
+    PRELOAD_NODE_MATERIAL,
+    PRELOAD_NODE_SHADER,
+} preloadNodeType;
+
+typedef enum preloadNodeState {
+    // Waiting on its dependencies, or on the main thread if it has none left.
+    PRELOAD_NODE_WAITING,
+    // Its file is being read on the batch's async queue.
+    PRELOAD_NODE_READING,
+    // Its job is running.
+    PRELOAD_NODE_LOADING,
+    // Its job finished and it needs the main thread to finish up.
+    PRELOAD_NODE_LOADED,
+    PRELOAD_NODE_DONE,
+    PRELOAD_NODE_FAILED,
+} preloadNodeState;
+
+struct preloadState;
+
+typedef struct preloadNode {
+    preloadNodeType type;
+    // Written by the node's job, read on the main thread.
+    u32 state;
+    char name[FILENAME_MAX_LENGTH];
+    // Dependencies that haven't finished yet.
+    u32 waitingOn;
+    // What the node's job loaded, when it loads anything.
+    b8 loaded;
+    resource res;
+    // Set once the batch holds a reference to what this loaded.
+    b8 acquired;
+    struct preloadState* owner;
+    // A loose file being read on the async queue, and what's been read of it.
+    char path[VFS_MAX_PATH];
+    fileHandle file;
+    u8* bytes;
+    u64 byteCnt;
+} preloadNode;
+
+// node depends on dependency.
+typedef struct preloadEdge {
+    u32 node;
+    u32 dependency;
+} preloadEdge;
+
+typedef struct preloadState {
+    // Only added to while the graph is built, the jobs point into it after that.
+    preloadNode* nodes;
+    preloadEdge* edges;
+    u32 done;
+    u32 failed;
+    u32 jobsInFlight;
+    u64 startNs;
+    // Loose textures get read here, all handed to the OS in one submission.
+    fsAsyncQueue reads;
+    b8 haveReads;
+    // Set by preloadEnd so reads finishing late don't start more jobs.
+    b8 ending;
+} preloadState;
+
+static u32 addNode(preloadState* state, preloadNodeType type, const char* name){
+    u64 nodeCnt = dinoLength(state->nodes);
+    for (u64 i = 0; i < nodeCnt; ++i){
+        if (state->nodes[i].type == type && strEqual(state->nodes[i].name, name)){
+            return (u32)i;
+        }
+    }
+    preloadNode node = {0};
+    node.type = type;
+    node.state = PRELOAD_NODE_WAITING;
+    strNCpy(node.name, name, FILENAME_MAX_LENGTH);
+    dinoPush(state->nodes, node);
+    return (u32)nodeCnt;
+}
+
+static void addEdge(preloadState* state, u32 node, u32 dependency){
+    preloadEdge edge = {node, dependency};
+    dinoPush(state->edges, edge);
+    state->nodes[node].waitingOn++;
+}
+
+// Reads just the texture names out of a material's config. Loading the
+// material for real would create its textures on this thread.
+static b8 addMaterialDependencies(preloadState* state, u32 node){
+    char fileName[512];
+    strFmt(fileName, "%s.fmat", state->nodes[node].name);
+    fsReader reader;
+    if (!vfsOpen(fileName, &reader, 0)){
+        FWARN("Preload couldn't open material %s", fileName);
+        return false;
+    }
+    strView line;
+    while (fsReaderNextLine(&reader, &line)){
+        line = strViewTrim(line);
+        strView var;
+        strView val;
+        if (line.len < 1 || line.str[0] == '#' || !strViewSplitOnce(line, '=', &var, &val)){
+            continue;
+        }
+        if (strViewEqualI(strViewTrim(var), "DiffuseMapName")){
+            char textureName[FILENAME_MAX_LENGTH];
+            strViewCopy(textureName, sizeof(textureName), strViewTrim(val));
+            addEdge(state, node, addNode(state, PRELOAD_NODE_TEXTURE, textureName));
+        }
+    }
+    fsReaderClose(&reader);
+    return true;
+}
+
+// The renderer creates its shaders from their stage files itself, so all
+// that's left to do ahead of time is make sure they're there.
+static b8 validateShader(preloadState* state, u32 node){
+    resource res;
+    if (!resourceLoad(state->nodes[node].name, RESOURCE_TYPE_SHADER, &res)){
+        FWARN("Preload couldn't load shader config %s", state->nodes[node].name);
+        return false;
+    }
+    shaderConfig* config = res.data;
+    b8 valid = config->stageCnt > 0;
+    for (u8 i = 0; i < config->stageCnt; ++i){
+        if (!vfsExists(config->stageFiles[i])){
+            FWARN("Shader %s is missing its stage file %s", state->nodes[node].name, config->stageFiles[i]);
+            valid = false;
+        }
+    }
+    resourceUnload(&res);
+    return valid;
+}
+
+static void finishJob(preloadNode* node){
+    // The node can be freed as soon as jobsInFlight drops, so that goes last.
+    u32* jobsInFlight = &node->owner->jobsInFlight;
+    __atomic_store_n(&node->state, PRELOAD_NODE_LOADED, __ATOMIC_RELEASE);
+    __atomic_sub_fetch(jobsInFlight, 1, __ATOMIC_RELEASE);
+}
+
+static void submitJob(preloadNode* node, PFN_jobStart job){
+    node->state = PRELOAD_NODE_LOADING;
+    __atomic_add_fetch(&node->owner->jobsInFlight, 1, __ATOMIC_RELAXED);
+    jobSubmit(job, node);
+}
+
+static void freeBytes(preloadNode* node){
+    if (node->bytes){
+        ffree(node->bytes, node->byteCnt, MEMORY_TAG_ARRAY);
+        node->bytes = 0;
+    }
+}
+
+// Loads a texture that isn't a loose file, like an archive entry. It's
+// already mapped, so there's no read to batch.
+static void loadJob(void* params){
+    preloadNode* node = params;
+    node->loaded = resourceLoad(node->name, RESOURCE_TYPE_IMAGE, &node->res);
+    finishJob(node);
+}
+
+// Decodes a texture once its file has been read.
+static void decodeJob(void* params){
+    preloadNode* node = params;
+    node->loaded = imageManagerLoadFromMemory(node->name, node->bytes, node->byteCnt, node->path, &node->res);
+    freeBytes(node);
+    finishJob(node);
+}
+
+// Called from fsAsyncPoll on the main thread.
+static void onTextureRead(void* userData, b8 success, u64 bytesRead){
+    preloadNode* node = userData;
+    fsClose(&node->file);
+    if (!success || bytesRead != node->byteCnt || node->owner->ending){
+        freeBytes(node);
+        node->loaded = false;
+        node->state = PRELOAD_NODE_LOADED;
+        return;
+    }
+    submitJob(node, decodeJob);
+}
+
+static b8 queueRead(preloadState* state, preloadNode* node){
+    if (!vfsGetLoosePath(node->name, node->path) || !fsOpen(node->path, FILE_MODE_READ, true, &node->file)){
+        return false;
+    }
+    u64 size = 0;
+    if (!fsSize(&node->file, &size) || size == 0 || size >= GIBIBYTES(2ULL)){
+        fsClose(&node->file);
+        return false;
+    }
+    node->bytes = fallocate(size, MEMORY_TAG_ARRAY);
+    node->byteCnt = size;
+    if (!fsReadAsync(&state->reads, &node->file, 0, size, node->bytes, onTextureRead, node)){
+        freeBytes(node);
+        fsClose(&node->file);
+        return false;
+    }
+    node->state = PRELOAD_NODE_READING;
+    return true;
+}
+
+static void finishNode(preloadState* state, u32 node, b8 success){
+    state->nodes[node].state = success ? PRELOAD_NODE_DONE : PRELOAD_NODE_FAILED;
+    if (success){
+        state->done++;
+    } else {
+        FWARN("Preload failed to load %s", state->nodes[node].name);
+        state->failed++;
+    }
+    u64 edgeCnt = dinoLength(state->edges);
+    for (u64 i = 0; i < edgeCnt; ++i){
+        if (state->edges[i].dependency == node){
+            state->nodes[state->edges[i].node].waitingOn--;
+        }
+    }
+}
+
+b8 preloadBegin(const char* manifestName, preloadBatch* outBatch){
+    outBatch->internalData = 0;
+    fsReader reader;
+    char fileLocation[VFS_MAX_PATH];
+    if (!vfsOpen(manifestName, &reader, fileLocation)){
+        FERROR("Could not open preload manifest: %s", manifestName);
+        return false;
+    }
+
+    preloadState* state = fallocate(sizeof(preloadState), MEMORY_TAG_ARRAY);
+    state->nodes = dinoCreate(preloadNode);
+    state->edges = dinoCreate(preloadEdge);
+    state->startNs = platformGetTimestampNs();
+
+    strView line;
+    while (fsReaderNextLine(&reader, &line)){
+        line = strViewTrim(line);
+        // Skip blank or comments (#)
+        if (line.len < 1 || line.str[0] == '#'){
+            continue;
+        }
+        strView var;
+        strView val;
+        if (!strViewSplitOnce(line, '=', &var, &val)){
+            FERROR("Formating error in %s:%u. Skipping Line.", fileLocation, reader.lineNumber);
+            continue;
+        }
+        var = strViewTrim(var);
+        char name[FILENAME_MAX_LENGTH];
+        strViewCopy(name, sizeof(name), strViewTrim(val));
+        if (strViewEqualI(var, "texture")){
+            addNode(state, PRELOAD_NODE_TEXTURE, name);
+        } else if (strViewEqualI(var, "material")){
+            addNode(state, PRELOAD_NODE_MATERIAL, name);
+        } else if (strViewEqualI(var, "shader")){
+            addNode(state, PRELOAD_NODE_SHADER, name);
+        } else {
+            FWARN("Unknown preload type in %s:%u. Skipping Line.", fileLocation, reader.lineNumber);
+        }
+    }
+    fsReaderClose(&reader);
+
+    // The graph is only one level deep, so finding the dependencies of what
+    // the manifest listed finds all of them. Dependencies get added to the
+    // end, so this only walks what was there to start with.
+    u64 listedCnt = dinoLength(state->nodes);
+    for (u64 i = 0; i < listedCnt; ++i){
+        if (state->nodes[i].type == PRELOAD_NODE_MATERIAL && !addMaterialDependencies(state, (u32)i)){
+            finishNode(state, (u32)i, false);
+        } else if (state->nodes[i].type == PRELOAD_NODE_SHADER){
+            finishNode(state, (u32)i, validateShader(state, (u32)i));
+        }
+    }
+
+    // Everything's in the graph now, so the nodes won't move. Start the leaves.
+    u64 nodeCnt = dinoLength(state->nodes);
+    u32 textureCnt = 0;
+    for (u64 i = 0; i < nodeCnt; ++i){
+        state->nodes[i].owner = state;
+        textureCnt += state->nodes[i].type == PRELOAD_NODE_TEXTURE;
+    }
+    state->haveReads = textureCnt && fsAsyncQueueCreate(textureCnt, &state->reads);
+    u32 readCnt = 0;
+    for (u64 i = 0; i < nodeCnt; ++i){
+        preloadNode* node = &state->nodes[i];
+        if (node->type != PRELOAD_NODE_TEXTURE){
+            continue;
+        }
+        if (state->haveReads && queueRead(state, node)){
+            readCnt++;
+        } else {
+            submitJob(node, loadJob);
+        }
+    }
+    if (readCnt){
+        fsAsyncSubmit(&state->reads);
+    }
+    FINFO("Preloading %llu assets from %s, reading %u files in one batch.", nodeCnt, manifestName, readCnt);
+    outBatch->internalData = state;
+    return true;
+}
+
+b8 preloadUpdate(preloadBatch* batch, f64 budgetMs){
+    preloadState* state = batch->internalData;
+    if (!state){
+        return true;
+    }
+    // Reads that are done get their decode jobs started.
+    if (state->haveReads){
+        fsAsyncPoll(&state->reads, false);
+    }
+    u64 nodeCnt = dinoLength(state->nodes);
+    u64 budgetNs = (u64)(budgetMs * 1000.0 * 1000.0);
+    u64 startNs = platformGetTimestampNs();
+    b8 progressed = true;
+    // Finishing a node can free up what depends on it, so go again until nothing moves.
+    while (progressed && state->done + state->failed < nodeCnt){
+        progressed = false;
+        for (u64 i = 0; i < nodeCnt; ++i){
+            if (budgetNs && platformGetTimestampNs() - startNs >= budgetNs){
+                return false;
+            }
+            preloadNode* node = &state->nodes[i];
+            u32 nodeState = __atomic_load_n(&node->state, __ATOMIC_ACQUIRE);
+            if (nodeState == PRELOAD_NODE_LOADED){
+                b8 success = node->loaded;
+                if (node->type == PRELOAD_NODE_TEXTURE && node->loaded){
+                    success = textureSystemTextureGetCreateFromImage(node->name, true, &node->res) != 0;
+                    node->acquired = success;
+                    resourceUnload(&node->res);
+                    node->loaded = false;
+                }
+                finishNode(state, (u32)i, success);
+                progressed = true;
+            } else if (nodeState == PRELOAD_NODE_WAITING && node->waitingOn == 0){
+                // Its textures are in, so this only reads the config. A
+                // material that fails to load comes back as a copy of the default.
+                material* m = materialSystemMaterialGet(node->name);
+                finishNode(state, (u32)i, m && !strEqual(m->name, DEFAULT_MATERIAL_NAME));
+                progressed = true;
+            }
+        }
+    }
+    if (state->done + state->failed < nodeCnt){
+        return false;
+    }
+    if (state->startNs){
+        FINFO("Preloaded %u assets in %.2fms, %u failed.", state->done,
+              (f64)(platformGetTimestampNs() - state->startNs) / (1000.0 * 1000.0), state->failed);
+        state->startNs = 0;
+    }
+    return true;
+}
+
+preloadProgress preloadGetProgress(preloadBatch* batch){
+    preloadProgress progress = {0};
+    preloadState* state = batch->internalData;
+    if (state){
+        progress.total = (u32)dinoLength(state->nodes);
+        progress.done = state->done;
+        progress.failed = state->failed;
+    }
+    return progress;
+}
+
+void preloadEnd(preloadBatch* batch){
+    preloadState* state = batch->internalData;
+    if (!state){
+        return;
+    }
+    // The reads and jobs point into the nodes.
+    state->ending = true;
+    if (state->haveReads){
+        while (fsAsyncPendingCount(&state->reads)){
+            fsAsyncPoll(&state->reads, true);
+        }
+        fsAsyncQueueDestroy(&state->reads);
+    }
+    while (__atomic_load_n(&state->jobsInFlight, __ATOMIC_ACQUIRE)){
+        platformSleep(1);
+    }
+    u64 nodeCnt = dinoLength(state->nodes);
+    for (u64 i = 0; i < nodeCnt; ++i){
+        preloadNode* node = &state->nodes[i];
+        if (node->type == PRELOAD_NODE_TEXTURE && node->loaded){
+            resourceUnload(&node->res);
+        }
+        if (node->acquired){
+            textureSystemTextureRelease(node->name);
+        }
+    }
+    dinoDestroy(state->nodes);
+    dinoDestroy(state->edges);
+    ffree(state, sizeof(preloadState), MEMORY_TAG_ARRAY);
+    batch->internalData = 0;
+}
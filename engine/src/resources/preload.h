@@ -0,0 +1,70 @@
+#pragma once
+
+#include "defines.h"
+
+/*
+ * Loads everything a manifest lists before it's needed, so nothing gets
+ * loaded the first time it's drawn. A manifest is a text file of key=value
+ * lines, one asset per line:
+ *
+ *   material=material
+ *   texture=texture.jpg
+ *   shader=Builtin.Shader.UI
+ *
+ * preloadBegin reads the manifest and the configs it points at to find what
+ * each asset depends on, like a material's textures. Loose texture files are
+ * all read in one fsReadAsync batch and decoded on the job system as their
+ * reads finish. Archive entries are already mapped, so they're decoded
+ * straight away. preloadUpdate then does the work that has to happen on the
+ * main thread, like creating the textures on the GPU, and finishes each
+ * material once its textures are in. Call it every frame behind a loading
+ * screen until it returns true.
+ *
+ * The renderer creates its shaders itself, so a shader only gets checked:
+ * its config has to load and all of its stage files have to exist.
+ */
+
+typedef struct preloadBatch {
+    void* internalData;
+} preloadBatch;
+
+typedef struct preloadProgress {
+    // Assets in the batch, including the ones found as dependencies.
+    u32 total;
+    // Assets that finished loading.
+    u32 done;
+    // Assets that couldn't be loaded. They count towards finishing too.
+    u32 failed;
+} preloadProgress;
+
+/**
+ * @brief Reads a manifest and starts loading everything in it.
+ * @param manifestName The manifest's name in the VFS
+ * @param outBatch The batch. End with preloadEnd
+ * @returns true if the manifest was read
+ */
+FSNAPI b8 preloadBegin(const char* manifestName, preloadBatch* outBatch);
+
+/**
+ * @brief Finishes whatever's ready on the main thread.
+ * @param batch The batch
+ * @param budgetMs Stops early once this much time has been spent. 0 for no limit
+ * @returns true once everything in the batch is done or failed
+ */
+FSNAPI b8 preloadUpdate(preloadBatch* batch, f64 budgetMs);
+
+/**
+ * @brief Gets how far along a batch is.
+ * @param batch The batch
+ * @returns The batch's progress
+ */
+FSNAPI preloadProgress preloadGetProgress(preloadBatch* batch);
+
+/**
+ * @brief Waits for a batch's loads and lets go of the textures it loaded.
+ * Anything else still using them keeps them, so call this once whatever the
+ * batch was for is done with. Materials stay loaded, the material system
+ * doesn't count its references yet.
+ * @param batch The batch
+ */
+FSNAPI void preloadEnd(preloadBatch* batch);
@@ -1,14 +1,80 @@
 #include "resourceManager.h"
+#include "core/counters.h"
+#include "core/fmemory.h"
+#include "core/fmutex.h"
+#include "core/fstring.h"
+#include "core/jobSystem.h"
 #include "core/logger.h"
+#include "core/profiler.h"
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+#include "resources/fpak.h"
 
 //Managers
 #include "managers/imageManager.h"
 #include "managers/binaryManager.h"
 #include "managers/materialManager.h"
+#include "managers/shaderManager.h"
+
+typedef enum asyncRequestState {
+    ASYNC_REQUEST_FREE,
+    // Waiting for a job to pick it up.
+    ASYNC_REQUEST_QUEUED,
+    ASYNC_REQUEST_LOADING,
+    // Loaded and waiting for resourceManagerUpdate.
+    ASYNC_REQUEST_LOADED,
+    // resourceManagerUpdate is running its callbacks.
+    ASYNC_REQUEST_DELIVERING,
+} asyncRequestState;
+
+typedef struct asyncRequest {
+    char name[FILENAME_MAX_LENGTH];
+    ResourceType type;
+    resourcePriority priority;
+    asyncRequestState state;
+    // When it was queued, so equal priorities load oldest first.
+    u64 order;
+    // How many waiters haven't cancelled. Only touched on the main thread.
+    u32 waiterCnt;
+    b8 success;
+    resource res;
+} asyncRequest;
+
+// Someone waiting on a request. Only touched on the main thread.
+typedef struct asyncWaiter {
+    // INVALID_ID when the waiter is free.
+    u32 request;
+    // Bumped every time the waiter is freed, so old handles stop working.
+    u16 generation;
+    PFN_resourceLoaded callback;
+    void* userData;
+} asyncWaiter;
+
+// A mapped binary that's handed out to everything loading the same bytes.
+typedef struct sharedResource {
+    // 0 when the slot is free.
+    u64 contentHash;
+    u32 refCnt;
+    // The first load, unloaded by its manager once refCnt hits 0.
+    resource res;
+} sharedResource;
 
 typedef struct resourceManagerState{
     resourceManagerSettings settings;
     resourceManager* loadedManagers;
+
+    // Async loads. Jobs move requests from queued to loaded under the mutex,
+    // everything else happens on the main thread.
+    asyncRequest* requests;
+    asyncWaiter* waiters;
+    fmutex requestMutex;
+    u64 nextOrder;
+    // Jobs submitted that haven't returned yet.
+    u32 jobsInFlight;
+
+    // Mapped binaries shared by content. Loads can run on jobs, so it has a mutex.
+    sharedResource* shared;
+    fmutex sharedMutex;
 } resourceManagerState;
 
 static resourceManagerState* systemPtr = 0;
@@ -19,7 +85,22 @@ b8 resourceManagerInit(u64* memoryRequirement, void* state, resourceManagerSetti
         return false;
     }
 
-    *memoryRequirement = sizeof(resourceManagerState) + sizeof(resourceManager) * settings.maxManagers;
+    if (settings.maxAsyncRequests == 0){
+        settings.maxAsyncRequests = 256;
+    }
+    // Handles keep the waiter's index in 16 bits.
+    if (settings.maxAsyncRequests > 0xFFFF){
+        settings.maxAsyncRequests = 0xFFFF;
+    }
+
+    if (settings.maxSharedResources == 0){
+        settings.maxSharedResources = 256;
+    }
+
+    u64 managersSize = sizeof(resourceManager) * settings.maxManagers;
+    u64 requestsSize = sizeof(asyncRequest) * settings.maxAsyncRequests;
+    u64 waitersSize = sizeof(asyncWaiter) * settings.maxAsyncRequests;
+    *memoryRequirement = sizeof(resourceManagerState) + managersSize + requestsSize + waitersSize + sizeof(sharedResource) * settings.maxSharedResources;
 
     if (!state){
         return true;
@@ -34,17 +115,64 @@ b8 resourceManagerInit(u64* memoryRequirement, void* state, resourceManagerSetti
         systemPtr->loadedManagers[i].id = INVALID_ID;
     }
 
+    systemPtr->requests = state + sizeof(resourceManagerState) + managersSize;
+    systemPtr->waiters = state + sizeof(resourceManagerState) + managersSize + requestsSize;
+    systemPtr->shared = state + sizeof(resourceManagerState) + managersSize + requestsSize + waitersSize;
+    fzeroMemory(systemPtr->shared, sizeof(sharedResource) * settings.maxSharedResources);
+    for (u32 i = 0; i < settings.maxAsyncRequests; i++){
+        systemPtr->requests[i].state = ASYNC_REQUEST_FREE;
+        systemPtr->waiters[i].request = INVALID_ID;
+        systemPtr->waiters[i].generation = 0;
+    }
+    if (!fmutexCreate(&systemPtr->requestMutex) || !fmutexCreate(&systemPtr->sharedMutex)){
+        FERROR("Resource manager couldn't create its mutexes.");
+        systemPtr = 0;
+        return false;
+    }
+
     //Load all standard managers
     resourceManagerLoadManager(imageManagerCreate());
     resourceManagerLoadManager(binaryManagerCreate());
+    resourceManagerLoadManager(binaryMappedManagerCreate());
     resourceManagerLoadManager(materialManagerCreate());
+    resourceManagerLoadManager(shaderManagerCreate());
+
+    if (settings.cachePath && !fsCreateDirectory(settings.cachePath)){
+        FWARN("Couldn't create the cache directory %s, caching is off.", settings.cachePath);
+        systemPtr->settings.cachePath = 0;
+    }
 
-    FINFO("Current resource manager root asset path is %s", settings.rootAssetPath);
     return true;
 }
 
 void resourceManagerShutdown(void* state){
     if (systemPtr){
+        // Drop what hasn't started, then wait for the rest. Queued jobs find
+        // nothing to do and return.
+        fmutexLock(&systemPtr->requestMutex);
+        for (u32 i = 0; i < systemPtr->settings.maxAsyncRequests; i++){
+            if (systemPtr->requests[i].state == ASYNC_REQUEST_QUEUED){
+                systemPtr->requests[i].state = ASYNC_REQUEST_FREE;
+            }
+        }
+        fmutexUnlock(&systemPtr->requestMutex);
+        while (__atomic_load_n(&systemPtr->jobsInFlight, __ATOMIC_ACQUIRE)){
+            platformSleep(1);
+        }
+        for (u32 i = 0; i < systemPtr->settings.maxAsyncRequests; i++){
+            asyncRequest* r = &systemPtr->requests[i];
+            if (r->state == ASYNC_REQUEST_LOADED && r->success){
+                resourceUnload(&r->res);
+            }
+        }
+        fmutexDestroy(&systemPtr->requestMutex);
+        for (u32 i = 0; i < systemPtr->settings.maxSharedResources; i++){
+            sharedResource* s = &systemPtr->shared[i];
+            if (s->contentHash){
+                FWARN("%s is still loaded at shutdown, %u references left.", s->res.fullPath, s->refCnt);
+            }
+        }
+        fmutexDestroy(&systemPtr->sharedMutex);
         systemPtr = 0;
     }
 }
@@ -69,7 +197,81 @@ b8 resourceManagerLoadManager(resourceManager manager){
     return true;
 }
 
+// Swaps a freshly loaded resource for the shared one with the same bytes if
+// there is one, or starts sharing it if not.
+static void shareResource(resource* res){
+    // Empty files have no data to tell their shared slot apart by, so it
+    // could never be let go of.
+    if (res->dataSize == 0){
+        return;
+    }
+    if (!res->contentHash){
+        res->contentHash = fpakChecksum(res->data, res->dataSize);
+        res->contentHash = res->contentHash ? res->contentHash : 1;
+    }
+    fmutexLock(&systemPtr->sharedMutex);
+    sharedResource* free = 0;
+    for (u32 i = 0; i < systemPtr->settings.maxSharedResources; i++){
+        sharedResource* s = &systemPtr->shared[i];
+        if (!s->contentHash){
+            free = free ? free : s;
+            continue;
+        }
+        // 64 bits of hash and the size matching is as good as the bytes matching.
+        if (s->contentHash == res->contentHash && s->res.dataSize == res->dataSize && s->res.data != res->data){
+            s->refCnt++;
+            fmutexUnlock(&systemPtr->sharedMutex);
+            FCOUNTER_INC("resource.dedupHits");
+            FCOUNTER_ADD("resource.dedupBytesSaved", res->dataSize);
+            resourceManager* m = &systemPtr->loadedManagers[res->managerID];
+            m->unload(m, res);
+            const char* name = res->name;
+            *res = s->res;
+            res->name = name;
+            return;
+        }
+    }
+    // Not sharing it if there's no room just means copies load like normal.
+    if (free){
+        free->contentHash = res->contentHash;
+        free->refCnt = 1;
+        free->res = *res;
+    }
+    fmutexUnlock(&systemPtr->sharedMutex);
+}
+
+// Drops a reference to a shared resource. Returns false if it isn't shared.
+static b8 unshareResource(resource* res){
+    if (!systemPtr->settings.hashContent || !res->contentHash || !res->data){
+        return false;
+    }
+    fmutexLock(&systemPtr->sharedMutex);
+    for (u32 i = 0; i < systemPtr->settings.maxSharedResources; i++){
+        sharedResource* s = &systemPtr->shared[i];
+        if (s->contentHash && s->res.data == res->data){
+            b8 last = --s->refCnt == 0;
+            resource first = s->res;
+            if (last){
+                fzeroMemory(s, sizeof(sharedResource));
+            }
+            fmutexUnlock(&systemPtr->sharedMutex);
+            if (last){
+                resourceManager* m = &systemPtr->loadedManagers[first.managerID];
+                m->unload(m, &first);
+            }
+            res->data = 0;
+            res->dataSize = 0;
+            res->fullPath = 0;
+            res->managerID = INVALID_ID;
+            return true;
+        }
+    }
+    fmutexUnlock(&systemPtr->sharedMutex);
+    return false;
+}
+
 b8 resourceLoad(const char* name, ResourceType type, resource* outResource){
+    FPROFILE_FUNC();
     if (!systemPtr){
         FERROR("Resource manager used before being inited.");
         return false;
@@ -84,10 +286,18 @@ b8 resourceLoad(const char* name, ResourceType type, resource* outResource){
     resourceManager* m = &systemPtr->loadedManagers[type];
 
     if (m->id != INVALID_ID && m->load && outResource && name){
-        m->load(m, name, outResource);
         outResource->managerID = type;
+        outResource->contentHash = 0;
+        if (!m->load(m, name, outResource)){
+            return false;
+        }
+        // Mapped binaries are read-only, so copies can all use the first one.
+        if (type == RESOURCE_TYPE_BINARY_MAPPED && systemPtr->settings.hashContent){
+            shareResource(outResource);
+        }
+        return true;
     }
-    return true;
+    return false;
 }
 
 b8 resourceUnload(resource* resource){
@@ -96,6 +306,10 @@ b8 resourceUnload(resource* resource){
         return false;
     }
 
+    if (unshareResource(resource)){
+        return true;
+    }
+
     resourceManager* m = &systemPtr->loadedManagers[resource->managerID];
 
     if (resource && m->id != INVALID_ID && m->unload){
@@ -104,16 +318,217 @@ b8 resourceUnload(resource* resource){
     return true;
 }
 
-char* resourceManagerRootAssetPath(){
-    if (systemPtr){
-        return systemPtr->settings.rootAssetPath;
+// Loads whichever queued request should go next. Each request queues one of
+// these, but they don't have to pick up the request that queued them.
+static void asyncLoadJob(void* params){
+    resourceManagerState* state = params;
+    fmutexLock(&state->requestMutex);
+    asyncRequest* next = 0;
+    for (u32 i = 0; i < state->settings.maxAsyncRequests; i++){
+        asyncRequest* r = &state->requests[i];
+        if (r->state == ASYNC_REQUEST_QUEUED &&
+            (!next || r->priority > next->priority || (r->priority == next->priority && r->order < next->order))){
+            next = r;
+        }
+    }
+    if (next){
+        next->state = ASYNC_REQUEST_LOADING;
     }
+    fmutexUnlock(&state->requestMutex);
 
-    return "";
+    if (next){
+        // The name is the request's own, so it stays put while it loads.
+        next->success = resourceLoad(next->name, next->type, &next->res);
+        fmutexLock(&state->requestMutex);
+        next->state = ASYNC_REQUEST_LOADED;
+        fmutexUnlock(&state->requestMutex);
+    }
+    __atomic_sub_fetch(&state->jobsInFlight, 1, __ATOMIC_RELEASE);
+}
+
+static asyncWaiter* getWaiter(u32 handle){
+    u32 idx = handle & 0xFFFF;
+    if (!systemPtr || handle == INVALID_ID || idx >= systemPtr->settings.maxAsyncRequests){
+        return 0;
+    }
+    asyncWaiter* w = &systemPtr->waiters[idx];
+    if (w->request == INVALID_ID || w->generation != (u16)(handle >> 16)){
+        return 0;
+    }
+    return w;
 }
 
-void resourceManagerChangeRootAssetPath(char* newRootAssetPath){
+static void freeWaiter(asyncWaiter* w){
+    w->request = INVALID_ID;
+    w->generation++;
+    w->callback = 0;
+    w->userData = 0;
+}
+
+u32 resourceLoadAsync(const char* name, ResourceType type, resourcePriority priority, PFN_resourceLoaded callback, void* userData){
+    if (!systemPtr){
+        FERROR("Resource manager used before being inited.");
+        return INVALID_ID;
+    }
+    if (!name || type >= RESOURCE_TYPE_CUSTOM || systemPtr->loadedManagers[type].id == INVALID_ID){
+        FERROR("Can't async load %s, there's no manager for its type.", name ? name : "");
+        return INVALID_ID;
+    }
+    if (systemPtr->loadedManagers[type].mainThreadOnly){
+        FERROR("Can't async load %s, its type has to load on the main thread.", name);
+        return INVALID_ID;
+    }
+    if (strLen(name) >= FILENAME_MAX_LENGTH){
+        FERROR("Can't async load %s, its name is too long.", name);
+        return INVALID_ID;
+    }
+
+    u32 waiterIdx = INVALID_ID;
+    for (u32 i = 0; i < systemPtr->settings.maxAsyncRequests; i++){
+        if (systemPtr->waiters[i].request == INVALID_ID){
+            waiterIdx = i;
+            break;
+        }
+    }
+    if (waiterIdx == INVALID_ID){
+        FWARN("Too many async loads waiting, can't load %s", name);
+        return INVALID_ID;
+    }
+
+    // Join a load that's already going if there is one.
+    fmutexLock(&systemPtr->requestMutex);
+    u32 requestIdx = INVALID_ID;
+    u32 freeIdx = INVALID_ID;
+    for (u32 i = 0; i < systemPtr->settings.maxAsyncRequests; i++){
+        asyncRequest* r = &systemPtr->requests[i];
+        if (r->state == ASYNC_REQUEST_FREE){
+            if (freeIdx == INVALID_ID){
+                freeIdx = i;
+            }
+        } else if (r->state != ASYNC_REQUEST_DELIVERING && r->type == type && strEqual(r->name, name)){
+            requestIdx = i;
+            break;
+        }
+    }
+    b8 queued = false;
+    if (requestIdx != INVALID_ID){
+        if (systemPtr->requests[requestIdx].state == ASYNC_REQUEST_QUEUED && priority > systemPtr->requests[requestIdx].priority){
+            systemPtr->requests[requestIdx].priority = priority;
+        }
+    } else if (freeIdx != INVALID_ID){
+        asyncRequest* r = &systemPtr->requests[freeIdx];
+        fzeroMemory(r, sizeof(asyncRequest));
+        strNCpy(r->name, name, FILENAME_MAX_LENGTH);
+        r->type = type;
+        r->priority = priority;
+        r->order = systemPtr->nextOrder++;
+        r->state = ASYNC_REQUEST_QUEUED;
+        requestIdx = freeIdx;
+        queued = true;
+    }
+    fmutexUnlock(&systemPtr->requestMutex);
+
+    if (requestIdx == INVALID_ID){
+        FWARN("Too many async loads waiting, can't load %s", name);
+        return INVALID_ID;
+    }
+    systemPtr->requests[requestIdx].waiterCnt++;
+    asyncWaiter* w = &systemPtr->waiters[waiterIdx];
+    w->request = requestIdx;
+    w->callback = callback;
+    w->userData = userData;
+
+    if (queued){
+        FCOUNTER_INC("resource.asyncLoads");
+        __atomic_add_fetch(&systemPtr->jobsInFlight, 1, __ATOMIC_RELAXED);
+        // Runs right here if the job system can't take it, the callback
+        // still waits for resourceManagerUpdate.
+        jobSubmit(asyncLoadJob, systemPtr);
+    }
+    return ((u32)w->generation << 16) | waiterIdx;
+}
+
+b8 resourceLoadCancel(u32 handle){
+    asyncWaiter* w = getWaiter(handle);
+    if (!w){
+        return false;
+    }
+    asyncRequest* r = &systemPtr->requests[w->request];
+    freeWaiter(w);
+    if (--r->waiterCnt == 0){
+        // A load that's running finishes, resourceManagerUpdate unloads it.
+        fmutexLock(&systemPtr->requestMutex);
+        if (r->state == ASYNC_REQUEST_QUEUED){
+            r->state = ASYNC_REQUEST_FREE;
+        }
+        fmutexUnlock(&systemPtr->requestMutex);
+    }
+    return true;
+}
+
+void resourceManagerUpdate(){
+    FPROFILE_FUNC();
+    if (!systemPtr){
+        return;
+    }
+    for (u32 i = 0; i < systemPtr->settings.maxAsyncRequests; i++){
+        asyncRequest* r = &systemPtr->requests[i];
+        fmutexLock(&systemPtr->requestMutex);
+        b8 loaded = r->state == ASYNC_REQUEST_LOADED;
+        if (loaded){
+            r->state = ASYNC_REQUEST_DELIVERING;
+        }
+        fmutexUnlock(&systemPtr->requestMutex);
+        if (!loaded){
+            continue;
+        }
+
+        // Callbacks can start or cancel other loads, just not join this one.
+        for (u32 j = 0; j < systemPtr->settings.maxAsyncRequests && r->waiterCnt; j++){
+            asyncWaiter* w = &systemPtr->waiters[j];
+            if (w->request != i){
+                continue;
+            }
+            PFN_resourceLoaded callback = w->callback;
+            void* userData = w->userData;
+            freeWaiter(w);
+            r->waiterCnt--;
+            if (callback){
+                callback(userData, r->success, &r->res);
+            }
+        }
+        if (r->success){
+            resourceUnload(&r->res);
+        }
+        fmutexLock(&systemPtr->requestMutex);
+        r->state = ASYNC_REQUEST_FREE;
+        fmutexUnlock(&systemPtr->requestMutex);
+    }
+}
+
+u32 resourceLoadAsyncPendingCount(){
+    if (!systemPtr){
+        return 0;
+    }
+    u32 cnt = 0;
+    fmutexLock(&systemPtr->requestMutex);
+    for (u32 i = 0; i < systemPtr->settings.maxAsyncRequests; i++){
+        if (systemPtr->requests[i].state != ASYNC_REQUEST_FREE){
+            cnt++;
+        }
+    }
+    fmutexUnlock(&systemPtr->requestMutex);
+    return cnt;
+}
+
+b8 resourceManagerHashesContent(){
+    return systemPtr && systemPtr->settings.hashContent;
+}
+
+const char* resourceManagerCachePath(){
     if (systemPtr){
-        systemPtr->settings.rootAssetPath = newRootAssetPath;
+        return systemPtr->settings.cachePath;
     }
+
+    return 0;
 }
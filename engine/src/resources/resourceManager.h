@@ -4,24 +4,101 @@
 
 typedef struct resourceManagerSettings {
     u32 maxManagers;
-    char* rootAssetPath;
+    // Where managers can keep things like decoded textures so the next load
+    // skips the decode. 0 turns caching off.
+    const char* cachePath;
+    // How many async loads can be waiting or running at once. 0 uses 256.
+    u32 maxAsyncRequests;
+    // Hashes what gets loaded so identical files under different names get
+    // loaded once and shared. Costs a hash of each file on its first load.
+    b8 hashContent;
+    // How many mapped binaries can be shared by content at once. 0 uses 256.
+    u32 maxSharedResources;
 } resourceManagerSettings;
 
+typedef enum resourcePriority {
+    RESOURCE_PRIORITY_LOW,
+    RESOURCE_PRIORITY_NORMAL,
+    RESOURCE_PRIORITY_HIGH,
+} resourcePriority;
+
+/**
+ * @brief Called on the main thread by resourceManagerUpdate when an async load finishes.
+ * @param userData What was passed to resourceLoadAsync
+ * @param success Whether it loaded
+ * @param res The resource. It's unloaded once every callback for it has run, so copy out what's needed
+ */
+typedef void (*PFN_resourceLoaded)(void* userData, b8 success, resource* res);
+
 typedef struct resourceManager {
     u32 id;
     ResourceType resourceType;
     const char* customTypeName;
     b8 (*load)(struct resourceManager* self, const char* name, resource* outResource);
     void (*unload)(struct resourceManager* self, resource* resource);
+    // Set when load has to run on the main thread, like when it creates GPU
+    // resources. These can't be loaded async.
+    b8 mainThreadOnly;
 } resourceManager;
 
-b8 resourceManagerInit(u64* memoryRequirement, void* state, resourceManagerSettings settings);
-void resourceManagerShutdown(void* state);
+FSNAPI b8 resourceManagerInit(u64* memoryRequirement, void* state, resourceManagerSettings settings);
+FSNAPI void resourceManagerShutdown(void* state);
 
 b8 resourceManagerLoadManager(resourceManager manager);
 
-b8 resourceLoad(const char* name, ResourceType type, resource* outResource);
-b8 resourceUnload(resource* resource);
+/**
+ * @brief Loads a resource. With content hashing on, mapped binaries with the
+ * same bytes as one that's already loaded share its data.
+ * @param name The resource's name
+ * @param type The resource's type
+ * @param outResource The loaded resource. Unload with resourceUnload
+ * @returns true if loaded
+ */
+FSNAPI b8 resourceLoad(const char* name, ResourceType type, resource* outResource);
+FSNAPI b8 resourceUnload(resource* resource);
+
+/**
+ * @brief Loads a resource on the job system. Asking for something that's
+ * already being loaded waits on that load instead of starting another. The
+ * callback runs on the main thread in resourceManagerUpdate, even when the
+ * load finishes right away.
+ * @param name The resource's name
+ * @param type The resource's type
+ * @param priority Waiting loads start highest priority first, then oldest first
+ * @param callback Called when it's loaded
+ * @param userData Passed to the callback
+ * @returns A handle for resourceLoadCancel, or INVALID_ID if it couldn't be queued
+ */
+FSNAPI u32 resourceLoadAsync(const char* name, ResourceType type, resourcePriority priority, PFN_resourceLoaded callback, void* userData);
+
+/**
+ * @brief Stops waiting on an async load, so its callback never runs. The load
+ * itself stops too if it hasn't started and nothing else is waiting on it.
+ * @param handle The handle from resourceLoadAsync
+ * @returns true if the callback hadn't run yet
+ */
+FSNAPI b8 resourceLoadCancel(u32 handle);
+
+/**
+ * @brief Runs the callbacks of async loads that have finished. The application
+ * calls this once a frame.
+ */
+FSNAPI void resourceManagerUpdate();
+
+/**
+ * @brief Gets how many async loads are waiting, running or waiting on their callbacks.
+ * @returns The count
+ */
+FSNAPI u32 resourceLoadAsyncPendingCount();
+
+/**
+ * @brief Whether loads hash their content so copies can be shared.
+ * @returns true if content is hashed
+ */
+b8 resourceManagerHashesContent();
 
-char* resourceManagerRootAssetPath();
-void resourceManagerChangeRootAssetPath(char* newRootAssetPath);
+/**
+ * @brief Gets the directory managers can cache things in.
+ * @returns The cache path, or 0 if caching is off
+ */
+const char* resourceManagerCachePath();
@@ -14,6 +14,9 @@ typedef enum ResourceType {
     RESOURCE_TYPE_IMAGE,
     RESOURCE_TYPE_MATERIAL,
     RESOURCE_TYPE_SHADER,
+    // A binary file mapped into memory instead of copied to the heap. The
+    // resource's data is read-only.
+    RESOURCE_TYPE_BINARY_MAPPED,
     RESOURCE_TYPE_CUSTOM
 } ResourceType;
 
@@ -23,6 +26,9 @@ typedef struct resource {
     char* fullPath;
     u32 dataSize;
     void* data;
+    // fpakChecksum of the file's bytes when the resource manager hashes
+    // content, for finding copies under other names. 0 if it wasn't hashed.
+    u64 contentHash;
 } resource;
 
 typedef struct imageRS {
@@ -0,0 +1,575 @@
+#include "vfs.h"
+
+#include "core/fmemory.h"
+#include "core/fmutex.h"
+#include "core/fstring.h"
+#include "core/logger.h"
+#include "helpers/blockCompress.h"
+#include "resources/fpak.h"
+
+#define VFS_DEFAULT_MAX_MOUNTS 8
+#define VFS_DEFAULT_MAX_CACHED_NAMES 4096
+// Name arena bytes per cached name, for the name and the path it resolved to.
+#define VFS_NAME_BYTES_PER_ENTRY 128
+
+typedef struct vfsMount {
+    vfsMountType type;
+    b8 active;
+    // Later mounts get searched first.
+    u32 order;
+    char path[VFS_MAX_PATH];
+    fpak pak;
+    // A bit per archive entry, set once its checksum has passed so it only
+    // gets hashed the first time it's loaded.
+    u8* verified;
+    const vfsMemoryFile* files;
+    u32 fileCnt;
+} vfsMount;
+
+// Where a name resolved to.
+typedef struct vfsCacheSlot {
+    // 0 marks an empty slot.
+    u64 hash;
+    // Interned into the names arena.
+    const char* name;
+    // The mount that has it, or INVALID_ID if none do.
+    u32 mountIdx;
+    // The loose file's path, or "<archive>:<name>" and "memory:<name>".
+    // Interned in the cache, resolve points it at the caller's copy.
+    const char* path;
+    const fpakEntry* entry;
+    const vfsMemoryFile* memFile;
+    // From vfsContentHash, 0 until it's asked for.
+    u64 contentHash;
+} vfsCacheSlot;
+
+typedef struct vfsState {
+    vfsMount* mounts;
+    u32 maxMounts;
+    // Active mount indexes, newest first.
+    u32* searchOrder;
+    u32 searchCnt;
+    u32 nextOrder;
+
+    // Guards the cache and names arena.
+    fmutex cacheMutex;
+    vfsCacheSlot* slots;
+    // Power of two, at least twice maxCachedNames.
+    u32 slotCnt;
+    u32 usedSlots;
+    u32 maxCachedNames;
+    char* names;
+    u64 namesCapacity;
+    u64 namesUsed;
+} vfsState;
+
+static vfsState* systemPtr = 0;
+
+static void clearCache() {
+    fzeroMemory(systemPtr->slots, sizeof(vfsCacheSlot) * systemPtr->slotCnt);
+    systemPtr->usedSlots = 0;
+    systemPtr->namesUsed = 0;
+}
+
+static void rebuildSearchOrder() {
+    systemPtr->searchCnt = 0;
+    for (u32 i = 0; i < systemPtr->maxMounts; ++i) {
+        if (!systemPtr->mounts[i].active) {
+            continue;
+        }
+        // Insertion sort, there are only a handful.
+        u32 j = systemPtr->searchCnt++;
+        while (j > 0 && systemPtr->mounts[systemPtr->searchOrder[j - 1]].order < systemPtr->mounts[i].order) {
+            systemPtr->searchOrder[j] = systemPtr->searchOrder[j - 1];
+            j--;
+        }
+        systemPtr->searchOrder[j] = i;
+    }
+}
+
+static const char* intern(const char* str) {
+    u64 size = strLen(str) + 1;
+    if (systemPtr->namesUsed + size > systemPtr->namesCapacity) {
+        return 0;
+    }
+    char* out = systemPtr->names + systemPtr->namesUsed;
+    fcopyMemory(out, str, size);
+    systemPtr->namesUsed += size;
+    return out;
+}
+
+// Searches the mounts newest first. pathBuf holds the resolved path.
+static void resolveUncached(const char* name, vfsCacheSlot* slot, char* pathBuf) {
+    slot->mountIdx = INVALID_ID;
+    slot->entry = 0;
+    slot->memFile = 0;
+    pathBuf[0] = 0;
+    for (u32 i = 0; i < systemPtr->searchCnt; ++i) {
+        u32 idx = systemPtr->searchOrder[i];
+        vfsMount* m = &systemPtr->mounts[idx];
+        switch (m->type) {
+            case VFS_MOUNT_DIRECTORY:
+                strFmt(pathBuf, "%s/%s", m->path, name);
+                if (fsExists(pathBuf)) {
+                    slot->mountIdx = idx;
+                    return;
+                }
+                break;
+            case VFS_MOUNT_PAK:
+                slot->entry = fpakFind(&m->pak, name);
+                if (slot->entry) {
+                    strFmt(pathBuf, "%s:%s", m->path, name);
+                    slot->mountIdx = idx;
+                    return;
+                }
+                break;
+            case VFS_MOUNT_MEMORY:
+                for (u32 f = 0; f < m->fileCnt; ++f) {
+                    if (strEqual(m->files[f].name, name)) {
+                        slot->memFile = &m->files[f];
+                        strFmt(pathBuf, "memory:%s", name);
+                        slot->mountIdx = idx;
+                        return;
+                    }
+                }
+                break;
+        }
+    }
+    pathBuf[0] = 0;
+}
+
+// Finds where a name lives, out of the cache if it's been looked up before.
+// The names arena gets reused once the cache fills up, so the path is copied
+// into pathOut, VFS_MAX_PATH chars, before the lock is let go.
+static b8 resolve(const char* name, vfsCacheSlot* outSlot, char* pathOut) {
+    if (!systemPtr) {
+        FERROR("VFS used before being inited.");
+        return false;
+    }
+    u64 len = strLen(name);
+    if (len == 0 || len >= VFS_MAX_PATH / 2) {
+        FERROR("VFS: '%s' isn't a valid asset name.", name);
+        return false;
+    }
+    u64 hash = fpakHashName(name, len);
+    // 0 marks empty slots.
+    hash = hash ? hash : 1;
+
+    fmutexLock(&systemPtr->cacheMutex);
+    u32 mask = systemPtr->slotCnt - 1;
+    u32 idx = (u32)hash & mask;
+    while (systemPtr->slots[idx].hash) {
+        vfsCacheSlot* s = &systemPtr->slots[idx];
+        if (s->hash == hash && strEqual(s->name, name)) {
+            *outSlot = *s;
+            strNCpy(pathOut, s->path, VFS_MAX_PATH);
+            outSlot->path = pathOut;
+            fmutexUnlock(&systemPtr->cacheMutex);
+            return outSlot->mountIdx != INVALID_ID;
+        }
+        idx = (idx + 1) & mask;
+    }
+
+    vfsCacheSlot slot;
+    slot.hash = hash;
+    slot.contentHash = 0;
+    resolveUncached(name, &slot, pathOut);
+
+    // Start over rather than evicting when full, names rarely get this far.
+    if (systemPtr->usedSlots >= systemPtr->maxCachedNames ||
+        systemPtr->namesUsed + len + strLen(pathOut) + 2 > systemPtr->namesCapacity) {
+        clearCache();
+        idx = (u32)hash & mask;
+    }
+    slot.name = intern(name);
+    slot.path = intern(pathOut);
+    systemPtr->slots[idx] = slot;
+    systemPtr->usedSlots++;
+    *outSlot = slot;
+    outSlot->path = pathOut;
+    fmutexUnlock(&systemPtr->cacheMutex);
+    return slot.mountIdx != INVALID_ID;
+}
+
+// Bytes for a bit per entry, at least one so empty archives still get an allocation.
+static u64 verifiedSize(const fpak* pak) {
+    return pak->header->entryCnt / 8 + 1;
+}
+
+static b8 verifyEntry(vfsMount* m, const fpakEntry* e, const char* path) {
+    if (e->compression != FPAK_COMPRESSION_NONE && e->compression != FPAK_COMPRESSION_LZ4) {
+        FERROR("VFS: %s uses a compression this build can't read.", path);
+        return false;
+    }
+    u64 idx = (u64)(e - m->pak.entries);
+    u8 bit = (u8)(1 << (idx % 8));
+    if (__atomic_load_n(&m->verified[idx / 8], __ATOMIC_ACQUIRE) & bit) {
+        return true;
+    }
+    if (!fpakVerifyEntry(&m->pak, e)) {
+        FERROR("VFS: %s failed its checksum.", path);
+        return false;
+    }
+    // Two threads can both verify it first, that's only wasted work.
+    __atomic_fetch_or(&m->verified[idx / 8], bit, __ATOMIC_RELEASE);
+    return true;
+}
+
+static u32 addMount(vfsMountType type) {
+    if (!systemPtr) {
+        FERROR("VFS used before being inited.");
+        return INVALID_ID;
+    }
+    for (u32 i = 0; i < systemPtr->maxMounts; ++i) {
+        vfsMount* m = &systemPtr->mounts[i];
+        if (!m->active) {
+            fzeroMemory(m, sizeof(vfsMount));
+            m->type = type;
+            return i;
+        }
+    }
+    FERROR("VFS: Out of mounts, raise vfsConfig.maxMounts.");
+    return INVALID_ID;
+}
+
+static void activateMount(u32 idx) {
+    vfsMount* m = &systemPtr->mounts[idx];
+    m->active = true;
+    m->order = systemPtr->nextOrder++;
+    rebuildSearchOrder();
+    vfsInvalidate();
+}
+
+static void mountRootDirectory(const char* path) {
+    if (path && vfsMountDirectory(path) == INVALID_ID) {
+        FWARN("VFS couldn't mount the asset directory %s.", path);
+    }
+}
+
+b8 vfsInit(u64* memoryRequirement, void* state, vfsConfig config) {
+    u32 maxMounts = config.maxMounts ? config.maxMounts : VFS_DEFAULT_MAX_MOUNTS;
+    u32 maxCachedNames = config.maxCachedNames ? config.maxCachedNames : VFS_DEFAULT_MAX_CACHED_NAMES;
+    u32 slotCnt = 1;
+    while (slotCnt < maxCachedNames * 2) {
+        slotCnt <<= 1;
+    }
+    u64 namesCapacity = (u64)maxCachedNames * VFS_NAME_BYTES_PER_ENTRY;
+
+    *memoryRequirement = sizeof(vfsState) + sizeof(vfsMount) * maxMounts + sizeof(u32) * maxMounts +
+                         sizeof(vfsCacheSlot) * slotCnt + namesCapacity;
+    if (!state) {
+        return true;
+    }
+
+    systemPtr = state;
+    fzeroMemory(systemPtr, *memoryRequirement);
+    systemPtr->mounts = (vfsMount*)((u8*)state + sizeof(vfsState));
+    systemPtr->maxMounts = maxMounts;
+    systemPtr->searchOrder = (u32*)(systemPtr->mounts + maxMounts);
+    systemPtr->slots = (vfsCacheSlot*)(systemPtr->searchOrder + maxMounts);
+    systemPtr->slotCnt = slotCnt;
+    systemPtr->maxCachedNames = maxCachedNames;
+    systemPtr->names = (char*)(systemPtr->slots + slotCnt);
+    systemPtr->namesCapacity = namesCapacity;
+
+    if (!fmutexCreate(&systemPtr->cacheMutex)) {
+        FERROR("VFS failed to create its cache mutex.");
+        systemPtr = 0;
+        return false;
+    }
+
+#if !defined(_DEBUG)
+    mountRootDirectory(config.rootAssetPath);
+#endif
+    if (config.pakPath && !fsExists(config.pakPath)) {
+        FINFO("No asset archive at %s, loading loose files only.", config.pakPath);
+    } else if (config.pakPath) {
+        vfsMountPak(config.pakPath);
+    }
+    // Loose files win in debug builds, that's where they get edited.
+#if defined(_DEBUG)
+    mountRootDirectory(config.rootAssetPath);
+#endif
+    return true;
+}
+
+void vfsShutdown(void* state) {
+    if (!systemPtr) {
+        return;
+    }
+    for (u32 i = 0; i < systemPtr->maxMounts; ++i) {
+        if (systemPtr->mounts[i].active) {
+            vfsUnmount(i);
+        }
+    }
+    fmutexDestroy(&systemPtr->cacheMutex);
+    systemPtr = 0;
+}
+
+u32 vfsMountDirectory(const char* path) {
+    u64 len = strLen(path);
+    if (len == 0 || len >= VFS_MAX_PATH / 2 || !fsExists(path)) {
+        FERROR("VFS: Can't mount directory '%s'.", path);
+        return INVALID_ID;
+    }
+    u32 idx = addMount(VFS_MOUNT_DIRECTORY);
+    if (idx == INVALID_ID) {
+        return INVALID_ID;
+    }
+    vfsMount* m = &systemPtr->mounts[idx];
+    strNCpy(m->path, path, VFS_MAX_PATH);
+    // Names get joined on with a '/'.
+    while (len > 1 && (m->path[len - 1] == '/' || m->path[len - 1] == '\\')) {
+        m->path[--len] = 0;
+    }
+    activateMount(idx);
+    FINFO("VFS mounted directory %s.", m->path);
+    return idx;
+}
+
+u32 vfsMountPak(const char* path) {
+    if (strLen(path) >= VFS_MAX_PATH / 2) {
+        FERROR("VFS: Can't mount archive '%s'.", path);
+        return INVALID_ID;
+    }
+    u32 idx = addMount(VFS_MOUNT_PAK);
+    if (idx == INVALID_ID) {
+        return INVALID_ID;
+    }
+    vfsMount* m = &systemPtr->mounts[idx];
+    if (!fpakOpen(path, &m->pak)) {
+        return INVALID_ID;
+    }
+    m->verified = fallocate(verifiedSize(&m->pak), MEMORY_TAG_ARRAY);
+    fzeroMemory(m->verified, verifiedSize(&m->pak));
+    strNCpy(m->path, path, VFS_MAX_PATH);
+    activateMount(idx);
+    return idx;
+}
+
+u32 vfsMountMemory(const vfsMemoryFile* files, u32 fileCnt) {
+    u32 idx = addMount(VFS_MOUNT_MEMORY);
+    if (idx == INVALID_ID) {
+        return INVALID_ID;
+    }
+    vfsMount* m = &systemPtr->mounts[idx];
+    m->files = files;
+    m->fileCnt = fileCnt;
+    strNCpy(m->path, "memory", VFS_MAX_PATH);
+    activateMount(idx);
+    return idx;
+}
+
+void vfsUnmount(u32 mountId) {
+    if (!systemPtr || mountId >= systemPtr->maxMounts || !systemPtr->mounts[mountId].active) {
+        return;
+    }
+    vfsMount* m = &systemPtr->mounts[mountId];
+    if (m->type == VFS_MOUNT_PAK) {
+        ffree(m->verified, verifiedSize(&m->pak), MEMORY_TAG_ARRAY);
+        m->verified = 0;
+        fpakClose(&m->pak);
+    }
+    m->active = false;
+    rebuildSearchOrder();
+    vfsInvalidate();
+}
+
+void vfsInvalidate() {
+    if (!systemPtr) {
+        return;
+    }
+    fmutexLock(&systemPtr->cacheMutex);
+    clearCache();
+    fmutexUnlock(&systemPtr->cacheMutex);
+}
+
+b8 vfsExists(const char* name) {
+    vfsCacheSlot slot;
+    char path[VFS_MAX_PATH];
+    return resolve(name, &slot, path);
+}
+
+b8 vfsMap(const char* name, fileMapHints hints, vfsMapping* outMapping) {
+    fzeroMemory(outMapping, sizeof(vfsMapping));
+    vfsCacheSlot slot;
+    if (!resolve(name, &slot, outMapping->path)) {
+        return false;
+    }
+    vfsMount* m = &systemPtr->mounts[slot.mountIdx];
+    switch (m->type) {
+        case VFS_MOUNT_DIRECTORY:
+            if (!fsMap(slot.path, hints, &outMapping->fileMap)) {
+                return false;
+            }
+            outMapping->data = outMapping->fileMap.data;
+            outMapping->size = outMapping->fileMap.size;
+            return true;
+        case VFS_MOUNT_PAK: {
+            const fpakEntry* e = slot.entry;
+            if (!verifyEntry(m, e, slot.path)) {
+                return false;
+            }
+            if (e->compression == FPAK_COMPRESSION_NONE) {
+                outMapping->data = fpakEntryData(&m->pak, e);
+                outMapping->size = e->size;
+                return true;
+            }
+            outMapping->owned = fallocate(e->rawSize, MEMORY_TAG_ARRAY);
+            if (!blockDecompress(fpakEntryData(&m->pak, e), e->size, outMapping->owned, e->rawSize)) {
+                FERROR("VFS: %s failed to decompress.", slot.path);
+                ffree(outMapping->owned, e->rawSize, MEMORY_TAG_ARRAY);
+                outMapping->owned = 0;
+                return false;
+            }
+            outMapping->data = outMapping->owned;
+            outMapping->size = e->rawSize;
+            return true;
+        }
+        case VFS_MOUNT_MEMORY:
+            outMapping->data = slot.memFile->data;
+            outMapping->size = slot.memFile->size;
+            return true;
+    }
+    return false;
+}
+
+// Finds a name's slot in the cache. Call with the cache locked.
+static vfsCacheSlot* findCached(u64 hash, const char* name) {
+    u32 mask = systemPtr->slotCnt - 1;
+    for (u32 idx = (u32)hash & mask; systemPtr->slots[idx].hash; idx = (idx + 1) & mask) {
+        vfsCacheSlot* s = &systemPtr->slots[idx];
+        if (s->hash == hash && strEqual(s->name, name)) {
+            return s;
+        }
+    }
+    return 0;
+}
+
+b8 vfsContentHash(const char* name, u64* outHash) {
+    vfsCacheSlot slot;
+    char path[VFS_MAX_PATH];
+    if (!resolve(name, &slot, path)) {
+        return false;
+    }
+    if (slot.contentHash) {
+        *outHash = slot.contentHash;
+        return true;
+    }
+    u64 contentHash;
+    const fpakEntry* e = slot.entry;
+    if (e && e->compression == FPAK_COMPRESSION_NONE) {
+        // The table of contents already has it.
+        contentHash = e->checksum;
+    } else {
+        vfsMapping mapping;
+        if (!vfsMap(name, FILE_MAP_HINT_SEQUENTIAL, &mapping)) {
+            return false;
+        }
+        contentHash = fpakChecksum(mapping.data, mapping.size);
+        vfsUnmap(&mapping);
+    }
+    // 0 means it hasn't been hashed.
+    contentHash = contentHash ? contentHash : 1;
+
+    // Remember it, unless the cache started over in the meantime.
+    fmutexLock(&systemPtr->cacheMutex);
+    vfsCacheSlot* s = findCached(slot.hash, name);
+    if (s) {
+        s->contentHash = contentHash;
+    }
+    fmutexUnlock(&systemPtr->cacheMutex);
+    *outHash = contentHash;
+    return true;
+}
+
+void vfsForgetContentHash(const char* name) {
+    vfsCacheSlot slot;
+    char path[VFS_MAX_PATH];
+    if (!resolve(name, &slot, path)) {
+        return;
+    }
+    fmutexLock(&systemPtr->cacheMutex);
+    vfsCacheSlot* s = findCached(slot.hash, name);
+    if (s) {
+        s->contentHash = 0;
+    }
+    fmutexUnlock(&systemPtr->cacheMutex);
+}
+
+b8 vfsGetLoosePath(const char* name, char* outPath) {
+    vfsCacheSlot slot;
+    if (!resolve(name, &slot, outPath)) {
+        return false;
+    }
+    return systemPtr->mounts[slot.mountIdx].type == VFS_MOUNT_DIRECTORY;
+}
+
+void vfsUnmap(vfsMapping* mapping) {
+    if (mapping->owned) {
+        ffree(mapping->owned, mapping->size, MEMORY_TAG_ARRAY);
+    }
+    fsUnmap(&mapping->fileMap);
+    fzeroMemory(mapping, sizeof(vfsMapping));
+}
+
+b8 vfsIsMountMemory(const void* data) {
+    if (!systemPtr || !data) {
+        return false;
+    }
+    for (u32 i = 0; i < systemPtr->searchCnt; ++i) {
+        vfsMount* m = &systemPtr->mounts[systemPtr->searchOrder[i]];
+        if (m->type == VFS_MOUNT_PAK && fpakContains(&m->pak, data)) {
+            return true;
+        }
+        if (m->type == VFS_MOUNT_MEMORY) {
+            for (u32 f = 0; f < m->fileCnt; ++f) {
+                const u8* start = m->files[f].data;
+                if ((const u8*)data >= start && (const u8*)data < start + m->files[f].size) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+b8 vfsOpen(const char* name, fsReader* outReader, char* outPath) {
+    vfsCacheSlot slot;
+    char path[VFS_MAX_PATH];
+    if (!resolve(name, &slot, path)) {
+        return false;
+    }
+    if (outPath) {
+        strNCpy(outPath, path, VFS_MAX_PATH);
+    }
+    vfsMount* m = &systemPtr->mounts[slot.mountIdx];
+    switch (m->type) {
+        case VFS_MOUNT_DIRECTORY:
+            return fsReaderOpen(slot.path, outReader);
+        case VFS_MOUNT_PAK: {
+            const fpakEntry* e = slot.entry;
+            if (!verifyEntry(m, e, slot.path)) {
+                return false;
+            }
+            if (e->compression == FPAK_COMPRESSION_NONE) {
+                fsReaderOpenMemory(fpakEntryData(&m->pak, e), e->size, outReader);
+                return true;
+            }
+            if (e->rawSize > sizeof(outReader->buffer)) {
+                FERROR("VFS: %s is too big to read lines from compressed. Pack it uncompressed.", slot.path);
+                return false;
+            }
+            if (!blockDecompress(fpakEntryData(&m->pak, e), e->size, outReader->buffer, e->rawSize)) {
+                FERROR("VFS: %s failed to decompress.", slot.path);
+                return false;
+            }
+            fsReaderOpenMemory(outReader->buffer, e->rawSize, outReader);
+            return true;
+        }
+        case VFS_MOUNT_MEMORY:
+            fsReaderOpenMemory(slot.memFile->data, slot.memFile->size, outReader);
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "defines.h"
+#include "platform/filesystem.h"
+
+/*
+ * Virtual filesystem for assets. Managers ask for a name like
+ * "shaders/App.UIShader.vert.spv" and the VFS finds it in its mounts:
+ * directories of loose files, .fpak archives and in-memory overlays.
+ * Mounts are searched newest first, so a patch archive or overlay mounted
+ * later replaces files without any code changes.
+ *
+ * Where a name resolved to is cached, keyed by the name interned into the
+ * VFS, so loading the same asset again is one hash lookup instead of
+ * formatting paths and checking the disk. Mounting, unmounting and
+ * vfsInvalidate clear the cache, so they shouldn't run while loads are in
+ * flight on other threads.
+ */
+
+// Longest path the VFS hands back, including the terminator.
+#define VFS_MAX_PATH 512
+
+typedef enum vfsMountType {
+    VFS_MOUNT_DIRECTORY,
+    VFS_MOUNT_PAK,
+    VFS_MOUNT_MEMORY,
+} vfsMountType;
+
+// A file in an in-memory overlay. Its name and data must outlive the mount.
+typedef struct vfsMemoryFile {
+    const char* name;
+    const void* data;
+    u64 size;
+} vfsMemoryFile;
+
+typedef struct vfsConfig {
+    // 0 uses 8.
+    u32 maxMounts;
+    // How many names can be cached before the cache starts over. 0 uses 4096.
+    u32 maxCachedNames;
+    // A directory of loose files. Optional. Debug builds mount it over pakPath
+    // so edited files win and can be hot reloaded, release builds under it.
+    const char* rootAssetPath;
+    // An archive of the assets. Optional, and it's fine if it's missing.
+    const char* pakPath;
+} vfsConfig;
+
+// A read-only view of a whole file from vfsMap.
+typedef struct vfsMapping {
+    const void* data;
+    u64 size;
+    // Where it was found, for logging. A copy, since the cache can start over
+    // on another thread while the mapping's in use.
+    char path[VFS_MAX_PATH];
+    // Set when the data is a decompressed archive entry the caller can keep,
+    // allocated with MEMORY_TAG_ARRAY. vfsUnmap frees it otherwise.
+    void* owned;
+    fileMapping fileMap;
+} vfsMapping;
+
+/**
+ * @brief Inits the VFS and mounts the config's root directory and archive.
+ * @param memoryRequirement Gets set to the memory the VFS needs
+ * @param state The VFS's memory. 0 to just get the memoryRequirement
+ * @param config The VFS's config
+ * @returns true if successful, false if failed
+ */
+FSNAPI b8 vfsInit(u64* memoryRequirement, void* state, vfsConfig config);
+
+/**
+ * @brief Unmounts everything.
+ * @param state The VFS's memory
+ */
+FSNAPI void vfsShutdown(void* state);
+
+/**
+ * @brief Mounts a directory of loose files over the current mounts.
+ * @param path The directory
+ * @returns The mount's id, or INVALID_ID if there's no room
+ */
+FSNAPI u32 vfsMountDirectory(const char* path);
+
+/**
+ * @brief Maps an archive and mounts it over the current mounts.
+ * @param path The archive
+ * @returns The mount's id, or INVALID_ID if it couldn't be opened
+ */
+FSNAPI u32 vfsMountPak(const char* path);
+
+/**
+ * @brief Mounts files that are already in memory over the current mounts.
+ * @param files The files. The array must outlive the mount
+ * @param fileCnt How many files there are
+ * @returns The mount's id, or INVALID_ID if there's no room
+ */
+FSNAPI u32 vfsMountMemory(const vfsMemoryFile* files, u32 fileCnt);
+
+/**
+ * @brief Removes a mount. Anything mapped out of an archive mount can't be
+ * used after this.
+ * @param mountId The mount's id
+ */
+FSNAPI void vfsUnmount(u32 mountId);
+
+/**
+ * @brief Forgets where every name resolved to, for when files on disk change.
+ */
+FSNAPI void vfsInvalidate();
+
+/**
+ * @brief Checks if any mount has a file.
+ * @param name The file's name
+ * @returns true if it exists
+ */
+FSNAPI b8 vfsExists(const char* name);
+
+/**
+ * @brief Gets a read-only view of a whole file. Loose files are memory
+ * mapped, archive and overlay files are viewed in place, and compressed
+ * archive entries get decompressed.
+ * @param name The file's name
+ * @param hints How the data is going to be read, for loose files
+ * @param outMapping The view
+ * @returns true if found and readable
+ */
+FSNAPI b8 vfsMap(const char* name, fileMapHints hints, vfsMapping* outMapping);
+
+/**
+ * @brief Gets the fpakChecksum of a file's contents, so files with the same
+ * bytes can be found whatever they're called. Uncompressed archive entries
+ * use the checksum in the table of contents, everything else is read and
+ * hashed the first time. The hash is cached with the name.
+ * @param name The file's name
+ * @param outHash The hash. Never 0
+ * @returns true if found and readable
+ */
+FSNAPI b8 vfsContentHash(const char* name, u64* outHash);
+
+/**
+ * @brief Drops a name's cached content hash, for when its file was written.
+ * The next vfsContentHash hashes it again.
+ * @param name The file's name
+ */
+FSNAPI void vfsForgetContentHash(const char* name);
+
+/**
+ * @brief Gets the path on disk of the loose file a name resolves to, for
+ * reading it some way the VFS doesn't, like fsReadAsync.
+ * @param name The file's name
+ * @param outPath The path. At least VFS_MAX_PATH chars
+ * @returns false if it isn't found, or resolves to an archive or overlay
+ */
+FSNAPI b8 vfsGetLoosePath(const char* name, char* outPath);
+
+/**
+ * @brief Releases a view from vfsMap. Clear owned first to keep a
+ * decompressed entry.
+ * @param mapping The view
+ */
+FSNAPI void vfsUnmap(vfsMapping* mapping);
+
+/**
+ * @brief Whether memory belongs to a mount, like an archive or overlay file
+ * vfsMap handed out, so whoever has it knows not to free or unmap it.
+ * @param data The memory
+ * @returns true if it's mount memory
+ */
+FSNAPI b8 vfsIsMountMemory(const void* data);
+
+/**
+ * @brief Opens a text file for reading lines. Compressed archive entries are
+ * decompressed into the reader's buffer, so they have to fit in
+ * FS_READER_BUFFER_SIZE.
+ * @param name The file's name
+ * @param outReader The reader. Close with fsReaderClose
+ * @param outPath Gets a copy of where it was found, for logging. At least
+ * VFS_MAX_PATH chars. Optional
+ * @returns true if found and opened
+ */
+FSNAPI b8 vfsOpen(const char* name, fsReader* outReader, char* outPath);
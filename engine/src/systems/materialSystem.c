@@ -7,13 +7,21 @@
 #include "helpers/dinoArray.h"
 #include "core/fmemory.h"
 #include "core/logger.h"
+#include "core/event.h"
+#include "platform/fileWatch.h"
+#include "platform/filesystem.h"
 #include "resources/resourceManager.h"
+#include "resources/vfs.h"
 
 typedef struct materialSystemState
 {
     hashtable materialIDs;
     void* hashtableMemory;
     material* materials;
+    // What each material was loaded as, which can differ from the Name in its file.
+    char (*fileNames)[FILENAME_MAX_LENGTH];
+    // The file watch for each material's file, INVALID_ID if it isn't watched.
+    u32* watchIDs;
     materialSystemSettings settings;
 
     material defaultMaterial;
@@ -22,12 +30,15 @@ typedef struct materialSystemState
 static materialSystemState* systemPtr;
 
 void destroyMaterial(material* mat);
+static b8 materialSystemOnFileChanged(u16 code, void* sender, void* listenerInst, eventContext context);
 
 void materialSystemInit(u64* memoryRequirement, void* state, materialSystemSettings settings){
-    // Block of memory will contain state structure, then block for array, then block for hashtable.
+    // Block of memory will contain state structure, then block for array, then block for hashtable, then names and watch ids.
     u64 materialSize = sizeof(material) * settings.maxMaterialCnt;
     u64 hashtableSize = sizeof(entry) * settings.maxMaterialCnt;
-    *memoryRequirement = sizeof(materialSystemState) + materialSize + hashtableSize;
+    u64 fileNamesSize = sizeof(char) * FILENAME_MAX_LENGTH * settings.maxMaterialCnt;
+    u64 watchIDsSize = sizeof(u32) * settings.maxMaterialCnt;
+    *memoryRequirement = sizeof(materialSystemState) + materialSize + hashtableSize + fileNamesSize + watchIDsSize;
     if (state == 0){
         return;
     }
@@ -39,19 +50,28 @@ void materialSystemInit(u64* memoryRequirement, void* state, materialSystemSetti
     void* hashtableMem = materialsMem + materialSize;
 
     systemPtr->materials = materialsMem;
+    systemPtr->fileNames = hashtableMem + hashtableSize;
+    systemPtr->watchIDs = hashtableMem + hashtableSize + fileNamesSize;
 
     hashtableCreate(sizeof(u64), settings.maxMaterialCnt, hashtableMem, false, &systemPtr->materialIDs);
 
     for (u64 i = 0; i < systemPtr->settings.maxMaterialCnt; i++){
         systemPtr->materials[i].id = INVALID_ID;
         systemPtr->materials[i].generation = INVALID_ID;
+        systemPtr->fileNames[i][0] = 0;
+        systemPtr->watchIDs[i] = INVALID_ID;
     }
 
     materialSystemCreateDefault();
+
+    eventRegister(EVENT_CODE_WATCHED_FILE_WRITTEN, 0, materialSystemOnFileChanged);
+    eventRegister(EVENT_CODE_WATCHED_FILE_DELETED, 0, materialSystemOnFileChanged);
 }
 
 void materialSystemShutdown(void* state){
     if (systemPtr){
+        eventUnregister(EVENT_CODE_WATCHED_FILE_WRITTEN, 0, materialSystemOnFileChanged);
+        eventUnregister(EVENT_CODE_WATCHED_FILE_DELETED, 0, materialSystemOnFileChanged);
         u32 c = systemPtr->settings.maxMaterialCnt;
         for (u32 i = 0; i < c; i++){
             if (systemPtr->materials[i].id != INVALID_ID){
@@ -97,21 +117,33 @@ material* materialSystemMaterialGet(const char* name){
     if (!alreadyCreated){
         material* m;
         resource res;
-        if (!resourceLoad(name, RESOURCE_TYPE_MATERIAL, &res)){
+        b8 loaded = resourceLoad(name, RESOURCE_TYPE_MATERIAL, &res);
+        if (!loaded){
             m = materialSystemGetDefault();
         }else{
             m = (material*)res.data;
         }
 
-        resourceUnload(&res);
-        
         if (!rendererCreateMaterial(m)){
             FERROR("Could not make default material");
+            if (loaded){
+                resourceUnload(&res);
+            }
             return false;
         }
         m->id = matID;
         systemPtr->materials[matID] = *m;
         hashtableSet(&systemPtr->materialIDs, name, &matID);
+        strNCpy(systemPtr->fileNames[matID], name, FILENAME_MAX_LENGTH);
+
+        // The loaded material was copied out above, so it can go now.
+        if (loaded){
+            // Watch loose files so edits show up without a restart.
+            if (fsExists(res.fullPath)){
+                systemPtr->watchIDs[matID] = fileWatchAdd(res.fullPath);
+            }
+            resourceUnload(&res);
+        }
     }
     systemPtr->materials[matID].generation++;
     return &systemPtr->materials[matID];
@@ -134,6 +166,8 @@ void materialSystemMaterialRelease(const char* name){
 
             // Destroy/reset material.
             destroyMaterial(m);
+            fileWatchRemove(systemPtr->watchIDs[id]);
+            systemPtr->watchIDs[id] = INVALID_ID;
 
             FTRACE("Released material '%s'., Material unloaded because reference count=0 and autoDelete=true.", name);
         }
@@ -145,6 +179,59 @@ void materialSystemMaterialRelease(const char* name){
     }
 }
 
+// Swaps a material's settings for what's in its file now. The renderer keeps
+// its own state for the material, so it only has to pick up the new values.
+static b8 reloadMaterial(material* m, const char* fileName){
+    resource res;
+    if (!resourceLoad(fileName, RESOURCE_TYPE_MATERIAL, &res)){
+        return false;
+    }
+    material* fresh = res.data;
+    if (fresh->type != m->type){
+        FWARN("Material %s changed its type, that needs a restart to show up.", fileName);
+    }
+
+    // Loading the file took its own reference to its texture, so let go of the old one.
+    texture* oldDiffuse = m->diffuseMap.texture;
+    m->diffuseColor = fresh->diffuseColor;
+    m->diffuseMap.texture = fresh->diffuseMap.texture;
+    if (oldDiffuse){
+        textureSystemTextureRelease(oldDiffuse->name);
+    }
+    m->generation++;
+
+    resourceUnload(&res);
+    return true;
+}
+
+// Reloads a material in place when its file changes.
+static b8 materialSystemOnFileChanged(u16 code, void* sender, void* listenerInst, eventContext context){
+    u32 watchID = context.data.u32[0];
+    for (u32 i = 0; i < systemPtr->settings.maxMaterialCnt; ++i){
+        if (systemPtr->watchIDs[i] != watchID){
+            continue;
+        }
+        const char* fileName = systemPtr->fileNames[i];
+        if (code == EVENT_CODE_WATCHED_FILE_DELETED){
+            // Another mount might still have it, like the archive the loose
+            // files are mounted over in debug builds.
+            char path[FILENAME_MAX_LENGTH + 8];
+            strFmt(path, "%s.fmat", fileName);
+            vfsInvalidate();
+            if (!vfsExists(path)){
+                FWARN("Material %s was deleted, keeping what's loaded.", fileName);
+                return true;
+            }
+        }
+        FINFO("Reloading material %s.", fileName);
+        if (!reloadMaterial(&systemPtr->materials[i], fileName)){
+            FWARN("Couldn't reload material %s, keeping what's loaded.", fileName);
+        }
+        return true;
+    }
+    return false;
+}
+
 void destroyMaterial(material* mat){
     if (mat){
         rendererDestroyMaterial(mat);
@@ -1,17 +1,32 @@
 #include "textureSystem.h"
 #include "helpers/hashtable.h"
+#include "core/counters.h"
+#include "core/event.h"
 #include "core/fstring.h"
 #include "core/logger.h"
 #include "core/fmemory.h"
 #include "renderer/rendererFront.h"
 #include "resources/resourcesTypes.h"
+#include "platform/fileWatch.h"
+#include "platform/filesystem.h"
 #include "resources/resourceManager.h"
+#include "resources/vfs.h"
 
 typedef struct textureSystemState
 {
     hashtable textureIDs;
     void* hashtableMemory;
     texture* textures;
+    // The file watch for each texture's file, INVALID_ID if it isn't watched.
+    u32* watchIDs;
+    // The async load each texture is waiting on, INVALID_ID if it isn't.
+    u32* requestIDs;
+    // Each texture's content hash when content is hashed, 0 otherwise.
+    u64* contentHashes;
+    // For names whose file has the same bytes as a texture that's already
+    // loaded, the texture whose GPU data they share. INVALID_ID for
+    // everything else.
+    u32* aliasOf;
     textureSystemSettings settings;
 
     texture defaultTexture;
@@ -25,14 +40,20 @@ b8 isNameDefault(const char* name){
 }
 
 b8 loadTexture(const char* texture_name, texture* t);
+static b8 uploadTexture(texture* t, resource* image);
+static void textureSystemOnImageLoaded(void* userData, b8 success, resource* res);
+static b8 textureSystemOnFileChanged(u16 code, void* sender, void* listenerInst, eventContext context);
 
 textureSystemState* systemPtr;
 
 void textureSystemInit(u64* memoryRequirement, void* state, textureSystemSettings settings){
-    // Block of memory will contain state structure, then block for array, then block for hashtable.
+    // Block of memory will contain state structure, then block for array, then block for hashtable,
+    // then the content hashes, then the watch ids, request ids and aliases.
     u64 texturesSize = sizeof(texture) * settings.maxTextureCnt;
     u64 hashtableSize = sizeof(entry) * settings.maxTextureCnt;
-    *memoryRequirement = sizeof(textureSystemState) + texturesSize + hashtableSize;
+    u64 contentHashesSize = sizeof(u64) * settings.maxTextureCnt;
+    u64 watchIDsSize = sizeof(u32) * settings.maxTextureCnt;
+    *memoryRequirement = sizeof(textureSystemState) + texturesSize + hashtableSize + contentHashesSize + watchIDsSize * 3;
     if (state == 0){
         return;
     }
@@ -44,22 +65,37 @@ void textureSystemInit(u64* memoryRequirement, void* state, textureSystemSetting
     void* hashtableMem = texturesMem + texturesSize;
 
     systemPtr->textures = texturesMem;
+    systemPtr->contentHashes = hashtableMem + hashtableSize;
+    systemPtr->watchIDs = (u32*)(systemPtr->contentHashes + settings.maxTextureCnt);
+    systemPtr->requestIDs = systemPtr->watchIDs + settings.maxTextureCnt;
+    systemPtr->aliasOf = systemPtr->requestIDs + settings.maxTextureCnt;
 
     hashtableCreate(sizeof(u64), settings.maxTextureCnt, hashtableMem, false, &systemPtr->textureIDs);
 
     for (u64 i = 0; i < systemPtr->settings.maxTextureCnt; i++){
         systemPtr->textures[i].id = INVALID_ID;
         systemPtr->textures[i].generation = INVALID_ID;
+        systemPtr->watchIDs[i] = INVALID_ID;
+        systemPtr->requestIDs[i] = INVALID_ID;
+        systemPtr->contentHashes[i] = 0;
+        systemPtr->aliasOf[i] = INVALID_ID;
     }
 
     textureSystemCreateDefault();
+
+    eventRegister(EVENT_CODE_WATCHED_FILE_WRITTEN, 0, textureSystemOnFileChanged);
+    eventRegister(EVENT_CODE_WATCHED_FILE_DELETED, 0, textureSystemOnFileChanged);
 }
 
 void textureSystemShutdown(void* state){
     if (systemPtr){
+        eventUnregister(EVENT_CODE_WATCHED_FILE_WRITTEN, 0, textureSystemOnFileChanged);
+        eventUnregister(EVENT_CODE_WATCHED_FILE_DELETED, 0, textureSystemOnFileChanged);
         for(u64 i = 0; i < systemPtr->settings.maxTextureCnt; i++){
             texture* t = &systemPtr->textures[i];
-            if (t->id != INVALID_ID){
+            resourceLoadCancel(systemPtr->requestIDs[i]);
+            // Aliases' data goes with their original.
+            if (t->id != INVALID_ID && systemPtr->aliasOf[i] == INVALID_ID){
                 rendererDestroyTexture(t);
             }
         }
@@ -68,7 +104,61 @@ void textureSystemShutdown(void* state){
     }
 }
 
-texture* textureSystemTextureGetCreate(const char* name, b8 autoDelete){
+// Finds a loaded texture with the same content.
+static u32 findByContent(u64 contentHash){
+    if (!contentHash){
+        return INVALID_ID;
+    }
+    for (u32 i = 0; i < systemPtr->settings.maxTextureCnt; ++i){
+        if (systemPtr->contentHashes[i] == contentHash && systemPtr->aliasOf[i] == INVALID_ID && systemPtr->textures[i].refCnt > 0){
+            return i;
+        }
+    }
+    return INVALID_ID;
+}
+
+// Points an alias at its original's GPU data. Has to be done again whenever
+// the original's data changes.
+static void mirrorOriginal(u32 aliasID){
+    texture* t = &systemPtr->textures[aliasID];
+    texture* original = &systemPtr->textures[systemPtr->aliasOf[aliasID]];
+    // Still loading, the alias draws the default until it's in.
+    if (original->generation == INVALID_ID){
+        return;
+    }
+    if (t->generation == INVALID_ID){
+        FCOUNTER_ADD("texture.dedupBytesSaved", (u64)original->width * original->height * original->channelCnt);
+    }
+    t->width = original->width;
+    t->height = original->height;
+    t->channelCnt = original->channelCnt;
+    t->hasTransparency = original->hasTransparency;
+    t->data = original->data;
+    t->generation = t->generation == INVALID_ID ? 0 : t->generation + 1;
+}
+
+// Gives an alias its own load again, once its file or its original's changed.
+static void breakAlias(u32 aliasID){
+    texture* t = &systemPtr->textures[aliasID];
+    char originalName[FILENAME_MAX_LENGTH];
+    strNCpy(originalName, systemPtr->textures[systemPtr->aliasOf[aliasID]].name, FILENAME_MAX_LENGTH);
+    systemPtr->aliasOf[aliasID] = INVALID_ID;
+    systemPtr->contentHashes[aliasID] = 0;
+    // The data is still the original's, so loading mustn't destroy it.
+    t->data = 0;
+    FINFO("Texture %s no longer shares %s, loading its own.", t->name, originalName);
+    if (!loadTexture(t->name, t)){
+        FWARN("Couldn't load texture %s, it'll stay the default.", t->name);
+        t->generation = INVALID_ID;
+    }
+    // Let go of the references it held on the original.
+    for (u64 i = 0; i < t->refCnt; ++i){
+        textureSystemTextureRelease(originalName);
+    }
+}
+
+// Gets or creates a texture, from image if it's given or from its file otherwise.
+static texture* acquireTexture(const char* name, b8 autoDelete, resource* image, b8 async){
     if (isNameDefault(name)){
         FWARN("Cannot make texture with default name");
     }
@@ -82,24 +172,81 @@ texture* textureSystemTextureGetCreate(const char* name, b8 autoDelete){
     
 
     if (alreadyCreated){
+        FCOUNTER_INC("texture.cacheHits");
         FTRACE("CREATED TEX: %d", texID);
-        systemPtr->textures[texID].generation++;
+        // An alias keeps the texture it shares alive too.
+        if (systemPtr->aliasOf[texID] != INVALID_ID){
+            systemPtr->textures[systemPtr->aliasOf[texID]].refCnt++;
+        }
+        // One that's still loading has to stay at INVALID_ID so the default gets drawn.
+        if (systemPtr->textures[texID].generation != INVALID_ID){
+            systemPtr->textures[texID].generation++;
+        }
         systemPtr->textures[texID].refCnt++;
         return &systemPtr->textures[texID];
     }
 
     texture* t = &systemPtr->textures[texID];
-    
+
+    // Share the texture if another name already loaded the same bytes. Checked
+    // before loading, so the copy never gets decoded or uploaded.
+    u64 contentHash = 0;
+    if (resourceManagerHashesContent()){
+        if (image && image->contentHash){
+            contentHash = image->contentHash;
+        } else if (!vfsContentHash(name, &contentHash)){
+            contentHash = 0;
+        }
+        u32 originalID = findByContent(contentHash);
+        if (originalID != INVALID_ID){
+            // It gets its own slot so it can be split off again if either file changes.
+            fzeroMemory(t, sizeof(texture));
+            t->type = TEXTURE_TYPE_2D;
+            t->id = texID;
+            t->generation = INVALID_ID;
+            t->autoDelete = autoDelete;
+            t->refCnt = 1;
+            strNCpy(t->name, name, FILENAME_MAX_LENGTH);
+            systemPtr->aliasOf[texID] = originalID;
+            systemPtr->contentHashes[texID] = contentHash;
+            systemPtr->textures[originalID].refCnt++;
+            mirrorOriginal(texID);
+            // Its own file is watched, it can change without the original's changing.
+            char path[VFS_MAX_PATH];
+            if (vfsGetLoosePath(name, path)){
+                systemPtr->watchIDs[texID] = fileWatchAdd(path);
+            }
+            hashtableSet(&systemPtr->textureIDs, t->name, &texID);
+            FCOUNTER_INC("texture.dedupHits");
+            return t;
+        }
+    }
+
     t->type = TEXTURE_TYPE_2D;
-    if (!loadTexture(name, t)){
+    // Set before loading, loadTexture keeps them and watches the file under this id.
+    t->id = texID;
+    strNCpy(t->name, name, FILENAME_MAX_LENGTH);
+    FCOUNTER_INC("texture.loads");
+    b8 loaded;
+    if (async){
+        // The renderer draws the default for it until the image is in.
+        t->generation = INVALID_ID;
+        t->data = 0;
+        systemPtr->requestIDs[texID] = resourceLoadAsync(name, RESOURCE_TYPE_IMAGE, RESOURCE_PRIORITY_NORMAL, textureSystemOnImageLoaded, (void*)texID);
+        // Load it now if it couldn't be queued.
+        loaded = systemPtr->requestIDs[texID] != INVALID_ID || loadTexture(name, t);
+    } else {
+        loaded = image ? uploadTexture(t, image) : loadTexture(name, t);
+    }
+    if (!loaded){
         FERROR("Failed to load texture with name: %s from filesystem", name);
+        t->id = INVALID_ID;
         return 0;
     }
 
     t->autoDelete = autoDelete;
-    t->id = texID;
     t->refCnt = 1;
-    strNCpy(t->name, name, FILENAME_MAX_LENGTH);
+    systemPtr->contentHashes[texID] = contentHash;
     u64 id = texID;
     FTRACE("TexID: %u", texID);
     hashtableSet(&systemPtr->textureIDs, t->name, &texID);
@@ -107,6 +254,18 @@ texture* textureSystemTextureGetCreate(const char* name, b8 autoDelete){
     return t;
 }
 
+texture* textureSystemTextureGetCreate(const char* name, b8 autoDelete){
+    return acquireTexture(name, autoDelete, 0, false);
+}
+
+texture* textureSystemTextureGetCreateFromImage(const char* name, b8 autoDelete, resource* image){
+    return acquireTexture(name, autoDelete, image, false);
+}
+
+texture* textureSystemTextureGetCreateAsync(const char* name, b8 autoDelete){
+    return acquireTexture(name, autoDelete, 0, true);
+}
+
 void textureSystemTextureRelease(const char* name){
     if (isNameDefault(name)){
         FWARN("Cant release default textures.");
@@ -127,9 +286,31 @@ void textureSystemTextureRelease(const char* name){
     u64 dupID = texID;
 
     texture* t = &systemPtr->textures[dupID];
+    u32 originalID = systemPtr->aliasOf[dupID];
+    if (originalID != INVALID_ID){
+        // The name goes once nothing uses it, the texture it shares goes by its own count.
+        t->refCnt--;
+        if (t->refCnt <= 0){
+            systemPtr->aliasOf[dupID] = INVALID_ID;
+            systemPtr->contentHashes[dupID] = 0;
+            fileWatchRemove(systemPtr->watchIDs[dupID]);
+            systemPtr->watchIDs[dupID] = INVALID_ID;
+            // The data is the original's.
+            t->data = 0;
+            t->id = INVALID_ID;
+            hashtableClear(&systemPtr->textureIDs, nameDup);
+        }
+        textureSystemTextureRelease(systemPtr->textures[originalID].name);
+        return;
+    }
     t->refCnt--;
     if (t->refCnt <= 0 && t->autoDelete){
+        systemPtr->contentHashes[dupID] = 0;
+        resourceLoadCancel(systemPtr->requestIDs[dupID]);
+        systemPtr->requestIDs[dupID] = INVALID_ID;
         rendererDestroyTexture(t);
+        fileWatchRemove(systemPtr->watchIDs[dupID]);
+        systemPtr->watchIDs[dupID] = INVALID_ID;
         hashtableClear(&systemPtr->textureIDs, nameDup);
         FTRACE("Released Texture: %s", nameDup);
     }
@@ -186,12 +367,23 @@ char* extName(const char* name){
 
 b8 loadTexture(const char* textureName, texture* t) {
     resource res;
-    resourceLoad(textureName, RESOURCE_TYPE_IMAGE, &res);
+    if (!resourceLoad(textureName, RESOURCE_TYPE_IMAGE, &res)){
+        return false;
+    }
+    b8 result = uploadTexture(t, &res);
+
+    // Clean up data.
+    resourceUnload(&res);
+    return result;
+}
 
-    imageRS* irs = res.data;
+// Creates the GPU side of a texture from a loaded image, replacing whatever t had.
+static b8 uploadTexture(texture* t, resource* image){
+    imageRS* irs = image->data;
 
     // Use a temporary texture to load into.
     texture temp;
+    fzeroMemory(&temp, sizeof(texture));
     temp.width = irs->width;
     temp.height = irs->height;
     temp.channelCnt = irs->channelCnt;
@@ -216,6 +408,12 @@ b8 loadTexture(const char* textureName, texture* t) {
     // Acquire internal texture resources and upload to GPU.
     rendererCreateTexture(irs->pixels, &temp);
 
+    // A reload is still the same texture to everything using it.
+    temp.id = t->id;
+    temp.type = t->type;
+    temp.refCnt = t->refCnt;
+    strNCpy(temp.name, t->name, FILENAME_MAX_LENGTH);
+
     // Take a copy of the old texture.
     texture old = *t;
 
@@ -225,13 +423,81 @@ b8 loadTexture(const char* textureName, texture* t) {
     // Destroy the old texture.
     rendererDestroyTexture(&old);
 
-    t->generation = 0;
+    // A new generation makes the renderer rewrite descriptors that use it.
+    t->generation = old.generation == INVALID_ID ? 0 : old.generation + 1;
 
-    // Clean up data.
-    resourceUnload(&res);
+    // Watch loose files so edits show up without a restart. Archive entries
+    // aren't files on disk.
+    u32 idx = t->id;
+    if (idx < systemPtr->settings.maxTextureCnt && systemPtr->watchIDs[idx] == INVALID_ID && fsExists(image->fullPath)){
+        systemPtr->watchIDs[idx] = fileWatchAdd(image->fullPath);
+    }
+    // A reload can change what it matches.
+    if (idx < systemPtr->settings.maxTextureCnt && image->contentHash){
+        systemPtr->contentHashes[idx] = image->contentHash;
+    }
     return true;
 }
 
+// Swaps the default out for the real image once an async load finishes.
+static void textureSystemOnImageLoaded(void* userData, b8 success, resource* res){
+    u64 texID = (u64)userData;
+    texture* t = &systemPtr->textures[texID];
+    systemPtr->requestIDs[texID] = INVALID_ID;
+    if (!success || !uploadTexture(t, res)){
+        FWARN("Failed to load texture %s, it'll stay the default.", t->name);
+        return;
+    }
+    // Names that found it while it was loading get its data now too.
+    for (u32 i = 0; i < systemPtr->settings.maxTextureCnt; ++i){
+        if (systemPtr->aliasOf[i] == texID){
+            mirrorOriginal(i);
+        }
+    }
+}
+
+// Reloads a texture in place when its file changes.
+static b8 textureSystemOnFileChanged(u16 code, void* sender, void* listenerInst, eventContext context){
+    u32 watchID = context.data.u32[0];
+    for (u64 i = 0; i < systemPtr->settings.maxTextureCnt; ++i){
+        if (systemPtr->watchIDs[i] != watchID){
+            continue;
+        }
+        texture* t = &systemPtr->textures[i];
+        if (code == EVENT_CODE_WATCHED_FILE_DELETED){
+            // Another mount might still have it, like the archive the loose
+            // files are mounted over in debug builds.
+            vfsInvalidate();
+            if (!vfsExists(t->name)){
+                FWARN("Texture %s was deleted, keeping what's loaded.", t->name);
+                return true;
+            }
+        }
+        // The hash the VFS has is of what the file used to have.
+        vfsForgetContentHash(t->name);
+        if (systemPtr->aliasOf[i] != INVALID_ID){
+            breakAlias((u32)i);
+            return true;
+        }
+        // Names sharing it keep what's in their own files.
+        for (u32 j = 0; j < systemPtr->settings.maxTextureCnt; ++j){
+            if (systemPtr->aliasOf[j] == i){
+                breakAlias(j);
+            }
+        }
+        // Nothing's left using it if only the aliases were.
+        if (systemPtr->watchIDs[i] != watchID){
+            return true;
+        }
+        FINFO("Reloading texture %s.", t->name);
+        if (!loadTexture(t->name, t)){
+            FWARN("Couldn't reload texture %s, keeping what's loaded.", t->name);
+        }
+        return true;
+    }
+    return false;
+}
+
 texture* textureSystemGetDefault(){
     return &systemPtr->defaultTexture;
 }
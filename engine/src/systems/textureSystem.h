@@ -18,6 +18,24 @@ typedef struct textureInfo {
 void textureSystemInit(u64* memoryRequirement, void* state, textureSystemSettings settings);
 void textureSystemShutdown(void* state);
 texture* textureSystemTextureGetCreate(const char* name, b8 autoDelete);
+/**
+ * @brief Gets a texture, creating it from an image that's already loaded if it
+ * doesn't exist yet. Lets images get decoded off the main thread.
+ * @param name The texture's name
+ * @param autoDelete Whether it gets destroyed once it's released by everything
+ * @param image The image from resourceLoad with RESOURCE_TYPE_IMAGE. The caller still unloads it
+ * @returns The texture, or 0 if it couldn't be created
+ */
+texture* textureSystemTextureGetCreateFromImage(const char* name, b8 autoDelete, resource* image);
+/**
+ * @brief Gets a texture, loading its image on the job system if it doesn't
+ * exist yet. Until the image is in, its generation stays INVALID_ID and the
+ * default texture gets drawn in its place.
+ * @param name The texture's name
+ * @param autoDelete Whether it gets destroyed once it's released by everything
+ * @returns The texture
+ */
+texture* textureSystemTextureGetCreateAsync(const char* name, b8 autoDelete);
 texture* textureSystemTextureGet(const char* name, b8 autoDelete);
 void textureSystemTextureRelease(const char* name);
 b8 textureSystemCreateDefault();
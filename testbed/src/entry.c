@@ -10,6 +10,11 @@ b8 createGame(game* outGame) {
     outGame->appConfig.startWidth = 1280;
     outGame->appConfig.startHeight = 720;
     outGame->appConfig.name = "Fusion Engine Testbed";
+    outGame->appConfig.targetFrameRate = 60;
+    outGame->appConfig.fixedUpdateRate = 60;
+    outGame->appConfig.maxUpdateSteps = 5;
+    outGame->appConfig.frameStatsPath = "frameStats.csv";
+    outGame->appConfig.preloadManifest = "testbed.fpre";
     // Assign the functions that users will be able to use.
     outGame->update = gameUpdate;
     outGame->render = gameRender;
@@ -19,7 +19,7 @@ b8 gameUpdate(game* gameInst, f32 deltaTime) {
     return true;
 }
 
-b8 gameRender(game* gameInst, f32 deltaTime) {
+b8 gameRender(game* gameInst, f32 deltaTime, f32 alpha) {
     return true;
 }
 
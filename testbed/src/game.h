@@ -11,6 +11,6 @@ b8 gameInitialize(game* gameInst);
 
 b8 gameUpdate(game* gameInst, f32 deltaTime);
 
-b8 gameRender(game* gameInst, f32 deltaTime);
+b8 gameRender(game* gameInst, f32 deltaTime, f32 alpha);
 
 void gameOnResize(game* gameInst, u32 width, u32 height);
\ No newline at end of file
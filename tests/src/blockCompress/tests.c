@@ -0,0 +1,118 @@
+#include <core/fmemory.h>
+#include <helpers/blockCompress.h>
+#include "../testManager.h"
+#include "../shouldBe.h"
+
+#include <string.h>
+
+#define TEST_DATA_SIZE 100000
+
+// Repeating pixels with some noise, like a decoded texture.
+static void fillPixels(u8* data, u64 size) {
+    u32 seed = 1234;
+    for (u64 i = 0; i < size; ++i) {
+        seed = seed * 1103515245 + 12345;
+        data[i] = (seed >> 16) % 16 == 0 ? (u8)(seed >> 8) : (u8)(i % 4 * 60);
+    }
+}
+
+static void fillNoise(u8* data, u64 size) {
+    u32 seed = 99;
+    for (u64 i = 0; i < size; ++i) {
+        seed = seed * 1103515245 + 12345;
+        data[i] = (u8)(seed >> 16);
+    }
+}
+
+static u8 roundTrip(void (*fill)(u8*, u64), b8 shouldShrink) {
+    u64 bound = blockCompressBound(TEST_DATA_SIZE);
+    u8* src = fallocate(TEST_DATA_SIZE, MEMORY_TAG_ARRAY);
+    u8* compressed = fallocate(bound, MEMORY_TAG_ARRAY);
+    u8* dst = fallocate(TEST_DATA_SIZE, MEMORY_TAG_ARRAY);
+    fill(src, TEST_DATA_SIZE);
+
+    u64 compressedSize = blockCompress(src, TEST_DATA_SIZE, compressed, bound);
+    should_not_be(0, compressedSize);
+    should_be(shouldShrink, (compressedSize < TEST_DATA_SIZE / 2));
+    should_be_true(blockDecompress(compressed, compressedSize, dst, TEST_DATA_SIZE));
+    should_be(0, memcmp(src, dst, TEST_DATA_SIZE));
+
+    ffree(src, TEST_DATA_SIZE, MEMORY_TAG_ARRAY);
+    ffree(compressed, bound, MEMORY_TAG_ARRAY);
+    ffree(dst, TEST_DATA_SIZE, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+u8 blockCompressRoundTrip() {
+    return roundTrip(fillPixels, true);
+}
+
+u8 blockCompressIncompressible() {
+    return roundTrip(fillNoise, false);
+}
+
+u8 blockCompressEmpty() {
+    u8 compressed[16];
+    u64 compressedSize = blockCompress(0, 0, compressed, sizeof(compressed));
+    should_be(1, compressedSize);
+    should_be_true(blockDecompress(compressed, compressedSize, 0, 0));
+    return true;
+}
+
+u8 blockCompressStreamed() {
+    u64 bound = blockCompressBound(TEST_DATA_SIZE);
+    u8* src = fallocate(TEST_DATA_SIZE, MEMORY_TAG_ARRAY);
+    u8* compressed = fallocate(bound, MEMORY_TAG_ARRAY);
+    u8* dst = fallocate(TEST_DATA_SIZE, MEMORY_TAG_ARRAY);
+    fillPixels(src, TEST_DATA_SIZE);
+    u64 compressedSize = blockCompress(src, TEST_DATA_SIZE, compressed, bound);
+
+    // Pieces that split sequences in every possible place.
+    blockDecoder decoder;
+    blockDecoderBegin(&decoder, dst, TEST_DATA_SIZE);
+    blockDecoderResult result = BLOCK_DECODER_NEED_INPUT;
+    u64 pos = 0;
+    for (u64 piece = 1; pos < compressedSize; piece = piece % 37 + 1) {
+        u64 n = compressedSize - pos < piece ? compressedSize - pos : piece;
+        result = blockDecoderUpdate(&decoder, compressed + pos, n);
+        pos += n;
+        if (pos < compressedSize) {
+            should_be(BLOCK_DECODER_NEED_INPUT, result);
+        }
+    }
+    should_be(BLOCK_DECODER_DONE, result);
+    should_be(0, memcmp(src, dst, TEST_DATA_SIZE));
+
+    ffree(src, TEST_DATA_SIZE, MEMORY_TAG_ARRAY);
+    ffree(compressed, bound, MEMORY_TAG_ARRAY);
+    ffree(dst, TEST_DATA_SIZE, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+u8 blockCompressRejectsCorrupt() {
+    u64 bound = blockCompressBound(TEST_DATA_SIZE);
+    u8* src = fallocate(TEST_DATA_SIZE, MEMORY_TAG_ARRAY);
+    u8* compressed = fallocate(bound, MEMORY_TAG_ARRAY);
+    u8* dst = fallocate(TEST_DATA_SIZE, MEMORY_TAG_ARRAY);
+    fillPixels(src, TEST_DATA_SIZE);
+    u64 compressedSize = blockCompress(src, TEST_DATA_SIZE, compressed, bound);
+
+    // Truncated, the wrong size, and a match reaching before the start.
+    should_be(false, blockDecompress(compressed, compressedSize - 1, dst, TEST_DATA_SIZE));
+    should_be(false, blockDecompress(compressed, compressedSize, dst, TEST_DATA_SIZE - 1));
+    u8 badOffset[] = {0x10, 'a', 0xFF, 0x00, 0x00};
+    should_be(false, blockDecompress(badOffset, sizeof(badOffset), dst, 8));
+
+    ffree(src, TEST_DATA_SIZE, MEMORY_TAG_ARRAY);
+    ffree(compressed, bound, MEMORY_TAG_ARRAY);
+    ffree(dst, TEST_DATA_SIZE, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+void blockCompressRegisterTests() {
+    testMgrRegisterTest(blockCompressRoundTrip, "Block compress round trips and shrinks repetitive data.");
+    testMgrRegisterTest(blockCompressIncompressible, "Block compress round trips incompressible data.");
+    testMgrRegisterTest(blockCompressEmpty, "Block compress handles empty input.");
+    testMgrRegisterTest(blockCompressStreamed, "Block decoder decodes a block fed in small pieces.");
+    testMgrRegisterTest(blockCompressRejectsCorrupt, "Block decompress rejects corrupt blocks.");
+}
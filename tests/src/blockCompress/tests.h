@@ -0,0 +1,3 @@
+#pragma once
+
+void blockCompressRegisterTests();
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include <core/fmemory.h>
+#include <platform/filesystem.h>
+#include "../testManager.h"
+#include "../shouldBe.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_FILE "fsAsyncTest.bin"
+#define TEST_FILE_SIZE 200000
+#define TEST_READ_SIZE 4096
+#define TEST_READ_CNT 32
+
+typedef struct readResult {
+    b8 called;
+    b8 success;
+    u64 bytesRead;
+} readResult;
+
+static void onRead(void* userData, b8 success, u64 bytesRead) {
+    readResult* r = userData;
+    r->called = true;
+    r->success = success;
+    r->bytesRead = bytesRead;
+}
+
+static u8* writeTestFile() {
+    u8* data = fallocate(TEST_FILE_SIZE, MEMORY_TAG_ARRAY);
+    u32 seed = 42;
+    for (u64 i = 0; i < TEST_FILE_SIZE; ++i) {
+        seed = seed * 1103515245 + 12345;
+        data[i] = (u8)(seed >> 16);
+    }
+    fileHandle fh;
+    u64 written = 0;
+    if (fsOpen(TEST_FILE, FILE_MODE_WRITE, true, &fh)) {
+        fsWrite(&fh, TEST_FILE_SIZE, data, &written);
+        fsClose(&fh);
+    }
+    return data;
+}
+
+u8 fsAsyncBatchedReads() {
+    u8* expected = writeTestFile();
+    fileHandle fh;
+    should_be_true(fsOpen(TEST_FILE, FILE_MODE_READ, true, &fh));
+
+    fsAsyncQueue queue;
+    should_be_true(fsAsyncQueueCreate(TEST_READ_CNT, &queue));
+    u8* buffers = fallocate(TEST_READ_SIZE * TEST_READ_CNT, MEMORY_TAG_ARRAY);
+    readResult results[TEST_READ_CNT] = {};
+    // Spread out backwards, so they don't line up with how the file was written.
+    for (u32 i = 0; i < TEST_READ_CNT; ++i) {
+        u64 offset = (u64)(TEST_READ_CNT - 1 - i) * 6007;
+        should_be_true(fsReadAsync(&queue, &fh, offset, TEST_READ_SIZE, buffers + i * TEST_READ_SIZE, onRead, &results[i]));
+    }
+    // The queue is full until something finishes.
+    should_be(false, fsReadAsync(&queue, &fh, 0, 1, buffers, onRead, 0));
+    should_be(TEST_READ_CNT, fsAsyncSubmit(&queue));
+    while (fsAsyncPendingCount(&queue)) {
+        fsAsyncPoll(&queue, true);
+    }
+
+    for (u32 i = 0; i < TEST_READ_CNT; ++i) {
+        u64 offset = (u64)(TEST_READ_CNT - 1 - i) * 6007;
+        should_be_true(results[i].called);
+        should_be_true(results[i].success);
+        should_be(TEST_READ_SIZE, results[i].bytesRead);
+        should_be(0, memcmp(buffers + i * TEST_READ_SIZE, expected + offset, TEST_READ_SIZE));
+    }
+
+    fsAsyncQueueDestroy(&queue);
+    fsClose(&fh);
+    remove(TEST_FILE);
+    ffree(buffers, TEST_READ_SIZE * TEST_READ_CNT, MEMORY_TAG_ARRAY);
+    ffree(expected, TEST_FILE_SIZE, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+u8 fsAsyncShortReadAtEnd() {
+    u8* expected = writeTestFile();
+    fileHandle fh;
+    should_be_true(fsOpen(TEST_FILE, FILE_MODE_READ, true, &fh));
+
+    fsAsyncQueue queue;
+    should_be_true(fsAsyncQueueCreate(4, &queue));
+    u8 buffer[TEST_READ_SIZE];
+    readResult tail = {};
+    readResult past = {};
+    should_be_true(fsReadAsync(&queue, &fh, TEST_FILE_SIZE - 100, TEST_READ_SIZE, buffer, onRead, &tail));
+    u8 pastBuffer[16];
+    should_be_true(fsReadAsync(&queue, &fh, TEST_FILE_SIZE + 100, sizeof(pastBuffer), pastBuffer, onRead, &past));
+    while (fsAsyncPendingCount(&queue)) {
+        fsAsyncPoll(&queue, true);
+    }
+
+    should_be_true(tail.success);
+    should_be(100, tail.bytesRead);
+    should_be(0, memcmp(buffer, expected + TEST_FILE_SIZE - 100, 100));
+    should_be_true(past.success);
+    should_be(0, past.bytesRead);
+
+    fsAsyncQueueDestroy(&queue);
+    fsClose(&fh);
+    remove(TEST_FILE);
+    ffree(expected, TEST_FILE_SIZE, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+void filesystemAsyncRegisterTests() {
+    testMgrRegisterTest(fsAsyncBatchedReads, "Async reads submitted in one batch all land in the right place.");
+    testMgrRegisterTest(fsAsyncShortReadAtEnd, "Async reads past the end of a file come up short.");
+}
@@ -1,3 +1,4 @@
+#include <core/fmemory.h>
 #include <core/linearAllocator.h>
 #include "../testManager.h"
 #include "../shouldBe.h"
@@ -96,10 +97,40 @@ u8 linearAllocAllocReset() {
     return true;
 }
 
+#define PERF_ALLOC_CNT 1000
+
+static linearAllocator perfAlloc;
+static void* perfBlocks[PERF_ALLOC_CNT];
+
+static void linearAllocPerfWork() {
+    linearAllocReset(&perfAlloc);
+    for (u32 i = 0; i < PERF_ALLOC_CNT; ++i) {
+        perfBlocks[i] = linearAllocAllocate(&perfAlloc, 64);
+    }
+}
+
+static void fallocatePerfWork() {
+    for (u32 i = 0; i < PERF_ALLOC_CNT; ++i) {
+        perfBlocks[i] = fallocate(64, MEMORY_TAG_ALLOCATORS);
+    }
+    for (u32 i = 0; i < PERF_ALLOC_CNT; ++i) {
+        ffree(perfBlocks[i], 64, MEMORY_TAG_ALLOCATORS);
+    }
+}
+
+u8 linearAllocFasterThanFallocate() {
+    linearAllocCreate(64 * PERF_ALLOC_CNT, &perfAlloc);
+    should_be_faster_than(linearAllocPerfWork, fallocatePerfWork, 50);
+    linearAllocDestroy(&perfAlloc);
+    return true;
+}
+
 void linearAllocRegisterTests(){
     testMgrRegisterTest(linearAllocCreateDestory,"Linear Allocator Create & Destroy");
     testMgrRegisterTest(linearAllocAllSpace, "Linear allocator alloc all space");
     testMgrRegisterTest(linearAllocMultipleAllSpace, "Linear allocator multiple allocations for all space");
     testMgrRegisterTest(linearAllocOverflow, "Linear allocator intentional overflow.");
     testMgrRegisterTest(linearAllocAllocReset, "Linear allocator Allocate then reset then allocate again then destroy.");
+    testMgrRegisterTimedTest(linearAllocMultipleAllSpace, "Linear allocator multiple allocations stays under budget.", 0.5, 100);
+    testMgrRegisterTest(linearAllocFasterThanFallocate, "Linear allocator is faster than fallocate/ffree.");
 }
@@ -1,19 +1,34 @@
 #include "testManager.h"
 
 #include "linearAllocator/tests.h"
+#include "blockCompress/tests.h"
+#include "filesystemAsync/tests.h"
+#include "resourceAsync/tests.h"
+#include "resourceDedup/tests.h"
 
+#include <core/fmemory.h>
 #include <core/logger.h>
 
 int main() {
+    // The allocators under test get their memory from fallocate.
+    memorySystemSettings memSettings;
+    memSettings.totalSize = MEBIBYTES(64);
+    memoryInit(memSettings);
+
     // Always initalize the test manager first.
     testMgrInit();
 
     // TODO: add test registrations here.
     linearAllocRegisterTests();
+    blockCompressRegisterTests();
+    filesystemAsyncRegisterTests();
+    resourceAsyncRegisterTests();
+    resourceDedupRegisterTests();
 
     FDEBUG("Starting tests...");
 
     testMgrRunTests();
 
+    memoryShutdown();
     return 0;
 }
@@ -0,0 +1,113 @@
+#include <core/fmemory.h>
+#include <resources/resourceManager.h>
+#include <resources/vfs.h>
+#include "../testManager.h"
+#include "../shouldBe.h"
+
+#include <string.h>
+
+static const char testData[] = "async resource test data";
+
+typedef struct loadResult {
+    u32 calls;
+    b8 success;
+    b8 matches;
+} loadResult;
+
+static void onLoaded(void* userData, b8 success, resource* res) {
+    loadResult* r = userData;
+    r->calls++;
+    r->success = success;
+    r->matches = success && res->dataSize == sizeof(testData) - 1 && memcmp(res->data, testData, res->dataSize) == 0;
+}
+
+typedef struct testSystems {
+    void* vfsState;
+    u64 vfsSize;
+    void* resourceState;
+    u64 resourceSize;
+} testSystems;
+
+static void startSystems(testSystems* s) {
+    static const vfsMemoryFile files[] = {{"test.bin", testData, sizeof(testData) - 1}};
+    vfsConfig vfsSettings = {};
+    vfsInit(&s->vfsSize, 0, vfsSettings);
+    s->vfsState = fallocate(s->vfsSize, MEMORY_TAG_RESOURCE);
+    vfsInit(&s->vfsSize, s->vfsState, vfsSettings);
+    vfsMountMemory(files, 1);
+
+    resourceManagerSettings resourceSettings = {};
+    resourceSettings.maxManagers = 32;
+    resourceManagerInit(&s->resourceSize, 0, resourceSettings);
+    s->resourceState = fallocate(s->resourceSize, MEMORY_TAG_RESOURCE);
+    resourceManagerInit(&s->resourceSize, s->resourceState, resourceSettings);
+}
+
+static void stopSystems(testSystems* s) {
+    resourceManagerShutdown(s->resourceState);
+    vfsShutdown(s->vfsState);
+    ffree(s->resourceState, s->resourceSize, MEMORY_TAG_RESOURCE);
+    ffree(s->vfsState, s->vfsSize, MEMORY_TAG_RESOURCE);
+}
+
+u8 resourceAsyncSharesLoads() {
+    testSystems s;
+    startSystems(&s);
+    loadResult first = {};
+    loadResult second = {};
+    should_not_be(INVALID_ID, resourceLoadAsync("test.bin", RESOURCE_TYPE_BINARY, RESOURCE_PRIORITY_NORMAL, onLoaded, &first));
+    should_not_be(INVALID_ID, resourceLoadAsync("test.bin", RESOURCE_TYPE_BINARY, RESOURCE_PRIORITY_HIGH, onLoaded, &second));
+    // Both wait on the same load, and nothing's called back until the update.
+    should_be(1, resourceLoadAsyncPendingCount());
+    should_be(0, first.calls);
+    while (resourceLoadAsyncPendingCount()) {
+        resourceManagerUpdate();
+    }
+    should_be(1, first.calls);
+    should_be(1, second.calls);
+    should_be_true(first.matches);
+    should_be_true(second.matches);
+
+    loadResult missing = {};
+    should_not_be(INVALID_ID, resourceLoadAsync("missing.bin", RESOURCE_TYPE_BINARY, RESOURCE_PRIORITY_LOW, onLoaded, &missing));
+    while (resourceLoadAsyncPendingCount()) {
+        resourceManagerUpdate();
+    }
+    should_be(1, missing.calls);
+    should_be(false, missing.success);
+    stopSystems(&s);
+    return true;
+}
+
+u8 resourceAsyncCancel() {
+    testSystems s;
+    startSystems(&s);
+    loadResult kept = {};
+    loadResult cancelled = {};
+    u32 keptHandle = resourceLoadAsync("test.bin", RESOURCE_TYPE_BINARY, RESOURCE_PRIORITY_NORMAL, onLoaded, &kept);
+    u32 cancelledHandle = resourceLoadAsync("test.bin", RESOURCE_TYPE_BINARY, RESOURCE_PRIORITY_NORMAL, onLoaded, &cancelled);
+    should_be_true(resourceLoadCancel(cancelledHandle));
+    should_be(false, resourceLoadCancel(cancelledHandle));
+    while (resourceLoadAsyncPendingCount()) {
+        resourceManagerUpdate();
+    }
+    should_be(1, kept.calls);
+    should_be(0, cancelled.calls);
+    // It's done, so there's nothing left to cancel.
+    should_be(false, resourceLoadCancel(keptHandle));
+
+    // Cancelling the only waiter still lets the load finish and get cleaned up.
+    u32 onlyHandle = resourceLoadAsync("test.bin", RESOURCE_TYPE_BINARY, RESOURCE_PRIORITY_NORMAL, onLoaded, &cancelled);
+    should_be_true(resourceLoadCancel(onlyHandle));
+    while (resourceLoadAsyncPendingCount()) {
+        resourceManagerUpdate();
+    }
+    should_be(0, cancelled.calls);
+    stopSystems(&s);
+    return true;
+}
+
+void resourceAsyncRegisterTests() {
+    testMgrRegisterTest(resourceAsyncSharesLoads, "Async loads of the same resource share one load and all get called back.");
+    testMgrRegisterTest(resourceAsyncCancel, "Cancelled async loads never get called back.");
+}
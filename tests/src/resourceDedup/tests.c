@@ -0,0 +1,70 @@
+#include <core/fmemory.h>
+#include <resources/resourceManager.h>
+#include <resources/vfs.h>
+#include "../testManager.h"
+#include "../shouldBe.h"
+
+static const char original[] = "the same bytes under two names";
+static const char copy[] = "the same bytes under two names";
+static const char other[] = "different bytes, the same size";
+
+u8 resourceDedupSharesCopies() {
+    static const vfsMemoryFile files[] = {
+        {"textures/a.bin", original, sizeof(original) - 1},
+        {"other/path/b.bin", copy, sizeof(copy) - 1},
+        {"c.bin", other, sizeof(other) - 1},
+    };
+    vfsConfig vfsSettings = {};
+    u64 vfsSize = 0;
+    vfsInit(&vfsSize, 0, vfsSettings);
+    void* vfsState = fallocate(vfsSize, MEMORY_TAG_RESOURCE);
+    vfsInit(&vfsSize, vfsState, vfsSettings);
+    vfsMountMemory(files, 3);
+
+    resourceManagerSettings resourceSettings = {};
+    resourceSettings.maxManagers = 32;
+    resourceSettings.hashContent = true;
+    u64 resourceSize = 0;
+    resourceManagerInit(&resourceSize, 0, resourceSettings);
+    void* resourceState = fallocate(resourceSize, MEMORY_TAG_RESOURCE);
+    resourceManagerInit(&resourceSize, resourceState, resourceSettings);
+
+    u64 hashA = 0;
+    u64 hashB = 0;
+    u64 hashC = 0;
+    should_be_true(vfsContentHash("textures/a.bin", &hashA));
+    should_be_true(vfsContentHash("other/path/b.bin", &hashB));
+    should_be_true(vfsContentHash("c.bin", &hashC));
+    should_be(hashA, hashB);
+    should_not_be(hashA, hashC);
+
+    resource a;
+    resource b;
+    resource c;
+    should_be_true(resourceLoad("textures/a.bin", RESOURCE_TYPE_BINARY_MAPPED, &a));
+    should_be_true(resourceLoad("other/path/b.bin", RESOURCE_TYPE_BINARY_MAPPED, &b));
+    should_be_true(resourceLoad("c.bin", RESOURCE_TYPE_BINARY_MAPPED, &c));
+    should_be(hashA, a.contentHash);
+    should_be(a.data, b.data);
+    should_not_be(a.data, c.data);
+
+    // The copy keeps the shared data after the first one lets go of it.
+    resourceUnload(&a);
+    should_be((void*)original, b.data);
+    resourceUnload(&b);
+    resourceUnload(&c);
+
+    should_be_true(resourceLoad("other/path/b.bin", RESOURCE_TYPE_BINARY_MAPPED, &b));
+    should_be((void*)copy, b.data);
+    resourceUnload(&b);
+
+    resourceManagerShutdown(resourceState);
+    vfsShutdown(vfsState);
+    ffree(resourceState, resourceSize, MEMORY_TAG_RESOURCE);
+    ffree(vfsState, vfsSize, MEMORY_TAG_RESOURCE);
+    return true;
+}
+
+void resourceDedupRegisterTests() {
+    testMgrRegisterTest(resourceDedupSharesCopies, "Mapped binaries with the same bytes share one load whatever they're called.");
+}
@@ -44,4 +44,19 @@
     if (actual != false) {                                                             \
         FERROR("--> Expected false, but got: true. File: %s:%d.", __FILE__, __LINE__); \
         return false;                                                                  \
-    }
\ No newline at end of file
+    }
+
+/**
+ * @brief Expects func to run faster than reference. Both are PFN_testWork and
+ * the median of repeats runs each gets compared.
+ */
+#define should_be_faster_than(func, reference, repeats)                                                          \
+    {                                                                                                            \
+        f64 funcTime = testMgrMedianTime(func, repeats);                                                         \
+        f64 referenceTime = testMgrMedianTime(reference, repeats);                                               \
+        if (funcTime >= referenceTime) {                                                                         \
+            FERROR("--> Expected %s (%.3fus) to be faster than %s (%.3fus). File: %s:%d.", #func, funcTime * 1e6, \
+                   #reference, referenceTime * 1e6, __FILE__, __LINE__);                                          \
+            return false;                                                                                        \
+        }                                                                                                        \
+    }
@@ -1,41 +1,89 @@
 #include "testManager.h"
 
-#include <core/clock.h>
 #include <core/logger.h>
 #include <defines.h>
 #include <helpers/dinoArray.h>
+#include <helpers/sampleStats.h>
+#include <platform/platform.h>
 
 typedef struct test{
     PFN_test func;
     char* logOutput;
+    f64 budgetMs;
+    u32 repeats;
 } test;
 
 static test* tests;
 
+// The runner never calls platformStartup, so this uses the timestamp
+// counter rather than platformGetAbsoluteTime.
+static f64 secondsSince(u64 startNs){
+    return (f64)(platformGetTimestampNs() - startNs) / 1000000000.0;
+}
+
 void testMgrInit(){
     tests = dinoCreate(test);
 }
 
 void testMgrRegisterTest(u8 (*PFN_test)(), char* logOutput){
+    testMgrRegisterTimedTest(PFN_test, logOutput, 0, 1);
+}
+
+void testMgrRegisterTimedTest(u8 (*PFN_test)(), char* logOutput, f64 budgetMs, u32 repeats){
     test e;
     e.func = PFN_test;
     e.logOutput = logOutput;
+    e.budgetMs = budgetMs;
+    e.repeats = repeats ? repeats : 1;
 
     dinoPush(tests,e);
 }
 
+f64 testMgrMedianTime(PFN_testWork work, u32 repeats){
+    if (repeats == 0){
+        repeats = 1;
+    }
+    f64* samples = dinoCreateReserve(repeats, f64);
+    f64* sorted = dinoCreateReserve(repeats, f64);
+    for (u32 i = 0; i < repeats; ++i){
+        u64 startNs = platformGetTimestampNs();
+        work();
+        samples[i] = secondsSince(startNs);
+    }
+    sampleStats stats;
+    sampleStatsCompute(samples, repeats, sorted, &stats);
+    dinoDestroy(samples);
+    dinoDestroy(sorted);
+    return stats.p50;
+}
+
 void testMgrRunTests(){
     u32 success = 0;
     u32 failed = 0;
     u32 skipped = 0;
-    clock totalCnt;
-    //clockStart(&totalCnt);
+    u64 totalStartNs = platformGetTimestampNs();
     u32 len = dinoLength(tests);
     for (u32 i = 0; i < len; ++i){
-        clock testCnt;
-        //clockStart(&testCnt);
-        u8 res = tests[i].func();
-        //clockUpdate(&testCnt);
+        u32 repeats = tests[i].repeats;
+        f64* samples = dinoCreateReserve(repeats, f64);
+        f64* sorted = dinoCreateReserve(repeats, f64);
+        u8 res = 1;
+        u32 runs = 0;
+        while (runs < repeats && res == 1){
+            u64 testStartNs = platformGetTimestampNs();
+            res = tests[i].func();
+            samples[runs++] = secondsSince(testStartNs);
+        }
+        sampleStats stats;
+        sampleStatsCompute(samples, runs, sorted, &stats);
+        dinoDestroy(samples);
+        dinoDestroy(sorted);
+
+        if (res == 1 && tests[i].budgetMs > 0 && stats.p50 * 1000.0 > tests[i].budgetMs){
+            FERROR("[OVER BUDGET] %s took %.3fms, the budget is %.3fms.", tests[i].logOutput, stats.p50 * 1000.0, tests[i].budgetMs);
+            res = 0;
+        }
+
         if (res == 1){
             success++;
             FINFO("Test successful. %s", tests[i].logOutput);
@@ -47,9 +95,12 @@ void testMgrRunTests(){
             FERROR("[FAILED] Test failed. %s", tests[i].logOutput);
         }
 
-        //clockUpdate(&totalCnt);
-        FINFO("%i/%i | Successful: %i | Skipped: %i | Failed: %i | %f/%f elapsed", i + 1, len, success, skipped, failed, testCnt.elapsed, totalCnt.elapsed);
+        f64 totalElapsed = secondsSince(totalStartNs);
+        if (runs > 1){
+            FINFO("%i/%i | Successful: %i | Skipped: %i | Failed: %i | %u runs median %.3fms p95 %.3fms max %.3fms | %.6f elapsed", i + 1, len, success, skipped, failed, runs, stats.p50 * 1000.0, stats.p95 * 1000.0, stats.max * 1000.0, totalElapsed);
+        }else{
+            FINFO("%i/%i | Successful: %i | Skipped: %i | Failed: %i | %.3fms/%.6f elapsed", i + 1, len, success, skipped, failed, stats.p50 * 1000.0, totalElapsed);
+        }
     }
-    //clockUpdate(&totalCnt);
-    FINFO("Successful: %i | Skipped: %i | Failed: %i | %.6f elapsed", success, skipped, failed, totalCnt.elapsed);
+    FINFO("Successful: %i | Skipped: %i | Failed: %i | %.6f elapsed", success, skipped, failed, secondsSince(totalStartNs));
 }
\ No newline at end of file
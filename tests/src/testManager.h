@@ -6,8 +6,24 @@
 
 typedef u8 (*PFN_test)();
 
+/** @brief A chunk of work to time with testMgrMedianTime. */
+typedef void (*PFN_testWork)();
+
 void testMgrInit();
 
 void testMgrRegisterTest(PFN_test, char* logOutput);
 
-void testMgrRunTests();
\ No newline at end of file
+/**
+ * @brief Registers a test that gets run repeats times and timed.
+ * @param budgetMs Fails the test if its median time goes over this. 0 for no budget
+ * @param repeats How many times to run it. Stops at the first failed run
+ */
+void testMgrRegisterTimedTest(PFN_test, char* logOutput, f64 budgetMs, u32 repeats);
+
+/**
+ * @brief Runs work repeats times and gets the median time of a run.
+ * @returns The median time in seconds
+ */
+f64 testMgrMedianTime(PFN_testWork work, u32 repeats);
+
+void testMgrRunTests();
@@ -0,0 +1,191 @@
+#include <core/logFormat.h>
+#include <platform/filesystem.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Turns a binary log (.flog) written with FSN_LOG_BINARY back into text.
+// Usage: flogDecoder <in.flog> [out.log]
+
+typedef struct formatDef {
+    char* format;
+    u8 argCnt;
+    u8 kinds[LOG_FORMAT_MAX_ARGS];
+} formatDef;
+
+static const char* levelStr[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]:  ", "[INFO]:  ", "[DEBUG]: ", "[TRACE]: "};
+
+typedef struct reader {
+    const u8* data;
+    u64 size;
+    u64 pos;
+} reader;
+
+static b8 readBytes(reader* r, void* out, u64 size){
+    if (r->pos + size > r->size){
+        return false;
+    }
+    memcpy(out, r->data + r->pos, size);
+    r->pos += size;
+    return true;
+}
+
+static const u8* skipBytes(reader* r, u64 size){
+    if (r->pos + size > r->size){
+        return 0;
+    }
+    const u8* p = r->data + r->pos;
+    r->pos += size;
+    return p;
+}
+
+static void writeLine(FILE* out, u64 timestamp, u64 firstTimestamp, u8 level, const char* text, u64 len){
+    f64 secs = (f64)(timestamp - firstTimestamp) / 1000000000.0;
+    fprintf(out, "[%12.6f] %s%.*s\n", secs, level < 6 ? levelStr[level] : "[?????]: ", (int)len, text);
+}
+
+int main(int argc, char** argv){
+    if (argc < 2){
+        fprintf(stderr, "Usage: %s <in.flog> [out.log]\n", argv[0]);
+        return 1;
+    }
+
+    fileHandle fh;
+    if (!fsOpen(argv[1], FILE_MODE_READ, true, &fh)){
+        fprintf(stderr, "Couldn't open %s\n", argv[1]);
+        return 1;
+    }
+    u64 size = 0;
+    fsSize(&fh, &size);
+    u8* data = malloc(size);
+    u64 read = 0;
+    if (!fsReadFileBytes(&fh, data, &read)){
+        fprintf(stderr, "Couldn't read %s\n", argv[1]);
+        fsClose(&fh);
+        return 1;
+    }
+    fsClose(&fh);
+
+    FILE* out = stdout;
+    if (argc > 2){
+        out = fopen(argv[2], "w");
+        if (!out){
+            fprintf(stderr, "Couldn't open %s for writing\n", argv[2]);
+            return 1;
+        }
+    }
+
+    reader r = {data, read, 0};
+    u32 magic = 0;
+    u16 version = 0;
+    u16 reserved = 0;
+    if (!readBytes(&r, &magic, 4) || !readBytes(&r, &version, 2) || !readBytes(&r, &reserved, 2) ||
+        magic != FLOG_MAGIC){
+        fprintf(stderr, "%s isn't a flog file\n", argv[1]);
+        return 1;
+    }
+    if (version != FLOG_VERSION){
+        fprintf(stderr, "%s is version %u, only version %u is supported\n", argv[1], version, FLOG_VERSION);
+        return 1;
+    }
+
+    u32 formatCap = 256;
+    formatDef* formats = calloc(formatCap, sizeof(formatDef));
+    b8 haveFirst = false;
+    u64 firstTimestamp = 0;
+    char text[8192];
+    u64 recordCnt = 0;
+
+    while (r.pos < r.size){
+        u8 type = 0;
+        readBytes(&r, &type, 1);
+        if (type == FLOG_ENTRY_FORMAT){
+            u32 id = 0;
+            u8 argCnt = 0;
+            u16 len = 0;
+            u8 kinds[LOG_FORMAT_MAX_ARGS];
+            if (!readBytes(&r, &id, 4) || !readBytes(&r, &argCnt, 1) || argCnt > LOG_FORMAT_MAX_ARGS ||
+                !readBytes(&r, kinds, argCnt) || !readBytes(&r, &len, 2)){
+                break;
+            }
+            const u8* fmt = skipBytes(&r, len);
+            if (!fmt || id == 0){
+                break;
+            }
+            while (id > formatCap){
+                formats = realloc(formats, sizeof(formatDef) * formatCap * 2);
+                memset(formats + formatCap, 0, sizeof(formatDef) * formatCap);
+                formatCap *= 2;
+            }
+            formatDef* d = &formats[id - 1];
+            free(d->format);
+            d->format = malloc(len + 1);
+            memcpy(d->format, fmt, len);
+            d->format[len] = 0;
+            d->argCnt = argCnt;
+            memcpy(d->kinds, kinds, argCnt);
+        }else if (type == FLOG_ENTRY_RECORD){
+            u32 id = 0;
+            u8 level = 0;
+            u64 timestamp = 0;
+            u16 payloadSize = 0;
+            if (!readBytes(&r, &id, 4) || !readBytes(&r, &level, 1) || !readBytes(&r, &timestamp, 8) ||
+                !readBytes(&r, &payloadSize, 2)){
+                break;
+            }
+            const u8* payload = skipBytes(&r, payloadSize);
+            if (!payload){
+                break;
+            }
+            if (!haveFirst){
+                firstTimestamp = timestamp;
+                haveFirst = true;
+            }
+            if (id == 0 || id > formatCap || !formats[id - 1].format){
+                u64 len = snprintf(text, sizeof(text), "<unknown format %u>", id);
+                writeLine(out, timestamp, firstTimestamp, level, text, len);
+            }else{
+                formatDef* d = &formats[id - 1];
+                u64 len = logFormatDecode(d->format, d->kinds, d->argCnt, payload, payloadSize, text, sizeof(text));
+                writeLine(out, timestamp, firstTimestamp, level, text, len);
+            }
+            recordCnt++;
+        }else if (type == FLOG_ENTRY_TEXT){
+            u8 level = 0;
+            u64 timestamp = 0;
+            u16 len = 0;
+            if (!readBytes(&r, &level, 1) || !readBytes(&r, &timestamp, 8) || !readBytes(&r, &len, 2)){
+                break;
+            }
+            const u8* t = skipBytes(&r, len);
+            if (!t){
+                break;
+            }
+            if (!haveFirst){
+                firstTimestamp = timestamp;
+                haveFirst = true;
+            }
+            writeLine(out, timestamp, firstTimestamp, level, (const char*)t, len);
+            recordCnt++;
+        }else{
+            fprintf(stderr, "Unknown entry type %u at offset %llu\n", type, (unsigned long long)(r.pos - 1));
+            break;
+        }
+    }
+
+    if (r.pos < r.size){
+        fprintf(stderr, "Stopped early, %s looks truncated or corrupt\n", argv[1]);
+    }
+    fprintf(stderr, "Decoded %llu records\n", (unsigned long long)recordCnt);
+
+    if (out != stdout){
+        fclose(out);
+    }
+    for (u32 i = 0; i < formatCap; ++i){
+        free(formats[i].format);
+    }
+    free(formats);
+    free(data);
+    return 0;
+}
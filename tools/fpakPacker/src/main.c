@@ -0,0 +1,232 @@
+#include <helpers/blockCompress.h>
+#include <platform/filesystem.h>
+#include <resources/fpak.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+// Packs every file under a directory into one .fpak archive.
+// Usage: fpakPacker [-c] <assetDir> <out.fpak>
+// -c compresses entries that shrink by at least an eighth. Already compressed
+// formats like PNG and JPG won't, so they stay stored as is.
+
+typedef struct packFile {
+    // Path relative to the asset dir, using '/'.
+    char* name;
+    u64 nameHash;
+} packFile;
+
+typedef struct packList {
+    packFile* files;
+    u32 cnt;
+    u32 capacity;
+} packList;
+
+static void addFile(packList* list, const char* name){
+    if (list->cnt == list->capacity){
+        list->capacity = list->capacity ? list->capacity * 2 : 64;
+        list->files = realloc(list->files, sizeof(packFile) * list->capacity);
+    }
+    packFile* f = &list->files[list->cnt++];
+    f->name = strdup(name);
+    f->nameHash = fpakHashName(name, strlen(name));
+}
+
+// Adds every file under root/rel to the list.
+static b8 walk(const char* root, const char* rel, packList* list){
+    char dirPath[1024];
+    snprintf(dirPath, sizeof(dirPath), rel[0] ? "%s/%s" : "%s", root, rel);
+#ifdef _WIN32
+    char pattern[1024];
+    snprintf(pattern, sizeof(pattern), "%s/*", dirPath);
+    WIN32_FIND_DATAA fd;
+    HANDLE find = FindFirstFileA(pattern, &fd);
+    if (find == INVALID_HANDLE_VALUE){
+        fprintf(stderr, "Couldn't open directory %s\n", dirPath);
+        return false;
+    }
+    do {
+        const char* entryName = fd.cFileName;
+        b8 isDir = (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+    DIR* dir = opendir(dirPath);
+    if (!dir){
+        fprintf(stderr, "Couldn't open directory %s\n", dirPath);
+        return false;
+    }
+    struct dirent* ent;
+    while ((ent = readdir(dir))){
+        const char* entryName = ent->d_name;
+        char fullPath[1024];
+        snprintf(fullPath, sizeof(fullPath), "%s/%s", dirPath, entryName);
+        struct stat st;
+        if (stat(fullPath, &st) != 0){
+            continue;
+        }
+        b8 isDir = S_ISDIR(st.st_mode);
+#endif
+        if (strcmp(entryName, ".") == 0 || strcmp(entryName, "..") == 0){
+            continue;
+        }
+        char childRel[1024];
+        snprintf(childRel, sizeof(childRel), rel[0] ? "%s/%s" : "%s%s", rel, entryName);
+        if (isDir){
+            walk(root, childRel, list);
+        } else {
+            addFile(list, childRel);
+        }
+#ifdef _WIN32
+    } while (FindNextFileA(find, &fd));
+    FindClose(find);
+#else
+    }
+    closedir(dir);
+#endif
+    return true;
+}
+
+static int compareFiles(const void* a, const void* b){
+    const packFile* fa = a;
+    const packFile* fb = b;
+    if (fa->nameHash != fb->nameHash){
+        return fa->nameHash < fb->nameHash ? -1 : 1;
+    }
+    return strcmp(fa->name, fb->name);
+}
+
+static b8 padTo(FILE* out, u64 alignment){
+    static const u8 zeros[FPAK_ALIGNMENT] = {0};
+    long pos = ftell(out);
+    u64 pad = (alignment - ((u64)pos % alignment)) % alignment;
+    return fwrite(zeros, 1, pad, out) == pad;
+}
+
+int main(int argc, char** argv){
+    b8 compress = argc > 1 && strcmp(argv[1], "-c") == 0;
+    if (compress){
+        argv++;
+        argc--;
+    }
+    if (argc < 3){
+        fprintf(stderr, "Usage: %s [-c] <assetDir> <out.fpak>\n", argv[0]);
+        return 1;
+    }
+    const char* root = argv[1];
+
+    packList list = {0};
+    if (!walk(root, "", &list)){
+        return 1;
+    }
+    // The table of contents gets binary searched by hash.
+    qsort(list.files, list.cnt, sizeof(packFile), compareFiles);
+
+    FILE* out = fopen(argv[2], "wb");
+    if (!out){
+        fprintf(stderr, "Couldn't open %s for writing\n", argv[2]);
+        return 1;
+    }
+
+    fpakHeader header = {0};
+    header.magic = FPAK_MAGIC;
+    header.version = FPAK_VERSION;
+    header.entryCnt = list.cnt;
+    // Written again with the offsets once everything else is.
+    fwrite(&header, sizeof(header), 1, out);
+
+    fpakEntry* entries = calloc(list.cnt ? list.cnt : 1, sizeof(fpakEntry));
+    u64 namesSize = 0;
+    u64 totalSize = 0;
+    u64 storedSize = 0;
+    u32 compressedCnt = 0;
+    for (u32 i = 0; i < list.cnt; ++i){
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", root, list.files[i].name);
+        fileMapping mapping;
+        if (!fsMap(path, FILE_MAP_HINT_SEQUENTIAL, &mapping)){
+            fprintf(stderr, "Couldn't read %s\n", path);
+            fclose(out);
+            return 1;
+        }
+        padTo(out, FPAK_ALIGNMENT);
+
+        fpakEntry* e = &entries[i];
+        e->nameHash = list.files[i].nameHash;
+        e->offset = (u64)ftell(out);
+        e->rawSize = mapping.size;
+        e->nameOffset = (u32)namesSize;
+        e->nameLen = (u16)strlen(list.files[i].name);
+        e->compression = FPAK_COMPRESSION_NONE;
+        namesSize += e->nameLen;
+        totalSize += mapping.size;
+
+        const void* data = mapping.data;
+        u64 size = mapping.size;
+        u8* compressed = 0;
+        if (compress && mapping.size){
+            u64 bound = blockCompressBound(mapping.size);
+            compressed = malloc(bound);
+            u64 compressedSize = blockCompress(mapping.data, mapping.size, compressed, bound);
+            if (compressedSize && compressedSize <= mapping.size - mapping.size / 8){
+                data = compressed;
+                size = compressedSize;
+                e->compression = FPAK_COMPRESSION_LZ4;
+                compressedCnt++;
+            }
+        }
+        e->size = size;
+        e->checksum = fpakChecksum(data, size);
+        storedSize += size;
+
+        b8 written = size == 0 || fwrite(data, 1, size, out) == size;
+        free(compressed);
+        fsUnmap(&mapping);
+        if (!written){
+            fprintf(stderr, "Couldn't write %s\n", argv[2]);
+            fclose(out);
+            return 1;
+        }
+    }
+
+    padTo(out, sizeof(u64));
+    header.tocOffset = (u64)ftell(out);
+    header.namesOffset = header.tocOffset + sizeof(fpakEntry) * list.cnt;
+    header.namesSize = namesSize;
+
+    // The toc and names are checksummed as one block, so build it in one buffer.
+    u64 tocSize = sizeof(fpakEntry) * list.cnt;
+    u8* toc = malloc(tocSize + namesSize + 1);
+    memcpy(toc, entries, tocSize);
+    for (u32 i = 0; i < list.cnt; ++i){
+        memcpy(toc + tocSize + entries[i].nameOffset, list.files[i].name, entries[i].nameLen);
+    }
+    header.tocChecksum = fpakChecksum(toc, tocSize + namesSize);
+    fwrite(toc, 1, tocSize + namesSize, out);
+
+    fseek(out, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, out);
+    b8 ok = ferror(out) == 0;
+    fclose(out);
+    if (!ok){
+        fprintf(stderr, "Couldn't write %s\n", argv[2]);
+        return 1;
+    }
+
+    fprintf(stderr, "Packed %u files (%llu bytes, %llu stored, %u compressed) into %s\n", list.cnt,
+            (unsigned long long)totalSize, (unsigned long long)storedSize, compressedCnt, argv[2]);
+
+    for (u32 i = 0; i < list.cnt; ++i){
+        free(list.files[i].name);
+    }
+    free(list.files);
+    free(entries);
+    free(toc);
+    return 0;
+}